@@ -15,6 +15,9 @@
 #include "model.h"
 #include "vpoint.h"
 #include "actor.h"
+#include "edgetbl.h"
+#include "cpufeat.h"
+#include "lmap1.h"
 
 struct Model *MakeCubeModel(void)
 {	struct Model *pModel;
@@ -230,6 +233,145 @@ void TESTVPoint(void)
 	}
 }
 
+/* TESTFillers(),
+ * Draws two cubes in every rendermode, once with the plain C span
+ * fillers and once with each set of SIMD fillers the processor
+ * supports, and compares the bitmaps. Some faces are translucent so
+ * the blending fillers are compared as well. Returns the number of
+ * bitmaps that differ from the plain C one.
+ */
+int TESTFillers(void)
+{	static unsigned long arVariants[3] = { 0, CPUF_SSE2, CPUF_SSE2 | CPUF_AVX2 };
+	static char *arVariantNames[3] = { "C", "SSE2", "AVX2" };
+	static unsigned long arRGB[6] = { 0xFF0000, 0x00FF00, 0x0000FF,
+												 0xFFFF00, 0x00FFFF, 0x808080 };
+	static char *arModeNames[4] = { "TRUECOLOR_32", "INDEXED_8", "RGB565_16", "PACKED_24" };
+	struct Lightmap1 arLmaps[6];
+	struct Model *pModel;
+	struct Polygon *pPoly;
+	struct Viewpoint Vpoint;
+	struct Actor Actr;
+	struct Actor Actr2;
+	struct Vector Axis;
+	unsigned char *pBitmap, *pReference;
+	unsigned long ulFeatures;
+	int nWidth, nHeight, nBytes;
+	int nMode, nVariant, nFailed;
+	int n;
+
+	nWidth = 160;
+	nHeight = 120;
+	nFailed = 0;
+	pModel = MakeCubeModel();
+	pBitmap = (unsigned char *)malloc(nWidth * nHeight * 4);
+	pReference = (unsigned char *)malloc(nWidth * nHeight * 4);
+	if ((pModel == NULL) || (pBitmap == NULL) || (pReference == NULL))
+	{	printf("Out of memory.\n");
+		return 1;
+	}
+
+	/* Color the faces, every third one translucent. */
+	for (n = 0; n < 6; n++)
+	{	Lightmap1_ConstructM(&(arLmaps[n]));
+		arLmaps[n].ulRGB = arRGB[n];
+		arLmaps[n].nIndex = (unsigned char)(n + 1);
+	}
+	for (n = 0; n < pModel->Polygons.nCount; n++)
+	{	pPoly = &(pModel->Polygons.arPolygons[n]);
+		pPoly->nFlags = ((n % 3) == 0) ? PF_TRANSLUCENT : PF_STATICCOLOR;
+		pPoly->ulRGB = arRGB[n % 6];
+		pPoly->usRGB565 = (unsigned short)(((arRGB[n % 6] >> 8) & 0xF800) |
+													  ((arRGB[n % 6] >> 5) & 0x07E0) |
+													  ((arRGB[n % 6] >> 3) & 0x001F));
+		pPoly->pLightmap = (void *)&(arLmaps[n % 6]);
+	}
+
+	/* Two turned cubes, one partly in front of the other. */
+	Actor_ConstructM(&Actr);
+	Actor_ConstructM(&Actr2);
+	Actor_SetModel(&Actr, pModel);
+	Actor_SetModel(&Actr2, pModel);
+	Axis.V[0] = 1.f;  Axis.V[1] = 1.f;  Axis.V[2] = 0.f;
+	Transformation_MakeRotateArbitrary(&(Actr.ActorFrame.TransformationToParent), &Axis, 0.6f);
+	Actr.ActorFrame.TransformationToParent.Translation.V[2] = 60.f;
+	Axis.V[0] = 0.f;  Axis.V[1] = 1.f;  Axis.V[2] = 1.f;
+	Transformation_MakeRotateArbitrary(&(Actr2.ActorFrame.TransformationToParent), &Axis, 0.9f);
+	Actr2.ActorFrame.TransformationToParent.Translation.V[0] = 12.f;
+	Actr2.ActorFrame.TransformationToParent.Translation.V[1] = 6.f;
+	Actr2.ActorFrame.TransformationToParent.Translation.V[2] = 80.f;
+	Actr.pNext = &Actr2;
+
+	Viewpoint_ConstructM(&Vpoint);
+	Vpoint.nWidth = nWidth;
+	Vpoint.nHeight = nHeight;
+	Vpoint.nPixelRow = nWidth;
+	Vpoint.pBitmap = pBitmap;
+	Vpoint.fXFOV = (20.f / 180.f) * 3.141592654f;
+	Vpoint.fYFOV = (16.f / 180.f) * 3.141592654f;
+	if (!EdgeTable_AtLeast(&(Vpoint.PolyEdgeTable), nHeight))
+	{	printf("Out of memory.\n");
+		return 1;
+	}
+	Viewpoint_PrecalcM(&Vpoint);
+	Viewpoint_PrecalcFrustrum(&Vpoint);
+
+	ulFeatures = CpuFeatures_Get();
+	for (nMode = 0; nMode < 4; nMode++)
+	{	Viewpoint_SetRendermode(&Vpoint, (unsigned char)nMode);
+		nBytes = nWidth * nHeight * Viewpoint_GetPixelSizeM(&Vpoint);
+		for (nVariant = 0; nVariant < 3; nVariant++)
+		{	if ((arVariants[nVariant] & ulFeatures) != arVariants[nVariant])
+			{	printf("%s %s fillers: not supported, skipped.\n",
+						 arModeNames[nMode], arVariantNames[nVariant]);
+				continue;
+			}
+			EdgeTable_SelectFillers(arVariants[nVariant]);
+
+			/* Draw over a pattern, so blending has something to
+			 * blend with. */
+			for (n = 0; n < nBytes; n++)
+				pBitmap[n] = (unsigned char)(n * 7);
+			if (!Viewpoint_PrepActorsForDraw(&Vpoint, &Actr) ||
+				 !Viewpoint_Draw(&Vpoint))
+			{	printf("Failed to draw...\n");
+				nFailed++;
+				continue;
+			}
+
+			if (nVariant == 0)
+			{	for (n = 0; n < nBytes; n++)
+					pReference[n] = pBitmap[n];
+				printf("%s C fillers: drawn %d polygons.\n", arModeNames[nMode],
+						 (int)Viewpoint_GetStatsM(&Vpoint)->lPolygons);
+			} else
+			{	for (n = 0; (n < nBytes) && (pBitmap[n] == pReference[n]); n++)
+					;
+				if (n < nBytes)
+				{	printf("%s %s fillers: differ from C at byte %d!\n",
+							 arModeNames[nMode], arVariantNames[nVariant], n);
+					nFailed++;
+				} else
+					printf("%s %s fillers: identical to C.\n",
+							 arModeNames[nMode], arVariantNames[nVariant]);
+			}
+		}
+	}
+
+	/* Back to the fillers the processor supports. */
+	EdgeTable_SelectFillers(ulFeatures);
+
+	/* Done. */
+	Vpoint.pBitmap = NULL;
+	Viewpoint_DestructM(&Vpoint);
+	Actor_DestructM(&Actr);
+	Actor_DestructM(&Actr2);
+	Model_DestructM(pModel);
+	free(pModel);
+	free(pBitmap);
+	free(pReference);
+	return nFailed;
+}
+
 void TESTHPlaneCube(void)
 {
 	struct PolySet pset;
@@ -378,4 +520,11 @@ main()
 	/* Test viewpoint logic. */
 	printf("VIEWPOINT LOGIC\n");
 	TESTVPoint();
+
+	/* Test the SIMD span fillers against the plain C ones. */
+	printf("SPAN FILLERS\n");
+	if (TESTFillers())
+		printf("Span fillers differ!\n");
+	else
+		printf("All span fillers agree.\n");
 }	
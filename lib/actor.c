@@ -40,14 +40,11 @@ void Actor_Construct(struct Actor *pThis)
 	Frame_ConstructM(&(pThis->ActorFrame));
 	PlaneSet_ConstructM(&(pThis->ClippingPlanes));
 	ActorPtrSet_ConstructM(&(pThis->SubActorSet));
-	PolySet_ConstructM(&(pThis->ClippedPolySetA));
-	PolySet_ConstructM(&(pThis->ClippedPolySetB));
+	PolySet_ConstructM(&(pThis->ClippedPolySet));
+
+	pThis->nPolygonAlloc = 0;		/* Not prepared for display yet. */
+	pThis->arpPolygons = NULL;
 
-	pThis->pSrcPolySet = NULL;		/* No clipping process is running. */
-	pThis->pTrgPolySet = NULL;		/* No clipping process is running. */
-	
-	VertexSet_ConstructM(&(pThis->ClippedVertexSet));
-	
 	ScreenVertexSet_Construct(&(pThis->NormalScreenVertices));
 	ScreenVertexSet_Construct(&(pThis->ClippedScreenVertices));
 	Vector_ConstructM(&(pThis->ViewpointOrigin));
@@ -64,9 +61,9 @@ void Actor_Destruct(struct Actor *pThis)
 {
 	PlaneSet_DestructM(&(pThis->ClippingPlanes));
 	ActorPtrSet_DestructM(&(pThis->SubActorSet));
-	PolySet_DestructM(&(pThis->ClippedPolySetA));
-	PolySet_DestructM(&(pThis->ClippedPolySetB));
-	VertexSet_DestructM(&(pThis->ClippedVertexSet));
+	PolySet_DestructM(&(pThis->ClippedPolySet));
+	if (pThis->arpPolygons != NULL)
+		free((void *)pThis->arpPolygons);
 	ScreenVertexSet_Destruct(&(pThis->NormalScreenVertices));
 	ScreenVertexSet_Destruct(&(pThis->ClippedScreenVertices));
 }
@@ -158,6 +155,43 @@ int Actor_InsertActor(struct Actor *pThis, struct Actor *pActor)
 	}
 }
 
+/********************************************************************
+* Function : Actor_GetScreenVertex()
+* Purpose : Retrieves the ScreenVertex of a vertex of a polygon to
+*           display.
+* Pre : pThis points to an Actor prepared for drawing, pPoly to one of
+*       it's polygons to display, nVertex is the position of the vertex
+*       in pPoly and pTexSV points to a ScreenVertex structure.
+* Post : Returns the ScreenVertex of the vertex. For PF_TEXTURE
+*        polygons this is pTexSV, holding a copy of it with the
+*        texture coordinates of the polygon at the vertex (or 0,0 if
+*        it has none) in texels multiplied by fIZ.
+********************************************************************/
+struct ScreenVertex *Actor_GetScreenVertex(struct Actor *pThis,
+														 struct Polygon *pPoly,
+														 int nVertex,
+														 struct ScreenVertex *pTexSV)
+{
+	struct ScreenVertex *pSV;
+	int k;
+
+	k = IndexSet_GetIndexM(&(pPoly->Vertices), nVertex);
+	if (k < 0)
+		pSV = ScreenVertexSet_GetScreenVertexM(&(pThis->ClippedScreenVertices), ~k);
+	else
+		pSV = ScreenVertexSet_GetScreenVertexM(&(pThis->NormalScreenVertices), k);
+	if (pPoly->nFlags != PF_TEXTURE)
+		return pSV;
+
+	*pTexSV = *pSV;
+	if (FloatSet_GetCountM(&(pPoly->TexCoords)) != 0)
+	{	pTexSV->fUZ = FloatSet_GetFloatM(&(pPoly->TexCoords), 2 * nVertex) * 256.f * pSV->fIZ;
+		pTexSV->fVZ = FloatSet_GetFloatM(&(pPoly->TexCoords), 2 * nVertex + 1) * 256.f * pSV->fIZ;
+	} else
+		pTexSV->fUZ = pTexSV->fVZ = 0.f;
+	return pTexSV;
+}
+
 #ifdef DEBUGC
 /********************************************************************
 * Function : Actor_DumpScreenVertices() (DEBUG ONLY)
@@ -203,11 +237,11 @@ void Actor_DumpScreenPolygons(struct Actor *pThis)
 	struct ScreenVertex *pSV;
 	
 	/* Iterate all normal polygons. */
-	printf("Actor_DumpScreenPolygons() -> %d polygons.\n", PolySet_GetCountM(pThis->pSrcPolySet));
+	printf("Actor_DumpScreenPolygons() -> %d polygons.\n", PolySet_GetCountM(&(pThis->pModel->Polygons)));
 	
-	for (n = 0; n < PolySet_GetCountM(pThis->pSrcPolySet); n++)
+	for (n = 0; n < PolySet_GetCountM(&(pThis->pModel->Polygons)); n++)
 	{	/* Get current polygon. */
-		pPoly = PolySet_GetPolygonM(pThis->pSrcPolySet, n);
+		pPoly = Actor_GetPolygonM(pThis, n);
 		
 		/* Iterate all of the polygon's vertices. */
 		printf("\t# vertices = %d, color = %d ('%c')\n", IndexSet_GetCountM(&(pPoly->Vertices)), pPoly->nColor, pPoly->nColor);
@@ -86,36 +86,22 @@ struct Actor
 	 * function. */
 	struct Vector	ViewpointOrigin;
 
-	/* Set containing polygons. This is the first clipped polygon
-	 * buffer. Here the polygons from the clip operations reside. */
-	struct PolySet		ClippedPolySetA;
-
-	/* Set containing polygons. This is the second clipped polygon
-	 * buffer. Here polygons from the clip operations reside. */
-	struct PolySet		ClippedPolySetB;
-
-	/* Pointer to the current source polyset. This defines where
-	 * the polygons are. Initially this would point into the Model,
-	 * but after clipping it would point to either ClippedPolySetA or
-	 * ClippedPolySetB. */
-	struct PolySet		*pSrcPolySet;
-
-	/* Pointer to the current target polyset. This defines where
-	 * the newly created polygons (from a clipping process) should go.
-	 * Initially this is set to ClippedPolySetA, but when
-	 * ClippedPolySetA has been filled, it becomes ClippedPolySetB.
-	 * The two sets exchange eachother in both pSrcPolySet and
-	 * pTrgPolySet, thus avoiding overwriting polygons. */
-	struct PolySet		*pTrgPolySet;
-
-	/* Set containing vertices. These vertices were created from
-	 * intersections with clipping planes. They can be identified by
-	 * having a negative index in a polygon. */
-	struct VertexSet	ClippedVertexSet;
+	/* Set containing polygons. Here the polygons from the clip
+	 * operations reside, see Viewpoint_PrepActorsForDraw(). */
+	struct PolySet		ClippedPolySet;
+
+	/* Pointers to the polygons to display, by index of the polygon
+	 * in the Model (nPolygonAlloc of them are allocated). Polygons
+	 * that needn't be clipped point into the Model itself, the others
+	 * into ClippedPolySet. */
+	int	nPolygonAlloc;
+	struct Polygon	**arpPolygons;
 
 	/* Sets containing 2D position of vertices and some shading
 	 * information. We have two of these, one for normal vertices
-	 * and one for clipped vertices. */
+	 * and one for clipped vertices. The latter were created from
+	 * intersections with clipping planes, they can be identified by
+	 * having a negative index in a polygon. */
 	struct ScreenVertexSet	NormalScreenVertices;
 	struct ScreenVertexSet	ClippedScreenVertices;
 
@@ -134,6 +120,25 @@ void Actor_Construct(struct Actor *pThis);
 #define Actor_ConstructM(pThis)\
 	Actor_Construct(pThis)
 
+/* Actor_GetPolygonM(pThis, nIndex),
+ * Retrieves a pointer to the polygon to display for polygon nIndex of
+ * the Model. Only valid after Viewpoint_PrepActorsForDraw().
+ */
+#define Actor_GetPolygonM(pThis, nIndex)\
+	((pThis)->arpPolygons[(nIndex)])
+
+/* Actor_GetScreenVertex(pThis, pPoly, nVertex, pTexSV),
+ * Retrieves the ScreenVertex of the nVertex'th vertex of pPoly, one of
+ * the polygons to display of pThis. Texture coordinates belong to the
+ * polygon, so for PF_TEXTURE polygons the ScreenVertex is copied into
+ * pTexSV with fUZ and fVZ filled in and pTexSV is returned. Only valid
+ * after Viewpoint_PrepActorsForDraw().
+ */
+struct ScreenVertex *Actor_GetScreenVertex(struct Actor *pThis,
+														 struct Polygon *pPoly,
+														 int nVertex,
+														 struct ScreenVertex *pTexSV);
+
 /* Actor_Destruct(pThis),
  * Actor_DestructM(pThis), (REDUNDANT MACRO)
  * Frees all memory associated with an actor. */
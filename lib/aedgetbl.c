@@ -0,0 +1,478 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : aedgetbl.c
+********************************************************************/
+
+#define AEDGETBL_C
+
+#include <stdlib.h>
+
+#include "aedgetbl.h"
+
+/* Number of polygons and edges the arrays grow by at least. */
+#define AEDGETBL_EXPAND_SIZE	256
+
+static int ActiveEdgeTable_CompareSegments(const void *pA, const void *pB);
+static void ActiveEdgeTable_GetSpan(struct ActiveEdgeTable *pThis,
+												struct AETPolygon *pPolygon, int nY,
+												int *pStart, int *pEnd);
+static void ActiveEdgeTable_SetSpan(struct ActiveEdgeTable *pThis,
+												struct AETPolygon *pPolygon, int nY,
+												struct EdgeTable *pEdgeTable);
+
+/********************************************************************
+* Function : ActiveEdgeTable_Construct()
+* Purpose : Initializes an ActiveEdgeTable structure.
+* Pre : pThis points to an ActiveEdgeTable structure.
+* Post : pThis points to an initialized ActiveEdgeTable structure.
+********************************************************************/
+void ActiveEdgeTable_Construct(struct ActiveEdgeTable *pThis)
+{
+	/* Call macro version. */
+	ActiveEdgeTable_ConstructM(pThis);
+}
+
+/********************************************************************
+* Function : ActiveEdgeTable_Destruct()
+* Purpose : Frees all memory associated with an ActiveEdgeTable
+*           structure.
+* Pre : pThis points to an initialized ActiveEdgeTable structure.
+* Post : pThis points to an invalid ActiveEdgeTable structure that
+*        uses no more memory.
+********************************************************************/
+void ActiveEdgeTable_Destruct(struct ActiveEdgeTable *pThis)
+{
+	if (pThis->arPolygons != NULL)
+		free((void *)pThis->arPolygons);
+	if (pThis->arEdges != NULL)
+		free((void *)pThis->arEdges);
+	if (pThis->arFirstPolygons != NULL)
+		free((void *)pThis->arFirstPolygons);
+	if (pThis->arActive != NULL)
+		free((void *)pThis->arActive);
+	if (pThis->arSegments != NULL)
+		free((void *)pThis->arSegments);
+	SBuffer_Destruct(&(pThis->LineBuffer));
+}
+
+/********************************************************************
+* Function : ActiveEdgeTable_SetSize()
+* Purpose : Sets the size of the bitmap an ActiveEdgeTable draws.
+* Pre : pThis points to an initialized ActiveEdgeTable structure.
+*       nWidth and nHeight are the size of the bitmap in pixels.
+* Post : If the returnvalue is 1, pThis has no polygons and will
+*        clip them to nWidth by nHeight pixels.
+*        If the returnvalue is 0, a memory failure occured and pThis
+*        has no size.
+********************************************************************/
+int ActiveEdgeTable_SetSize(struct ActiveEdgeTable *pThis, int nWidth, int nHeight)
+{
+	int *pFirst;
+	struct AETSegment *pSegments;
+
+	if (nWidth < 0)
+		nWidth = 0;
+	if (nHeight < 0)
+		nHeight = 0;
+	pThis->nWidth = 0;
+	pThis->nHeight = 0;
+
+	if (nHeight > pThis->nAllocScanlines)
+	{	pFirst = (int *)realloc((void *)pThis->arFirstPolygons, sizeof(int) * nHeight);
+		if (pFirst == NULL)
+			return 0;	/* Memory failure. */
+		pThis->arFirstPolygons = pFirst;
+		pThis->nAllocScanlines = nHeight;
+	}
+
+	/* Segments don't overlap and aren't empty, so there are never
+	 * more of them than pixels on a scanline. */
+	if (nWidth >= pThis->nAllocSegments)
+	{	pSegments = (struct AETSegment *)realloc((void *)pThis->arSegments,
+															  sizeof(struct AETSegment) * (nWidth + 1));
+		if (pSegments == NULL)
+			return 0;	/* Memory failure. */
+		pThis->arSegments = pSegments;
+		pThis->nAllocSegments = nWidth + 1;
+	}
+
+	if (!SBuffer_SetSize(&(pThis->LineBuffer), nWidth, 1))
+		return 0;	/* Memory failure. */
+
+	pThis->nWidth = nWidth;
+	pThis->nHeight = nHeight;
+	ActiveEdgeTable_Clear(pThis);
+	return 1;
+}
+
+/********************************************************************
+* Function : ActiveEdgeTable_Clear()
+* Purpose : Removes all polygons from an ActiveEdgeTable.
+* Pre : pThis points to an initialized ActiveEdgeTable structure.
+* Post : pThis has no polygons.
+********************************************************************/
+void ActiveEdgeTable_Clear(struct ActiveEdgeTable *pThis)
+{
+	int n;
+
+	for (n = 0; n < pThis->nHeight; n++)
+		pThis->arFirstPolygons[n] = -1;
+	pThis->nPolygons = 0;
+	pThis->nEdges = 0;
+	pThis->nActive = 0;
+	pThis->nSegments = 0;
+}
+
+/********************************************************************
+* Function : ActiveEdgeTable_AddPolygon()
+* Purpose : Adds a polygon and it's edges to an ActiveEdgeTable.
+* Pre : pThis points to an initialized ActiveEdgeTable structure,
+*       pActor to an Actor prepared for drawing and pPoly to one of
+*       it's polygons. nFlags are the POLFLAGS of it's fill, or 0 to
+*       plot it in the single pixel value ulPixel.
+* Post : If the returnvalue is 1, pPoly has been added in front of
+*        all polygons added before, if it covers any pixels.
+*        If the returnvalue is 0, a memory failure occured.
+* Note : The edges are set up exactly like the EdgeTable_AddEdge()
+*        functions do, in the same order, so the spans and their
+*        attributes are exactly those that the EdgeTable would
+*        produce for the polygon.
+********************************************************************/
+int ActiveEdgeTable_AddPolygon(struct ActiveEdgeTable *pThis,
+										 struct Actor *pActor,
+										 struct Polygon *pPoly,
+										 unsigned long nFlags,
+										 unsigned long ulPixel)
+{
+	struct AETPolygon *pPolygon;
+	struct AETEdge *pEdge;
+	struct ScreenVertex *pSV, *pLastSV, *pTop, *pBottom;
+	struct ScreenVertex arEdgeSV[2];
+	int nCount;
+	int nAlloc;
+	int nTop, nBottom;
+	int dy;
+	int m;
+	void *p;
+
+	/* Only display polygons with more than 2 vertices. */
+	nCount = IndexSet_GetCountM(&(pPoly->Vertices));
+	if (nCount <= 2)
+		return 1;
+
+	/* Make room for the polygon and it's edges. */
+	if (pThis->nPolygons == pThis->nAllocPolygons)
+	{	nAlloc = pThis->nAllocPolygons * 2 + AEDGETBL_EXPAND_SIZE;
+		p = realloc((void *)pThis->arActive, sizeof(int) * nAlloc);
+		if (p == NULL)
+			return 0;	/* Memory failure. */
+		pThis->arActive = (int *)p;
+		p = realloc((void *)pThis->arPolygons, sizeof(struct AETPolygon) * nAlloc);
+		if (p == NULL)
+			return 0;	/* Memory failure. */
+		pThis->arPolygons = (struct AETPolygon *)p;
+		pThis->nAllocPolygons = nAlloc;
+	}
+	if (pThis->nEdges + nCount > pThis->nAllocEdges)
+	{	nAlloc = pThis->nAllocEdges * 2 + nCount + AEDGETBL_EXPAND_SIZE;
+		p = realloc((void *)pThis->arEdges, sizeof(struct AETEdge) * nAlloc);
+		if (p == NULL)
+			return 0;	/* Memory failure. */
+		pThis->arEdges = (struct AETEdge *)p;
+		pThis->nAllocEdges = nAlloc;
+	}
+
+	pPolygon = pThis->arPolygons + pThis->nPolygons;
+	pPolygon->pPoly = pPoly;
+	pPolygon->nFlags = nFlags;
+	pPolygon->ulPixel = ulPixel;
+	pPolygon->nFirstEdge = pThis->nEdges;
+	pPolygon->nEdges = 0;
+	nTop = 32767;
+	nBottom = -32768;
+
+	/* Add the edges, starting with the one from the last vertex to
+	 * the first, like Viewpoint_ScanPolygon() does. Textured vertices
+	 * are copied, alternately into the two of arEdgeSV. */
+	pLastSV = Actor_GetScreenVertex(pActor, pPoly, nCount - 1, &(arEdgeSV[0]));
+	for (m = 0; m < nCount; m++)
+	{	pSV = Actor_GetScreenVertex(pActor, pPoly, m, &(arEdgeSV[(m & 1) ^ 1]));
+
+		/* Ignore horizontal edges, the sign of dy determines the
+		 * side of the polygon. */
+		if (pLastSV->nY != pSV->nY)
+		{	pEdge = pThis->arEdges + pPolygon->nFirstEdge + pPolygon->nEdges;
+			if (pLastSV->nY > pSV->nY)
+			{	pTop = pSV;
+				pBottom = pLastSV;
+				pEdge->nSide = 2;
+			} else
+			{	pTop = pLastSV;
+				pBottom = pSV;
+				pEdge->nSide = 1;
+			}
+			pEdge->nTop = pTop->nY;
+			pEdge->nBottom = pBottom->nY;
+			dy = pBottom->nY - pTop->nY;
+			pEdge->xstep = ((long)(pBottom->nX - pTop->nX) * 65536L) / dy;
+			pEdge->x = ((long)pTop->nX * 65536L) + 32768L;
+			switch (nFlags)
+			{	case PF_DYNACOLOR :
+					pEdge->istep = (((int)pBottom->nIntensity - (int)pTop->nIntensity) * 65536) / dy;
+					pEdge->i = ((int)pTop->nIntensity * 65536) + 32768;
+					break;
+				case PF_CHROME :
+					pEdge->cxstep = (((int)pBottom->nCX - (int)pTop->nCX) * 65536) / dy;
+					pEdge->cx = ((int)pTop->nCX * 65536) + 32768;
+					pEdge->cystep = (((int)pBottom->nCY - (int)pTop->nCY) * 65536) / dy;
+					pEdge->cy = ((int)pTop->nCY * 65536) + 32768;
+					break;
+				case PF_TEXTURE :
+					pEdge->uzstep = (pBottom->fUZ - pTop->fUZ) / (float)dy;
+					pEdge->fUZ = pTop->fUZ;
+					pEdge->vzstep = (pBottom->fVZ - pTop->fVZ) / (float)dy;
+					pEdge->fVZ = pTop->fVZ;
+					pEdge->izstep = (pBottom->fIZ - pTop->fIZ) / (float)dy;
+					pEdge->fIZ = pTop->fIZ;
+					break;
+			}
+			pPolygon->nEdges++;
+
+			if (pTop->nY < nTop)
+				nTop = pTop->nY;
+			if (pBottom->nY > nBottom)
+				nBottom = pBottom->nY;
+		}
+		pLastSV = pSV;
+	}
+
+	/* The last scanline isn't filled. */
+	if (nTop < 0)
+		nTop = 0;
+	if (nBottom > pThis->nHeight)
+		nBottom = pThis->nHeight;
+	if (nBottom <= nTop)
+		return 1;	/* Nothing to draw. */
+
+	pPolygon->nTop = nTop;
+	pPolygon->nBottom = nBottom;
+	pPolygon->nNext = pThis->arFirstPolygons[nTop];
+	pThis->arFirstPolygons[nTop] = pThis->nPolygons;
+	pThis->nEdges += pPolygon->nEdges;
+	pThis->nPolygons++;
+	return 1;
+}
+
+/********************************************************************
+* Function : ActiveEdgeTable_GetSpan()
+* Purpose : Helper to ActiveEdgeTable_Walk(), determines the span of
+*           a polygon on a scanline.
+* Pre : pThis points to an initialized ActiveEdgeTable structure,
+*       pPolygon is one of it's polygons that is active on scanline
+*       nY.
+* Post : *pStart up to (not including) *pEnd is the span.
+* Note : Where two edges on the same side meet, both cover the
+*        scanline and the last one wins, like in the EdgeTable.
+********************************************************************/
+static void ActiveEdgeTable_GetSpan(struct ActiveEdgeTable *pThis,
+												struct AETPolygon *pPolygon, int nY,
+												int *pStart, int *pEnd)
+{
+	struct AETEdge *pEdge;
+	int n;
+
+	*pStart = *pEnd = 0;
+	pEdge = pThis->arEdges + pPolygon->nFirstEdge;
+	for (n = pPolygon->nEdges; n > 0; n--, pEdge++)
+		if ((pEdge->nTop <= nY) && (nY <= pEdge->nBottom))
+		{	if (pEdge->nSide == 1)
+				*pStart = (short)((pEdge->x + pEdge->xstep * (nY - pEdge->nTop)) >> 16);
+			else
+				*pEnd = (short)((pEdge->x + pEdge->xstep * (nY - pEdge->nTop)) >> 16);
+		}
+}
+
+/********************************************************************
+* Function : ActiveEdgeTable_SetSpan()
+* Purpose : Helper to ActiveEdgeTable_Walk(), sets up the span of a
+*           polygon on a scanline in an EdgeTable.
+* Pre : pThis points to an initialized ActiveEdgeTable structure,
+*       pPolygon is one of it's polygons that is active on scanline
+*       nY. pEdgeTable has at least as many scanlines as pThis.
+* Post : Scanline nY of pEdgeTable holds the span of pPolygon and the
+*        attributes it's fill needs, exactly as if the polygon's
+*        edges had been added to it.
+* Note : The attributes are computed from the top of the edge like
+*        the EdgeTable_AddEdge() functions step them, so they're the
+*        same to the bit.
+********************************************************************/
+static void ActiveEdgeTable_SetSpan(struct ActiveEdgeTable *pThis,
+												struct AETPolygon *pPolygon, int nY,
+												struct EdgeTable *pEdgeTable)
+{
+	struct AETEdge *pEdge;
+	short *pSpan;
+	int *pIntensity, *pCX, *pCY;
+	float *pUZ, *pVZ, *pIZ;
+	int k;
+	int n;
+
+	pEdge = pThis->arEdges + pPolygon->nFirstEdge;
+	for (n = pPolygon->nEdges; n > 0; n--, pEdge++)
+		if ((pEdge->nTop <= nY) && (nY <= pEdge->nBottom))
+		{	if (pEdge->nSide == 1)
+			{	pSpan = pEdgeTable->arSpanStartValues;
+				pIntensity = pEdgeTable->arSpanStartIntensities;
+				pCX = pEdgeTable->arSpanStartCX;
+				pCY = pEdgeTable->arSpanStartCY;
+				pUZ = pEdgeTable->arSpanStartUZ;
+				pVZ = pEdgeTable->arSpanStartVZ;
+				pIZ = pEdgeTable->arSpanStartIZ;
+			} else
+			{	pSpan = pEdgeTable->arSpanEndValues;
+				pIntensity = pEdgeTable->arSpanEndIntensities;
+				pCX = pEdgeTable->arSpanEndCX;
+				pCY = pEdgeTable->arSpanEndCY;
+				pUZ = pEdgeTable->arSpanEndUZ;
+				pVZ = pEdgeTable->arSpanEndVZ;
+				pIZ = pEdgeTable->arSpanEndIZ;
+			}
+			k = nY - pEdge->nTop;
+			pSpan[nY] = (short)((pEdge->x + pEdge->xstep * k) >> 16);
+			switch (pPolygon->nFlags)
+			{	case PF_DYNACOLOR :
+					pIntensity[nY] = pEdge->i + pEdge->istep * k;
+					break;
+				case PF_CHROME :
+					pCX[nY] = pEdge->cx + pEdge->cxstep * k;
+					pCY[nY] = pEdge->cy + pEdge->cystep * k;
+					break;
+				case PF_TEXTURE :
+					pUZ[nY] = pEdge->fUZ + pEdge->uzstep * (float)k;
+					pVZ[nY] = pEdge->fVZ + pEdge->vzstep * (float)k;
+					pIZ[nY] = pEdge->fIZ + pEdge->izstep * (float)k;
+					break;
+			}
+		}
+}
+
+/********************************************************************
+* Function : ActiveEdgeTable_CompareSegments()
+* Purpose : qsort() comparison, orders segments from left to right.
+********************************************************************/
+static int ActiveEdgeTable_CompareSegments(const void *pA, const void *pB)
+{
+	return ((const struct AETSegment *)pA)->nStart -
+			 ((const struct AETSegment *)pB)->nStart;
+}
+
+/********************************************************************
+* Function : ActiveEdgeTable_Walk()
+* Purpose : Draws the polygons of an ActiveEdgeTable scanline by
+*           scanline.
+* Pre : pThis points to an initialized ActiveEdgeTable structure,
+*       pEdgeTable to an EdgeTable with at least as many scanlines,
+*       pSegment is the function drawing part of a polygon's span
+*       and pData is passed to it.
+* Post : pSegment has been called for every part of a span in front
+*        of all others, top to bottom and left to right, on the
+*        scanlines the interlacing of pEdgeTable doesn't skip. The
+*        scanlines have been added to the DamageList of pEdgeTable,
+*        if it has one.
+* Note : The active polygons are kept frontmost first. Their spans
+*        are inserted into a single scanline span buffer in that
+*        order, what's left of each span after that is in front.
+*        The scanline stops as soon as it's fully covered.
+********************************************************************/
+void ActiveEdgeTable_Walk(struct ActiveEdgeTable *pThis,
+								  struct EdgeTable *pEdgeTable,
+								  ActiveEdgeTable_SegmentFunc pSegment, void *pData)
+{
+	struct AETPolygon *pPolygon;
+	struct AETSegment *pSegments;
+	short *pPiece;
+	int nPieces;
+	int xs, xe;
+	int nY;
+	int n, m, k;
+
+	pThis->nActive = 0;
+	for (nY = 0; nY < pThis->nHeight; nY++)
+	{	/* Drop the polygons that ended. */
+		m = 0;
+		for (n = 0; n < pThis->nActive; n++)
+			if (pThis->arPolygons[pThis->arActive[n]].nBottom > nY)
+				pThis->arActive[m++] = pThis->arActive[n];
+		pThis->nActive = m;
+
+		/* Add those that start, polygons added later are in front. */
+		for (k = pThis->arFirstPolygons[nY]; k != -1; k = pThis->arPolygons[k].nNext)
+		{	n = pThis->nActive++;
+			while ((n > 0) && (pThis->arActive[n - 1] < k))
+			{	pThis->arActive[n] = pThis->arActive[n - 1];
+				n--;
+			}
+			pThis->arActive[n] = k;
+		}
+		if (pThis->nActive == 0)
+			continue;
+		if ((nY - pEdgeTable->nRowPhase) & (pEdgeTable->nRowStep - 1))
+			continue;	/* Scanline of the other field. */
+
+		/* Find the parts of the spans in front. */
+		SBuffer_Clear(&(pThis->LineBuffer));
+		pSegments = pThis->arSegments;
+		for (n = 0; (n < pThis->nActive) && !SBuffer_IsFullM(&(pThis->LineBuffer)); n++)
+		{	ActiveEdgeTable_GetSpan(pThis, pThis->arPolygons + pThis->arActive[n], nY, &xs, &xe);
+			nPieces = SBuffer_InsertSpan(&(pThis->LineBuffer), 0, xs, xe);
+			pPiece = pThis->LineBuffer.arPieces;
+			while (nPieces-- > 0)
+			{	pSegments->nStart = pPiece[0];
+				pSegments->nEnd = pPiece[1];
+				pSegments->nPolygon = pThis->arActive[n];
+				pSegments++;
+				pPiece += 2;
+			}
+		}
+		pThis->nSegments = (int)(pSegments - pThis->arSegments);
+
+		if (pThis->nSegments == 0)
+			continue;
+
+		/* Draw them from left to right, the scissor rectangle
+		 * selects the part of the span. */
+		qsort((void *)pThis->arSegments, pThis->nSegments, sizeof(struct AETSegment),
+				ActiveEdgeTable_CompareSegments);
+		pSegments = pThis->arSegments;
+		for (n = 0; n < pThis->nSegments; n++, pSegments++)
+		{	pPolygon = pThis->arPolygons + pSegments->nPolygon;
+			ActiveEdgeTable_SetSpan(pThis, pPolygon, nY, pEdgeTable);
+			pEdgeTable->nMinScan = nY;
+			pEdgeTable->nMaxScan = nY + 1;
+			EdgeTable_SetClipRect(pEdgeTable, pSegments->nStart, nY, pSegments->nEnd, nY + 1);
+			pSegment(pData, pEdgeTable, pPolygon);
+		}
+
+		/* Keep track of what's drawn. */
+		if (pEdgeTable->pDamage != NULL)
+			DamageList_Add(pEdgeTable->pDamage, pThis->arSegments[0].nStart, nY,
+								pSegments[-1].nEnd, nY + 1);
+	}
+}
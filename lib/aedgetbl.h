@@ -0,0 +1,202 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : aedgetbl.h
+* Purpose : Header file for the ActiveEdgeTable structure.
+* Description : The ActiveEdgeTable draws a whole scene scanline by
+*               scanline. All polygons are collected first, in draw
+*               order, with their edges. Walking the scanlines from
+*               top to bottom, it keeps a list of the polygons active
+*               on the scanline and works out which parts of their
+*               spans are in front. Only those are drawn, from left to
+*               right, so every pixel is written once and the bitmap
+*               is written sequentially. The edges carry the vertex
+*               attributes the fill of their polygon needs, so a part
+*               of a span is handed to the fills as it is, without
+*               scanning the polygon again.
+********************************************************************/
+
+#ifndef AEDGETBL_H
+#define AEDGETBL_H
+
+#include "actor.h"
+#include "edgetbl.h"
+#include "sbuffer.h"
+
+/* An edge of a polygon in the ActiveEdgeTable. */
+struct AETEdge
+{
+	int	nTop;			/* Y of the top vertex. */
+	int	nBottom;		/* Y of the bottom vertex. */
+	long	x;				/* X at nTop, 16.16 fixed point, rounded. */
+	long	xstep;		/* X increment per scanline, 16.16. */
+	int	nSide;		/* 1 for the left side (span start), 2 for
+							 * the right side (span end). */
+
+	/* Vertex attributes at nTop and their increments per scanline,
+	 * only those the fill of the polygon needs are set. */
+	int	i, istep;				/* Intensity, 8.16, PF_DYNACOLOR. */
+	int	cx, cxstep;				/* Chrome map coordinates, 16.16, */
+	int	cy, cystep;				/* PF_CHROME. */
+	float	fUZ, uzstep;			/* U / Z, V / Z and 1 / Z, PF_TEXTURE. */
+	float	fVZ, vzstep;
+	float	fIZ, izstep;
+};
+
+/* A polygon in the ActiveEdgeTable. */
+struct AETPolygon
+{
+	struct Polygon	*pPoly;
+	unsigned long	nFlags;		/* POLFLAGS of the fill, 0 to plot the
+										 * polygon in the single pixel value
+										 * ulPixel. */
+	unsigned long	ulPixel;
+	int	nFirstEdge;				/* Index of it's first edge. */
+	int	nEdges;					/* Number of edges. */
+	int	nTop;						/* First scanline drawn. */
+	int	nBottom;					/* Last scanline drawn + 1. */
+	int	nNext;					/* Next polygon with the same nTop,
+										 * -1 if none. */
+};
+
+/* A part of a span that is in front. */
+struct AETSegment
+{
+	short	nStart;					/* First X. */
+	short	nEnd;						/* Last X + 1. */
+	int	nPolygon;				/* Index of the polygon. */
+};
+
+/* ActiveEdgeTable_SegmentFunc,
+ * Function filling a part of the span of pPolygon. pEdgeTable holds
+ * the span on a single scanline, from nMinScan up to nMaxScan, and
+ * it's scissor rectangle is the part. pData is the data passed to
+ * ActiveEdgeTable_Walk().
+ */
+typedef void (*ActiveEdgeTable_SegmentFunc)(void *pData,
+														  struct EdgeTable *pEdgeTable,
+														  struct AETPolygon *pPolygon);
+
+struct ActiveEdgeTable
+{
+	/* Size of the bitmap. Polygons are clipped to it. */
+	int	nWidth;
+	int	nHeight;
+
+	/* Array containing all polygons added, in draw order. Polygons
+	 * added later are in front of those added before. */
+	int	nPolygons;
+	int	nAllocPolygons;
+	struct AETPolygon	*arPolygons;
+
+	/* Array containing the edges of all polygons. */
+	int	nEdges;
+	int	nAllocEdges;
+	struct AETEdge	*arEdges;
+
+	/* Array containing nAllocScanlines indices, the first polygon
+	 * that starts on each scanline (linked by nNext), -1 if none. */
+	int	nAllocScanlines;
+	int	*arFirstPolygons;
+
+	/* Array containing the indices of the polygons active on the
+	 * current scanline, frontmost first. Allocated along with
+	 * arPolygons. */
+	int	nActive;
+	int	*arActive;
+
+	/* Array containing the segments in front on the current
+	 * scanline, room for nWidth of them. */
+	int	nSegments;
+	int	nAllocSegments;
+	struct AETSegment	*arSegments;
+
+	/* Coverage of the current scanline. */
+	struct SBuffer	LineBuffer;
+};
+
+/* ActiveEdgeTable_Construct(pThis),
+ * ActiveEdgeTable_ConstructM(pThis),
+ * Initializes an ActiveEdgeTable, it has no size.
+ */
+void ActiveEdgeTable_Construct(struct ActiveEdgeTable *pThis);
+#define ActiveEdgeTable_ConstructM(pThis)\
+(	(pThis)->nWidth = 0,\
+	(pThis)->nHeight = 0,\
+	(pThis)->nPolygons = 0,\
+	(pThis)->nAllocPolygons = 0,\
+	(pThis)->arPolygons = NULL,\
+	(pThis)->nEdges = 0,\
+	(pThis)->nAllocEdges = 0,\
+	(pThis)->arEdges = NULL,\
+	(pThis)->nAllocScanlines = 0,\
+	(pThis)->arFirstPolygons = NULL,\
+	(pThis)->nActive = 0,\
+	(pThis)->arActive = NULL,\
+	(pThis)->nSegments = 0,\
+	(pThis)->nAllocSegments = 0,\
+	(pThis)->arSegments = NULL,\
+	SBuffer_Construct(&((pThis)->LineBuffer))\
+)
+
+/* ActiveEdgeTable_Destruct(pThis),
+ * Frees all memory associated with an ActiveEdgeTable structure.
+ */
+void ActiveEdgeTable_Destruct(struct ActiveEdgeTable *pThis);
+
+/* ActiveEdgeTable_SetSize(pThis, nWidth, nHeight),
+ * Sets the size of the bitmap and removes all polygons.
+ * Returns 1 if succesful, 0 otherwise (memory allocation failure).
+ */
+int ActiveEdgeTable_SetSize(struct ActiveEdgeTable *pThis, int nWidth, int nHeight);
+
+/* ActiveEdgeTable_Clear(pThis),
+ * Removes all polygons.
+ */
+void ActiveEdgeTable_Clear(struct ActiveEdgeTable *pThis);
+
+/* ActiveEdgeTable_AddPolygon(pThis, pActor, pPoly, nFlags, ulPixel),
+ * Adds polygon pPoly of Actor pActor (which must have been prepared
+ * for drawing) in front of all polygons added before. nFlags are the
+ * POLFLAGS of the fill it's drawn with, selecting the vertex
+ * attributes interpolated along it's edges. If nFlags is 0, it's
+ * plotted in the single pixel value ulPixel instead.
+ * Returns 1 if succesful, 0 otherwise (memory allocation failure).
+ */
+int ActiveEdgeTable_AddPolygon(struct ActiveEdgeTable *pThis,
+										 struct Actor *pActor,
+										 struct Polygon *pPoly,
+										 unsigned long nFlags,
+										 unsigned long ulPixel);
+
+/* ActiveEdgeTable_Walk(pThis, pEdgeTable, pSegment, pData),
+ * Walks all scanlines from top to bottom and calls pSegment for the
+ * parts of the spans that are in front, from left to right, with
+ * the part set up in pEdgeTable. The pixels covered are exactly
+ * those the polygons would cover when drawn one after the other,
+ * each pixel is passed once. Scanlines the interlacing of pEdgeTable
+ * skips are passed over, the scanlines drawn are added to it's
+ * DamageList, if it has one. pEdgeTable must have as many scanlines
+ * as pThis, it's scissor rectangle is left set to the last part.
+ */
+void ActiveEdgeTable_Walk(struct ActiveEdgeTable *pThis,
+								  struct EdgeTable *pEdgeTable,
+								  ActiveEdgeTable_SegmentFunc pSegment, void *pData);
+
+#endif
@@ -26,6 +26,8 @@
 
 #include "colormgr.h"
 
+static int ColorManager_BuildBlendTable(struct ColorManager *pThis);
+
 /********************************************************************
 * Function : ColorManager_Construct()
 * Purpose : Initializes a ColorManager structure.
@@ -54,8 +56,12 @@ void ColorManager_Construct(struct ColorManager *pThis)
 	/* Construct Octree. */
 	Octree_ConstructM(&(pThis->ColOctree));
 
+	/* No blend table until one is requested. */
+	pThis->bBlendTable = 0;
+	pThis->pBlendTable = NULL;
+
 	/* Initialize colormap, grayscale, 0 is black, 255 is white. */
-	for (n = 0; n < 255; n++)
+	for (n = 0; n < 256; n++)
 	{	pThis->Colormap[n] = n | (n << 8) | (n << 16);
 	}
 }
@@ -103,6 +109,10 @@ void ColorManager_Destruct(struct ColorManager *pThis)
 
 	/* Destroy the Octree. */
 	Octree_Destruct(&(pThis->ColOctree));
+
+	/* Free the blend table. */
+	if (pThis->pBlendTable != NULL)
+		free((void *)pThis->pBlendTable);
 }
 
 /********************************************************************
@@ -330,5 +340,73 @@ int ColorManager_AssignColors(struct ColorManager *pThis)
 		pLmap1 = pLmap1->pLNext;
 	}
 
+	/* Build the blend table if there are translucent polygons, and
+	 * give every Lightmap1 it's row. */
+	if (pThis->bBlendTable && !ColorManager_BuildBlendTable(pThis))
+		return 0;	/* Memory failure. */
+	pLmap1 = pThis->pLmap1Head;
+	while (pLmap1 != NULL)
+	{
+		if (pThis->pBlendTable != NULL)
+			pLmap1->arBlend = pThis->pBlendTable + ((unsigned int)pLmap1->nIndex << 8);
+		pLmap1 = pLmap1->pLNext;
+	}
+
+	return 1;
+}
+
+/********************************************************************
+* Function : ColorManager_BuildBlendTable()
+* Purpose : Helper to ColorManager_AssignColors(), fills the blend
+*           table from the colormap.
+* Pre : pThis points to an initialized ColorManager structure whose
+*       Colormap has just been filled.
+* Post : If the returnvalue is 1, pThis->pBlendTable holds the index
+*        of the color closest to the one half way between every two
+*        colors of the colormap.
+*        If the returnvalue is 0, a memory failure occured.
+* Note : Blending rounds up, as the truecolor blend fills do. The
+*        table is symmetric, so only half of it is searched.
+********************************************************************/
+static int ColorManager_BuildBlendTable(struct ColorManager *pThis)
+{
+	unsigned long ulA, ulB;
+	int nR, nG, nB;
+	int dr, dg, db;
+	long lDist, lBest;
+	int nBest;
+	int n, m, k;
+
+	if (pThis->pBlendTable == NULL)
+	{	pThis->pBlendTable = (unsigned char *)malloc(256 * 256);
+		if (pThis->pBlendTable == NULL)
+			return 0;	/* Memory failure. */
+	}
+
+	for (n = 0; n < 256; n++)
+	{	ulA = pThis->Colormap[n];
+		for (m = n; m < 256; m++)
+		{	ulB = pThis->Colormap[m];
+			nR = (int)((((ulA >> 16) & 0xFF) + ((ulB >> 16) & 0xFF) + 1) >> 1);
+			nG = (int)((((ulA >> 8) & 0xFF) + ((ulB >> 8) & 0xFF) + 1) >> 1);
+			nB = (int)(((ulA & 0xFF) + (ulB & 0xFF) + 1) >> 1);
+
+			/* Find the closest color of the colormap. */
+			nBest = n;
+			lBest = 0x7FFFFFFFL;
+			for (k = 0; (k < 256) && (lBest != 0); k++)
+			{	dr = (int)((pThis->Colormap[k] >> 16) & 0xFF) - nR;
+				dg = (int)((pThis->Colormap[k] >> 8) & 0xFF) - nG;
+				db = (int)(pThis->Colormap[k] & 0xFF) - nB;
+				lDist = (long)dr * dr + (long)dg * dg + (long)db * db;
+				if (lDist < lBest)
+				{	lBest = lDist;
+					nBest = k;
+				}
+			}
+			pThis->pBlendTable[(n << 8) | m] = (unsigned char)nBest;
+			pThis->pBlendTable[(m << 8) | n] = (unsigned char)nBest;
+		}
+	}
 	return 1;
 }
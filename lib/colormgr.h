@@ -51,6 +51,13 @@ struct ColorManager
 	 * this ColorManager. */
 	struct Lightmap1		*pLmap1Head;	/* Linked by pLNext. */
 	struct Lightmap1		*Lmap1Hash[LIGHTMAP1_HASH];
+
+	/* Blend table for translucent polygons, 256 rows of 256 colormap
+	 * indices. Entry (n << 8) | m is the index of the color closest
+	 * to the one half way between colors n and m. It's only built by
+	 * ColorManager_AssignColors() if bBlendTable is set. */
+	int	bBlendTable;
+	unsigned char	*pBlendTable;
 };
 
 /* ColorManager_Construct(pThis),
@@ -80,6 +87,15 @@ void ColorManager_Destruct(struct ColorManager *pThis);
 (	(ulRGB) % LIGHTMAP1_HASH\
 )
 
+/* ColorManager_RGBTo565M(ulRGB),
+ * Converts a 0xRRGGBB color to a 16 bit RGB565 pixel value by
+ * truncating each component. */
+#define ColorManager_RGBTo565M(ulRGB)\
+(	(unsigned short)((((ulRGB) >> 8) & 0xF800) |\
+						  (((ulRGB) >> 5) & 0x07E0) |\
+						  (((ulRGB) >> 3) & 0x001F))\
+)
+
 /* ColorManager_GetLightmap256(pThis, ulRGB0, ulRGB255),
  * Checks if a Lightmap256 structure with the intensity
  * range ulRGB0..ulRGB255 already exists, if so, it returns
@@ -99,8 +115,17 @@ struct Lightmap256 *ColorManager_GetLightmap256(struct ColorManager *pThis,
 struct Lightmap1 *ColorManager_GetLightmap1(struct ColorManager *pThis,
 														  unsigned long ulRGB);
 
+/* ColorManager_RequestBlendTableM(pThis),
+ * Requests a blend table, which is then built by the next
+ * ColorManager_AssignColors(). */
+#define ColorManager_RequestBlendTableM(pThis)\
+(	(pThis)->bBlendTable = 1\
+)
+
 /* ColorManager_AssignColors(pThis),
- * Evaluates the colors requested and assigns indices to the colors. */
+ * Evaluates the colors requested and assigns indices to the colors.
+ * If a blend table was requested it's built as well, and the arBlend
+ * of every Lightmap1 is set to it's row of it. */
 int ColorManager_AssignColors(struct ColorManager *pThis);
 
 
@@ -0,0 +1,89 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : cpufeat.c
+********************************************************************/
+
+#define CPUFEAT_C
+
+#include "cpufeat.h"
+
+#if defined(CHROME_X86_SIMD) && defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/* Features found, valid once bDetected is set. */
+static unsigned long ulDetectedFeatures = 0;
+static int bDetected = 0;
+
+/********************************************************************
+* Function : CpuFeatures_Get()
+* Purpose : Returns the SIMD extensions offered by the processor.
+* Pre : None.
+* Post : Returnvalue is a combination of CPUFEATURES flags. The
+*        processor has only been queried during the first call.
+********************************************************************/
+unsigned long CpuFeatures_Get(void)
+{
+#if defined(CHROME_X86_SIMD) && defined(_MSC_VER)
+	int arRegs[4];
+#endif
+
+	if (bDetected)
+		return ulDetectedFeatures;
+
+	ulDetectedFeatures = 0;
+
+#ifdef CHROME_X86_SIMD
+#ifdef __GNUC__
+	/* GCC's builtins already check whether the OS saves the
+	 * extended registers. */
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("sse2"))
+		ulDetectedFeatures |= CPUF_SSE2;
+	if (__builtin_cpu_supports("avx2"))
+		ulDetectedFeatures |= CPUF_AVX2;
+#else
+	__cpuid(arRegs, 0);
+	if (arRegs[0] >= 7)
+	{
+		/* Leaf 1 : EDX bit 26 is SSE2, ECX bit 27 is OSXSAVE and
+		 * bit 28 is AVX. */
+		__cpuid(arRegs, 1);
+		if (arRegs[3] & (1 << 26))
+			ulDetectedFeatures |= CPUF_SSE2;
+		if ((arRegs[2] & (3 << 27)) == (3 << 27) &&
+			 (_xgetbv(0) & 6) == 6)
+		{	/* YMM state is saved by the OS, check leaf 7 EBX bit 5
+			 * for AVX2. */
+			__cpuidex(arRegs, 7, 0);
+			if (arRegs[1] & (1 << 5))
+				ulDetectedFeatures |= CPUF_AVX2;
+		}
+	} else
+	{	__cpuid(arRegs, 1);
+		if (arRegs[3] & (1 << 26))
+			ulDetectedFeatures |= CPUF_SSE2;
+	}
+#endif
+#endif
+
+	bDetected = 1;
+	return ulDetectedFeatures;
+}
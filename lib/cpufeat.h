@@ -0,0 +1,71 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : cpufeat.h
+* Purpose : Header file for CPU feature detection.
+* Description : Detects which SIMD instruction set extensions the
+*               processor offers. Inner loops that come in several
+*               flavours (such as the EdgeTable span fillers) use
+*               this to pick the fastest implementation once, after
+*               which the choice is used for the rest of the run.
+********************************************************************/
+
+#ifndef CPUFEAT_H
+#define CPUFEAT_H
+
+/* SIMD code is only compiled for Intel targets using a compiler that
+ * knows the SSE2 and AVX2 intrinsics. Define CHROME_NO_SIMD to use
+ * the plain C code everywhere. */
+#if !defined(CHROME_NO_SIMD) && \
+	((defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))) || \
+	 (defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))))
+#define CHROME_X86_SIMD
+#endif
+
+/* CPUFEAT_TARGET_SSE2, CPUFEAT_TARGET_AVX2,
+ * Put in front of a function that uses SSE2 or AVX2 intrinsics.
+ * GCC only emits instructions beyond the compile target for
+ * functions that have been marked as such, Visual C doesn't care. */
+#ifdef CHROME_X86_SIMD
+#ifdef __GNUC__
+#define CPUFEAT_TARGET_SSE2 __attribute__((target("sse2")))
+#define CPUFEAT_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define CPUFEAT_TARGET_SSE2
+#define CPUFEAT_TARGET_AVX2
+#endif
+#endif
+
+enum CPUFEATURES {
+	CPUF_SSE2 = 1,					/* SSE2, 128 bit integer and double
+										 * precision vectors. */
+	CPUF_AVX2 = 2,					/* AVX2, 256 bit integer vectors.
+										 * Only set if the operating system
+										 * also saves the YMM registers. */
+	CPUF_DUMMY						/* Dummy to end of enumeration. */
+};
+
+/* CpuFeatures_Get(),
+ * Returns a combination of CPUFEATURES flags describing the SIMD
+ * extensions that can be used. The processor is only queried on the
+ * first call. Always returns 0 if CHROME_X86_SIMD is not defined.
+ */
+unsigned long CpuFeatures_Get(void);
+
+#endif
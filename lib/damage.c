@@ -0,0 +1,149 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : damage.c
+********************************************************************/
+
+#define DAMAGE_C
+
+#include <stdlib.h>
+
+#include "damage.h"
+
+/* DamageList_AreaM(nLeft, nTop, nRight, nBottom),
+ * Area of a rectangle in pixels, as a long. */
+#define DamageList_AreaM(nLeft, nTop, nRight, nBottom)\
+	((long)((nRight) - (nLeft)) * (long)((nBottom) - (nTop)))
+
+/********************************************************************
+* Function : DamageList_Construct()
+* Purpose : Initializes a DamageList structure.
+* Pre : pThis points to a DamageList structure.
+* Post : pThis points to an initialized, empty, DamageList
+*        structure.
+********************************************************************/
+void DamageList_Construct(struct DamageList *pThis)
+{
+	/* Call macro version. */
+	DamageList_ConstructM(pThis);
+}
+
+/********************************************************************
+* Function : DamageList_Add()
+* Purpose : Adds a rectangle to a DamageList.
+* Pre : pThis points to an initialized DamageList structure, nLeft,
+*       nTop up to (not including) nRight, nBottom is the rectangle.
+* Post : The rectangles of pThis cover the rectangle and everything
+*        they covered before.
+* Note : A rectangle is merged with one of the list when their union
+*        isn't larger than both of them together, so touching or
+*        overlapping rectangles (like the scanlines of a polygon)
+*        grow into one. The merged rectangle is then added again as
+*        it may now touch others as well. When the list is full, the
+*        rectangle is merged with the one that grows least.
+********************************************************************/
+void DamageList_Add(struct DamageList *pThis, int nLeft, int nTop,
+						  int nRight, int nBottom)
+{
+	struct DamageRect *pRect;
+	struct DamageRect *pBest;
+	long lArea, lGrowth, lBestGrowth;
+	int nUL, nUT, nUR, nUB;
+	int n;
+
+	if ((nRight <= nLeft) || (nBottom <= nTop))
+		return;	/* Nothing to add. */
+
+	lArea = DamageList_AreaM(nLeft, nTop, nRight, nBottom);
+	n = 0;
+	while (n < pThis->nRects)
+	{	pRect = &(pThis->arRects[n]);
+		nUL = (pRect->nLeft < nLeft) ? pRect->nLeft : nLeft;
+		nUT = (pRect->nTop < nTop) ? pRect->nTop : nTop;
+		nUR = (pRect->nRight > nRight) ? pRect->nRight : nRight;
+		nUB = (pRect->nBottom > nBottom) ? pRect->nBottom : nBottom;
+		if (DamageList_AreaM(nUL, nUT, nUR, nUB) <=
+			 DamageList_AreaM(pRect->nLeft, pRect->nTop, pRect->nRight, pRect->nBottom) + lArea)
+		{	/* Merge, remove pRect and start over with the union. */
+			*pRect = pThis->arRects[--(pThis->nRects)];
+			nLeft = nUL;
+			nTop = nUT;
+			nRight = nUR;
+			nBottom = nUB;
+			lArea = DamageList_AreaM(nLeft, nTop, nRight, nBottom);
+			n = 0;
+		} else
+			n++;
+	}
+
+	if (pThis->nRects < DAMAGELIST_MAXRECTS)
+	{	/* Room for another one. */
+		pRect = &(pThis->arRects[(pThis->nRects)++]);
+		pRect->nLeft = nLeft;
+		pRect->nTop = nTop;
+		pRect->nRight = nRight;
+		pRect->nBottom = nBottom;
+		return;
+	}
+
+	/* The list is full, merge with the rectangle that grows least. */
+	pBest = NULL;
+	lBestGrowth = 0;
+	for (n = 0; n < pThis->nRects; n++)
+	{	pRect = &(pThis->arRects[n]);
+		nUL = (pRect->nLeft < nLeft) ? pRect->nLeft : nLeft;
+		nUT = (pRect->nTop < nTop) ? pRect->nTop : nTop;
+		nUR = (pRect->nRight > nRight) ? pRect->nRight : nRight;
+		nUB = (pRect->nBottom > nBottom) ? pRect->nBottom : nBottom;
+		lGrowth = DamageList_AreaM(nUL, nUT, nUR, nUB) -
+					 DamageList_AreaM(pRect->nLeft, pRect->nTop, pRect->nRight, pRect->nBottom);
+		if ((pBest == NULL) || (lGrowth < lBestGrowth))
+		{	pBest = pRect;
+			lBestGrowth = lGrowth;
+		}
+	}
+	if (nLeft < pBest->nLeft)
+		pBest->nLeft = nLeft;
+	if (nTop < pBest->nTop)
+		pBest->nTop = nTop;
+	if (nRight > pBest->nRight)
+		pBest->nRight = nRight;
+	if (nBottom > pBest->nBottom)
+		pBest->nBottom = nBottom;
+}
+
+/********************************************************************
+* Function : DamageList_AddList()
+* Purpose : Adds all rectangles of one DamageList to another.
+* Pre : pThis and pSrc point to initialized DamageList structures,
+*       they're not the same.
+* Post : The rectangles of pThis cover those of pSrc and everything
+*        they covered before.
+********************************************************************/
+void DamageList_AddList(struct DamageList *pThis, struct DamageList *pSrc)
+{
+	struct DamageRect *pRect;
+	int n;
+
+	for (n = 0; n < pSrc->nRects; n++)
+	{	pRect = &(pSrc->arRects[n]);
+		DamageList_Add(pThis, pRect->nLeft, pRect->nTop,
+							pRect->nRight, pRect->nBottom);
+	}
+}
@@ -0,0 +1,93 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : damage.h
+* Purpose : Header file for the DamageList structure.
+* Description : The DamageList structure keeps a small list of
+*               rectangles covering the parts of a bitmap that were
+*               drawn. Rectangles that are added are merged with the
+*               ones already there when that doesn't cover much more
+*               than both did, and always once the list is full, so
+*               the list never needs any memory of it's own.
+********************************************************************/
+
+#ifndef DAMAGE_H
+#define DAMAGE_H
+
+/* Maximum number of rectangles in a DamageList. */
+#define DAMAGELIST_MAXRECTS	16
+
+/* A rectangle from nLeft, nTop up to (not including) nRight,
+ * nBottom, in pixels. */
+struct DamageRect
+{
+	int	nLeft;
+	int	nTop;
+	int	nRight;
+	int	nBottom;
+};
+
+struct DamageList
+{
+	int	nRects;
+	struct DamageRect	arRects[DAMAGELIST_MAXRECTS];
+};
+
+/* DamageList_Construct(pThis),
+ * DamageList_ConstructM(pThis),
+ * Initializes a DamageList structure, it holds no rectangles. There
+ * is no destructor, the DamageList uses no memory.
+ */
+void DamageList_Construct(struct DamageList *pThis);
+#define DamageList_ConstructM(pThis)\
+	((pThis)->nRects = 0)
+
+/* DamageList_ClearM(pThis),
+ * Removes all rectangles.
+ */
+#define DamageList_ClearM(pThis)\
+	((pThis)->nRects = 0)
+
+/* DamageList_Add(pThis, nLeft, nTop, nRight, nBottom),
+ * Adds the rectangle nLeft, nTop up to (not including) nRight,
+ * nBottom. Afterwards, the rectangles of pThis cover it and all that
+ * they covered before, but they may cover more. Empty rectangles are
+ * ignored.
+ */
+void DamageList_Add(struct DamageList *pThis, int nLeft, int nTop,
+						  int nRight, int nBottom);
+
+/* DamageList_AddList(pThis, pSrc),
+ * Adds all rectangles of DamageList pSrc to pThis.
+ */
+void DamageList_AddList(struct DamageList *pThis, struct DamageList *pSrc);
+
+/* DamageList_GetCountM(pThis),
+ * Retrieves the number of rectangles.
+ */
+#define DamageList_GetCountM(pThis)\
+	((pThis)->nRects)
+
+/* DamageList_GetRectM(pThis, nIndex),
+ * Retrieves the DamageRect at index nIndex.
+ */
+#define DamageList_GetRectM(pThis, nIndex)\
+	(&((pThis)->arRects[(nIndex)]))
+
+#endif
@@ -66,7 +66,7 @@ struct DirLight
 #define DirLight_CalcIntensityM(pThis, pNormal)\
 (	((pThis)->Direction.V[0] * (pNormal)->V[0] +\
 	 (pThis)->Direction.V[1] * (pNormal)->V[1] +\
-	 (pThis)->Direction.V[2] * (pNormal)->V[2]))\
+	 (pThis)->Direction.V[2] * (pNormal)->V[2])\
 )
 
 #endif
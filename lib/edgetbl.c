@@ -28,10 +28,76 @@
 #endif
 
 #include "edgetbl.h"
+#include "cpufeat.h"
+
+#ifdef CHROME_X86_SIMD
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
 
 /* Inlined MS-Visual C Intel ASM is used if defined.
  #define VCINTEL_ASM */
 
+/* EdgeTable_Put24M(p, c),
+ * Writes 0xRRGGBB color c as a packed 24 bit pixel at p (blue, green,
+ * red) and advances p past it. */
+#define EdgeTable_Put24M(p, c)\
+(	(p)[0] = (unsigned char)(c),\
+	(p)[1] = (unsigned char)((c) >> 8),\
+	(p)[2] = (unsigned char)((c) >> 16),\
+	(p) += 3\
+)
+
+/* EdgeTable_FirstRowM(pThis),
+ * The first scanline from nMinScan on that interlacing doesn't
+ * skip. */
+#define EdgeTable_FirstRowM(pThis)\
+(	(pThis)->nMinScan +\
+	(((pThis)->nMinScan - (pThis)->nRowPhase) & ((pThis)->nRowStep - 1))\
+)
+
+/* Span fillers, these write nCount pixels of a single color starting
+ * at p. Selected by EdgeTable_SelectFillers(). */
+static void EdgeTable_FillSpan8C(unsigned char *p, int nCount,
+											unsigned char nColor);
+static void EdgeTable_FillSpan32C(unsigned_int_32 *p, int nCount,
+											 unsigned_int_32 aRGB);
+static void EdgeTable_FillSpan16C(unsigned_int_16 *p, int nCount,
+											 unsigned_int_16 nColor);
+static void EdgeTable_FillSpan24C(unsigned char *p, int nCount,
+											 unsigned_int_32 aRGB);
+#ifdef CHROME_X86_SIMD
+static void EdgeTable_FillSpan8SSE2(unsigned char *p, int nCount,
+												unsigned char nColor);
+static void EdgeTable_FillSpan16SSE2(unsigned_int_16 *p, int nCount,
+												 unsigned_int_16 nColor);
+static void EdgeTable_FillSpan32SSE2(unsigned_int_32 *p, int nCount,
+												 unsigned_int_32 aRGB);
+static void EdgeTable_FillSpan8AVX2(unsigned char *p, int nCount,
+												unsigned char nColor);
+static void EdgeTable_FillSpan32AVX2(unsigned_int_32 *p, int nCount,
+												 unsigned_int_32 aRGB);
+#endif
+
+static void (*EdgeTable_pFillSpan8)(unsigned char *p, int nCount,
+												unsigned char nColor) = NULL;
+static void (*EdgeTable_pFillSpan32)(unsigned_int_32 *p, int nCount,
+												 unsigned_int_32 aRGB) = NULL;
+static void (*EdgeTable_pFillSpan16)(unsigned_int_16 *p, int nCount,
+												 unsigned_int_16 nColor) = NULL;
+static void (*EdgeTable_pFillSpan24)(unsigned char *p, int nCount,
+												 unsigned_int_32 aRGB) = NULL;
+
+static void EdgeTable_BlendSpan32C(unsigned_int_32 *p, int nCount,
+											  unsigned_int_32 aRGB);
+#ifdef CHROME_X86_SIMD
+static void EdgeTable_BlendSpan32SSE2(unsigned_int_32 *p, int nCount,
+												  unsigned_int_32 aRGB);
+#endif
+
+static void (*EdgeTable_pBlendSpan32)(unsigned_int_32 *p, int nCount,
+												  unsigned_int_32 aRGB) = NULL;
+
 /********************************************************************
 * Function : EdgeTable_Construct()
 * Purpose : Initializes an EdgeTable structure.
@@ -66,7 +132,7 @@ void EdgeTable_Destruct(struct EdgeTable *pThis)
 void EdgeTable_Whipe(struct EdgeTable *pThis)
 {
 	/* Call macro version. */
-	EdgeTable_Whipe(pThis);
+	EdgeTable_WhipeM(pThis);
 }
 
 /********************************************************************
@@ -81,47 +147,358 @@ void EdgeTable_Whipe(struct EdgeTable *pThis)
 ********************************************************************/
 int EdgeTable_AtLeast(struct EdgeTable *pThis, int nScanLines)
 {
-	short	*p1,*p2;
-	int n;
+	short	*p1,*p2,*p3,*p4;
+	int	*arNew[6];		/* Intensities and chrome coordinates. */
+	int	**arOld[6];
+	float	*arNewF[6];		/* Texture coordinates. */
+	float	**arOldF[6];
+	int	bFailed;
+	int n, m;
 	/* Check if we have enough scanlines. */
 	if (pThis->nScanlines >= nScanLines)
 	{	return 1;	/* Already enough scanlines available. */
 	} else
-	{	/* Allocate new start of spans. */
+	{	/* Old arrays of span attributes, in the order of arNew. */
+		arOld[0] = &(pThis->arSpanStartIntensities);
+		arOld[1] = &(pThis->arSpanEndIntensities);
+		arOld[2] = &(pThis->arSpanStartCX);
+		arOld[3] = &(pThis->arSpanStartCY);
+		arOld[4] = &(pThis->arSpanEndCX);
+		arOld[5] = &(pThis->arSpanEndCY);
+		arOldF[0] = &(pThis->arSpanStartUZ);
+		arOldF[1] = &(pThis->arSpanStartVZ);
+		arOldF[2] = &(pThis->arSpanStartIZ);
+		arOldF[3] = &(pThis->arSpanEndUZ);
+		arOldF[4] = &(pThis->arSpanEndVZ);
+		arOldF[5] = &(pThis->arSpanEndIZ);
+
+		/* Allocate new start and end of spans and their attributes. */
 		p1 = (short *)malloc(sizeof(short) * nScanLines);
+		p2 = (short *)malloc(sizeof(short) * nScanLines);
+		p3 = (short *)malloc(sizeof(short) * nScanLines);
+		p4 = (short *)malloc(sizeof(short) * nScanLines);
+		bFailed = (p1 == NULL) || (p2 == NULL) || (p3 == NULL) || (p4 == NULL);
+		for (m = 0; m < 6; m++)
+		{	arNew[m] = (int *)malloc(sizeof(int) * nScanLines);
+			arNewF[m] = (float *)malloc(sizeof(float) * nScanLines);
+			bFailed |= (arNew[m] == NULL) || (arNewF[m] == NULL);
+		}
 		
 		/* Check for memory failure */
-		if (p1 == NULL)
+		if (bFailed)
 		{	/* Memory Failure. */
+			free((void *)p1);
+			free((void *)p2);
+			free((void *)p3);
+			free((void *)p4);
+			for (m = 0; m < 6; m++)
+			{	free((void *)arNew[m]);
+				free((void *)arNewF[m]);
+			}
 			return 0;
 		}
 		
 		for (n = 0; n < nScanLines; n++)
-			p1[n] = 0;
-
-		/* Allocate new end of spans. */
-		p2 = (short *)malloc(sizeof(short) * nScanLines);
-		
-		/* Check for memory failure */
-		if (p2 == NULL)
-		{	/* Memory failure. */
-			free(p1);
-			return 0;
+		{	p1[n] = p2[n] = p3[n] = p4[n] = 0;
+			for (m = 0; m < 6; m++)
+			{	arNew[m][n] = 0;
+				arNewF[m][n] = 0.f;
+			}
 		}
 
-		for (n = 0; n < nScanLines; n++)
-			p2[n] = 0;
-		
 		/* Got the memory, free the old span arrays, set the new. */
 		free((void *)pThis->arSpanStartValues);
 		free((void *)pThis->arSpanEndValues);
 		pThis->arSpanStartValues = p1;
 		pThis->arSpanEndValues = p2;
+		free((void *)pThis->arPendingStartValues);
+		free((void *)pThis->arPendingEndValues);
+		pThis->arPendingStartValues = p3;
+		pThis->arPendingEndValues = p4;
+		pThis->nPendingMinScan = nScanLines;
+		pThis->nPendingMaxScan = 0;
+		for (m = 0; m < 6; m++)
+		{	free((void *)*arOld[m]);
+			*arOld[m] = arNew[m];
+			free((void *)*arOldF[m]);
+			*arOldF[m] = arNewF[m];
+		}
+
+		/* A scissor rectangle that covered all scanlines keeps
+		 * doing so. */
+		if (pThis->nClipBottom >= pThis->nScanlines)
+			pThis->nClipBottom = nScanLines;
 		pThis->nScanlines = nScanLines;
 		return 1;
 	}
 }
 
+/********************************************************************
+* Function : EdgeTable_SetClipRect()
+* Purpose : Sets the scissor rectangle to which edges and spans are
+*           clipped.
+* Pre : pThis points to an initialized EdgeTable structure that
+*       doesn't contain a half finished polygon.
+*       nLeft, nTop, nRight and nBottom define the rectangle, the
+*       right and bottom edges are exclusive.
+* Post : Polygons added to pThis are clipped to the rectangle, or to
+*        the number of scanlines if that is less than nBottom.
+********************************************************************/
+void EdgeTable_SetClipRect(struct EdgeTable *pThis, int nLeft, int nTop,
+									int nRight, int nBottom)
+{
+	if (nTop < 0)
+		nTop = 0;
+	if (nBottom > pThis->nScanlines)
+		nBottom = pThis->nScanlines;
+	pThis->nClipLeft = nLeft;
+	pThis->nClipTop = nTop;
+	pThis->nClipRight = nRight;
+	pThis->nClipBottom = nBottom;
+}
+
+/********************************************************************
+* Function : EdgeTable_SetInterlace()
+* Purpose : Selects the scanlines the fills draw.
+* Pre : pThis points to an initialized EdgeTable structure.
+*       nInterlace is non zero to only draw every other scanline,
+*       nField selects the even (0) or odd (1) ones.
+* Post : If nInterlace is non zero, the fills only draw scanlines
+*        whose lowest bit is that of nField. Otherwise they draw all
+*        scanlines.
+********************************************************************/
+void EdgeTable_SetInterlace(struct EdgeTable *pThis, int nInterlace, int nField)
+{
+	pThis->nRowStep = (nInterlace != 0) ? 2 : 1;
+	pThis->nRowPhase = (nInterlace != 0) ? (nField & 1) : 0;
+}
+
+/********************************************************************
+* Function : EdgeTable_AddDamage()
+* Purpose : Adds the pixels covered by the polygon in an EdgeTable to
+*           it's DamageList.
+* Pre : pThis points to an initialized EdgeTable structure holding
+*       all edges of a polygon.
+* Post : If pThis->pDamage is not NULL, it covers all pixels the
+*        fills draw for the polygon, as far as they're inside the
+*        scissor rectangle.
+* Note : The spans are clipped just like EdgeTable_ClipSpan() does,
+*        so empty scanlines don't make the rectangle any larger.
+********************************************************************/
+void EdgeTable_AddDamage(struct EdgeTable *pThis)
+{
+	int nLeft, nTop, nRight, nBottom;
+	int xs, xe;
+	int nY;
+
+	if (pThis->pDamage == NULL)
+		return;
+
+	nLeft = nTop = 32767;
+	nRight = nBottom = -32768;
+	for (nY = pThis->nMinScan; nY < pThis->nMaxScan; nY++)
+	{	xs = pThis->arSpanStartValues[nY];
+		xe = pThis->arSpanEndValues[nY];
+		if (xs < pThis->nClipLeft)
+			xs = pThis->nClipLeft;
+		if (xe > pThis->nClipRight)
+			xe = pThis->nClipRight;
+		if (xs < xe)
+		{	if (nY < nTop)
+				nTop = nY;
+			nBottom = nY + 1;
+			if (xs < nLeft)
+				nLeft = xs;
+			if (xe > nRight)
+				nRight = xe;
+		}
+	}
+	DamageList_Add(pThis->pDamage, nLeft, nTop, nRight, nBottom);
+}
+
+/********************************************************************
+* Function : EdgeTable_MergeSpans()
+* Purpose : Coalesces the spans of a polygon with the pending spans,
+*           so polygons of the same color can be filled at once.
+* Pre : pThis points to an initialized EdgeTable structure holding
+*       all edges of a polygon.
+* Post : If the returnvalue is 1, the pending spans cover the pixels
+*        they covered before and those of the polygon.
+*        If the returnvalue is 0, there's a scanline on which the
+*        spans of the polygon and the pending ones neither overlap
+*        nor touch, so they can't be a single span. The pending
+*        spans haven't changed.
+* Note : Without pending spans, those of the polygon become the
+*        pending spans.
+********************************************************************/
+int EdgeTable_MergeSpans(struct EdgeTable *pThis)
+{
+	short	*pStart, *pEnd;
+	int nTop, nBottom;
+	int xs, xe;
+	int nY;
+
+	if (pThis->nMinScan >= pThis->nMaxScan)
+		return 1;	/* Nothing to add. */
+
+	pStart = pThis->arPendingStartValues;
+	pEnd = pThis->arPendingEndValues;
+	if (!EdgeTable_HasPendingM(pThis))
+	{	/* The polygon starts the pending spans. */
+		for (nY = pThis->nMinScan; nY < pThis->nMaxScan; nY++)
+		{	pStart[nY] = pThis->arSpanStartValues[nY];
+			pEnd[nY] = pThis->arSpanEndValues[nY];
+		}
+		pThis->nPendingMinScan = pThis->nMinScan;
+		pThis->nPendingMaxScan = pThis->nMaxScan;
+		return 1;
+	}
+
+	/* Check the scanlines both have spans on. */
+	nTop = (pThis->nMinScan > pThis->nPendingMinScan) ?
+			 pThis->nMinScan : pThis->nPendingMinScan;
+	nBottom = (pThis->nMaxScan < pThis->nPendingMaxScan) ?
+				 pThis->nMaxScan : pThis->nPendingMaxScan;
+	for (nY = nTop; nY < nBottom; nY++)
+	{	xs = pThis->arSpanStartValues[nY];
+		xe = pThis->arSpanEndValues[nY];
+		if ((xs < xe) && (pStart[nY] < pEnd[nY]) &&
+			 ((xs > pEnd[nY]) || (xe < pStart[nY])))
+			return 0;	/* A gap in between. */
+	}
+
+	/* Scanlines in between a polygon and the pending spans are
+	 * empty. */
+	for (nY = pThis->nMaxScan; nY < pThis->nPendingMinScan; nY++)
+		pStart[nY] = pEnd[nY] = 0;
+	for (nY = pThis->nPendingMaxScan; nY < pThis->nMinScan; nY++)
+		pStart[nY] = pEnd[nY] = 0;
+
+	/* Merge them. */
+	for (nY = pThis->nMinScan; nY < pThis->nMaxScan; nY++)
+	{	xs = pThis->arSpanStartValues[nY];
+		xe = pThis->arSpanEndValues[nY];
+		if ((nY < pThis->nPendingMinScan) || (nY >= pThis->nPendingMaxScan) ||
+			 (pStart[nY] >= pEnd[nY]))
+		{	/* No pending span on this scanline. */
+			pStart[nY] = (short)xs;
+			pEnd[nY] = (short)xe;
+		} else if (xs < xe)
+		{	if (xs < pStart[nY])
+				pStart[nY] = (short)xs;
+			if (xe > pEnd[nY])
+				pEnd[nY] = (short)xe;
+		}
+	}
+	if (pThis->nMinScan < pThis->nPendingMinScan)
+		pThis->nPendingMinScan = pThis->nMinScan;
+	if (pThis->nMaxScan > pThis->nPendingMaxScan)
+		pThis->nPendingMaxScan = pThis->nMaxScan;
+	return 1;
+}
+
+/********************************************************************
+* Function : EdgeTable_SwapPending()
+* Purpose : Swaps the spans of an EdgeTable with it's pending spans.
+* Pre : pThis points to an initialized EdgeTable structure.
+* Post : The spans of pThis are the ones that were pending and the
+*        other way round.
+********************************************************************/
+void EdgeTable_SwapPending(struct EdgeTable *pThis)
+{
+	short	*p;
+	int n;
+
+	p = pThis->arSpanStartValues;
+	pThis->arSpanStartValues = pThis->arPendingStartValues;
+	pThis->arPendingStartValues = p;
+	p = pThis->arSpanEndValues;
+	pThis->arSpanEndValues = pThis->arPendingEndValues;
+	pThis->arPendingEndValues = p;
+
+	n = pThis->nMinScan;
+	pThis->nMinScan = pThis->nPendingMinScan;
+	pThis->nPendingMinScan = n;
+	n = pThis->nMaxScan;
+	pThis->nMaxScan = pThis->nPendingMaxScan;
+	pThis->nPendingMaxScan = n;
+}
+
+/********************************************************************
+* Function : EdgeTable_ClipEdge()
+* Purpose : Helper to the AddEdge functions, orders the vertices of
+*           an edge from top to bottom and clips the edge to the
+*           scanlines of the scissor rectangle.
+* Pre : pThis points to an initialized EdgeTable structure, *ppTop
+*       and *ppBottom point to the source and target ScreenVertex of
+*       an edge of a counterclockwise convex polygon.
+* Post : If the returnvalue is 0, the edge is horizontal or fully
+*        outside the scissor rectangle and nothing should be added.
+*        Otherwise *ppTop and *ppBottom point to the top and bottom
+*        vertex, *pSkip holds the number of scanlines clipped from
+*        the top and *pCount the number of scanlines to write, from
+*        scanline (*ppTop)->nY + *pSkip on. nMinScan and nMaxScan
+*        have been updated. The returnvalue is 1 for an edge on the
+*        left side of the polygon (goes in the span start arrays)
+*        and 2 for an edge on the right side (span end arrays).
+********************************************************************/
+static int EdgeTable_ClipEdge(struct EdgeTable *pThis,
+										struct ScreenVertex **ppTop,
+										struct ScreenVertex **ppBottom,
+										int *pSkip, int *pCount)
+{
+	struct ScreenVertex *pVtx;
+	int	nSide;
+	int	sy, ey;			/* Start and End Y values. */
+
+	/* Ignore horizontal edges. */
+	if ((*ppTop)->nY == (*ppBottom)->nY)
+		return 0;
+
+	/* Classify the edge.
+	 * The sign of dy determines the side of the polygon. */
+	if ((*ppTop)->nY > (*ppBottom)->nY)
+	{	/* The edge belongs to the right side of the counterclockwise
+		 * polygon. Flip the edge. */
+		pVtx = *ppTop;
+		*ppTop = *ppBottom;
+		*ppBottom = pVtx;
+		nSide = 2;
+	} else
+	{	/* The edge belongs to the left side of the counterclockwise
+		 * polygon. */
+		nSide = 1;
+	}
+	sy = (*ppTop)->nY;
+	ey = (*ppBottom)->nY;
+
+	/* Clip against the scissor rectangle. The last scanline of the
+	 * edge isn't filled, so it may be dropped when it's beyond the
+	 * bottom. */
+	*pSkip = 0;
+	if (sy < pThis->nClipTop)
+	{	if (ey < pThis->nClipTop)
+			return 0;	/* Fully above. */
+		*pSkip = pThis->nClipTop - sy;
+		sy = pThis->nClipTop;
+	}
+	if (ey >= pThis->nClipBottom)
+	{	if (sy >= pThis->nClipBottom)
+			return 0;	/* Fully below. */
+		ey = pThis->nClipBottom;
+		*pCount = ey - sy;
+	} else
+		*pCount = ey - sy + 1;
+
+	/* Update Scan min and max. */
+	if (sy < pThis->nMinScan)
+		pThis->nMinScan = sy;
+	if (ey > pThis->nMaxScan)
+		pThis->nMaxScan = ey;
+
+	return nSide;
+}
+
 /********************************************************************
 * Function : EdgeTable_AddEdge()
 * Purpose : Adds an edge defined by the two ScreenVertex structures
@@ -130,340 +507,2500 @@ int EdgeTable_AtLeast(struct EdgeTable *pThis, int nScanLines)
 *       pSrcVtx and pTrgVtx point to two ScreenVertex structures that
 *       together define an edge of a counterclockwise convex polygon.
 * Post : The EdgeTable contains the edge specified by pSrcVtx and
-*        pTrgVtx.
+*        pTrgVtx, clipped to the scanlines of the scissor rectangle.
+* Note : The edge is stepped with a 16.16 fixed point DDA, a single
+*        add per scanline no matter how shallow the edge is.
+*        Edges are always stepped from their top vertex down,
+*        whether they end up on the left or right side, and X starts
+*        half a pixel in so it's rounded rather than truncated. An
+*        edge shared by two polygons therefore produces exactly the
+*        same X values for both; as spans include their start but
+*        not their end, the polygons meet without gaps or pixels
+*        that are drawn twice.
 ********************************************************************/
 void EdgeTable_AddEdge(struct EdgeTable *pThis,
 							  struct ScreenVertex *pSrcVtx,
 							  struct ScreenVertex *pTrgVtx)
 {
-	short	dx, dy;			/* Delta X and Delta Y values. */
 	short	*pSpan;			/* Ptr to span list of edge. */
-	short	sx, sy;			/* Start X and Start Y values. */
-	short denominator;
-	short increment;
+	int	nSide;			/* Side of the polygon, see ClipEdge. */
+	int	nSkip, nCount;	/* Scanlines clipped and to write. */
+	long	x;					/* Current X, 16.16 fixed point. */
+	long	xstep;			/* X increment per scanline, 16.16. */
 
 #ifdef DEBUGC
 	printf("EdgeTable_AddEdge() -> Adding edge from (%d,%d) to (%d,%d).\n", pSrcVtx->nX, pSrcVtx->nY,
 																									pTrgVtx->nX, pTrgVtx->nY);	
 #endif
-	dx = pTrgVtx->nX - pSrcVtx->nX;
+	nSide = EdgeTable_ClipEdge(pThis, &pSrcVtx, &pTrgVtx, &nSkip, &nCount);
+	if (nSide == 0)
+		return;
+	/* pSrcVtx is now the top vertex, pTrgVtx the bottom one. */
+
+	/* Setup the DDA. dx * 65536 fits in 32 bits for any coordinate
+	 * inside the guard band. */
+	xstep = ((long)(pTrgVtx->nX - pSrcVtx->nX) * 65536L) / (pTrgVtx->nY - pSrcVtx->nY);
+	x = ((long)pSrcVtx->nX * 65536L) + 32768L + xstep * nSkip;
+
+	pSpan = (nSide == 1) ? pThis->arSpanStartValues : pThis->arSpanEndValues;
+	pSpan += pSrcVtx->nY + nSkip;
+	while (nCount > 0)
+	{	/* Output span X position. */
+		*(pSpan++) = (short)(x >> 16);
+		x += xstep;
+		nCount--;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_AddGouraudEdge()
+* Purpose : Adds an edge defined by the two ScreenVertex structures
+*           pSrcVtx and pTrgVtx to the EdgeTable pThis, interpolating
+*           the intensity of the vertices along the edge.
+* Pre : As EdgeTable_AddEdge().
+* Post : As EdgeTable_AddEdge(), the span intensities of the edge's
+*        scanlines have been set as well.
+* Note : Intensity is stepped in 8.16 fixed point just like X, so
+*        shared edges have identical intensities as well.
+********************************************************************/
+void EdgeTable_AddGouraudEdge(struct EdgeTable *pThis,
+										struct ScreenVertex *pSrcVtx,
+										struct ScreenVertex *pTrgVtx)
+{
+	short	*pSpan;			/* Ptr to span list of edge. */
+	int	*pIntensity;	/* Ptr to span intensities of edge. */
+	int	nSide;			/* Side of the polygon, see ClipEdge. */
+	int	nSkip, nCount;	/* Scanlines clipped and to write. */
+	int	dy;
+	long	x;					/* Current X, 16.16 fixed point. */
+	long	xstep;			/* X increment per scanline, 16.16. */
+	int	i;					/* Current intensity, 8.16 fixed point. */
+	int	istep;			/* Intensity increment per scanline, 8.16. */
+
+	nSide = EdgeTable_ClipEdge(pThis, &pSrcVtx, &pTrgVtx, &nSkip, &nCount);
+	if (nSide == 0)
+		return;
+	/* pSrcVtx is now the top vertex, pTrgVtx the bottom one. */
+
+	/* Setup the DDAs. */
 	dy = pTrgVtx->nY - pSrcVtx->nY;
+	xstep = ((long)(pTrgVtx->nX - pSrcVtx->nX) * 65536L) / dy;
+	x = ((long)pSrcVtx->nX * 65536L) + 32768L + xstep * nSkip;
+	istep = (((int)pTrgVtx->nIntensity - (int)pSrcVtx->nIntensity) * 65536) / dy;
+	i = ((int)pSrcVtx->nIntensity * 65536) + 32768 + istep * nSkip;
 
-	/* Ignore horizontal edges. */
-	if (dy == 0)
+	if (nSide == 1)
+	{	pSpan = pThis->arSpanStartValues;
+		pIntensity = pThis->arSpanStartIntensities;
+	} else
+	{	pSpan = pThis->arSpanEndValues;
+		pIntensity = pThis->arSpanEndIntensities;
+	}
+	pSpan += pSrcVtx->nY + nSkip;
+	pIntensity += pSrcVtx->nY + nSkip;
+	while (nCount > 0)
+	{	/* Output span X position and intensity. */
+		*(pSpan++) = (short)(x >> 16);
+		*(pIntensity++) = i;
+		x += xstep;
+		i += istep;
+		nCount--;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_AddChromeEdge()
+* Purpose : Adds an edge defined by the two ScreenVertex structures
+*           pSrcVtx and pTrgVtx to the EdgeTable pThis, interpolating
+*           the chrome map coordinates of the vertices along the edge.
+* Pre : As EdgeTable_AddEdge().
+* Post : As EdgeTable_AddEdge(), the span chrome coordinates of the
+*        edge's scanlines have been set as well.
+********************************************************************/
+void EdgeTable_AddChromeEdge(struct EdgeTable *pThis,
+									  struct ScreenVertex *pSrcVtx,
+									  struct ScreenVertex *pTrgVtx)
+{
+	short	*pSpan;			/* Ptr to span list of edge. */
+	int	*pCX, *pCY;		/* Ptrs to span chrome coordinates of edge. */
+	int	nSide;			/* Side of the polygon, see ClipEdge. */
+	int	nSkip, nCount;	/* Scanlines clipped and to write. */
+	int	dy;
+	long	x;					/* Current X, 16.16 fixed point. */
+	long	xstep;			/* X increment per scanline, 16.16. */
+	int	cx, cy;			/* Current chrome coordinates, 16.16. */
+	int	cxstep, cystep;
+
+	nSide = EdgeTable_ClipEdge(pThis, &pSrcVtx, &pTrgVtx, &nSkip, &nCount);
+	if (nSide == 0)
 		return;
-	
-	/* Classify the edge.
-	 * 4 cases possible, depending on the sign of dx and dy. */
-	if (dy < 0)
-	{	/* The edge belongs to the right side of the counterclockwise
-		 * polygon. */
-		/* Flip the edge. */
-		dx = -dx;
-		dy = -dy;
-		/* Initialize Start X and Y positions. */
-		sx = pTrgVtx->nX;
-		sy = pTrgVtx->nY;
-		/* Update Scan min and max. */
-		if (sy < pThis->nMinScan)
-			pThis->nMinScan = sy;
-		if (pSrcVtx->nY > pThis->nMaxScan)
-			pThis->nMaxScan = pSrcVtx->nY;
-		/* Set the pointer. */
-		pSpan = pThis->arSpanEndValues + sy;
-		
-		if (dx >= 0)
-		{	/* Edge goes to the right. */
-			denominator = dy;
-			increment = dy >> 1;
-			while (dy >= 0)
-			{	/* Output span X position. */
-				*(pSpan++) = sx;
-				increment += dx;
-				while (increment >= denominator)
-				{	sx++;
-					increment -= denominator;
-				}
-				dy--;
-			}
-		} else
-		{	/* Edge goes to the left. */
-			denominator = dy;
-			increment = dy >> 1;
-			dx = -dx;
-			while (dy >= 0)
-			{	/* Output span X position. */
-				*(pSpan++) = sx;
-				increment += dx;
-				while (increment > denominator)
-				{	sx--;
-					increment -= denominator;
-				}
-				dy--;
-			}
-		}
+	/* pSrcVtx is now the top vertex, pTrgVtx the bottom one. */
+
+	/* Setup the DDAs. */
+	dy = pTrgVtx->nY - pSrcVtx->nY;
+	xstep = ((long)(pTrgVtx->nX - pSrcVtx->nX) * 65536L) / dy;
+	x = ((long)pSrcVtx->nX * 65536L) + 32768L + xstep * nSkip;
+	cxstep = (((int)pTrgVtx->nCX - (int)pSrcVtx->nCX) * 65536) / dy;
+	cx = ((int)pSrcVtx->nCX * 65536) + 32768 + cxstep * nSkip;
+	cystep = (((int)pTrgVtx->nCY - (int)pSrcVtx->nCY) * 65536) / dy;
+	cy = ((int)pSrcVtx->nCY * 65536) + 32768 + cystep * nSkip;
+
+	if (nSide == 1)
+	{	pSpan = pThis->arSpanStartValues;
+		pCX = pThis->arSpanStartCX;
+		pCY = pThis->arSpanStartCY;
 	} else
-	{	/* The edge belongs to the left side of the counterclockwise
-		 * polygon. */
-		/* Initialize Start X and Y positions. */
-		sx = pSrcVtx->nX;
-		sy = pSrcVtx->nY;
-		/* Update Scan min and max. */
-		if (sy < pThis->nMinScan)
-			pThis->nMinScan = sy;
-		if (pTrgVtx->nY > pThis->nMaxScan)
-			pThis->nMaxScan = pTrgVtx->nY;
-		/* Set the pointer. */
-		pSpan = pThis->arSpanStartValues + sy;
-		if (dx >= 0)
-		{	/* Edge goes to the right. */
-			denominator = dy;
-			increment = dy >> 1;
-			while (dy >= 0)
-			{	/* Output span X position. */
-				*(pSpan++) = sx;
-				increment += dx;
-				while (increment > denominator)
-				{	sx++;
-					increment -= denominator;
-				}
-				dy--;
-			}
-		} else
-		{	/* Edge goes to the left. */
-			denominator = dy;
-			increment = dy >> 1;
-			dx = -dx;
-			while (dy >= 0)
-			{	/* Output span X position. */
-				*(pSpan++) = sx;
-				increment += dx;
-				while (increment >= denominator)
-				{	sx--;
-					increment -= denominator;
-				}
-				dy--;
-			}
-		}
+	{	pSpan = pThis->arSpanEndValues;
+		pCX = pThis->arSpanEndCX;
+		pCY = pThis->arSpanEndCY;
+	}
+	pSpan += pSrcVtx->nY + nSkip;
+	pCX += pSrcVtx->nY + nSkip;
+	pCY += pSrcVtx->nY + nSkip;
+	while (nCount > 0)
+	{	/* Output span X position and chrome coordinates. */
+		*(pSpan++) = (short)(x >> 16);
+		*(pCX++) = cx;
+		*(pCY++) = cy;
+		x += xstep;
+		cx += cxstep;
+		cy += cystep;
+		nCount--;
 	}
 }
 
 /********************************************************************
-* Function : EdgeTable_SolidFill()
-* Purpose : Fills a bitmap pBitmap with the polygon spans stored in
-*           EdgeTable pThis using the byte value nColor.
-* Pre : pThis points to an initialized EdgeTable structure, nColor
-*       defines the value to use for the fill, nBytesPerRow defines
-*       the number of bytes in a single scanline of the target bitmap
-*       pBitmap.
-* Post : pBitmap now contains the polygon defined in pThis. It is
-*        filled by color nColor.
-* Notes : This routine may be significantly increased in speed by
-*         drawing 4 pixels at a time (using a long). This has not
-*         been implemented because the bitmap buffer may be from
-*         Windows 95's DirectDraw GameSDK in which case the buffer
-*         may use a lot of hardware page flipping which will hang if
-*         we cross the buffer boundary by a long.
-* Notes : This is actually the SECOND version of this routine as the
-*         first didn't work with Microsoft Visual C++'s Global
+* Function : EdgeTable_AddTextureEdge()
+* Purpose : Adds an edge defined by the two ScreenVertex structures
+*           pSrcVtx and pTrgVtx to the EdgeTable pThis, interpolating
+*           the texture map coordinates divided by Z and 1 / Z of the
+*           vertices along the edge.
+* Pre : As EdgeTable_AddEdge().
+* Post : As EdgeTable_AddEdge(), the span texture coordinates of the
+*        edge's scanlines have been set as well.
+* Note : Unlike the texture coordinates themselves, U / Z, V / Z and
+*        1 / Z are linear in screen space, so they may be interpolated
+*        along the edge. They are computed from the top vertex for
+*        every scanline rather than accumulated, so an edge clipped
+*        at the top gets exactly the values it has unclipped.
+********************************************************************/
+void EdgeTable_AddTextureEdge(struct EdgeTable *pThis,
+										struct ScreenVertex *pSrcVtx,
+										struct ScreenVertex *pTrgVtx)
+{
+	short	*pSpan;			/* Ptr to span list of edge. */
+	float	*pUZ, *pVZ, *pIZ;	/* Ptrs to span texture coordinates of edge. */
+	int	nSide;			/* Side of the polygon, see ClipEdge. */
+	int	nSkip, nCount;	/* Scanlines clipped and to write. */
+	int	dy;
+	long	x;					/* Current X, 16.16 fixed point. */
+	long	xstep;			/* X increment per scanline, 16.16. */
+	float	uzstep, vzstep, izstep;
+
+	nSide = EdgeTable_ClipEdge(pThis, &pSrcVtx, &pTrgVtx, &nSkip, &nCount);
+	if (nSide == 0)
+		return;
+	/* pSrcVtx is now the top vertex, pTrgVtx the bottom one. */
+
+	/* Setup the DDAs. */
+	dy = pTrgVtx->nY - pSrcVtx->nY;
+	xstep = ((long)(pTrgVtx->nX - pSrcVtx->nX) * 65536L) / dy;
+	x = ((long)pSrcVtx->nX * 65536L) + 32768L + xstep * nSkip;
+	uzstep = (pTrgVtx->fUZ - pSrcVtx->fUZ) / (float)dy;
+	vzstep = (pTrgVtx->fVZ - pSrcVtx->fVZ) / (float)dy;
+	izstep = (pTrgVtx->fIZ - pSrcVtx->fIZ) / (float)dy;
+
+	if (nSide == 1)
+	{	pSpan = pThis->arSpanStartValues;
+		pUZ = pThis->arSpanStartUZ;
+		pVZ = pThis->arSpanStartVZ;
+		pIZ = pThis->arSpanStartIZ;
+	} else
+	{	pSpan = pThis->arSpanEndValues;
+		pUZ = pThis->arSpanEndUZ;
+		pVZ = pThis->arSpanEndVZ;
+		pIZ = pThis->arSpanEndIZ;
+	}
+	pSpan += pSrcVtx->nY + nSkip;
+	pUZ += pSrcVtx->nY + nSkip;
+	pVZ += pSrcVtx->nY + nSkip;
+	pIZ += pSrcVtx->nY + nSkip;
+	while (nCount > 0)
+	{	/* Output span X position and texture coordinates. */
+		*(pSpan++) = (short)(x >> 16);
+		*(pUZ++) = pSrcVtx->fUZ + uzstep * (float)nSkip;
+		*(pVZ++) = pSrcVtx->fVZ + vzstep * (float)nSkip;
+		*(pIZ++) = pSrcVtx->fIZ + izstep * (float)nSkip;
+		x += xstep;
+		nSkip++;
+		nCount--;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_SelectFillers()
+* Purpose : Selects the span fillers used by the EdgeTable fill
+*           routines.
+* Pre : ulFeatures is a combination of CPUFEATURES flags, usually
+*       the result of CpuFeatures_Get().
+* Post : The fastest span fillers supported by ulFeatures will be
+*        used from now on. If ulFeatures is 0, or the library was
+*        built without CHROME_X86_SIMD, the plain C fillers are used.
+********************************************************************/
+void EdgeTable_SelectFillers(unsigned long ulFeatures)
+{
+	EdgeTable_pFillSpan8 = EdgeTable_FillSpan8C;
+	EdgeTable_pFillSpan32 = EdgeTable_FillSpan32C;
+	EdgeTable_pFillSpan16 = EdgeTable_FillSpan16C;
+	EdgeTable_pFillSpan24 = EdgeTable_FillSpan24C;
+	EdgeTable_pBlendSpan32 = EdgeTable_BlendSpan32C;
+
+#ifdef CHROME_X86_SIMD
+	if (ulFeatures & CPUF_SSE2)
+		EdgeTable_pBlendSpan32 = EdgeTable_BlendSpan32SSE2;
+	if (ulFeatures & CPUF_AVX2)
+	{	EdgeTable_pFillSpan8 = EdgeTable_FillSpan8AVX2;
+		EdgeTable_pFillSpan32 = EdgeTable_FillSpan32AVX2;
+		EdgeTable_pFillSpan16 = EdgeTable_FillSpan16SSE2;
+	} else
+	if (ulFeatures & CPUF_SSE2)
+	{	EdgeTable_pFillSpan8 = EdgeTable_FillSpan8SSE2;
+		EdgeTable_pFillSpan32 = EdgeTable_FillSpan32SSE2;
+		EdgeTable_pFillSpan16 = EdgeTable_FillSpan16SSE2;
+	}
+#endif
+}
+
+/********************************************************************
+* Function : EdgeTable_InitFillers()
+* Purpose : Selects the span fillers if that hasn't been done yet.
+* Pre : -
+* Post : The span fillers have been selected, either by an earlier
+*        call to EdgeTable_SelectFillers() or now, from
+*        CpuFeatures_Get().
+********************************************************************/
+void EdgeTable_InitFillers(void)
+{
+	if (EdgeTable_pFillSpan8 == NULL)
+		EdgeTable_SelectFillers(CpuFeatures_Get());
+}
+
+/********************************************************************
+* Function : EdgeTable_FillSpan8C()
+* Purpose : Plain C span filler for 8 bit bitmaps. Writes nCount
+*           bytes of nColor starting at p.
+* Pre : p points into a bitmap that has room for nCount bytes,
+*       nCount may be 0 or negative in which case nothing is done.
+* Post : The nCount bytes starting at p have been set to nColor.
+* Notes : This routine is the SECOND version of the byte filler as
+*         the first didn't work with Microsoft Visual C++'s Global
 *         Optimisations and GameSDK's DirectDraw. Reason for this was
 *         that the Global Optimisation flag converted a while loop
 *         writing bytes to a stosd (writing longs). This write was
 *         however not alligned on a long boundary and thus caused
 *         DirectDraw's page fault handler (for producing a virtual
 *         flat frame buffer) to throw up and hang Win95.
-*         This implementation should be significantly faster than
-*         the old one because it uses long writes instead of byte
-*         writes. It DOES however make sure the long's are long
-*         alligned which gives the CPU a single cycle bonus if I'm
-*         right.
+*         This implementation writes leading bytes until it's on a
+*         long allignment, then writes as many longs as needed and
+*         finally appends trailing bytes. It never writes outside
+*         the span.
 ********************************************************************/
-void EdgeTable_SolidFill(struct EdgeTable *pThis, unsigned char nColor,
-	 short nBytesPerRow, unsigned char *pBitmap)
+static void EdgeTable_FillSpan8C(unsigned char *p, int nCount,
+											unsigned char nColor)
 {
-	/* A simple loop in which we fill the array pBitmap with the
-	 * spans from pThis. */
-	short	*pStart, *pEnd;
-	unsigned char *p;
-	int dx, dy;
+	int dx;
 	int nTrailCount;
 	int nLongCount;
 	int nByteCount;
-	unsigned long LongColor;
+	unsigned_int_32 LongColor;
 
-#ifdef DEBUGC
-	printf("EdgeTable_SolidFill() -> nColor = %d\n", nColor);
-#endif
+	if (nCount <= 0)
+		return;
 
-	/* Initialize span lookup. */
-	pStart = pThis->arSpanStartValues + pThis->nMinScan;
-	pEnd = pThis->arSpanEndValues + pThis->nMinScan;
-	/* Initialize bitmap pointer. */
-	pBitmap += nBytesPerRow * pThis->nMinScan;
 	/* Initialize long used for double writes. */
-	LongColor = (unsigned long)nColor;
+	LongColor = (unsigned_int_32)nColor;
 	LongColor = LongColor << 24 | LongColor << 16 | LongColor << 8 | LongColor;
 
-	dy = pThis->nMaxScan - pThis->nMinScan;
-	while (dy > 0)	/* We may be loosing the last scanline here. */
-	{	p = pBitmap + *pStart;
-		/* Draw dx bytes of nColor at address p. */
-		/* The main bunch should be long's because they're faster
-		 * in a single write.
-		 * However, some platforms & CPU's require us to ensure
-		 * that our writes are alligned to long addresses.
-		 * Windows' GameSDK DirectDraw is one of the main reasons
-		 * for choosing this complicated scenario.
-		 * Consequently we first write leading bytes until we're
-		 * on a long allignment, then we write as many longs as
-		 * needed and finally we append trailing bytes.
-		 * We assume that pBitmap is long alligned(!) */
-
-		/* Get total number of pixels to go. */
-		dx = *(pEnd++) - *(pStart++);
-
-		/* Get number of bytes needed before long allignment. */
-		nByteCount = (-((int)p)) & 3;
-
-		/* Check if there are still bytes left. */
-		if (dx < nByteCount)
-			nByteCount = dx;		/* Correct, we don't need to allign as
-										 * there are not enough bytes to pass
-										 * the first long. */
-		/* Calculate bytes to go after this step. */
-		dx -= nByteCount;
-
-		/* Write leading bytes. */
+	/* Get total number of pixels to go. */
+	dx = nCount;
+
+	/* Get number of bytes needed before long allignment. */
+	nByteCount = (int)((0 - (size_t)p) & 3);
+
+	/* Check if there are still bytes left. */
+	if (dx < nByteCount)
+		nByteCount = dx;		/* Correct, we don't need to allign as
+									 * there are not enough bytes to pass
+									 * the first long. */
+	/* Calculate bytes to go after this step. */
+	dx -= nByteCount;
+
+	/* Write leading bytes. */
 #ifdef VCINTEL_ASM
-		if (nByteCount > 0)
+	if (nByteCount > 0)
+	{
+		__asm
 		{
-			__asm
-			{
-				mov	ecx, nByteCount
-				mov	al, nColor
-				mov	ebx, p
-				leadloop:
-				mov	[ebx], al
-				inc	ebx
-				dec	ecx
-				jnz	leadloop
-			}
-			p += nByteCount;
+			mov	ecx, nByteCount
+			mov	al, nColor
+			mov	ebx, p
+			leadloop:
+			mov	[ebx], al
+			inc	ebx
+			dec	ecx
+			jnz	leadloop
 		}
+		p += nByteCount;
+	}
 #else
-		while (nByteCount > 0)
-		{	*(p++) = nColor;
-			nByteCount--;
-		}
+	while (nByteCount > 0)
+	{	*(p++) = nColor;
+		nByteCount--;
+	}
 #endif
 
-		/* Write long alligned body.
-		 * Long alligned body is truncated division of remaining
-		 * bytes by 4. Note that if there are less than 4 bytes
-		 * to be done, the shift will cause nLongCount to become
-		 * 0 and the operation is cancelled after which dx still
-		 * holds the correct amount of bytes to be done. */
-		nLongCount = dx >> 2;
+	/* Write long alligned body.
+	 * Long alligned body is truncated division of remaining
+	 * bytes by 4. Note that if there are less than 4 bytes
+	 * to be done, the shift will cause nLongCount to become
+	 * 0 and the operation is cancelled after which dx still
+	 * holds the correct amount of bytes to be done. */
+	nLongCount = dx >> 2;
 
 #ifdef VCINTEL_ASM
-		if (nLongCount > 0)
+	if (nLongCount > 0)
+	{
+		__asm
 		{
-			__asm
-			{
-				mov	ecx, nLongCount
-				mov	ebx, p
-				mov	eax, LongColor
-				mov	edx, 4
-				bodyloop:
-				mov	[ebx], eax
-				add	ebx, edx
-				dec	ecx
-				jnz	bodyloop
-			}
-			p += nLongCount * 4;
+			mov	ecx, nLongCount
+			mov	ebx, p
+			mov	eax, LongColor
+			mov	edx, 4
+			bodyloop:
+			mov	[ebx], eax
+			add	ebx, edx
+			dec	ecx
+			jnz	bodyloop
 		}
+		p += nLongCount * 4;
+	}
 #else
-		while (nLongCount > 0)
-		{	*(((unsigned long *)p)++) = LongColor;
-			nLongCount--;
-		}
+	while (nLongCount > 0)
+	{	*((unsigned_int_32 *)p) = LongColor;
+		p += 4;
+		nLongCount--;
+	}
 #endif
 
-		/* Calculate bytes to go after longs. */
-		dx &= 3;
+	/* Calculate bytes to go after longs. */
+	dx &= 3;
 
-		/* Write trailing bytes. */
+	/* Write trailing bytes. */
 #ifdef VCINTEL_ASM
-		if (dx > 0)
-		{	nTrailCount = dx;
-			__asm
-			{
-				mov	ebx, p
-				mov	ecx, nTrailCount
-				mov	al, nColor
-				trailloop:
-				mov	[ebx], al
-				inc	ebx
-				dec	ecx
-				jnz	trailloop
-			}
-			p += dx;
+	if (dx > 0)
+	{	nTrailCount = dx;
+		__asm
+		{
+			mov	ebx, p
+			mov	ecx, nTrailCount
+			mov	al, nColor
+			trailloop:
+			mov	[ebx], al
+			inc	ebx
+			dec	ecx
+			jnz	trailloop
 		}
+		p += dx;
+	}
 #else
-		while (dx > 0)
-		{	*(p++) = nColor;
-			dx--;
-		}
+	while (dx > 0)
+	{	*(p++) = nColor;
+		dx--;
+	}
 #endif
+}
 
-		pBitmap += nBytesPerRow;
-		dy--;
+/********************************************************************
+* Function : EdgeTable_FillSpan32C()
+* Purpose : Plain C span filler for 32 bit bitmaps. Writes nCount
+*           pixels of aRGB starting at p.
+* Pre : p points into a bitmap that has room for nCount pixels,
+*       nCount may be 0 or negative in which case nothing is done.
+* Post : The nCount pixels starting at p have been set to aRGB.
+********************************************************************/
+static void EdgeTable_FillSpan32C(unsigned_int_32 *p, int nCount,
+											 unsigned_int_32 aRGB)
+{
+	while (nCount-- > 0)
+	{	*p++ = aRGB;
 	}
 }
 
 /********************************************************************
-* Function : EdgeTable_SolidFill32()
-* Purpose : Fills a bitmap pBitmap with the polygon spans stored in
-*           EdgeTable pThis using a 32 bit aRGB color.
-* Pre : pThis points to an initialized EdgeTable structure, aRGB
-*       defines the value to use for the fill, nPixelsPerRow defines
-*       the number of PIXELS in a single scanline of the target bitmap
-*       pBitmap.
-* Post : pBitmap now contains the polygon defined in pThis. It is
-*        filled by color aRGB.
-* Note : THE BITMAP MUST BE AN ALIGNED 32-BIT COLOR BITMAP OR IT
-*       WILL SEGFAULT!
+* Function : EdgeTable_FillSpan16C()
+* Purpose : Plain C span filler for 16 bit bitmaps. Writes nCount
+*           pixels of nColor starting at p.
+* Pre : p points into a bitmap that has room for nCount pixels,
+*       nCount may be 0 or negative in which case nothing is done.
+* Post : The nCount pixels starting at p have been set to nColor.
+* Note : Like EdgeTable_FillSpan8C(), pairs of pixels are written as
+*        alligned longs in between a leading and a trailing pixel.
 ********************************************************************/
-void EdgeTable_SolidFill32(struct EdgeTable *pThis, unsigned_int_32 aRGB,
-	 short nPixelsPerRow, unsigned_int_32 *pBitmap)
+static void EdgeTable_FillSpan16C(unsigned_int_16 *p, int nCount,
+											 unsigned_int_16 nColor)
 {
-	/* A simple loop in which we fill the array pBitmap with the
-	 * spans from pThis. */
-	short	*pStart, *pEnd;
-	unsigned_int_32 *p;
-	int dx, dy;
-
-#ifdef DEBUGC
-	printf("EdgeTable_SolidFill32() -> aRGB = %d\n", aRGB);
-#endif
+	unsigned_int_32 *pLong;
+	union
+	{	unsigned_int_32 ulLong;
+		unsigned_int_16 arPair[2];
+	} Pair;
 
-	/* Initialize span lookup. */
-	pStart = pThis->arSpanStartValues + pThis->nMinScan;
-	pEnd = pThis->arSpanEndValues + pThis->nMinScan;
-	/* Initialize bitmap pointer. */
-	pBitmap += nPixelsPerRow * pThis->nMinScan;
+	if (nCount <= 0)
+		return;
 
-	dy = pThis->nMaxScan - pThis->nMinScan;
-	while (dy > 0)	/* We may be loosing the last scanline here. */
-	{	p = pBitmap + *pStart;
-		/* Draw dx pixels of aRGB at address p. */
-		dx = *(pEnd++) - *(pStart++);
+	/* Leading pixel up to a long allignment. */
+	if (((size_t)p & 3) != 0)
+	{	*(p++) = nColor;
+		nCount--;
+	}
 
-		while (dx-- > 0)
-		{	*p++ = aRGB;
+	/* Long alligned body, if the bitmap is alligned on 2 bytes. */
+	if (((size_t)p & 3) == 0)
+	{	Pair.arPair[0] = Pair.arPair[1] = nColor;
+		pLong = (unsigned_int_32 *)p;
+		while (nCount >= 2)
+		{	*(pLong++) = Pair.ulLong;
+			nCount -= 2;
 		}
-
-		pBitmap += nPixelsPerRow;
-		dy--;
+		p = (unsigned_int_16 *)pLong;
 	}
+
+	/* Trailing pixels. */
+	while (nCount-- > 0)
+		*(p++) = nColor;
 }
+
+/********************************************************************
+* Function : EdgeTable_FillSpan24C()
+* Purpose : Plain C span filler for packed 24 bit bitmaps. Writes
+*           nCount pixels of 0xRRGGBB color aRGB starting at p.
+* Pre : p points into a bitmap that has room for nCount pixels of 3
+*       bytes, nCount may be 0 or negative in which case nothing is
+*       done.
+* Post : The nCount pixels starting at p have been set to aRGB.
+* Note : Once p is alligned on a long, 4 pixels are exactly 3 longs.
+*        Those are built once, in memory order, and then repeated.
+********************************************************************/
+static void EdgeTable_FillSpan24C(unsigned char *p, int nCount,
+											 unsigned_int_32 aRGB)
+{
+	unsigned_int_32 arLongs[3];
+	unsigned char *pPattern;
+	unsigned_int_32 *pLong;
+	int n;
+
+	/* Leading pixels up to a long allignment. */
+	while ((nCount > 0) && (((size_t)p & 3) != 0))
+	{	EdgeTable_Put24M(p, aRGB);
+		nCount--;
+	}
+	if (nCount < 4)
+	{	while (nCount-- > 0)
+		{	EdgeTable_Put24M(p, aRGB);
+		}
+		return;
+	}
+
+	/* Build 4 pixels as 3 longs. */
+	pPattern = (unsigned char *)arLongs;
+	for (n = 0; n < 4; n++)
+	{	EdgeTable_Put24M(pPattern, aRGB);
+	}
+
+	/* Long alligned body. */
+	pLong = (unsigned_int_32 *)p;
+	while (nCount >= 4)
+	{	pLong[0] = arLongs[0];
+		pLong[1] = arLongs[1];
+		pLong[2] = arLongs[2];
+		pLong += 3;
+		nCount -= 4;
+	}
+
+	/* Trailing pixels. */
+	p = (unsigned char *)pLong;
+	while (nCount-- > 0)
+	{	EdgeTable_Put24M(p, aRGB);
+	}
+}
+
+#ifdef CHROME_X86_SIMD
+/********************************************************************
+* Function : EdgeTable_FillSpan8SSE2()
+* Purpose : SSE2 span filler for 8 bit bitmaps. Writes nCount bytes
+*           of nColor starting at p.
+* Pre : As EdgeTable_FillSpan8C(), the processor supports SSE2.
+* Post : As EdgeTable_FillSpan8C().
+* Note : Just like the C version, leading and trailing bytes are
+*        written one at a time so the 16 byte writes in between are
+*        alligned and never touch memory outside the span.
+********************************************************************/
+CPUFEAT_TARGET_SSE2
+static void EdgeTable_FillSpan8SSE2(unsigned char *p, int nCount,
+												unsigned char nColor)
+{
+	__m128i Color;
+	int nByteCount;
+
+	/* Short spans aren't worth the setup. */
+	if (nCount < 32)
+	{	EdgeTable_FillSpan8C(p, nCount, nColor);
+		return;
+	}
+
+	/* Leading bytes up to a 16 byte allignment. */
+	nByteCount = (int)((0 - (size_t)p) & 15);
+	nCount -= nByteCount;
+	while (nByteCount-- > 0)
+		*(p++) = nColor;
+
+	/* Alligned body. */
+	Color = _mm_set1_epi8((char)nColor);
+	while (nCount >= 16)
+	{	_mm_store_si128((__m128i *)p, Color);
+		p += 16;
+		nCount -= 16;
+	}
+
+	/* Trailing bytes. */
+	while (nCount-- > 0)
+		*(p++) = nColor;
+}
+
+/********************************************************************
+* Function : EdgeTable_FillSpan16SSE2()
+* Purpose : SSE2 span filler for 16 bit bitmaps. Writes nCount pixels
+*           of nColor starting at p.
+* Pre : As EdgeTable_FillSpan16C(), the processor supports SSE2.
+* Post : As EdgeTable_FillSpan16C().
+********************************************************************/
+CPUFEAT_TARGET_SSE2
+static void EdgeTable_FillSpan16SSE2(unsigned_int_16 *p, int nCount,
+												 unsigned_int_16 nColor)
+{
+	__m128i Color;
+
+	if (nCount < 16)
+	{	EdgeTable_FillSpan16C(p, nCount, nColor);
+		return;
+	}
+
+	/* Leading pixels up to a 16 byte allignment. If the bitmap isn't
+	 * even alligned on 2 bytes this never happens and the unalligned
+	 * stores below take care of everything. */
+	while ((nCount > 0) && (((size_t)p & 15) != 0) && (((size_t)p & 1) == 0))
+	{	*(p++) = nColor;
+		nCount--;
+	}
+
+	Color = _mm_set1_epi16((short)nColor);
+	if (((size_t)p & 15) == 0)
+	{	while (nCount >= 8)
+		{	_mm_store_si128((__m128i *)p, Color);
+			p += 8;
+			nCount -= 8;
+		}
+	} else
+	{	while (nCount >= 8)
+		{	_mm_storeu_si128((__m128i *)p, Color);
+			p += 8;
+			nCount -= 8;
+		}
+	}
+
+	/* Trailing pixels. */
+	while (nCount-- > 0)
+		*(p++) = nColor;
+}
+
+/********************************************************************
+* Function : EdgeTable_FillSpan32SSE2()
+* Purpose : SSE2 span filler for 32 bit bitmaps. Writes nCount pixels
+*           of aRGB starting at p.
+* Pre : As EdgeTable_FillSpan32C(), the processor supports SSE2.
+* Post : As EdgeTable_FillSpan32C().
+********************************************************************/
+CPUFEAT_TARGET_SSE2
+static void EdgeTable_FillSpan32SSE2(unsigned_int_32 *p, int nCount,
+												 unsigned_int_32 aRGB)
+{
+	__m128i Color;
+
+	if (nCount < 8)
+	{	EdgeTable_FillSpan32C(p, nCount, aRGB);
+		return;
+	}
+
+	/* Leading pixels up to a 16 byte allignment. If the bitmap isn't
+	 * even alligned on 4 bytes this never happens and the unalligned
+	 * stores below take care of everything. */
+	while ((nCount > 0) && (((size_t)p & 15) != 0) && (((size_t)p & 3) == 0))
+	{	*(p++) = aRGB;
+		nCount--;
+	}
+
+	Color = _mm_set1_epi32((int)aRGB);
+	if (((size_t)p & 15) == 0)
+	{	while (nCount >= 4)
+		{	_mm_store_si128((__m128i *)p, Color);
+			p += 4;
+			nCount -= 4;
+		}
+	} else
+	{	while (nCount >= 4)
+		{	_mm_storeu_si128((__m128i *)p, Color);
+			p += 4;
+			nCount -= 4;
+		}
+	}
+
+	/* Trailing pixels. */
+	while (nCount-- > 0)
+		*(p++) = aRGB;
+}
+
+/********************************************************************
+* Function : EdgeTable_FillSpan8AVX2()
+* Purpose : AVX2 span filler for 8 bit bitmaps. Writes nCount bytes
+*           of nColor starting at p.
+* Pre : As EdgeTable_FillSpan8C(), the processor supports AVX2.
+* Post : As EdgeTable_FillSpan8C().
+********************************************************************/
+CPUFEAT_TARGET_AVX2
+static void EdgeTable_FillSpan8AVX2(unsigned char *p, int nCount,
+												unsigned char nColor)
+{
+	__m256i Color;
+	int nByteCount;
+
+	if (nCount < 64)
+	{	EdgeTable_FillSpan8C(p, nCount, nColor);
+		return;
+	}
+
+	/* Leading bytes up to a 32 byte allignment. */
+	nByteCount = (int)((0 - (size_t)p) & 31);
+	nCount -= nByteCount;
+	while (nByteCount-- > 0)
+		*(p++) = nColor;
+
+	/* Alligned body. */
+	Color = _mm256_set1_epi8((char)nColor);
+	while (nCount >= 32)
+	{	_mm256_store_si256((__m256i *)p, Color);
+		p += 32;
+		nCount -= 32;
+	}
+
+	/* Trailing bytes. */
+	while (nCount-- > 0)
+		*(p++) = nColor;
+}
+
+/********************************************************************
+* Function : EdgeTable_FillSpan32AVX2()
+* Purpose : AVX2 span filler for 32 bit bitmaps. Writes nCount pixels
+*           of aRGB starting at p.
+* Pre : As EdgeTable_FillSpan32C(), the processor supports AVX2.
+* Post : As EdgeTable_FillSpan32C().
+********************************************************************/
+CPUFEAT_TARGET_AVX2
+static void EdgeTable_FillSpan32AVX2(unsigned_int_32 *p, int nCount,
+												 unsigned_int_32 aRGB)
+{
+	__m256i Color;
+
+	if (nCount < 16)
+	{	EdgeTable_FillSpan32C(p, nCount, aRGB);
+		return;
+	}
+
+	/* Leading pixels up to a 32 byte allignment (see the SSE2
+	 * version for unalligned bitmaps). */
+	while ((nCount > 0) && (((size_t)p & 31) != 0) && (((size_t)p & 3) == 0))
+	{	*(p++) = aRGB;
+		nCount--;
+	}
+
+	Color = _mm256_set1_epi32((int)aRGB);
+	if (((size_t)p & 31) == 0)
+	{	while (nCount >= 8)
+		{	_mm256_store_si256((__m256i *)p, Color);
+			p += 8;
+			nCount -= 8;
+		}
+	} else
+	{	while (nCount >= 8)
+		{	_mm256_storeu_si256((__m256i *)p, Color);
+			p += 8;
+			nCount -= 8;
+		}
+	}
+
+	/* Trailing pixels. */
+	while (nCount-- > 0)
+		*(p++) = aRGB;
+}
+#endif
+
+/********************************************************************
+* Function : EdgeTable_ClipSpan()
+* Purpose : Helper to the fill functions, determines the pieces of a
+*           span that should be drawn.
+* Pre : pThis points to an initialized EdgeTable structure, xs up to
+*       (not including) xe is the span on scanline nY.
+* Post : Returns the number of pieces to draw, *ppPieces points to
+*        their start and (exclusive) end X pairs. These are the span
+*        clipped against the scissor rectangle and, if pThis has a
+*        span buffer, the parts of that not yet covered in it. The
+*        span buffer now covers the span. There are no pieces on
+*        scanlines skipped by interlacing.
+********************************************************************/
+static int EdgeTable_ClipSpan(struct EdgeTable *pThis, int nY, int xs, int xe,
+										short **ppPieces)
+{
+	/* Skip the scanlines of the other field. */
+	*ppPieces = pThis->arPiece;
+	if ((nY - pThis->nRowPhase) & (pThis->nRowStep - 1))
+		return 0;
+
+	/* Clip the span against the scissor rectangle. */
+	if (xs < pThis->nClipLeft)
+		xs = pThis->nClipLeft;
+	if (xe > pThis->nClipRight)
+		xe = pThis->nClipRight;
+
+	if (pThis->pSBuffer != NULL)
+	{	/* Only draw what's still uncovered. */
+		*ppPieces = pThis->pSBuffer->arPieces;
+		return SBuffer_InsertSpan(pThis->pSBuffer, nY, xs, xe);
+	}
+
+	*ppPieces = pThis->arPiece;
+	if (xe <= xs)
+		return 0;
+	pThis->arPiece[0] = (short)xs;
+	pThis->arPiece[1] = (short)xe;
+	return 1;
+}
+
+/********************************************************************
+* Function : EdgeTable_SolidFill()
+* Purpose : Fills a bitmap pBitmap with the polygon spans stored in
+*           EdgeTable pThis using the byte value nColor.
+* Pre : pThis points to an initialized EdgeTable structure, nColor
+*       defines the value to use for the fill, nBytesPerRow defines
+*       the number of bytes in a single scanline of the target bitmap
+*       pBitmap.
+* Post : pBitmap now contains the polygon defined in pThis. It is
+*        filled by color nColor.
+* Notes : The actual writing is done by the span filler selected by
+*         EdgeTable_SelectFillers(). All of them take care never to
+*         cross the span boundaries with a wide write because the
+*         bitmap buffer may be from Windows 95's DirectDraw GameSDK
+*         in which case the buffer may use a lot of hardware page
+*         flipping which will hang if we cross the buffer boundary
+*         by a long.
+********************************************************************/
+void EdgeTable_SolidFill(struct EdgeTable *pThis, unsigned char nColor,
+	 short nBytesPerRow, unsigned char *pBitmap)
+{
+	/* A simple loop in which we fill the array pBitmap with the
+	 * spans from pThis. */
+	short	*pStart, *pEnd;
+	short	*pPiece;
+	int nPieces;
+	int nY;
+	int dy;
+	int nStep;
+	void (*pFillSpan)(unsigned char *p, int nCount, unsigned char nColor);
+
+#ifdef DEBUGC
+	printf("EdgeTable_SolidFill() -> nColor = %d\n", nColor);
+#endif
+
+	/* Select span fillers on first use. */
+	if (EdgeTable_pFillSpan8 == NULL)
+		EdgeTable_SelectFillers(CpuFeatures_Get());
+	pFillSpan = EdgeTable_pFillSpan8;
+
+	/* Initialize span lookup, from the first scanline to draw on
+	 * every nStep scanlines. */
+	nY = EdgeTable_FirstRowM(pThis);
+	nStep = pThis->nRowStep;
+	pStart = pThis->arSpanStartValues + nY;
+	pEnd = pThis->arSpanEndValues + nY;
+	/* Initialize bitmap pointer. */
+	pBitmap += nBytesPerRow * nY;
+
+	dy = pThis->nMaxScan - nY;
+	while (dy > 0)	/* We may be loosing the last scanline here. */
+	{	/* Clip the span and draw the pieces that remain. */
+		nPieces = EdgeTable_ClipSpan(pThis, nY, *pStart, *pEnd, &pPiece);
+		while (nPieces-- > 0)
+		{	pFillSpan(pBitmap + pPiece[0], pPiece[1] - pPiece[0], nColor);
+			pPiece += 2;
+		}
+
+		pStart += nStep;
+		pEnd += nStep;
+		pBitmap += nBytesPerRow * nStep;
+		nY += nStep;
+		dy -= nStep;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_SolidFill32()
+* Purpose : Fills a bitmap pBitmap with the polygon spans stored in
+*           EdgeTable pThis using a 32 bit aRGB color.
+* Pre : pThis points to an initialized EdgeTable structure, aRGB
+*       defines the value to use for the fill, nPixelsPerRow defines
+*       the number of PIXELS in a single scanline of the target bitmap
+*       pBitmap.
+* Post : pBitmap now contains the polygon defined in pThis. It is
+*        filled by color aRGB.
+* Note : THE BITMAP MUST BE AN ALIGNED 32-BIT COLOR BITMAP OR IT
+*       WILL SEGFAULT!
+********************************************************************/
+void EdgeTable_SolidFill32(struct EdgeTable *pThis, unsigned_int_32 aRGB,
+	 short nPixelsPerRow, unsigned_int_32 *pBitmap)
+{
+	/* A simple loop in which we fill the array pBitmap with the
+	 * spans from pThis. */
+	short	*pStart, *pEnd;
+	short	*pPiece;
+	int nPieces;
+	int nY;
+	int dy;
+	int nStep;
+	void (*pFillSpan)(unsigned_int_32 *p, int nCount, unsigned_int_32 aRGB);
+
+#ifdef DEBUGC
+	printf("EdgeTable_SolidFill32() -> aRGB = %d\n", aRGB);
+#endif
+
+	/* Select span fillers on first use. */
+	if (EdgeTable_pFillSpan32 == NULL)
+		EdgeTable_SelectFillers(CpuFeatures_Get());
+	pFillSpan = EdgeTable_pFillSpan32;
+
+	/* Initialize span lookup, from the first scanline to draw on
+	 * every nStep scanlines. */
+	nY = EdgeTable_FirstRowM(pThis);
+	nStep = pThis->nRowStep;
+	pStart = pThis->arSpanStartValues + nY;
+	pEnd = pThis->arSpanEndValues + nY;
+	/* Initialize bitmap pointer. */
+	pBitmap += nPixelsPerRow * nY;
+
+	dy = pThis->nMaxScan - nY;
+	while (dy > 0)	/* We may be loosing the last scanline here. */
+	{	/* Clip the span and draw the pieces that remain. */
+		nPieces = EdgeTable_ClipSpan(pThis, nY, *pStart, *pEnd, &pPiece);
+		while (nPieces-- > 0)
+		{	pFillSpan(pBitmap + pPiece[0], pPiece[1] - pPiece[0], aRGB);
+			pPiece += 2;
+		}
+
+		pStart += nStep;
+		pEnd += nStep;
+		pBitmap += nPixelsPerRow * nStep;
+		nY += nStep;
+		dy -= nStep;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_GouraudFill()
+* Purpose : Fills a bitmap pBitmap with the polygon spans stored in
+*           EdgeTable pThis, looking up the color of each pixel in
+*           the intensity ramp arIndices.
+* Pre : pThis points to an initialized EdgeTable structure whose
+*       edges were added by EdgeTable_AddGouraudEdge(). arIndices
+*       points to 256 colormap indices, from intensity 0 to 255
+*       (the arIndices of a Lightmap256), nBytesPerRow defines the
+*       number of bytes in a single scanline of the target bitmap
+*       pBitmap.
+* Post : pBitmap now contains the gouraud shaded polygon defined in
+*        pThis.
+********************************************************************/
+void EdgeTable_GouraudFill(struct EdgeTable *pThis, unsigned char *arIndices,
+	 short nBytesPerRow, unsigned char *pBitmap)
+{
+	short	*pStart, *pEnd;
+	int	*pStartI, *pEndI;
+	unsigned char *p;
+	short	*pPiece;
+	int nPieces;
+	int xs, xe;
+	int i, istep;
+	int ip;						/* Intensity at the current pixel. */
+	int n;
+	int nY;
+	int dy;
+
+	/* Initialize span lookup. */
+	pStart = pThis->arSpanStartValues + pThis->nMinScan;
+	pEnd = pThis->arSpanEndValues + pThis->nMinScan;
+	pStartI = pThis->arSpanStartIntensities + pThis->nMinScan;
+	pEndI = pThis->arSpanEndIntensities + pThis->nMinScan;
+	/* Initialize bitmap pointer. */
+	pBitmap += nBytesPerRow * pThis->nMinScan;
+
+	dy = pThis->nMaxScan - pThis->nMinScan;
+	nY = pThis->nMinScan;
+	while (dy > 0)	/* We may be loosing the last scanline here. */
+	{	xs = *(pStart++);
+		xe = *(pEnd++);
+		i = *(pStartI++);
+		istep = *(pEndI++);
+		if (xe > xs)
+		{	/* Setup the intensity DDA for the span. */
+			istep = (istep - i) / (xe - xs);
+
+			/* Clip the span and draw the pieces that remain. */
+			nPieces = EdgeTable_ClipSpan(pThis, nY, xs, xe, &pPiece);
+			while (nPieces-- > 0)
+			{	p = pBitmap + pPiece[0];
+				ip = i + istep * (pPiece[0] - xs);
+				n = pPiece[1] - pPiece[0];
+				while (n-- > 0)
+				{	*(p++) = arIndices[ip >> 16];
+					ip += istep;
+				}
+				pPiece += 2;
+			}
+		}
+
+		pBitmap += nBytesPerRow;
+		nY++;
+		dy--;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_GouraudFill32()
+* Purpose : Fills a bitmap pBitmap with the polygon spans stored in
+*           EdgeTable pThis, scaling the color aRGB by the intensity
+*           of each pixel.
+* Pre : pThis points to an initialized EdgeTable structure whose
+*       edges were added by EdgeTable_AddGouraudEdge(). aRGB is the
+*       color at full intensity, nPixelsPerRow defines the number of
+*       PIXELS in a single scanline of the target bitmap pBitmap.
+* Post : pBitmap now contains the gouraud shaded polygon defined in
+*        pThis, ranging from black at intensity 0 to aRGB at 255.
+* Note : THE BITMAP MUST BE AN ALIGNED 32-BIT COLOR BITMAP OR IT
+*       WILL SEGFAULT!
+********************************************************************/
+void EdgeTable_GouraudFill32(struct EdgeTable *pThis, unsigned_int_32 aRGB,
+	 short nPixelsPerRow, unsigned_int_32 *pBitmap)
+{
+	short	*pStart, *pEnd;
+	int	*pStartI, *pEndI;
+	unsigned_int_32 *p;
+	short	*pPiece;
+	int nPieces;
+	int xs, xe;
+	int i, ie;
+	int nR, nG, nB;
+	int r, g, b;				/* Color components at the span start, 8.16. */
+	int rstep, gstep, bstep;
+	int rp, gp, bp;			/* Current color components, 8.16. */
+	int n;
+	int nY;
+	int dy;
+
+	nR = (int)((aRGB >> 16) & 0xFF);
+	nG = (int)((aRGB >> 8) & 0xFF);
+	nB = (int)(aRGB & 0xFF);
+
+	/* Initialize span lookup. */
+	pStart = pThis->arSpanStartValues + pThis->nMinScan;
+	pEnd = pThis->arSpanEndValues + pThis->nMinScan;
+	pStartI = pThis->arSpanStartIntensities + pThis->nMinScan;
+	pEndI = pThis->arSpanEndIntensities + pThis->nMinScan;
+	/* Initialize bitmap pointer. */
+	pBitmap += nPixelsPerRow * pThis->nMinScan;
+
+	dy = pThis->nMaxScan - pThis->nMinScan;
+	nY = pThis->nMinScan;
+	while (dy > 0)	/* We may be loosing the last scanline here. */
+	{	xs = *(pStart++);
+		xe = *(pEnd++);
+		/* Scale 8.16 intensity to a 0.16 fraction of full
+		 * intensity (i / 255 rather than i / 256). */
+		i = *(pStartI++);
+		i = (i >> 8) + (i >> 16);
+		ie = *(pEndI++);
+		ie = (ie >> 8) + (ie >> 16);
+		if (xe > xs)
+		{	/* Setup the color DDAs for the span. */
+			r = nR * i;
+			g = nG * i;
+			b = nB * i;
+			rstep = (nR * ie - r) / (xe - xs);
+			gstep = (nG * ie - g) / (xe - xs);
+			bstep = (nB * ie - b) / (xe - xs);
+
+			/* Clip the span and draw the pieces that remain. */
+			nPieces = EdgeTable_ClipSpan(pThis, nY, xs, xe, &pPiece);
+			while (nPieces-- > 0)
+			{	p = pBitmap + pPiece[0];
+				rp = r + rstep * (pPiece[0] - xs);
+				gp = g + gstep * (pPiece[0] - xs);
+				bp = b + bstep * (pPiece[0] - xs);
+				n = pPiece[1] - pPiece[0];
+				while (n-- > 0)
+				{	*(p++) = (unsigned_int_32)(((rp >> 16) << 16) | ((gp >> 16) << 8) | (bp >> 16));
+					rp += rstep;
+					gp += gstep;
+					bp += bstep;
+				}
+				pPiece += 2;
+			}
+		}
+
+		pBitmap += nPixelsPerRow;
+		nY++;
+		dy--;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_ChromeFill()
+* Purpose : Fills a bitmap pBitmap with the polygon spans stored in
+*           EdgeTable pThis, sampling the texture pTexels at the
+*           interpolated chrome map coordinates.
+* Pre : pThis points to an initialized EdgeTable structure whose
+*       edges were added by EdgeTable_AddChromeEdge(). pTexels points
+*       to a 256x256 texture of colormap indices, stored from left to
+*       right, top to bottom (e.g. the CMBmp of a TextureMap).
+*       nBytesPerRow defines the number of bytes in a single scanline
+*       of the target bitmap pBitmap.
+* Post : pBitmap now contains the chrome mapped polygon defined in
+*        pThis.
+* Note : The coordinates are interpolated lineairly across each
+*        span, which is good enough for the smoothly varying normals
+*        chrome mapping derives them from. Coordinates wrap around.
+********************************************************************/
+void EdgeTable_ChromeFill(struct EdgeTable *pThis, unsigned char *pTexels,
+	 short nBytesPerRow, unsigned char *pBitmap)
+{
+	short	*pStart, *pEnd;
+	int	*pStartCX, *pStartCY, *pEndCX, *pEndCY;
+	unsigned char *p;
+	short	*pPiece;
+	int nPieces;
+	int xs, xe;
+	int cx, cy, cxstep, cystep;
+	int cxp, cyp;				/* Coordinates at the current pixel. */
+	int n;
+	int nY;
+	int dy;
+
+	/* Initialize span lookup. */
+	pStart = pThis->arSpanStartValues + pThis->nMinScan;
+	pEnd = pThis->arSpanEndValues + pThis->nMinScan;
+	pStartCX = pThis->arSpanStartCX + pThis->nMinScan;
+	pStartCY = pThis->arSpanStartCY + pThis->nMinScan;
+	pEndCX = pThis->arSpanEndCX + pThis->nMinScan;
+	pEndCY = pThis->arSpanEndCY + pThis->nMinScan;
+	/* Initialize bitmap pointer. */
+	pBitmap += nBytesPerRow * pThis->nMinScan;
+
+	dy = pThis->nMaxScan - pThis->nMinScan;
+	nY = pThis->nMinScan;
+	while (dy > 0)	/* We may be loosing the last scanline here. */
+	{	xs = *(pStart++);
+		xe = *(pEnd++);
+		cx = *(pStartCX++);
+		cy = *(pStartCY++);
+		cxstep = *(pEndCX++);
+		cystep = *(pEndCY++);
+		if (xe > xs)
+		{	/* Setup the coordinate DDAs for the span. */
+			cxstep = (cxstep - cx) / (xe - xs);
+			cystep = (cystep - cy) / (xe - xs);
+
+			/* Clip the span and draw the pieces that remain. */
+			nPieces = EdgeTable_ClipSpan(pThis, nY, xs, xe, &pPiece);
+			while (nPieces-- > 0)
+			{	p = pBitmap + pPiece[0];
+				cxp = cx + cxstep * (pPiece[0] - xs);
+				cyp = cy + cystep * (pPiece[0] - xs);
+				n = pPiece[1] - pPiece[0];
+				while (n-- > 0)
+				{	*(p++) = pTexels[((cyp >> 8) & 0xFF00) | ((cxp >> 16) & 0xFF)];
+					cxp += cxstep;
+					cyp += cystep;
+				}
+				pPiece += 2;
+			}
+		}
+
+		pBitmap += nBytesPerRow;
+		nY++;
+		dy--;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_ChromeFill32()
+* Purpose : Fills a bitmap pBitmap with the polygon spans stored in
+*           EdgeTable pThis, sampling the texture pTexels at the
+*           interpolated chrome map coordinates.
+* Pre : As EdgeTable_ChromeFill(), but pTexels indexes the 0xRRGGBB
+*       colors in pPalette (e.g. the Bitmap and aulPalette of a
+*       TextureMap) and nPixelsPerRow defines the number of PIXELS in
+*       a single scanline of the target bitmap pBitmap.
+* Post : pBitmap now contains the chrome mapped polygon defined in
+*        pThis.
+* Note : THE BITMAP MUST BE AN ALIGNED 32-BIT COLOR BITMAP OR IT
+*       WILL SEGFAULT!
+********************************************************************/
+void EdgeTable_ChromeFill32(struct EdgeTable *pThis, unsigned char *pTexels,
+	 unsigned long *pPalette, short nPixelsPerRow, unsigned_int_32 *pBitmap)
+{
+	short	*pStart, *pEnd;
+	int	*pStartCX, *pStartCY, *pEndCX, *pEndCY;
+	unsigned_int_32 *p;
+	short	*pPiece;
+	int nPieces;
+	int xs, xe;
+	int cx, cy, cxstep, cystep;
+	int cxp, cyp;				/* Coordinates at the current pixel. */
+	int n;
+	int nY;
+	int dy;
+
+	/* Initialize span lookup. */
+	pStart = pThis->arSpanStartValues + pThis->nMinScan;
+	pEnd = pThis->arSpanEndValues + pThis->nMinScan;
+	pStartCX = pThis->arSpanStartCX + pThis->nMinScan;
+	pStartCY = pThis->arSpanStartCY + pThis->nMinScan;
+	pEndCX = pThis->arSpanEndCX + pThis->nMinScan;
+	pEndCY = pThis->arSpanEndCY + pThis->nMinScan;
+	/* Initialize bitmap pointer. */
+	pBitmap += nPixelsPerRow * pThis->nMinScan;
+
+	dy = pThis->nMaxScan - pThis->nMinScan;
+	nY = pThis->nMinScan;
+	while (dy > 0)	/* We may be loosing the last scanline here. */
+	{	xs = *(pStart++);
+		xe = *(pEnd++);
+		cx = *(pStartCX++);
+		cy = *(pStartCY++);
+		cxstep = *(pEndCX++);
+		cystep = *(pEndCY++);
+		if (xe > xs)
+		{	/* Setup the coordinate DDAs for the span. */
+			cxstep = (cxstep - cx) / (xe - xs);
+			cystep = (cystep - cy) / (xe - xs);
+
+			/* Clip the span and draw the pieces that remain. */
+			nPieces = EdgeTable_ClipSpan(pThis, nY, xs, xe, &pPiece);
+			while (nPieces-- > 0)
+			{	p = pBitmap + pPiece[0];
+				cxp = cx + cxstep * (pPiece[0] - xs);
+				cyp = cy + cystep * (pPiece[0] - xs);
+				n = pPiece[1] - pPiece[0];
+				while (n-- > 0)
+				{	*(p++) = (unsigned_int_32)pPalette[pTexels[((cyp >> 8) & 0xFF00) | ((cxp >> 16) & 0xFF)]];
+					cxp += cxstep;
+					cyp += cystep;
+				}
+				pPiece += 2;
+			}
+		}
+
+		pBitmap += nPixelsPerRow;
+		nY++;
+		dy--;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_TextureFill()
+* Purpose : Fills a bitmap pBitmap with the polygon spans stored in
+*           EdgeTable pThis, sampling the texture pTexels at the
+*           perspective correct texture map coordinates.
+* Pre : pThis points to an initialized EdgeTable structure whose
+*       edges were added by EdgeTable_AddTextureEdge(). pTexels
+*       points to a 256x256 texture of colormap indices, stored from
+*       left to right, top to bottom (e.g. the CMBmp of a TextureMap).
+*       nBytesPerRow defines the number of bytes in a single scanline
+*       of the target bitmap pBitmap.
+* Post : pBitmap now contains the texture mapped polygon defined in
+*        pThis.
+* Note : Dividing for every pixel is too slow, so each span is cut
+*        into runs of (1 << EDGETABLE_SUBDIVSHIFT) pixels. The
+*        coordinates are only divided at the end of each run and are
+*        stepped linearly in between, the error this introduces is
+*        invisible for runs this short. Coordinates wrap around.
+********************************************************************/
+void EdgeTable_TextureFill(struct EdgeTable *pThis, unsigned char *pTexels,
+	 short nBytesPerRow, unsigned char *pBitmap)
+{
+	short	*pStart, *pEnd;
+	float	*pStartUZ, *pStartVZ, *pStartIZ, *pEndUZ, *pEndVZ, *pEndIZ;
+	unsigned char *p;
+	short	*pPiece;
+	int nPieces;
+	int xs, xe;
+	float uz, vz, iz;				/* Texture coordinates at the span start. */
+	float uzstep, vzstep, izstep;	/* Their increment per pixel. */
+	float uzp, vzp, izp;			/* Texture coordinates at the current run. */
+	float z;
+	int u, v, ustep, vstep;		/* Texel coordinates, 16.16. */
+	int u1, v1;						/* Texel coordinates at the end of a run. */
+	int x0, x1;						/* Start and end of the current run. */
+	int nRun;
+	int n;
+	int nY;
+	int dy;
+
+	/* Initialize span lookup. */
+	pStart = pThis->arSpanStartValues + pThis->nMinScan;
+	pEnd = pThis->arSpanEndValues + pThis->nMinScan;
+	pStartUZ = pThis->arSpanStartUZ + pThis->nMinScan;
+	pStartVZ = pThis->arSpanStartVZ + pThis->nMinScan;
+	pStartIZ = pThis->arSpanStartIZ + pThis->nMinScan;
+	pEndUZ = pThis->arSpanEndUZ + pThis->nMinScan;
+	pEndVZ = pThis->arSpanEndVZ + pThis->nMinScan;
+	pEndIZ = pThis->arSpanEndIZ + pThis->nMinScan;
+	/* Initialize bitmap pointer. */
+	pBitmap += nBytesPerRow * pThis->nMinScan;
+
+	dy = pThis->nMaxScan - pThis->nMinScan;
+	nY = pThis->nMinScan;
+	while (dy > 0)	/* We may be loosing the last scanline here. */
+	{	xs = *(pStart++);
+		xe = *(pEnd++);
+		uz = *(pStartUZ++);
+		vz = *(pStartVZ++);
+		iz = *(pStartIZ++);
+		uzstep = *(pEndUZ++);
+		vzstep = *(pEndVZ++);
+		izstep = *(pEndIZ++);
+		if ((xe > xs) && (iz > 0.f) && (izstep > 0.f))
+		{	/* Setup the texture coordinate steps for the span. */
+			z = 1.f / (float)(xe - xs);
+			uzstep = (uzstep - uz) * z;
+			vzstep = (vzstep - vz) * z;
+			izstep = (izstep - iz) * z;
+
+			/* Clip the span and draw the pieces that remain. */
+			nPieces = EdgeTable_ClipSpan(pThis, nY, xs, xe, &pPiece);
+			while (nPieces-- > 0)
+			{	/* The runs are laid out from the start of the span, not
+				 * of the piece, so a piece is drawn exactly like the same
+				 * pixels of the whole span. */
+				x0 = xs + (((pPiece[0] - xs) >> EDGETABLE_SUBDIVSHIFT) << EDGETABLE_SUBDIVSHIFT);
+				uzp = uz + uzstep * (float)(x0 - xs);
+				vzp = vz + vzstep * (float)(x0 - xs);
+				izp = iz + izstep * (float)(x0 - xs);
+				z = 65536.f / izp;
+				u1 = (int)(uzp * z);
+				v1 = (int)(vzp * z);
+
+				/* Draw the piece in runs. */
+				p = pBitmap + pPiece[0];
+				n = pPiece[0];
+				while (n < pPiece[1])
+				{	/* Start at the end of the previous run. */
+					u = u1;
+					v = v1;
+					x1 = x0 + (1 << EDGETABLE_SUBDIVSHIFT);
+					if (x1 > xe)
+						x1 = xe;
+					nRun = x1 - x0;
+
+					/* Divide at the end of the run. */
+					uzp = uz + uzstep * (float)(x1 - xs);
+					vzp = vz + vzstep * (float)(x1 - xs);
+					izp = iz + izstep * (float)(x1 - xs);
+					z = 65536.f / izp;
+					u1 = (int)(uzp * z);
+					v1 = (int)(vzp * z);
+					if (nRun == (1 << EDGETABLE_SUBDIVSHIFT))
+					{	ustep = (u1 - u) >> EDGETABLE_SUBDIVSHIFT;
+						vstep = (v1 - v) >> EDGETABLE_SUBDIVSHIFT;
+					} else
+					{	ustep = (u1 - u) / nRun;
+						vstep = (v1 - v) / nRun;
+					}
+
+					/* Skip the part of the run before the piece. */
+					u += ustep * (n - x0);
+					v += vstep * (n - x0);
+					if (x1 > pPiece[1])
+						x1 = pPiece[1];
+
+					/* Step linearly inside the run. */
+					while (n < x1)
+					{	*(p++) = pTexels[((v >> 8) & 0xFF00) | ((u >> 16) & 0xFF)];
+						u += ustep;
+						v += vstep;
+						n++;
+					}
+					x0 += (1 << EDGETABLE_SUBDIVSHIFT);
+				}
+				pPiece += 2;
+			}
+		}
+
+		pBitmap += nBytesPerRow;
+		nY++;
+		dy--;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_TextureFill32()
+* Purpose : Fills a bitmap pBitmap with the polygon spans stored in
+*           EdgeTable pThis, sampling the texture pTexels at the
+*           perspective correct texture map coordinates.
+* Pre : As EdgeTable_TextureFill(), but pTexels indexes the 0xRRGGBB
+*       colors in pPalette (e.g. the Bitmap and aulPalette of a
+*       TextureMap) and nPixelsPerRow defines the number of PIXELS in
+*       a single scanline of the target bitmap pBitmap.
+* Post : pBitmap now contains the texture mapped polygon defined in
+*        pThis.
+* Note : Dividing for every pixel is too slow, so each span is cut
+*        into runs of (1 << EDGETABLE_SUBDIVSHIFT) pixels. The
+*        coordinates are only divided at the end of each run and are
+*        stepped linearly in between, the error this introduces is
+*        invisible for runs this short. Coordinates wrap around.
+*        THE BITMAP MUST BE AN ALIGNED 32-BIT COLOR BITMAP OR IT
+*        WILL SEGFAULT!
+********************************************************************/
+void EdgeTable_TextureFill32(struct EdgeTable *pThis, unsigned char *pTexels,
+	 unsigned long *pPalette, short nPixelsPerRow, unsigned_int_32 *pBitmap)
+{
+	short	*pStart, *pEnd;
+	float	*pStartUZ, *pStartVZ, *pStartIZ, *pEndUZ, *pEndVZ, *pEndIZ;
+	unsigned_int_32 *p;
+	short	*pPiece;
+	int nPieces;
+	int xs, xe;
+	float uz, vz, iz;				/* Texture coordinates at the span start. */
+	float uzstep, vzstep, izstep;	/* Their increment per pixel. */
+	float uzp, vzp, izp;			/* Texture coordinates at the current run. */
+	float z;
+	int u, v, ustep, vstep;		/* Texel coordinates, 16.16. */
+	int u1, v1;						/* Texel coordinates at the end of a run. */
+	int x0, x1;						/* Start and end of the current run. */
+	int nRun;
+	int n;
+	int nY;
+	int dy;
+
+	/* Initialize span lookup. */
+	pStart = pThis->arSpanStartValues + pThis->nMinScan;
+	pEnd = pThis->arSpanEndValues + pThis->nMinScan;
+	pStartUZ = pThis->arSpanStartUZ + pThis->nMinScan;
+	pStartVZ = pThis->arSpanStartVZ + pThis->nMinScan;
+	pStartIZ = pThis->arSpanStartIZ + pThis->nMinScan;
+	pEndUZ = pThis->arSpanEndUZ + pThis->nMinScan;
+	pEndVZ = pThis->arSpanEndVZ + pThis->nMinScan;
+	pEndIZ = pThis->arSpanEndIZ + pThis->nMinScan;
+	/* Initialize bitmap pointer. */
+	pBitmap += nPixelsPerRow * pThis->nMinScan;
+
+	dy = pThis->nMaxScan - pThis->nMinScan;
+	nY = pThis->nMinScan;
+	while (dy > 0)	/* We may be loosing the last scanline here. */
+	{	xs = *(pStart++);
+		xe = *(pEnd++);
+		uz = *(pStartUZ++);
+		vz = *(pStartVZ++);
+		iz = *(pStartIZ++);
+		uzstep = *(pEndUZ++);
+		vzstep = *(pEndVZ++);
+		izstep = *(pEndIZ++);
+		if ((xe > xs) && (iz > 0.f) && (izstep > 0.f))
+		{	/* Setup the texture coordinate steps for the span. */
+			z = 1.f / (float)(xe - xs);
+			uzstep = (uzstep - uz) * z;
+			vzstep = (vzstep - vz) * z;
+			izstep = (izstep - iz) * z;
+
+			/* Clip the span and draw the pieces that remain. */
+			nPieces = EdgeTable_ClipSpan(pThis, nY, xs, xe, &pPiece);
+			while (nPieces-- > 0)
+			{	/* The runs are laid out from the start of the span, not
+				 * of the piece, so a piece is drawn exactly like the same
+				 * pixels of the whole span. */
+				x0 = xs + (((pPiece[0] - xs) >> EDGETABLE_SUBDIVSHIFT) << EDGETABLE_SUBDIVSHIFT);
+				uzp = uz + uzstep * (float)(x0 - xs);
+				vzp = vz + vzstep * (float)(x0 - xs);
+				izp = iz + izstep * (float)(x0 - xs);
+				z = 65536.f / izp;
+				u1 = (int)(uzp * z);
+				v1 = (int)(vzp * z);
+
+				/* Draw the piece in runs. */
+				p = pBitmap + pPiece[0];
+				n = pPiece[0];
+				while (n < pPiece[1])
+				{	/* Start at the end of the previous run. */
+					u = u1;
+					v = v1;
+					x1 = x0 + (1 << EDGETABLE_SUBDIVSHIFT);
+					if (x1 > xe)
+						x1 = xe;
+					nRun = x1 - x0;
+
+					/* Divide at the end of the run. */
+					uzp = uz + uzstep * (float)(x1 - xs);
+					vzp = vz + vzstep * (float)(x1 - xs);
+					izp = iz + izstep * (float)(x1 - xs);
+					z = 65536.f / izp;
+					u1 = (int)(uzp * z);
+					v1 = (int)(vzp * z);
+					if (nRun == (1 << EDGETABLE_SUBDIVSHIFT))
+					{	ustep = (u1 - u) >> EDGETABLE_SUBDIVSHIFT;
+						vstep = (v1 - v) >> EDGETABLE_SUBDIVSHIFT;
+					} else
+					{	ustep = (u1 - u) / nRun;
+						vstep = (v1 - v) / nRun;
+					}
+
+					/* Skip the part of the run before the piece. */
+					u += ustep * (n - x0);
+					v += vstep * (n - x0);
+					if (x1 > pPiece[1])
+						x1 = pPiece[1];
+
+					/* Step linearly inside the run. */
+					while (n < x1)
+					{	*(p++) = (unsigned_int_32)pPalette[pTexels[((v >> 8) & 0xFF00) | ((u >> 16) & 0xFF)]];
+						u += ustep;
+						v += vstep;
+						n++;
+					}
+					x0 += (1 << EDGETABLE_SUBDIVSHIFT);
+				}
+				pPiece += 2;
+			}
+		}
+
+		pBitmap += nPixelsPerRow;
+		nY++;
+		dy--;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_SolidFill16()
+* Purpose : Fills a bitmap pBitmap with the polygon spans stored in
+*           EdgeTable pThis using a 16 bit RGB565 color.
+* Pre : pThis points to an initialized EdgeTable structure, nColor
+*       defines the value to use for the fill, nPixelsPerRow defines
+*       the number of PIXELS in a single scanline of the target bitmap
+*       pBitmap.
+* Post : pBitmap now contains the polygon defined in pThis. It is
+*        filled by color nColor.
+* Note : THE BITMAP MUST BE AN ALIGNED 16-BIT COLOR BITMAP OR IT
+*       WILL SEGFAULT!
+********************************************************************/
+void EdgeTable_SolidFill16(struct EdgeTable *pThis, unsigned_int_16 nColor,
+	 short nPixelsPerRow, unsigned_int_16 *pBitmap)
+{
+	/* A simple loop in which we fill the array pBitmap with the
+	 * spans from pThis. */
+	short	*pStart, *pEnd;
+	short	*pPiece;
+	int nPieces;
+	int nY;
+	int dy;
+	int nStep;
+	void (*pFillSpan)(unsigned_int_16 *p, int nCount, unsigned_int_16 nColor);
+
+#ifdef DEBUGC
+	printf("EdgeTable_SolidFill16() -> nColor = %d\n", nColor);
+#endif
+
+	/* Select span fillers on first use. */
+	if (EdgeTable_pFillSpan16 == NULL)
+		EdgeTable_SelectFillers(CpuFeatures_Get());
+	pFillSpan = EdgeTable_pFillSpan16;
+
+	/* Initialize span lookup, from the first scanline to draw on
+	 * every nStep scanlines. */
+	nY = EdgeTable_FirstRowM(pThis);
+	nStep = pThis->nRowStep;
+	pStart = pThis->arSpanStartValues + nY;
+	pEnd = pThis->arSpanEndValues + nY;
+	/* Initialize bitmap pointer. */
+	pBitmap += nPixelsPerRow * nY;
+
+	dy = pThis->nMaxScan - nY;
+	while (dy > 0)	/* We may be loosing the last scanline here. */
+	{	/* Clip the span and draw the pieces that remain. */
+		nPieces = EdgeTable_ClipSpan(pThis, nY, *pStart, *pEnd, &pPiece);
+		while (nPieces-- > 0)
+		{	pFillSpan(pBitmap + pPiece[0], pPiece[1] - pPiece[0], nColor);
+			pPiece += 2;
+		}
+
+		pStart += nStep;
+		pEnd += nStep;
+		pBitmap += nPixelsPerRow * nStep;
+		nY += nStep;
+		dy -= nStep;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_GouraudFill16()
+* Purpose : Fills a bitmap pBitmap with the polygon spans stored in
+*           EdgeTable pThis, scaling the color aRGB by the intensity
+*           of each pixel.
+* Pre : pThis points to an initialized EdgeTable structure whose
+*       edges were added by EdgeTable_AddGouraudEdge(). aRGB is the
+*       color at full intensity, nPixelsPerRow defines the number of
+*       PIXELS in a single scanline of the target bitmap pBitmap.
+* Post : pBitmap now contains the gouraud shaded polygon defined in
+*        pThis, ranging from black at intensity 0 to aRGB at 255,
+*        in RGB565.
+* Note : THE BITMAP MUST BE AN ALIGNED 16-BIT COLOR BITMAP OR IT
+*       WILL SEGFAULT!
+********************************************************************/
+void EdgeTable_GouraudFill16(struct EdgeTable *pThis, unsigned_int_32 aRGB,
+	 short nPixelsPerRow, unsigned_int_16 *pBitmap)
+{
+	short	*pStart, *pEnd;
+	int	*pStartI, *pEndI;
+	unsigned_int_16 *p;
+	short	*pPiece;
+	int nPieces;
+	int xs, xe;
+	int i, ie;
+	int nR, nG, nB;
+	int r, g, b;				/* Color components at the span start, 8.16. */
+	int rstep, gstep, bstep;
+	int rp, gp, bp;			/* Current color components, 8.16. */
+	int n;
+	int nY;
+	int dy;
+
+	nR = (int)((aRGB >> 16) & 0xFF);
+	nG = (int)((aRGB >> 8) & 0xFF);
+	nB = (int)(aRGB & 0xFF);
+
+	/* Initialize span lookup. */
+	pStart = pThis->arSpanStartValues + pThis->nMinScan;
+	pEnd = pThis->arSpanEndValues + pThis->nMinScan;
+	pStartI = pThis->arSpanStartIntensities + pThis->nMinScan;
+	pEndI = pThis->arSpanEndIntensities + pThis->nMinScan;
+	/* Initialize bitmap pointer. */
+	pBitmap += nPixelsPerRow * pThis->nMinScan;
+
+	dy = pThis->nMaxScan - pThis->nMinScan;
+	nY = pThis->nMinScan;
+	while (dy > 0)	/* We may be loosing the last scanline here. */
+	{	xs = *(pStart++);
+		xe = *(pEnd++);
+		/* Scale 8.16 intensity to a 0.16 fraction of full
+		 * intensity (i / 255 rather than i / 256). */
+		i = *(pStartI++);
+		i = (i >> 8) + (i >> 16);
+		ie = *(pEndI++);
+		ie = (ie >> 8) + (ie >> 16);
+		if (xe > xs)
+		{	/* Setup the color DDAs for the span. */
+			r = nR * i;
+			g = nG * i;
+			b = nB * i;
+			rstep = (nR * ie - r) / (xe - xs);
+			gstep = (nG * ie - g) / (xe - xs);
+			bstep = (nB * ie - b) / (xe - xs);
+
+			/* Clip the span and draw the pieces that remain. */
+			nPieces = EdgeTable_ClipSpan(pThis, nY, xs, xe, &pPiece);
+			while (nPieces-- > 0)
+			{	p = pBitmap + pPiece[0];
+				rp = r + rstep * (pPiece[0] - xs);
+				gp = g + gstep * (pPiece[0] - xs);
+				bp = b + bstep * (pPiece[0] - xs);
+				n = pPiece[1] - pPiece[0];
+				while (n-- > 0)
+				{	*(p++) = (unsigned_int_16)(((rp >> 19) << 11) | ((gp >> 18) << 5) | (bp >> 19));
+					rp += rstep;
+					gp += gstep;
+					bp += bstep;
+				}
+				pPiece += 2;
+			}
+		}
+
+		pBitmap += nPixelsPerRow;
+		nY++;
+		dy--;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_ChromeFill16()
+* Purpose : Fills a bitmap pBitmap with the polygon spans stored in
+*           EdgeTable pThis, sampling the texture pTexels at the
+*           interpolated chrome map coordinates.
+* Pre : As EdgeTable_ChromeFill(), but pTexels indexes the
+*       RGB565 colors in pPalette (e.g. the Bitmap and ausPalette565 of a
+*       TextureMap) and nPixelsPerRow defines the number of PIXELS in
+*       a single scanline of the target bitmap pBitmap.
+* Post : pBitmap now contains the chrome mapped polygon defined in
+*        pThis.
+* Note : THE BITMAP MUST BE AN ALIGNED 16-BIT COLOR BITMAP OR IT
+*       WILL SEGFAULT!
+********************************************************************/
+void EdgeTable_ChromeFill16(struct EdgeTable *pThis, unsigned char *pTexels,
+	 unsigned_int_16 *pPalette, short nPixelsPerRow, unsigned_int_16 *pBitmap)
+{
+	short	*pStart, *pEnd;
+	int	*pStartCX, *pStartCY, *pEndCX, *pEndCY;
+	unsigned_int_16 *p;
+	short	*pPiece;
+	int nPieces;
+	int xs, xe;
+	int cx, cy, cxstep, cystep;
+	int cxp, cyp;				/* Coordinates at the current pixel. */
+	int n;
+	int nY;
+	int dy;
+
+	/* Initialize span lookup. */
+	pStart = pThis->arSpanStartValues + pThis->nMinScan;
+	pEnd = pThis->arSpanEndValues + pThis->nMinScan;
+	pStartCX = pThis->arSpanStartCX + pThis->nMinScan;
+	pStartCY = pThis->arSpanStartCY + pThis->nMinScan;
+	pEndCX = pThis->arSpanEndCX + pThis->nMinScan;
+	pEndCY = pThis->arSpanEndCY + pThis->nMinScan;
+	/* Initialize bitmap pointer. */
+	pBitmap += nPixelsPerRow * pThis->nMinScan;
+
+	dy = pThis->nMaxScan - pThis->nMinScan;
+	nY = pThis->nMinScan;
+	while (dy > 0)	/* We may be loosing the last scanline here. */
+	{	xs = *(pStart++);
+		xe = *(pEnd++);
+		cx = *(pStartCX++);
+		cy = *(pStartCY++);
+		cxstep = *(pEndCX++);
+		cystep = *(pEndCY++);
+		if (xe > xs)
+		{	/* Setup the coordinate DDAs for the span. */
+			cxstep = (cxstep - cx) / (xe - xs);
+			cystep = (cystep - cy) / (xe - xs);
+
+			/* Clip the span and draw the pieces that remain. */
+			nPieces = EdgeTable_ClipSpan(pThis, nY, xs, xe, &pPiece);
+			while (nPieces-- > 0)
+			{	p = pBitmap + pPiece[0];
+				cxp = cx + cxstep * (pPiece[0] - xs);
+				cyp = cy + cystep * (pPiece[0] - xs);
+				n = pPiece[1] - pPiece[0];
+				while (n-- > 0)
+				{	*(p++) = (unsigned_int_16)pPalette[pTexels[((cyp >> 8) & 0xFF00) | ((cxp >> 16) & 0xFF)]];
+					cxp += cxstep;
+					cyp += cystep;
+				}
+				pPiece += 2;
+			}
+		}
+
+		pBitmap += nPixelsPerRow;
+		nY++;
+		dy--;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_TextureFill16()
+* Purpose : Fills a bitmap pBitmap with the polygon spans stored in
+*           EdgeTable pThis, sampling the texture pTexels at the
+*           perspective correct texture map coordinates.
+* Pre : As EdgeTable_TextureFill(), but pTexels indexes the
+*       RGB565 colors in pPalette (e.g. the Bitmap and ausPalette565 of a
+*       TextureMap) and nPixelsPerRow defines the number of PIXELS in
+*       a single scanline of the target bitmap pBitmap.
+* Post : pBitmap now contains the texture mapped polygon defined in
+*        pThis.
+* Note : Dividing for every pixel is too slow, so each span is cut
+*        into runs of (1 << EDGETABLE_SUBDIVSHIFT) pixels. The
+*        coordinates are only divided at the end of each run and are
+*        stepped linearly in between, the error this introduces is
+*        invisible for runs this short. Coordinates wrap around.
+*        THE BITMAP MUST BE AN ALIGNED 16-BIT COLOR BITMAP OR IT
+*        WILL SEGFAULT!
+********************************************************************/
+void EdgeTable_TextureFill16(struct EdgeTable *pThis, unsigned char *pTexels,
+	 unsigned_int_16 *pPalette, short nPixelsPerRow, unsigned_int_16 *pBitmap)
+{
+	short	*pStart, *pEnd;
+	float	*pStartUZ, *pStartVZ, *pStartIZ, *pEndUZ, *pEndVZ, *pEndIZ;
+	unsigned_int_16 *p;
+	short	*pPiece;
+	int nPieces;
+	int xs, xe;
+	float uz, vz, iz;				/* Texture coordinates at the span start. */
+	float uzstep, vzstep, izstep;	/* Their increment per pixel. */
+	float uzp, vzp, izp;			/* Texture coordinates at the current run. */
+	float z;
+	int u, v, ustep, vstep;		/* Texel coordinates, 16.16. */
+	int u1, v1;						/* Texel coordinates at the end of a run. */
+	int x0, x1;						/* Start and end of the current run. */
+	int nRun;
+	int n;
+	int nY;
+	int dy;
+
+	/* Initialize span lookup. */
+	pStart = pThis->arSpanStartValues + pThis->nMinScan;
+	pEnd = pThis->arSpanEndValues + pThis->nMinScan;
+	pStartUZ = pThis->arSpanStartUZ + pThis->nMinScan;
+	pStartVZ = pThis->arSpanStartVZ + pThis->nMinScan;
+	pStartIZ = pThis->arSpanStartIZ + pThis->nMinScan;
+	pEndUZ = pThis->arSpanEndUZ + pThis->nMinScan;
+	pEndVZ = pThis->arSpanEndVZ + pThis->nMinScan;
+	pEndIZ = pThis->arSpanEndIZ + pThis->nMinScan;
+	/* Initialize bitmap pointer. */
+	pBitmap += nPixelsPerRow * pThis->nMinScan;
+
+	dy = pThis->nMaxScan - pThis->nMinScan;
+	nY = pThis->nMinScan;
+	while (dy > 0)	/* We may be loosing the last scanline here. */
+	{	xs = *(pStart++);
+		xe = *(pEnd++);
+		uz = *(pStartUZ++);
+		vz = *(pStartVZ++);
+		iz = *(pStartIZ++);
+		uzstep = *(pEndUZ++);
+		vzstep = *(pEndVZ++);
+		izstep = *(pEndIZ++);
+		if ((xe > xs) && (iz > 0.f) && (izstep > 0.f))
+		{	/* Setup the texture coordinate steps for the span. */
+			z = 1.f / (float)(xe - xs);
+			uzstep = (uzstep - uz) * z;
+			vzstep = (vzstep - vz) * z;
+			izstep = (izstep - iz) * z;
+
+			/* Clip the span and draw the pieces that remain. */
+			nPieces = EdgeTable_ClipSpan(pThis, nY, xs, xe, &pPiece);
+			while (nPieces-- > 0)
+			{	/* The runs are laid out from the start of the span, not
+				 * of the piece, so a piece is drawn exactly like the same
+				 * pixels of the whole span. */
+				x0 = xs + (((pPiece[0] - xs) >> EDGETABLE_SUBDIVSHIFT) << EDGETABLE_SUBDIVSHIFT);
+				uzp = uz + uzstep * (float)(x0 - xs);
+				vzp = vz + vzstep * (float)(x0 - xs);
+				izp = iz + izstep * (float)(x0 - xs);
+				z = 65536.f / izp;
+				u1 = (int)(uzp * z);
+				v1 = (int)(vzp * z);
+
+				/* Draw the piece in runs. */
+				p = pBitmap + pPiece[0];
+				n = pPiece[0];
+				while (n < pPiece[1])
+				{	/* Start at the end of the previous run. */
+					u = u1;
+					v = v1;
+					x1 = x0 + (1 << EDGETABLE_SUBDIVSHIFT);
+					if (x1 > xe)
+						x1 = xe;
+					nRun = x1 - x0;
+
+					/* Divide at the end of the run. */
+					uzp = uz + uzstep * (float)(x1 - xs);
+					vzp = vz + vzstep * (float)(x1 - xs);
+					izp = iz + izstep * (float)(x1 - xs);
+					z = 65536.f / izp;
+					u1 = (int)(uzp * z);
+					v1 = (int)(vzp * z);
+					if (nRun == (1 << EDGETABLE_SUBDIVSHIFT))
+					{	ustep = (u1 - u) >> EDGETABLE_SUBDIVSHIFT;
+						vstep = (v1 - v) >> EDGETABLE_SUBDIVSHIFT;
+					} else
+					{	ustep = (u1 - u) / nRun;
+						vstep = (v1 - v) / nRun;
+					}
+
+					/* Skip the part of the run before the piece. */
+					u += ustep * (n - x0);
+					v += vstep * (n - x0);
+					if (x1 > pPiece[1])
+						x1 = pPiece[1];
+
+					/* Step linearly inside the run. */
+					while (n < x1)
+					{	*(p++) = (unsigned_int_16)pPalette[pTexels[((v >> 8) & 0xFF00) | ((u >> 16) & 0xFF)]];
+						u += ustep;
+						v += vstep;
+						n++;
+					}
+					x0 += (1 << EDGETABLE_SUBDIVSHIFT);
+				}
+				pPiece += 2;
+			}
+		}
+
+		pBitmap += nPixelsPerRow;
+		nY++;
+		dy--;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_SolidFill24()
+* Purpose : Fills a bitmap pBitmap with the polygon spans stored in
+*           EdgeTable pThis using a 24 bit RGB color.
+* Pre : pThis points to an initialized EdgeTable structure, aRGB
+*       defines the value to use for the fill, nPixelsPerRow defines
+*       the number of PIXELS in a single scanline of the target bitmap
+*       pBitmap.
+* Post : pBitmap now contains the polygon defined in pThis. It is
+*        filled by color aRGB.
+* Note : The pixels are packed, 3 bytes each in the order blue,
+*        green, red. They need not be alligned.
+********************************************************************/
+void EdgeTable_SolidFill24(struct EdgeTable *pThis, unsigned_int_32 aRGB,
+	 short nPixelsPerRow, unsigned char *pBitmap)
+{
+	/* A simple loop in which we fill the array pBitmap with the
+	 * spans from pThis. */
+	short	*pStart, *pEnd;
+	short	*pPiece;
+	int nPieces;
+	int nY;
+	int dy;
+	int nStep;
+	void (*pFillSpan)(unsigned char *p, int nCount, unsigned_int_32 aRGB);
+
+#ifdef DEBUGC
+	printf("EdgeTable_SolidFill24() -> aRGB = %d\n", aRGB);
+#endif
+
+	/* Select span fillers on first use. */
+	if (EdgeTable_pFillSpan24 == NULL)
+		EdgeTable_SelectFillers(CpuFeatures_Get());
+	pFillSpan = EdgeTable_pFillSpan24;
+
+	/* Initialize span lookup, from the first scanline to draw on
+	 * every nStep scanlines. */
+	nY = EdgeTable_FirstRowM(pThis);
+	nStep = pThis->nRowStep;
+	pStart = pThis->arSpanStartValues + nY;
+	pEnd = pThis->arSpanEndValues + nY;
+	/* Initialize bitmap pointer. */
+	pBitmap += 3 * nPixelsPerRow * nY;
+
+	dy = pThis->nMaxScan - nY;
+	while (dy > 0)	/* We may be loosing the last scanline here. */
+	{	/* Clip the span and draw the pieces that remain. */
+		nPieces = EdgeTable_ClipSpan(pThis, nY, *pStart, *pEnd, &pPiece);
+		while (nPieces-- > 0)
+		{	pFillSpan(pBitmap + 3 * pPiece[0], pPiece[1] - pPiece[0], aRGB);
+			pPiece += 2;
+		}
+
+		pStart += nStep;
+		pEnd += nStep;
+		pBitmap += 3 * nPixelsPerRow * nStep;
+		nY += nStep;
+		dy -= nStep;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_GouraudFill24()
+* Purpose : Fills a bitmap pBitmap with the polygon spans stored in
+*           EdgeTable pThis, scaling the color aRGB by the intensity
+*           of each pixel.
+* Pre : pThis points to an initialized EdgeTable structure whose
+*       edges were added by EdgeTable_AddGouraudEdge(). aRGB is the
+*       color at full intensity, nPixelsPerRow defines the number of
+*       PIXELS in a single scanline of the target bitmap pBitmap.
+* Post : pBitmap now contains the gouraud shaded polygon defined in
+*        pThis, ranging from black at intensity 0 to aRGB at 255.
+* Note : The pixels are packed, 3 bytes each in the order blue,
+*        green, red. They need not be alligned.
+********************************************************************/
+void EdgeTable_GouraudFill24(struct EdgeTable *pThis, unsigned_int_32 aRGB,
+	 short nPixelsPerRow, unsigned char *pBitmap)
+{
+	short	*pStart, *pEnd;
+	int	*pStartI, *pEndI;
+	unsigned char *p;
+	unsigned_int_32 c;
+	short	*pPiece;
+	int nPieces;
+	int xs, xe;
+	int i, ie;
+	int nR, nG, nB;
+	int r, g, b;				/* Color components at the span start, 8.16. */
+	int rstep, gstep, bstep;
+	int rp, gp, bp;			/* Current color components, 8.16. */
+	int n;
+	int nY;
+	int dy;
+
+	nR = (int)((aRGB >> 16) & 0xFF);
+	nG = (int)((aRGB >> 8) & 0xFF);
+	nB = (int)(aRGB & 0xFF);
+
+	/* Initialize span lookup. */
+	pStart = pThis->arSpanStartValues + pThis->nMinScan;
+	pEnd = pThis->arSpanEndValues + pThis->nMinScan;
+	pStartI = pThis->arSpanStartIntensities + pThis->nMinScan;
+	pEndI = pThis->arSpanEndIntensities + pThis->nMinScan;
+	/* Initialize bitmap pointer. */
+	pBitmap += 3 * nPixelsPerRow * pThis->nMinScan;
+
+	dy = pThis->nMaxScan - pThis->nMinScan;
+	nY = pThis->nMinScan;
+	while (dy > 0)	/* We may be loosing the last scanline here. */
+	{	xs = *(pStart++);
+		xe = *(pEnd++);
+		/* Scale 8.16 intensity to a 0.16 fraction of full
+		 * intensity (i / 255 rather than i / 256). */
+		i = *(pStartI++);
+		i = (i >> 8) + (i >> 16);
+		ie = *(pEndI++);
+		ie = (ie >> 8) + (ie >> 16);
+		if (xe > xs)
+		{	/* Setup the color DDAs for the span. */
+			r = nR * i;
+			g = nG * i;
+			b = nB * i;
+			rstep = (nR * ie - r) / (xe - xs);
+			gstep = (nG * ie - g) / (xe - xs);
+			bstep = (nB * ie - b) / (xe - xs);
+
+			/* Clip the span and draw the pieces that remain. */
+			nPieces = EdgeTable_ClipSpan(pThis, nY, xs, xe, &pPiece);
+			while (nPieces-- > 0)
+			{	p = pBitmap + 3 * pPiece[0];
+				rp = r + rstep * (pPiece[0] - xs);
+				gp = g + gstep * (pPiece[0] - xs);
+				bp = b + bstep * (pPiece[0] - xs);
+				n = pPiece[1] - pPiece[0];
+				while (n-- > 0)
+				{	c = (unsigned_int_32)(((rp >> 16) << 16) | ((gp >> 16) << 8) | (bp >> 16));
+					EdgeTable_Put24M(p, c);
+					rp += rstep;
+					gp += gstep;
+					bp += bstep;
+				}
+				pPiece += 2;
+			}
+		}
+
+		pBitmap += 3 * nPixelsPerRow;
+		nY++;
+		dy--;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_ChromeFill24()
+* Purpose : Fills a bitmap pBitmap with the polygon spans stored in
+*           EdgeTable pThis, sampling the texture pTexels at the
+*           interpolated chrome map coordinates.
+* Pre : As EdgeTable_ChromeFill(), but pTexels indexes the 0xRRGGBB
+*       colors in pPalette (e.g. the Bitmap and aulPalette of a
+*       TextureMap) and nPixelsPerRow defines the number of PIXELS in
+*       a single scanline of the target bitmap pBitmap.
+* Post : pBitmap now contains the chrome mapped polygon defined in
+*        pThis.
+* Note : The pixels are packed, 3 bytes each in the order blue,
+*        green, red. They need not be alligned.
+********************************************************************/
+void EdgeTable_ChromeFill24(struct EdgeTable *pThis, unsigned char *pTexels,
+	 unsigned long *pPalette, short nPixelsPerRow, unsigned char *pBitmap)
+{
+	short	*pStart, *pEnd;
+	int	*pStartCX, *pStartCY, *pEndCX, *pEndCY;
+	unsigned char *p;
+	unsigned_int_32 c;
+	short	*pPiece;
+	int nPieces;
+	int xs, xe;
+	int cx, cy, cxstep, cystep;
+	int cxp, cyp;				/* Coordinates at the current pixel. */
+	int n;
+	int nY;
+	int dy;
+
+	/* Initialize span lookup. */
+	pStart = pThis->arSpanStartValues + pThis->nMinScan;
+	pEnd = pThis->arSpanEndValues + pThis->nMinScan;
+	pStartCX = pThis->arSpanStartCX + pThis->nMinScan;
+	pStartCY = pThis->arSpanStartCY + pThis->nMinScan;
+	pEndCX = pThis->arSpanEndCX + pThis->nMinScan;
+	pEndCY = pThis->arSpanEndCY + pThis->nMinScan;
+	/* Initialize bitmap pointer. */
+	pBitmap += 3 * nPixelsPerRow * pThis->nMinScan;
+
+	dy = pThis->nMaxScan - pThis->nMinScan;
+	nY = pThis->nMinScan;
+	while (dy > 0)	/* We may be loosing the last scanline here. */
+	{	xs = *(pStart++);
+		xe = *(pEnd++);
+		cx = *(pStartCX++);
+		cy = *(pStartCY++);
+		cxstep = *(pEndCX++);
+		cystep = *(pEndCY++);
+		if (xe > xs)
+		{	/* Setup the coordinate DDAs for the span. */
+			cxstep = (cxstep - cx) / (xe - xs);
+			cystep = (cystep - cy) / (xe - xs);
+
+			/* Clip the span and draw the pieces that remain. */
+			nPieces = EdgeTable_ClipSpan(pThis, nY, xs, xe, &pPiece);
+			while (nPieces-- > 0)
+			{	p = pBitmap + 3 * pPiece[0];
+				cxp = cx + cxstep * (pPiece[0] - xs);
+				cyp = cy + cystep * (pPiece[0] - xs);
+				n = pPiece[1] - pPiece[0];
+				while (n-- > 0)
+				{	c = (unsigned_int_32)pPalette[pTexels[((cyp >> 8) & 0xFF00) | ((cxp >> 16) & 0xFF)]];
+					EdgeTable_Put24M(p, c);
+					cxp += cxstep;
+					cyp += cystep;
+				}
+				pPiece += 2;
+			}
+		}
+
+		pBitmap += 3 * nPixelsPerRow;
+		nY++;
+		dy--;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_TextureFill24()
+* Purpose : Fills a bitmap pBitmap with the polygon spans stored in
+*           EdgeTable pThis, sampling the texture pTexels at the
+*           perspective correct texture map coordinates.
+* Pre : As EdgeTable_TextureFill(), but pTexels indexes the 0xRRGGBB
+*       colors in pPalette (e.g. the Bitmap and aulPalette of a
+*       TextureMap) and nPixelsPerRow defines the number of PIXELS in
+*       a single scanline of the target bitmap pBitmap.
+* Post : pBitmap now contains the texture mapped polygon defined in
+*        pThis.
+* Note : Dividing for every pixel is too slow, so each span is cut
+*        into runs of (1 << EDGETABLE_SUBDIVSHIFT) pixels. The
+*        coordinates are only divided at the end of each run and are
+*        stepped linearly in between, the error this introduces is
+*        invisible for runs this short. Coordinates wrap around.
+*        THE BITMAP MUST BE AN ALIGNED 32-BIT COLOR BITMAP OR IT
+*        WILL SEGFAULT!
+********************************************************************/
+void EdgeTable_TextureFill24(struct EdgeTable *pThis, unsigned char *pTexels,
+	 unsigned long *pPalette, short nPixelsPerRow, unsigned char *pBitmap)
+{
+	short	*pStart, *pEnd;
+	float	*pStartUZ, *pStartVZ, *pStartIZ, *pEndUZ, *pEndVZ, *pEndIZ;
+	unsigned char *p;
+	unsigned_int_32 c;
+	short	*pPiece;
+	int nPieces;
+	int xs, xe;
+	float uz, vz, iz;				/* Texture coordinates at the span start. */
+	float uzstep, vzstep, izstep;	/* Their increment per pixel. */
+	float uzp, vzp, izp;			/* Texture coordinates at the current run. */
+	float z;
+	int u, v, ustep, vstep;		/* Texel coordinates, 16.16. */
+	int u1, v1;						/* Texel coordinates at the end of a run. */
+	int x0, x1;						/* Start and end of the current run. */
+	int nRun;
+	int n;
+	int nY;
+	int dy;
+
+	/* Initialize span lookup. */
+	pStart = pThis->arSpanStartValues + pThis->nMinScan;
+	pEnd = pThis->arSpanEndValues + pThis->nMinScan;
+	pStartUZ = pThis->arSpanStartUZ + pThis->nMinScan;
+	pStartVZ = pThis->arSpanStartVZ + pThis->nMinScan;
+	pStartIZ = pThis->arSpanStartIZ + pThis->nMinScan;
+	pEndUZ = pThis->arSpanEndUZ + pThis->nMinScan;
+	pEndVZ = pThis->arSpanEndVZ + pThis->nMinScan;
+	pEndIZ = pThis->arSpanEndIZ + pThis->nMinScan;
+	/* Initialize bitmap pointer. */
+	pBitmap += 3 * nPixelsPerRow * pThis->nMinScan;
+
+	dy = pThis->nMaxScan - pThis->nMinScan;
+	nY = pThis->nMinScan;
+	while (dy > 0)	/* We may be loosing the last scanline here. */
+	{	xs = *(pStart++);
+		xe = *(pEnd++);
+		uz = *(pStartUZ++);
+		vz = *(pStartVZ++);
+		iz = *(pStartIZ++);
+		uzstep = *(pEndUZ++);
+		vzstep = *(pEndVZ++);
+		izstep = *(pEndIZ++);
+		if ((xe > xs) && (iz > 0.f) && (izstep > 0.f))
+		{	/* Setup the texture coordinate steps for the span. */
+			z = 1.f / (float)(xe - xs);
+			uzstep = (uzstep - uz) * z;
+			vzstep = (vzstep - vz) * z;
+			izstep = (izstep - iz) * z;
+
+			/* Clip the span and draw the pieces that remain. */
+			nPieces = EdgeTable_ClipSpan(pThis, nY, xs, xe, &pPiece);
+			while (nPieces-- > 0)
+			{	/* The runs are laid out from the start of the span, not
+				 * of the piece, so a piece is drawn exactly like the same
+				 * pixels of the whole span. */
+				x0 = xs + (((pPiece[0] - xs) >> EDGETABLE_SUBDIVSHIFT) << EDGETABLE_SUBDIVSHIFT);
+				uzp = uz + uzstep * (float)(x0 - xs);
+				vzp = vz + vzstep * (float)(x0 - xs);
+				izp = iz + izstep * (float)(x0 - xs);
+				z = 65536.f / izp;
+				u1 = (int)(uzp * z);
+				v1 = (int)(vzp * z);
+
+				/* Draw the piece in runs. */
+				p = pBitmap + 3 * pPiece[0];
+				n = pPiece[0];
+				while (n < pPiece[1])
+				{	/* Start at the end of the previous run. */
+					u = u1;
+					v = v1;
+					x1 = x0 + (1 << EDGETABLE_SUBDIVSHIFT);
+					if (x1 > xe)
+						x1 = xe;
+					nRun = x1 - x0;
+
+					/* Divide at the end of the run. */
+					uzp = uz + uzstep * (float)(x1 - xs);
+					vzp = vz + vzstep * (float)(x1 - xs);
+					izp = iz + izstep * (float)(x1 - xs);
+					z = 65536.f / izp;
+					u1 = (int)(uzp * z);
+					v1 = (int)(vzp * z);
+					if (nRun == (1 << EDGETABLE_SUBDIVSHIFT))
+					{	ustep = (u1 - u) >> EDGETABLE_SUBDIVSHIFT;
+						vstep = (v1 - v) >> EDGETABLE_SUBDIVSHIFT;
+					} else
+					{	ustep = (u1 - u) / nRun;
+						vstep = (v1 - v) / nRun;
+					}
+
+					/* Skip the part of the run before the piece. */
+					u += ustep * (n - x0);
+					v += vstep * (n - x0);
+					if (x1 > pPiece[1])
+						x1 = pPiece[1];
+
+					/* Step linearly inside the run. */
+					while (n < x1)
+					{	c = (unsigned_int_32)pPalette[pTexels[((v >> 8) & 0xFF00) | ((u >> 16) & 0xFF)]];
+						EdgeTable_Put24M(p, c);
+						u += ustep;
+						v += vstep;
+						n++;
+					}
+					x0 += (1 << EDGETABLE_SUBDIVSHIFT);
+				}
+				pPiece += 2;
+			}
+		}
+
+		pBitmap += 3 * nPixelsPerRow;
+		nY++;
+		dy--;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_BlendFill()
+* Purpose : Blends the polygon spans stored in EdgeTable pThis into
+*           bitmap pBitmap through a row of a blend table.
+* Pre : pThis points to an initialized EdgeTable structure, arBlend
+*       to 256 colormap indices (the arBlend of a Lightmap1),
+*       nBytesPerRow is the number of bytes in a single scanline of
+*       pBitmap.
+* Post : Every pixel of the polygon in pBitmap has been replaced by
+*        the entry of arBlend it indexes.
+********************************************************************/
+void EdgeTable_BlendFill(struct EdgeTable *pThis, unsigned char *arBlend,
+	 short nBytesPerRow, unsigned char *pBitmap)
+{
+	short	*pStart, *pEnd;
+	short	*pPiece;
+	unsigned char *p;
+	int nPieces;
+	int nCount;
+	int nY;
+	int dy;
+	int nStep;
+
+	/* Initialize span lookup, from the first scanline to draw on
+	 * every nStep scanlines. */
+	nY = EdgeTable_FirstRowM(pThis);
+	nStep = pThis->nRowStep;
+	pStart = pThis->arSpanStartValues + nY;
+	pEnd = pThis->arSpanEndValues + nY;
+	/* Initialize bitmap pointer. */
+	pBitmap += nBytesPerRow * nY;
+
+	dy = pThis->nMaxScan - nY;
+	while (dy > 0)	/* We may be loosing the last scanline here. */
+	{	/* Clip the span and blend the pieces that remain, a single
+		 * table fetch per pixel. */
+		nPieces = EdgeTable_ClipSpan(pThis, nY, *pStart, *pEnd, &pPiece);
+		while (nPieces-- > 0)
+		{	p = pBitmap + pPiece[0];
+			nCount = pPiece[1] - pPiece[0];
+			while (nCount-- > 0)
+			{	*p = arBlend[*p];
+				p++;
+			}
+			pPiece += 2;
+		}
+
+		pStart += nStep;
+		pEnd += nStep;
+		pBitmap += nBytesPerRow * nStep;
+		nY += nStep;
+		dy -= nStep;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_BlendFill32()
+* Purpose : Blends the polygon spans stored in EdgeTable pThis half
+*           and half with color aRGB into a 32 bit bitmap.
+* Pre : pThis points to an initialized EdgeTable structure, aRGB is
+*       the color, nPixelsPerRow the number of pixels in a single
+*       scanline of pBitmap.
+* Post : Every pixel of the polygon in pBitmap has been replaced by
+*        the average of it and aRGB, all 4 bytes rounded up.
+* Note : The actual blending is done by the span blender selected by
+*        EdgeTable_SelectFillers().
+********************************************************************/
+void EdgeTable_BlendFill32(struct EdgeTable *pThis, unsigned_int_32 aRGB,
+	 short nPixelsPerRow, unsigned_int_32 *pBitmap)
+{
+	short	*pStart, *pEnd;
+	short	*pPiece;
+	int nPieces;
+	int nY;
+	int dy;
+	int nStep;
+	void (*pBlendSpan)(unsigned_int_32 *p, int nCount, unsigned_int_32 aRGB);
+
+	/* Select span blenders on first use. */
+	if (EdgeTable_pBlendSpan32 == NULL)
+		EdgeTable_SelectFillers(CpuFeatures_Get());
+	pBlendSpan = EdgeTable_pBlendSpan32;
+
+	/* Initialize span lookup, from the first scanline to draw on
+	 * every nStep scanlines. */
+	nY = EdgeTable_FirstRowM(pThis);
+	nStep = pThis->nRowStep;
+	pStart = pThis->arSpanStartValues + nY;
+	pEnd = pThis->arSpanEndValues + nY;
+	/* Initialize bitmap pointer. */
+	pBitmap += nPixelsPerRow * nY;
+
+	dy = pThis->nMaxScan - nY;
+	while (dy > 0)	/* We may be loosing the last scanline here. */
+	{	/* Clip the span and blend the pieces that remain. */
+		nPieces = EdgeTable_ClipSpan(pThis, nY, *pStart, *pEnd, &pPiece);
+		while (nPieces-- > 0)
+		{	pBlendSpan(pBitmap + pPiece[0], pPiece[1] - pPiece[0], aRGB);
+			pPiece += 2;
+		}
+
+		pStart += nStep;
+		pEnd += nStep;
+		pBitmap += nPixelsPerRow * nStep;
+		nY += nStep;
+		dy -= nStep;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_BlendFill16()
+* Purpose : RGB565 version of EdgeTable_BlendFill32().
+* Pre : As EdgeTable_BlendFill32(), nColor is an RGB565 pixel value.
+* Post : Every pixel of the polygon in pBitmap has been replaced by
+*        the average of it and nColor, all 3 components rounded up.
+********************************************************************/
+void EdgeTable_BlendFill16(struct EdgeTable *pThis, unsigned_int_16 nColor,
+	 short nPixelsPerRow, unsigned_int_16 *pBitmap)
+{
+	short	*pStart, *pEnd;
+	short	*pPiece;
+	unsigned_int_16 *p;
+	int nPieces;
+	int nCount;
+	int nY;
+	int dy;
+	int nStep;
+
+	/* Initialize span lookup, from the first scanline to draw on
+	 * every nStep scanlines. */
+	nY = EdgeTable_FirstRowM(pThis);
+	nStep = pThis->nRowStep;
+	pStart = pThis->arSpanStartValues + nY;
+	pEnd = pThis->arSpanEndValues + nY;
+	/* Initialize bitmap pointer. */
+	pBitmap += nPixelsPerRow * nY;
+
+	dy = pThis->nMaxScan - nY;
+	while (dy > 0)	/* We may be loosing the last scanline here. */
+	{	/* Clip the span and blend the pieces that remain. The lowest
+		 * bit of every component is masked off the difference, so
+		 * it doesn't shift into the next one. */
+		nPieces = EdgeTable_ClipSpan(pThis, nY, *pStart, *pEnd, &pPiece);
+		while (nPieces-- > 0)
+		{	p = pBitmap + pPiece[0];
+			nCount = pPiece[1] - pPiece[0];
+			while (nCount-- > 0)
+			{	*p = (unsigned_int_16)((*p | nColor) - (((*p ^ nColor) & 0xF7DE) >> 1));
+				p++;
+			}
+			pPiece += 2;
+		}
+
+		pStart += nStep;
+		pEnd += nStep;
+		pBitmap += nPixelsPerRow * nStep;
+		nY += nStep;
+		dy -= nStep;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_BlendFill24()
+* Purpose : Packed 24 bit version of EdgeTable_BlendFill32().
+* Pre : As EdgeTable_BlendFill32().
+* Post : As EdgeTable_BlendFill32().
+********************************************************************/
+void EdgeTable_BlendFill24(struct EdgeTable *pThis, unsigned_int_32 aRGB,
+	 short nPixelsPerRow, unsigned char *pBitmap)
+{
+	short	*pStart, *pEnd;
+	short	*pPiece;
+	unsigned char *p;
+	int nPieces;
+	int nCount;
+	int nY;
+	int dy;
+	int nStep;
+	int nB, nG, nR;
+
+	nB = (int)(aRGB & 0xFF);
+	nG = (int)((aRGB >> 8) & 0xFF);
+	nR = (int)((aRGB >> 16) & 0xFF);
+
+	/* Initialize span lookup, from the first scanline to draw on
+	 * every nStep scanlines. */
+	nY = EdgeTable_FirstRowM(pThis);
+	nStep = pThis->nRowStep;
+	pStart = pThis->arSpanStartValues + nY;
+	pEnd = pThis->arSpanEndValues + nY;
+	/* Initialize bitmap pointer. */
+	pBitmap += 3 * nPixelsPerRow * nY;
+
+	dy = pThis->nMaxScan - nY;
+	while (dy > 0)	/* We may be loosing the last scanline here. */
+	{	/* Clip the span and blend the pieces that remain. */
+		nPieces = EdgeTable_ClipSpan(pThis, nY, *pStart, *pEnd, &pPiece);
+		while (nPieces-- > 0)
+		{	p = pBitmap + 3 * pPiece[0];
+			nCount = pPiece[1] - pPiece[0];
+			while (nCount-- > 0)
+			{	p[0] = (unsigned char)((p[0] + nB + 1) >> 1);
+				p[1] = (unsigned char)((p[1] + nG + 1) >> 1);
+				p[2] = (unsigned char)((p[2] + nR + 1) >> 1);
+				p += 3;
+			}
+			pPiece += 2;
+		}
+
+		pStart += nStep;
+		pEnd += nStep;
+		pBitmap += 3 * nPixelsPerRow * nStep;
+		nY += nStep;
+		dy -= nStep;
+	}
+}
+
+/********************************************************************
+* Function : EdgeTable_BlendSpan32C()
+* Purpose : Plain C span blender for 32 bit bitmaps.
+* Pre : p points to nCount pixels.
+* Post : Every pixel has been replaced by the average of it and aRGB,
+*        all 4 bytes rounded up.
+* Note : a | b less half of a ^ b is the rounded up average of every
+*        byte, the lowest bits are masked off so they don't shift
+*        into the byte below.
+********************************************************************/
+static void EdgeTable_BlendSpan32C(unsigned_int_32 *p, int nCount,
+											  unsigned_int_32 aRGB)
+{
+	while (nCount-- > 0)
+	{	*p = (*p | aRGB) - (((*p ^ aRGB) & 0xFEFEFEFEU) >> 1);
+		p++;
+	}
+}
+
+#ifdef CHROME_X86_SIMD
+/********************************************************************
+* Function : EdgeTable_BlendSpan32SSE2()
+* Purpose : SSE2 span blender for 32 bit bitmaps, blends 4 pixels at
+*           once.
+* Pre : As EdgeTable_BlendSpan32C(), the processor supports SSE2.
+* Post : As EdgeTable_BlendSpan32C(), pavgb rounds up as well.
+********************************************************************/
+CPUFEAT_TARGET_SSE2
+static void EdgeTable_BlendSpan32SSE2(unsigned_int_32 *p, int nCount,
+												  unsigned_int_32 aRGB)
+{
+	__m128i Color;
+
+	if (nCount < 8)
+	{	EdgeTable_BlendSpan32C(p, nCount, aRGB);
+		return;
+	}
+
+	/* Leading pixels up to a 16 byte allignment, as
+	 * EdgeTable_FillSpan32SSE2(). */
+	while ((nCount > 0) && (((size_t)p & 15) != 0) && (((size_t)p & 3) == 0))
+	{	*p = (*p | aRGB) - (((*p ^ aRGB) & 0xFEFEFEFEU) >> 1);
+		p++;
+		nCount--;
+	}
+
+	Color = _mm_set1_epi32((int)aRGB);
+	while (nCount >= 4)
+	{	_mm_storeu_si128((__m128i *)p,
+							  _mm_avg_epu8(_mm_loadu_si128((__m128i *)p), Color));
+		p += 4;
+		nCount -= 4;
+	}
+
+	/* Trailing pixels. */
+	EdgeTable_BlendSpan32C(p, nCount, aRGB);
+}
+#endif
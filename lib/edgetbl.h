@@ -31,16 +31,59 @@
 #define EDGETBL_H
 
 #include "scrvertx.h"
-typedef unsigned long unsigned_int_32; /* Use for now... */
+#include "sbuffer.h"
+#include "damage.h"
+#include "rstats.h"
+typedef unsigned int unsigned_int_32; /* Use for now... (long is 64 bits
+                                      * on LP64 platforms). */
+typedef unsigned short unsigned_int_16;
+
+/* The texture fills divide to get perspective correct texture
+ * coordinates once every (1 << EDGETABLE_SUBDIVSHIFT) pixels and step
+ * linearly in between. */
+#define EDGETABLE_SUBDIVSHIFT	4
 
 struct EdgeTable
 {
 	/* Number of scanlines maintained in the structure.
-	 * This is NOT dynamic. Scan converting polygons that cross
-	 * the number of scanlines WILL hang your machine (as there
-	 * is no 2D clipping). */
+	 * This is NOT dynamic. Edges are clipped to the scissor
+	 * rectangle below, which never extends beyond the number of
+	 * scanlines. */
 	int	nScanlines;
 
+	/* Scissor rectangle. Edges are clipped to the scanlines
+	 * nClipTop up to (not including) nClipBottom and spans are
+	 * clipped to nClipLeft up to (not including) nClipRight while
+	 * filling. Set by EdgeTable_SetClipRect(), by default it
+	 * covers all scanlines and doesn't clip X at all. */
+	int	nClipLeft;
+	int	nClipTop;
+	int	nClipRight;
+	int	nClipBottom;
+
+	/* Span buffer. If not NULL, the fills only write the parts of
+	 * spans that pSBuffer doesn't cover yet and mark them covered,
+	 * so polygons should be drawn front to back. arPiece holds the
+	 * single piece of a span when there's no span buffer. */
+	struct SBuffer	*pSBuffer;
+	short	arPiece[2];
+
+	/* Damage. If not NULL, EdgeTable_AddDamage() adds the pixels a
+	 * polygon covers to pDamage. */
+	struct DamageList	*pDamage;
+
+	/* Statistics. If not NULL, whoever draws with the EdgeTable
+	 * counts the polygons it handles in pStats. */
+	struct RenderStats	*pStats;
+
+	/* Interlacing. The fills only draw the scanlines nRowPhase,
+	 * nRowPhase + nRowStep and so on. nRowStep is 1 (all scanlines,
+	 * the default) or 2, set by EdgeTable_SetInterlace(). The solid
+	 * fills step over the other scanlines, the rest still set up
+	 * their spans but don't draw them. */
+	int	nRowStep;
+	int	nRowPhase;
+
 	/* Minimum and Maximum scanline. These describe the actual
 	 * area in which the Span Start and End values are valid. */
 	int	nMinScan;
@@ -53,6 +96,41 @@ struct EdgeTable
 	/* Array containing nScanlines shorts which describe the
 	 * ending X positions of span. */
 	short	*arSpanEndValues;
+
+	/* Pending spans. EdgeTable_MergeSpans() coalesces the spans of
+	 * polygons of the same color here, so they can be filled at
+	 * once. They're valid from nPendingMinScan up to (not
+	 * including) nPendingMaxScan, scanlines none of the polygons
+	 * covers have an empty span. */
+	int	nPendingMinScan;
+	int	nPendingMaxScan;
+	short	*arPendingStartValues;
+	short	*arPendingEndValues;
+
+	/* Arrays containing nScanlines ints which describe the
+	 * intensity at the start and end of a span in 8.16 fixed point.
+	 * Only set by EdgeTable_AddGouraudEdge(). */
+	int	*arSpanStartIntensities;
+	int	*arSpanEndIntensities;
+
+	/* Arrays containing nScanlines ints which describe the chrome
+	 * map coordinates at the start and end of a span in 16.16 fixed
+	 * point. Only set by EdgeTable_AddChromeEdge(). */
+	int	*arSpanStartCX;
+	int	*arSpanStartCY;
+	int	*arSpanEndCX;
+	int	*arSpanEndCY;
+
+	/* Arrays containing nScanlines floats which describe the texture
+	 * map coordinates divided by Z (in texels) and 1 / Z at the
+	 * start and end of a span. Only set by
+	 * EdgeTable_AddTextureEdge(). */
+	float	*arSpanStartUZ;
+	float	*arSpanStartVZ;
+	float	*arSpanStartIZ;
+	float	*arSpanEndUZ;
+	float	*arSpanEndVZ;
+	float	*arSpanEndIZ;
 };
 
 /* EdgeTable_Construct(pThis),
@@ -62,10 +140,35 @@ struct EdgeTable
 void EdgeTable_Construct(struct EdgeTable *pThis);
 #define EdgeTable_ConstructM(pThis)\
 (	(pThis)->nScanlines = 0,\
+	(pThis)->nClipLeft = -32768,\
+	(pThis)->nClipTop = 0,\
+	(pThis)->nClipRight = 32767,\
+	(pThis)->nClipBottom = 0,\
+	(pThis)->pSBuffer = NULL,\
+	(pThis)->pDamage = NULL,\
+	(pThis)->pStats = NULL,\
+	(pThis)->nRowStep = 1,\
+	(pThis)->nRowPhase = 0,\
 	(pThis)->nMinScan = 0,\
 	(pThis)->nMaxScan = 0,\
 	(pThis)->arSpanStartValues = NULL,\
-	(pThis)->arSpanEndValues = NULL\
+	(pThis)->arSpanEndValues = NULL,\
+	(pThis)->nPendingMinScan = 0,\
+	(pThis)->nPendingMaxScan = 0,\
+	(pThis)->arPendingStartValues = NULL,\
+	(pThis)->arPendingEndValues = NULL,\
+	(pThis)->arSpanStartIntensities = NULL,\
+	(pThis)->arSpanEndIntensities = NULL,\
+	(pThis)->arSpanStartCX = NULL,\
+	(pThis)->arSpanStartCY = NULL,\
+	(pThis)->arSpanEndCX = NULL,\
+	(pThis)->arSpanEndCY = NULL,\
+	(pThis)->arSpanStartUZ = NULL,\
+	(pThis)->arSpanStartVZ = NULL,\
+	(pThis)->arSpanStartIZ = NULL,\
+	(pThis)->arSpanEndUZ = NULL,\
+	(pThis)->arSpanEndVZ = NULL,\
+	(pThis)->arSpanEndIZ = NULL\
 )
 
 /* EdgeTable_Destruct(pThis),
@@ -79,6 +182,48 @@ void EdgeTable_Destruct(struct EdgeTable *pThis);
 	):(0),\
 	(NULL != (pThis)->arSpanEndValues) ?\
 	(	free((void *)(pThis)->arSpanEndValues)\
+	):(0),\
+	(NULL != (pThis)->arPendingStartValues) ?\
+	(	free((void *)(pThis)->arPendingStartValues)\
+	):(0),\
+	(NULL != (pThis)->arPendingEndValues) ?\
+	(	free((void *)(pThis)->arPendingEndValues)\
+	):(0),\
+	(NULL != (pThis)->arSpanStartIntensities) ?\
+	(	free((void *)(pThis)->arSpanStartIntensities)\
+	):(0),\
+	(NULL != (pThis)->arSpanEndIntensities) ?\
+	(	free((void *)(pThis)->arSpanEndIntensities)\
+	):(0),\
+	(NULL != (pThis)->arSpanStartCX) ?\
+	(	free((void *)(pThis)->arSpanStartCX)\
+	):(0),\
+	(NULL != (pThis)->arSpanStartCY) ?\
+	(	free((void *)(pThis)->arSpanStartCY)\
+	):(0),\
+	(NULL != (pThis)->arSpanEndCX) ?\
+	(	free((void *)(pThis)->arSpanEndCX)\
+	):(0),\
+	(NULL != (pThis)->arSpanEndCY) ?\
+	(	free((void *)(pThis)->arSpanEndCY)\
+	):(0),\
+	(NULL != (pThis)->arSpanStartUZ) ?\
+	(	free((void *)(pThis)->arSpanStartUZ)\
+	):(0),\
+	(NULL != (pThis)->arSpanStartVZ) ?\
+	(	free((void *)(pThis)->arSpanStartVZ)\
+	):(0),\
+	(NULL != (pThis)->arSpanStartIZ) ?\
+	(	free((void *)(pThis)->arSpanStartIZ)\
+	):(0),\
+	(NULL != (pThis)->arSpanEndUZ) ?\
+	(	free((void *)(pThis)->arSpanEndUZ)\
+	):(0),\
+	(NULL != (pThis)->arSpanEndVZ) ?\
+	(	free((void *)(pThis)->arSpanEndVZ)\
+	):(0),\
+	(NULL != (pThis)->arSpanEndIZ) ?\
+	(	free((void *)(pThis)->arSpanEndIZ)\
 	):(0)\
 )
 
@@ -92,6 +237,34 @@ void EdgeTable_Whipe(struct EdgeTable *pThis);
 	(pThis)->nMaxScan = 0\
 )
 
+/* EdgeTable_HasPendingM(pThis),
+ * Evaluates to non zero if pThis holds pending spans.
+ */
+#define EdgeTable_HasPendingM(pThis)\
+(	(pThis)->nPendingMinScan < (pThis)->nPendingMaxScan\
+)
+
+/* EdgeTable_ClearPendingM(pThis),
+ * Drops the pending spans of pThis.
+ */
+#define EdgeTable_ClearPendingM(pThis)\
+(	(pThis)->nPendingMinScan = (pThis)->nScanlines,\
+	(pThis)->nPendingMaxScan = 0\
+)
+
+/* EdgeTable_MergeSpans(pThis),
+ * Coalesces the spans of the polygon in pThis with the pending ones.
+ * Returns 0, leaving the pending spans alone, if they can't be merged
+ * because they don't touch on a scanline both have a span on.
+ */
+int EdgeTable_MergeSpans(struct EdgeTable *pThis);
+
+/* EdgeTable_SwapPending(pThis),
+ * Swaps the spans of pThis with the pending ones, so the fills draw
+ * those. Swap back before adding another polygon.
+ */
+void EdgeTable_SwapPending(struct EdgeTable *pThis);
+
 /* EdgeTable_AtLeast(pThis, nScanLines),
  * Guarantees that there are at least nScanLines available in
  * the EdgeTable pThis. Don't call this function when in the
@@ -99,12 +272,79 @@ void EdgeTable_Whipe(struct EdgeTable *pThis);
  */
 int EdgeTable_AtLeast(struct EdgeTable *pThis, int nScanLines);
 
+/* EdgeTable_SetClipRect(pThis, nLeft, nTop, nRight, nBottom),
+ * Sets the scissor rectangle of an EdgeTable. Right and bottom are
+ * exclusive, the bottom is limited to the number of scanlines. Don't
+ * call this function when in the middle of a polygon.
+ */
+void EdgeTable_SetClipRect(struct EdgeTable *pThis, int nLeft, int nTop,
+									int nRight, int nBottom);
+
+/* EdgeTable_SetInterlace(pThis, nInterlace, nField),
+ * With nInterlace set, the fills only draw the even (nField 0) or
+ * odd (nField 1) scanlines, otherwise all of them. The edges and
+ * the damage are not affected. Don't call this function when in the
+ * middle of a polygon.
+ */
+void EdgeTable_SetInterlace(struct EdgeTable *pThis, int nInterlace, int nField);
+
+/* EdgeTable_AddDamage(pThis),
+ * Adds the bounding rectangle of the polygon in pThis, clipped to the
+ * scissor rectangle, to pThis->pDamage if that's not NULL. Call this
+ * after all edges were added, the rectangle holds all pixels any of
+ * the fills would draw.
+ */
+void EdgeTable_AddDamage(struct EdgeTable *pThis);
+
 /* EdgeTable_AddEdge(pThis, pSrcVtx, pTrgVtx),
- * Adds an edge to an EdgeTable. */
+ * Adds an edge to an EdgeTable. The edge is clipped to the scanlines
+ * of the scissor rectangle, so vertices may lie outside of it. */
 void EdgeTable_AddEdge(struct EdgeTable *pThis,
 							  struct ScreenVertex *pSrcVtx,
 							  struct ScreenVertex *pTrgVtx);
 
+/* EdgeTable_AddGouraudEdge(pThis, pSrcVtx, pTrgVtx),
+ * Adds an edge to an EdgeTable like EdgeTable_AddEdge(), but also
+ * interpolates the nIntensity of the vertices along the edge. Use
+ * this for all edges of polygons drawn with the Gouraud fills. */
+void EdgeTable_AddGouraudEdge(struct EdgeTable *pThis,
+										struct ScreenVertex *pSrcVtx,
+										struct ScreenVertex *pTrgVtx);
+
+/* EdgeTable_AddChromeEdge(pThis, pSrcVtx, pTrgVtx),
+ * Adds an edge to an EdgeTable like EdgeTable_AddEdge(), but also
+ * interpolates the chrome map coordinates (nCX, nCY) of the vertices
+ * along the edge. Use this for all edges of polygons drawn with the
+ * Chrome fills. */
+void EdgeTable_AddChromeEdge(struct EdgeTable *pThis,
+									  struct ScreenVertex *pSrcVtx,
+									  struct ScreenVertex *pTrgVtx);
+
+/* EdgeTable_AddTextureEdge(pThis, pSrcVtx, pTrgVtx),
+ * Adds an edge to an EdgeTable like EdgeTable_AddEdge(), but also
+ * interpolates the texture map coordinates divided by Z (fUZ, fVZ)
+ * and 1 / Z (fIZ) of the vertices along the edge. Use this for all
+ * edges of polygons drawn with the Texture fills. */
+void EdgeTable_AddTextureEdge(struct EdgeTable *pThis,
+										struct ScreenVertex *pSrcVtx,
+										struct ScreenVertex *pTrgVtx);
+
+/* EdgeTable_SelectFillers(ulFeatures),
+ * Selects the span fillers used by the fill routines below from a
+ * combination of CPUFEATURES flags (see cpufeat.h). This is done
+ * automatically with CpuFeatures_Get() on the first fill, call it with
+ * 0 to force the plain C span fillers. All fillers produce identical
+ * output.
+ */
+void EdgeTable_SelectFillers(unsigned long ulFeatures);
+
+/* EdgeTable_InitFillers(),
+ * Selects the span fillers with CpuFeatures_Get() unless they have
+ * been selected already. The fills do this themselves, call it before
+ * filling from several threads at once so they don't all try to.
+ */
+void EdgeTable_InitFillers(void);
+
 /* EdgeTable_SolidFill(pThis, nColor, nBytesPerRow, pBitmap),
  * Fills bitmap pBitmap (having nBytesPerRow bytes per row) with
  * the spans stored in EdgeTable using value nColor.
@@ -120,4 +360,138 @@ void EdgeTable_SolidFill(struct EdgeTable *pThis, unsigned char nColor,
 void EdgeTable_SolidFill32(struct EdgeTable *pThis, unsigned_int_32 aRGB,
 	 short nBytesPerRow, unsigned_int_32 *pBitmap);
 
+/* EdgeTable_GouraudFill(pThis, arIndices, nBytesPerRow, pBitmap),
+ * Fills bitmap pBitmap (having nBytesPerRow bytes per row) with
+ * the spans stored in EdgeTable, the intensity of each pixel
+ * selects it's color from the 256 indices in arIndices (e.g. the
+ * arIndices of a Lightmap256). The edges must have been added with
+ * EdgeTable_AddGouraudEdge().
+ */
+void EdgeTable_GouraudFill(struct EdgeTable *pThis, unsigned char *arIndices,
+	 short nBytesPerRow, unsigned char *pBitmap);
+
+/* EdgeTable_GouraudFill32(pThis, aRGB, nPixelsPerRow, pBitmap),
+ * Truecolor version of EdgeTable_GouraudFill(), the color of each
+ * pixel ranges from black at intensity 0 to aRGB at intensity 255.
+ */
+void EdgeTable_GouraudFill32(struct EdgeTable *pThis, unsigned_int_32 aRGB,
+	 short nPixelsPerRow, unsigned_int_32 *pBitmap);
+
+/* EdgeTable_ChromeFill(pThis, pTexels, nBytesPerRow, pBitmap),
+ * Fills bitmap pBitmap (having nBytesPerRow bytes per row) with
+ * the spans stored in EdgeTable, sampling the 256x256 texture
+ * pTexels (e.g. the CMBmp of a TextureMap) at the chrome map
+ * coordinates. The coordinates are interpolated affinely. The edges
+ * must have been added with EdgeTable_AddChromeEdge().
+ */
+void EdgeTable_ChromeFill(struct EdgeTable *pThis, unsigned char *pTexels,
+	 short nBytesPerRow, unsigned char *pBitmap);
+
+/* EdgeTable_ChromeFill32(pThis, pTexels, pPalette, nPixelsPerRow, pBitmap),
+ * Truecolor version of EdgeTable_ChromeFill(), the texels index the
+ * 0xRRGGBB colors in pPalette (e.g. the Bitmap and aulPalette of a
+ * TextureMap).
+ */
+void EdgeTable_ChromeFill32(struct EdgeTable *pThis, unsigned char *pTexels,
+	 unsigned long *pPalette, short nPixelsPerRow, unsigned_int_32 *pBitmap);
+
+/* EdgeTable_TextureFill(pThis, pTexels, nBytesPerRow, pBitmap),
+ * Fills bitmap pBitmap (having nBytesPerRow bytes per row) with
+ * the spans stored in EdgeTable, sampling the 256x256 texture
+ * pTexels (e.g. the CMBmp of a TextureMap) perspective correctly.
+ * The edges must have been added with EdgeTable_AddTextureEdge().
+ */
+void EdgeTable_TextureFill(struct EdgeTable *pThis, unsigned char *pTexels,
+	 short nBytesPerRow, unsigned char *pBitmap);
+
+/* EdgeTable_TextureFill32(pThis, pTexels, pPalette, nPixelsPerRow, pBitmap),
+ * Truecolor version of EdgeTable_TextureFill(), the texels index the
+ * 0xRRGGBB colors in pPalette (e.g. the Bitmap and aulPalette of a
+ * TextureMap).
+ */
+void EdgeTable_TextureFill32(struct EdgeTable *pThis, unsigned char *pTexels,
+	 unsigned long *pPalette, short nPixelsPerRow, unsigned_int_32 *pBitmap);
+
+/* EdgeTable_SolidFill16(pThis, nColor, nPixelsPerRow, pBitmap),
+ * RGB565 version of EdgeTable_SolidFill32(), fills with the 16 bit
+ * pixel value nColor (e.g. the usRGB565 of a Polygon).
+ */
+void EdgeTable_SolidFill16(struct EdgeTable *pThis, unsigned_int_16 nColor,
+	 short nPixelsPerRow, unsigned_int_16 *pBitmap);
+
+/* EdgeTable_GouraudFill16(pThis, aRGB, nPixelsPerRow, pBitmap),
+ * RGB565 version of EdgeTable_GouraudFill32().
+ */
+void EdgeTable_GouraudFill16(struct EdgeTable *pThis, unsigned_int_32 aRGB,
+	 short nPixelsPerRow, unsigned_int_16 *pBitmap);
+
+/* EdgeTable_ChromeFill16(pThis, pTexels, pPalette, nPixelsPerRow, pBitmap),
+ * RGB565 version of EdgeTable_ChromeFill32(), the texels index the
+ * 16 bit pixel values in pPalette (e.g. the Bitmap and ausPalette565
+ * of a TextureMap).
+ */
+void EdgeTable_ChromeFill16(struct EdgeTable *pThis, unsigned char *pTexels,
+	 unsigned_int_16 *pPalette, short nPixelsPerRow, unsigned_int_16 *pBitmap);
+
+/* EdgeTable_TextureFill16(pThis, pTexels, pPalette, nPixelsPerRow, pBitmap),
+ * RGB565 version of EdgeTable_TextureFill32(), pPalette as with
+ * EdgeTable_ChromeFill16().
+ */
+void EdgeTable_TextureFill16(struct EdgeTable *pThis, unsigned char *pTexels,
+	 unsigned_int_16 *pPalette, short nPixelsPerRow, unsigned_int_16 *pBitmap);
+
+/* EdgeTable_SolidFill24(pThis, aRGB, nPixelsPerRow, pBitmap),
+ * Packed 24 bit version of EdgeTable_SolidFill32(). Pixels are 3
+ * bytes (blue, green, red) without any allignment, nPixelsPerRow is
+ * still in PIXELS. The same goes for the other 24 bit fills.
+ */
+void EdgeTable_SolidFill24(struct EdgeTable *pThis, unsigned_int_32 aRGB,
+	 short nPixelsPerRow, unsigned char *pBitmap);
+
+/* EdgeTable_BlendFill(pThis, arBlend, nBytesPerRow, pBitmap),
+ * Translucent version of EdgeTable_SolidFill(), every pixel of the
+ * spans is replaced by the entry of arBlend (256 colormap indices,
+ * the arBlend of a Lightmap1) it indexes.
+ */
+void EdgeTable_BlendFill(struct EdgeTable *pThis, unsigned char *arBlend,
+	 short nBytesPerRow, unsigned char *pBitmap);
+
+/* EdgeTable_BlendFill32(pThis, aRGB, nPixelsPerRow, pBitmap),
+ * Translucent version of EdgeTable_SolidFill32(), every pixel of the
+ * spans is replaced by the average of it and aRGB. Uses SSE2 where
+ * available.
+ */
+void EdgeTable_BlendFill32(struct EdgeTable *pThis, unsigned_int_32 aRGB,
+	 short nPixelsPerRow, unsigned_int_32 *pBitmap);
+
+/* EdgeTable_BlendFill16(pThis, nColor, nPixelsPerRow, pBitmap),
+ * RGB565 version of EdgeTable_BlendFill32().
+ */
+void EdgeTable_BlendFill16(struct EdgeTable *pThis, unsigned_int_16 nColor,
+	 short nPixelsPerRow, unsigned_int_16 *pBitmap);
+
+/* EdgeTable_BlendFill24(pThis, aRGB, nPixelsPerRow, pBitmap),
+ * Packed 24 bit version of EdgeTable_BlendFill32().
+ */
+void EdgeTable_BlendFill24(struct EdgeTable *pThis, unsigned_int_32 aRGB,
+	 short nPixelsPerRow, unsigned char *pBitmap);
+
+/* EdgeTable_GouraudFill24(pThis, aRGB, nPixelsPerRow, pBitmap),
+ * Packed 24 bit version of EdgeTable_GouraudFill32().
+ */
+void EdgeTable_GouraudFill24(struct EdgeTable *pThis, unsigned_int_32 aRGB,
+	 short nPixelsPerRow, unsigned char *pBitmap);
+
+/* EdgeTable_ChromeFill24(pThis, pTexels, pPalette, nPixelsPerRow, pBitmap),
+ * Packed 24 bit version of EdgeTable_ChromeFill32().
+ */
+void EdgeTable_ChromeFill24(struct EdgeTable *pThis, unsigned char *pTexels,
+	 unsigned long *pPalette, short nPixelsPerRow, unsigned char *pBitmap);
+
+/* EdgeTable_TextureFill24(pThis, pTexels, pPalette, nPixelsPerRow, pBitmap),
+ * Packed 24 bit version of EdgeTable_TextureFill32().
+ */
+void EdgeTable_TextureFill24(struct EdgeTable *pThis, unsigned char *pTexels,
+	 unsigned long *pPalette, short nPixelsPerRow, unsigned char *pBitmap);
+
 #endif
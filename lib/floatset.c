@@ -51,6 +51,30 @@ void FloatSet_Destruct(struct FloatSet *pThis)
 	FloatSet_DestructM(pThis);
 }
 
+/********************************************************************
+* Function : FloatSet_Clone()
+* Purpose : Clones a FloatSet into another FloatSet.
+* Pre : pThis points to an initialized FloatSet structure, pClone
+*       points to an initialized FloatSet structure.
+* Post : If the returnvalue is 1, pClone now is a FloatSet with the
+*        same contents as pThis but without using the same memory.
+*        If the returnvalue is 0, a memory allocation failure
+*        occured. (pThis remains the same, pClone is unstable.)
+********************************************************************/
+int FloatSet_Clone(struct FloatSet *pThis, struct FloatSet *pClone)
+{
+	int n;
+
+	if (!FloatSet_AtLeast(pClone, pThis->nCount))
+		return 0;	/* Memory failure. */
+
+	/* Clone the contents. */
+	for (n = 0; n < pThis->nCount; n++)
+		pClone->arFloats[n] = pThis->arFloats[n];
+	pClone->nCount = pThis->nCount;
+	return 1;
+}
+
 /********************************************************************
 * Function : FloatSet_Expand()
 * Purpose : Expands the allocation space in a FloatSet structure.
@@ -91,6 +115,31 @@ int FloatSet_Expand(struct FloatSet *pThis)
 	}
 }
 
+/********************************************************************
+* Function : FloatSet_AtLeast()
+* Purpose : Guarantees that there's space for a number of floats in a
+*           FloatSet structure.
+* Pre : pThis points to an initialized FloatSet structure.
+* Post : If the returnvalue is 1, pThis has at least nCount floats
+*        allocated, the floats in use are unchanged and those
+*        past them are undefined.
+*        If the returnvalue is 0, a memory failure occured.
+********************************************************************/
+int FloatSet_AtLeast(struct FloatSet *pThis, int nCount)
+{
+	float *p;
+
+	if (pThis->nAlloc >= nCount)
+		return 1;	/* Already enough. */
+
+	p = (float *)realloc((void *)pThis->arFloats, sizeof(float) * nCount);
+	if (p == NULL)
+		return 0;	/* Memory failure. */
+	pThis->arFloats = p;
+	pThis->nAlloc = nCount;
+	return 1;
+}
+
 /********************************************************************
 * Function : FloatSet_Add(),
 * Purpose : Adds a new float to a FloatSet.
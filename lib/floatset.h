@@ -61,12 +61,26 @@ void FloatSet_Destruct(struct FloatSet *pThis);
 	{	free((pThis)->arFloats);\
 	}
 
+/* FloatSet_Clone(pThis, pClone),
+ * Makes a clone of pThis in pClone.
+ * If the returnvalue is 1, the clone was succesful,
+ * if the returnvalue is 0, a memory failure occured.
+ */
+int FloatSet_Clone(struct FloatSet *pThis, struct FloatSet *pClone);
+
 /* FloatSet_Expand(pThis),
  * Expands the number of allocated floats in pThis by EXPAND_SIZE.
  * Returns 1 if succesful, 0 otherwise (memory allocation failure).
  */
 int FloatSet_Expand(struct FloatSet *pThis);
 
+/* FloatSet_AtLeast(pThis, nCount),
+ * Guarantees that there are at least nCount floats allocated, the
+ * floats in use are kept.
+ * Returns 1 if succesful, 0 otherwise (memory allocation failure).
+ */
+int FloatSet_AtLeast(struct FloatSet *pThis, int nCount);
+
 /* FloatSet_Add(pThis, fFloat),
  * FloatSet_AddM(pThis, fFloat),
  * Adds a new float to the FloatSet structure.
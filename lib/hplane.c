@@ -418,8 +418,10 @@ struct HPlane *HPlane_ConstructTree(struct PolySet *pPolygons,
 					 * to both OutSpacePolys and InSpacePolys. */
 					InPol.Vertices.nCount = 0;
 					InPol.ulRGB = pPoly->ulRGB;
+					InPol.usRGB565 = pPoly->usRGB565;
 					OutPol.Vertices.nCount = 0;
 					OutPol.ulRGB = pPoly->ulRGB;
+					OutPol.usRGB565 = pPoly->usRGB565;
 					if ((!HPlane_SplitPolygon(pHPlane, pPoly, &VertDistances, pVertices, &InPol, &OutPol)) ||
 						 (!PolySet_AddM(&OutSpacePolys, &OutPol)) ||
 						 (!PolySet_AddM(&InSpacePolys, &InPol)))
@@ -782,9 +784,11 @@ struct HPlane *HPlane_ConstructTreeQuick(struct PolySet *pPolygons,
 					 * to both OutSpacePolys and InSpacePolys. */
 					InPol.Vertices.nCount = 0;
 					InPol.ulRGB = pPoly->ulRGB;
+					InPol.usRGB565 = pPoly->usRGB565;
 					InPol.pLightmap = pPoly->pLightmap;
 					OutPol.Vertices.nCount = 0;
 					OutPol.ulRGB = pPoly->ulRGB;
+					OutPol.usRGB565 = pPoly->usRGB565;
 					OutPol.pLightmap = pPoly->pLightmap;
 					if ((!HPlane_SplitPolygon(pHPlane, pPoly, &VertDistances, pVertices, &InPol, &OutPol)) ||
 						 (!PolySet_AddM(&OutSpacePolys, &OutPol)) ||
@@ -904,6 +908,8 @@ void HPlane_DestroyTree(struct HPlane *pThis)
 *        direction of pHPlane's normal.
 *        pVertices has new vertices added for edges that intersected
 *        the plane.
+*        If pPolygon has TexCoords, both polygons have those of their
+*        vertices, interpolated for the new ones.
 * Note : Vertex interpolation is done in this function, but should
 *        really be done in the Vertex structure file.
 ********************************************************************/
@@ -922,18 +928,32 @@ int HPlane_SplitPolygon(struct HPlane *pThis, struct Polygon *pPolygon,
 	struct Vertex *pV0, *pV1;	/* Vertex pointers for interpolation. */
 	float fInterpol;		/* Interpolation multiplier. (Temp. var.) */
 	int nNVIndex;		/* New Vertex Index, index of interpolated vertices. */
+	int bTexCoords;	/* Polygon has texture coordinates. */
+	float fU, fV;		/* Texture coordinates of the vertex. */
+	float fLastU, fLastV;	/* Texture coordinates of the last vertex. */
+	float fIU, fIV;	/* Texture coordinates of the intersection. */
 	
 	/* Copy polygon properties. */
 	pInSidePol->pLightmap = pPolygon->pLightmap;
 	pInSidePol->nFlags = pPolygon->nFlags;
 	pInSidePol->ulRGB = pPolygon->ulRGB;
+	pInSidePol->usRGB565 = pPolygon->usRGB565;
 	pOutSidePol->pLightmap = pPolygon->pLightmap;
 	pOutSidePol->nFlags = pPolygon->nFlags;
 	pOutSidePol->ulRGB = pPolygon->ulRGB;
+	pOutSidePol->usRGB565 = pPolygon->usRGB565;
+	pInSidePol->TexCoords.nCount = 0;
+	pOutSidePol->TexCoords.nCount = 0;
+	bTexCoords = (FloatSet_GetCountM(&(pPolygon->TexCoords)) != 0);
+	fU = fV = fLastU = fLastV = 0.f;
 
 	/* Get the polygon's last vertex index. */
 	n = pPolygon->Vertices.nCount - 1;
 	nLastVIndex = IndexSet_GetIndexM(&(pPolygon->Vertices), n);
+	if (bTexCoords)
+	{	fLastU = FloatSet_GetFloatM(&(pPolygon->TexCoords), 2 * n);
+		fLastV = FloatSet_GetFloatM(&(pPolygon->TexCoords), 2 * n + 1);
+	}
 	/* Get the last vertex index's distance. */
 	LastVDistance = FloatSet_GetFloatM(pDistances, nLastVIndex);
 	
@@ -941,6 +961,10 @@ int HPlane_SplitPolygon(struct HPlane *pThis, struct Polygon *pPolygon,
 	{
 		/* Get the index for this vertex. */
 		nVIndex = IndexSet_GetIndexM(&(pPolygon->Vertices), n);
+		if (bTexCoords)
+		{	fU = FloatSet_GetFloatM(&(pPolygon->TexCoords), 2 * n);
+			fV = FloatSet_GetFloatM(&(pPolygon->TexCoords), 2 * n + 1);
+		}
 		/* Get the distance for this vertex. */
 		VDistance = FloatSet_GetFloatM(pDistances, nVIndex);
 		
@@ -995,16 +1019,35 @@ int HPlane_SplitPolygon(struct HPlane *pThis, struct Polygon *pPolygon,
 				return 0;		/* Mem Failure. */
 			if (!IndexSet_AddM(&(pInSidePol->Vertices), nNVIndex))
 				return 0;		/* Mem Failure. */
+			if (bTexCoords)
+			{	fIU = fLastU + (fU - fLastU) * fInterpol;
+				fIV = fLastV + (fV - fLastV) * fInterpol;
+				if ((!FloatSet_AddM(&(pOutSidePol->TexCoords), fIU)) ||
+					 (!FloatSet_AddM(&(pOutSidePol->TexCoords), fIV)) ||
+					 (!FloatSet_AddM(&(pInSidePol->TexCoords), fIU)) ||
+					 (!FloatSet_AddM(&(pInSidePol->TexCoords), fIV)))
+					return 0;		/* Mem Failure. */
+			}
 		}
 		if (VDistance < 0.f)
 		{	if (!IndexSet_AddM(&(pInSidePol->Vertices), nVIndex))
 				return 0;		/* Mem Failure. */
+			if (bTexCoords &&
+				 ((!FloatSet_AddM(&(pInSidePol->TexCoords), fU)) ||
+				  (!FloatSet_AddM(&(pInSidePol->TexCoords), fV))))
+				return 0;		/* Mem Failure. */
 		} else
 		{	if (!IndexSet_AddM(&(pOutSidePol->Vertices), nVIndex))
 				return 0;		/* Mem Failure. */
+			if (bTexCoords &&
+				 ((!FloatSet_AddM(&(pOutSidePol->TexCoords), fU)) ||
+				  (!FloatSet_AddM(&(pOutSidePol->TexCoords), fV))))
+				return 0;		/* Mem Failure. */
 		}
 		LastVDistance = VDistance;
 		nLastVIndex = nVIndex;
+		fLastU = fU;
+		fLastV = fV;
 	}
 	return 1;
 }
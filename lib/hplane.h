@@ -118,7 +118,8 @@ void HPlane_Destruct(struct HPlane *pThis);
  * distances of it's vertices relative to the plane pDistances and
  * it's vertices pVertices.
  * Intersecting vertices consist of interpolated vertices. The
- * intersecting vertices are added to pVertices.
+ * intersecting vertices are added to pVertices. Texture coordinates
+ * of pPolygon are split along with it's vertices.
  */
 int HPlane_SplitPolygon(struct HPlane *pThis, struct Polygon *pPolygon,
 								struct FloatSet *pDistances,
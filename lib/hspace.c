@@ -0,0 +1,410 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : hspace.c
+********************************************************************/
+
+#define HSPACE_C
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "hspace.h"
+#include "cpufeat.h"
+
+#ifdef CHROME_X86_SIMD
+#include <emmintrin.h>
+#endif
+
+/* Function testing a row of HALFSPACE_BLOCKSIZE pixels against all
+ * edges of a HalfSpace, see HalfSpace_RowMaskC(). */
+typedef unsigned int (*HalfSpace_RowMaskFunc)(struct HalfSpace *pThis, int *arE);
+
+static unsigned int HalfSpace_RowMaskC(struct HalfSpace *pThis, int *arE);
+#ifdef CHROME_X86_SIMD
+static unsigned int HalfSpace_RowMaskSSE2(struct HalfSpace *pThis, int *arE);
+#endif
+static void HalfSpace_PlotRun(unsigned char *p, int nCount,
+										unsigned_int_32 aPixel, int nPixelSize);
+
+static HalfSpace_RowMaskFunc HalfSpace_pRowMask = NULL;
+
+/********************************************************************
+* Function : HalfSpace_Setup()
+* Purpose : Builds the edge functions of a polygon.
+* Pre : pThis points to a HalfSpace structure, arpVertices to the
+*       nVertices ScreenVertex structures of the polygon.
+* Post : If the returnvalue is 1, pThis holds the bounds and edge
+*        functions of the polygon.
+*        If the returnvalue is 0, the polygon is too large, has too
+*        many vertices or isn't counterclockwise and convex, pThis
+*        is undefined.
+* Note : Every scanline of the polygon gets it's start from an edge
+*        going down and it's end from one going up. As long as the
+*        polygon is convex, both are the tightest of the edges of
+*        their kind, so a pixel is covered if it's inside all edges.
+********************************************************************/
+int HalfSpace_Setup(struct HalfSpace *pThis,
+						  struct ScreenVertex **arpVertices, int nVertices)
+{
+	struct ScreenVertex *pPrev, *pSV, *pNext;
+	struct ScreenVertex *pTop, *pBottom;
+	long lTurn;
+	long lArea;
+	long lX, lXStep;
+	int nDir, nLastDir, nTurns;
+	int n;
+
+	if ((nVertices < 3) || (nVertices > HALFSPACE_MAXEDGES))
+		return 0;
+
+	/* Find the bounds. */
+	pThis->nLeft = pThis->nRight = arpVertices[0]->nX;
+	pThis->nTop = pThis->nBottom = arpVertices[0]->nY;
+	for (n = 1; n < nVertices; n++)
+	{	pSV = arpVertices[n];
+		if (pSV->nX < pThis->nLeft)
+			pThis->nLeft = pSV->nX;
+		if (pSV->nX > pThis->nRight)
+			pThis->nRight = pSV->nX;
+		if (pSV->nY < pThis->nTop)
+			pThis->nTop = pSV->nY;
+		if (pSV->nY > pThis->nBottom)
+			pThis->nBottom = pSV->nY;
+	}
+	if (((pThis->nRight - pThis->nLeft) > HALFSPACE_MAXSIZE) ||
+		 ((pThis->nBottom - pThis->nTop) > HALFSPACE_MAXSIZE))
+		return 0;	/* Too large. */
+
+	/* A counterclockwise convex polygon turns the same way at every
+	 * vertex and changes between going down and going up only twice.
+	 * Start with the direction of the last edge that isn't
+	 * horizontal. */
+	nLastDir = 0;
+	for (n = 0; n < nVertices; n++)
+	{	pSV = arpVertices[n];
+		pPrev = arpVertices[(n == 0) ? nVertices - 1 : n - 1];
+		if (pSV->nY != pPrev->nY)
+			nLastDir = (pSV->nY > pPrev->nY) ? 1 : -1;
+	}
+	nTurns = 0;
+	lArea = 0;
+	pPrev = arpVertices[nVertices - 2];
+	pSV = arpVertices[nVertices - 1];
+	for (n = 0; n < nVertices; n++)
+	{	pNext = arpVertices[n];
+		lTurn = (long)(pSV->nX - pPrev->nX) * (pNext->nY - pSV->nY) -
+				  (long)(pSV->nY - pPrev->nY) * (pNext->nX - pSV->nX);
+		if (lTurn > 0)
+			return 0;	/* Not convex, or clockwise. */
+		lArea += (long)pSV->nX * pNext->nY - (long)pNext->nX * pSV->nY;
+		if (pNext->nY != pSV->nY)
+		{	nDir = (pNext->nY > pSV->nY) ? 1 : -1;
+			if (nDir != nLastDir)
+				nTurns++;
+			nLastDir = nDir;
+		}
+		pPrev = pSV;
+		pSV = pNext;
+	}
+	if ((nTurns != 2) || (lArea >= 0))
+		return 0;	/* Wraps around more than once, or has no area. */
+
+	/* Build the edge functions, relative to the top left of the
+	 * bounds. */
+	pThis->nEdges = 0;
+	pSV = arpVertices[nVertices - 1];
+	for (n = 0; n < nVertices; n++)
+	{	pNext = arpVertices[n];
+		if (pSV->nY != pNext->nY)
+		{	if (pSV->nY < pNext->nY)
+			{	pTop = pSV;
+				pBottom = pNext;
+			} else
+			{	pTop = pNext;
+				pBottom = pSV;
+			}
+
+			/* The DDA of EdgeTable_AddEdge(), the edge is at 16.16 X
+			 * lX + lXStep * Y on scanline Y. */
+			lXStep = ((long)(pBottom->nX - pTop->nX) * 65536L) / (pBottom->nY - pTop->nY);
+			lX = ((long)(pTop->nX - pThis->nLeft) * 65536L) + 32768L -
+				  lXStep * (pTop->nY - pThis->nTop);
+
+			if (pSV == pTop)
+			{	/* Going down, a span start. Pixel X is drawn from
+				 * X >= x >> 16 on, that is if (X + 1) * 65536 > x. */
+				pThis->arA[pThis->nEdges] = 65536;
+				pThis->arB[pThis->nEdges] = (int)-lXStep;
+				pThis->arC[pThis->nEdges] = (int)(65536L - lX);
+			} else
+			{	/* Going up, a span end. Pixel X is drawn up to
+				 * X < x >> 16, that is if (X + 1) * 65536 <= x. */
+				pThis->arA[pThis->nEdges] = -65536;
+				pThis->arB[pThis->nEdges] = (int)lXStep;
+				pThis->arC[pThis->nEdges] = (int)(lX - 65536L + 1);
+			}
+			pThis->nEdges++;
+		}
+		pSV = pNext;
+	}
+	return 1;
+}
+
+/********************************************************************
+* Function : HalfSpace_SolidFill()
+* Purpose : Fills the polygon a HalfSpace was set up for with a
+*           single pixel value.
+* Pre : pThis points to a HalfSpace on which HalfSpace_Setup()
+*       succeeded, pClip to an initialized EdgeTable without a span
+*       buffer. aPixel is the pixel value, nPixelSize it's size in
+*       bytes (1 to 4), pBitmap points to the bitmap, nPixelsPerRow
+*       pixels to a row.
+* Post : The pixels of the polygon inside the scissor rectangle of
+*        pClip, on the scanlines it draws, are set to aPixel. If
+*        pClip->pDamage is not NULL, it covers them.
+********************************************************************/
+void HalfSpace_SolidFill(struct HalfSpace *pThis, struct EdgeTable *pClip,
+								 unsigned_int_32 aPixel, int nPixelSize,
+								 int nPixelsPerRow, unsigned char *pBitmap)
+{
+	int arE[HALFSPACE_MAXEDGES];		/* Edge functions at the block. */
+	int arRowE[HALFSPACE_MAXEDGES];	/* Edge functions at the row. */
+	int nLeft, nTop, nRight, nBottom;
+	int nBX, nBY;							/* Block, relative to the bounds. */
+	int x0, x1, y0, y1;					/* Part of the block to draw. */
+	int nAccept;
+	int nMin, nMax;
+	unsigned int nMask;
+	int e;
+	int x, y;
+	int n;
+
+	/* Clip the bounds. */
+	nLeft = (pThis->nLeft > pClip->nClipLeft) ? pThis->nLeft : pClip->nClipLeft;
+	nTop = (pThis->nTop > pClip->nClipTop) ? pThis->nTop : pClip->nClipTop;
+	nRight = (pThis->nRight < pClip->nClipRight) ? pThis->nRight : pClip->nClipRight;
+	nBottom = (pThis->nBottom < pClip->nClipBottom) ? pThis->nBottom : pClip->nClipBottom;
+	if ((nLeft >= nRight) || (nTop >= nBottom))
+		return;
+	if (pClip->pDamage != NULL)
+		DamageList_Add(pClip->pDamage, nLeft, nTop, nRight, nBottom);
+
+	/* Select the maskers on first use. */
+	if (HalfSpace_pRowMask == NULL)
+		HalfSpace_SelectMaskers(CpuFeatures_Get());
+
+	/* Make the clipped bounds relative as well. */
+	nLeft -= pThis->nLeft;
+	nTop -= pThis->nTop;
+	nRight -= pThis->nLeft;
+	nBottom -= pThis->nTop;
+
+	for (nBY = 0; nBY < nBottom; nBY += HALFSPACE_BLOCKSIZE)
+	{	if (nBY + HALFSPACE_BLOCKSIZE <= nTop)
+			continue;
+		y0 = (nBY > nTop) ? nBY : nTop;
+		y1 = (nBY + HALFSPACE_BLOCKSIZE < nBottom) ? nBY + HALFSPACE_BLOCKSIZE : nBottom;
+		for (nBX = 0; nBX < nRight; nBX += HALFSPACE_BLOCKSIZE)
+		{	if (nBX + HALFSPACE_BLOCKSIZE <= nLeft)
+				continue;
+
+			/* Find the smallest and largest value of every edge
+			 * function over the block. A block outside any edge is
+			 * skipped, one inside all is filled whole. */
+			nAccept = 1;
+			for (n = 0; n < pThis->nEdges; n++)
+			{	e = pThis->arA[n] * nBX + pThis->arB[n] * nBY + pThis->arC[n];
+				nMin = nMax = e;
+				if (pThis->arA[n] > 0)
+					nMax += pThis->arA[n] * (HALFSPACE_BLOCKSIZE - 1);
+				else
+					nMin += pThis->arA[n] * (HALFSPACE_BLOCKSIZE - 1);
+				if (pThis->arB[n] > 0)
+					nMax += pThis->arB[n] * (HALFSPACE_BLOCKSIZE - 1);
+				else
+					nMin += pThis->arB[n] * (HALFSPACE_BLOCKSIZE - 1);
+				if (nMax <= 0)
+					break;	/* Outside. */
+				if (nMin <= 0)
+					nAccept = 0;
+				arE[n] = e;
+			}
+			if (n < pThis->nEdges)
+				continue;
+
+			x0 = (nBX > nLeft) ? nBX : nLeft;
+			x1 = (nBX + HALFSPACE_BLOCKSIZE < nRight) ? nBX + HALFSPACE_BLOCKSIZE : nRight;
+			for (y = y0; y < y1; y++)
+			{	/* Skip the scanlines of the other field. */
+				if ((y + pThis->nTop - pClip->nRowPhase) & (pClip->nRowStep - 1))
+					continue;
+
+				if (nAccept)
+				{	HalfSpace_PlotRun(pBitmap + ((size_t)(y + pThis->nTop) * nPixelsPerRow +
+															x0 + pThis->nLeft) * nPixelSize,
+											x1 - x0, aPixel, nPixelSize);
+					continue;
+				}
+
+				/* Test the pixels of the row, then draw the runs that
+				 * are inside, within x0 up to x1. */
+				for (n = 0; n < pThis->nEdges; n++)
+					arRowE[n] = arE[n] + pThis->arB[n] * (y - nBY);
+				nMask = HalfSpace_pRowMask(pThis, arRowE) &
+						  ((1U << (x1 - nBX)) - 1) & ~((1U << (x0 - nBX)) - 1);
+				x = 0;
+				while (nMask != 0)
+				{	while (!(nMask & 1))
+					{	nMask >>= 1;
+						x++;
+					}
+					n = 0;
+					while (nMask & 1)
+					{	nMask >>= 1;
+						n++;
+					}
+					HalfSpace_PlotRun(pBitmap + ((size_t)(y + pThis->nTop) * nPixelsPerRow +
+															nBX + x + pThis->nLeft) * nPixelSize,
+											n, aPixel, nPixelSize);
+					x += n;
+				}
+			}
+		}
+	}
+}
+
+/********************************************************************
+* Function : HalfSpace_SelectMaskers()
+* Purpose : Selects the function testing rows of pixels in blocks on
+*           edges.
+* Pre : ulFeatures holds the CPUF_XXX flags of the processor.
+* Post : The fastest masker the flags allow is used from now on.
+********************************************************************/
+void HalfSpace_SelectMaskers(unsigned long ulFeatures)
+{
+	HalfSpace_pRowMask = HalfSpace_RowMaskC;
+#ifdef CHROME_X86_SIMD
+	if (ulFeatures & CPUF_SSE2)
+		HalfSpace_pRowMask = HalfSpace_RowMaskSSE2;
+#endif
+}
+
+/********************************************************************
+* Function : HalfSpace_InitMaskers()
+* Purpose : Selects the maskers if that hasn't been done yet.
+* Pre : -
+* Post : The maskers have been selected, either by an earlier call to
+*        HalfSpace_SelectMaskers() or now, from CpuFeatures_Get().
+********************************************************************/
+void HalfSpace_InitMaskers(void)
+{
+	if (HalfSpace_pRowMask == NULL)
+		HalfSpace_SelectMaskers(CpuFeatures_Get());
+}
+
+/********************************************************************
+* Function : HalfSpace_RowMaskC()
+* Purpose : Plain C version of the row test of HalfSpace_SolidFill().
+* Pre : pThis points to a set up HalfSpace, arE to the values of it's
+*       edge functions at the first pixel of the row.
+* Post : Returns a mask with bit X set for each of the
+*        HALFSPACE_BLOCKSIZE pixels X of the row inside all edges.
+********************************************************************/
+static unsigned int HalfSpace_RowMaskC(struct HalfSpace *pThis, int *arE)
+{
+	unsigned int nMask;
+	int x, n;
+
+	nMask = 0;
+	for (x = 0; x < HALFSPACE_BLOCKSIZE; x++)
+	{	for (n = 0; n < pThis->nEdges; n++)
+			if (arE[n] + pThis->arA[n] * x <= 0)
+				break;
+		if (n == pThis->nEdges)
+			nMask |= 1U << x;
+	}
+	return nMask;
+}
+
+#ifdef CHROME_X86_SIMD
+/********************************************************************
+* Function : HalfSpace_RowMaskSSE2()
+* Purpose : SSE2 version of HalfSpace_RowMaskC(), tests 4 pixels of
+*           the row against an edge at once.
+* Pre : As HalfSpace_RowMaskC(), the processor supports SSE2.
+* Post : As HalfSpace_RowMaskC().
+********************************************************************/
+CPUFEAT_TARGET_SSE2
+static unsigned int HalfSpace_RowMaskSSE2(struct HalfSpace *pThis, int *arE)
+{
+	__m128i vZero, vIn0, vIn1, vE0, vE1;
+	int a, n;
+
+	vZero = _mm_setzero_si128();
+	vIn0 = _mm_cmpeq_epi32(vZero, vZero);
+	vIn1 = vIn0;
+	for (n = 0; n < pThis->nEdges; n++)
+	{	a = pThis->arA[n];
+		vE0 = _mm_setr_epi32(arE[n], arE[n] + a, arE[n] + 2 * a, arE[n] + 3 * a);
+		vE1 = _mm_add_epi32(vE0, _mm_set1_epi32(4 * a));
+		vIn0 = _mm_and_si128(vIn0, _mm_cmpgt_epi32(vE0, vZero));
+		vIn1 = _mm_and_si128(vIn1, _mm_cmpgt_epi32(vE1, vZero));
+	}
+	return (unsigned int)_mm_movemask_ps(_mm_castsi128_ps(vIn0)) |
+			 ((unsigned int)_mm_movemask_ps(_mm_castsi128_ps(vIn1)) << 4);
+}
+#endif
+
+/********************************************************************
+* Function : HalfSpace_PlotRun()
+* Purpose : Helper to HalfSpace_SolidFill(), sets a run of pixels.
+* Pre : p points to the first of nCount pixels of nPixelSize bytes.
+* Post : The pixels are set to aPixel.
+********************************************************************/
+static void HalfSpace_PlotRun(unsigned char *p, int nCount,
+										unsigned_int_32 aPixel, int nPixelSize)
+{
+	unsigned_int_16 *pShort;
+	unsigned_int_32 *pLong;
+
+	switch (nPixelSize)
+	{	case 1 :
+			memset(p, (int)(aPixel & 0xFF), nCount);
+			break;
+		case 2 :
+			pShort = (unsigned_int_16 *)p;
+			while (nCount-- > 0)
+				*(pShort++) = (unsigned_int_16)aPixel;
+			break;
+		case 3 :
+			while (nCount-- > 0)
+			{	p[0] = (unsigned char)aPixel;
+				p[1] = (unsigned char)(aPixel >> 8);
+				p[2] = (unsigned char)(aPixel >> 16);
+				p += 3;
+			}
+			break;
+		default :
+			pLong = (unsigned_int_32 *)p;
+			while (nCount-- > 0)
+				*(pLong++) = aPixel;
+			break;
+	}
+}
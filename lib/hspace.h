@@ -0,0 +1,104 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : hspace.h
+* Purpose : Header file for the HalfSpace structure.
+* Description : The HalfSpace structure rasterizes small convex
+*               polygons without an EdgeTable. Every edge is turned
+*               into an edge function that is positive on the inside
+*               of the edge, the polygon is then walked in blocks of
+*               8 by 8 pixels. Blocks outside an edge are skipped and
+*               blocks inside all edges are filled whole, only the
+*               blocks on an edge are tested pixel by pixel.
+*               The edge functions follow the DDA of
+*               EdgeTable_AddEdge(), so a polygon covers exactly the
+*               same pixels either way.
+********************************************************************/
+
+#ifndef HSPACE_H
+#define HSPACE_H
+
+#include "scrvertx.h"
+#include "edgetbl.h"
+
+/* Polygons up to HALFSPACE_MAXSIZE pixels wide and high with at most
+ * HALFSPACE_MAXEDGES edges can be set up. The maximum size keeps the
+ * edge functions well inside 32 bits. */
+#define HALFSPACE_MAXSIZE		32
+#define HALFSPACE_MAXEDGES		8
+
+/* Width and height of the blocks, in pixels. */
+#define HALFSPACE_BLOCKSIZE	8
+
+struct HalfSpace
+{
+	/* Bounds of the polygon, the pixels it covers are nLeft up to
+	 * (not including) nRight, nTop up to (not including) nBottom. */
+	int	nLeft;
+	int	nTop;
+	int	nRight;
+	int	nBottom;
+
+	/* The edge functions, pixel X, Y (relative to nLeft, nTop) is
+	 * inside edge n if arA[n] * X + arB[n] * Y + arC[n] > 0.
+	 * Horizontal edges don't need one. */
+	int	nEdges;
+	int	arA[HALFSPACE_MAXEDGES];
+	int	arB[HALFSPACE_MAXEDGES];
+	int	arC[HALFSPACE_MAXEDGES];
+};
+
+/* HalfSpace_Setup(pThis, arpVertices, nVertices),
+ * Sets up pThis for the polygon with the nVertices ScreenVertex
+ * structures arpVertices points to.
+ * Returns 1 if succesful, 0 if the polygon can't be rasterized by a
+ * HalfSpace: it's too large, has too many vertices or isn't a
+ * counterclockwise convex polygon. Use an EdgeTable then.
+ */
+int HalfSpace_Setup(struct HalfSpace *pThis,
+						  struct ScreenVertex **arpVertices, int nVertices);
+
+/* HalfSpace_SolidFill(pThis, pClip, aPixel, nPixelSize, nPixelsPerRow,
+ *                     pBitmap),
+ * Fills the polygon pThis was set up for in pBitmap with pixel
+ * value aPixel, nPixelSize (1 to 4) bytes in size, just like the
+ * EdgeTable_SolidFill functions. The scissor rectangle, interlacing
+ * and damage of EdgeTable pClip are used, it's span buffer should be
+ * NULL. Uses SSE2 for the blocks on edges where available.
+ */
+void HalfSpace_SolidFill(struct HalfSpace *pThis, struct EdgeTable *pClip,
+								 unsigned_int_32 aPixel, int nPixelSize,
+								 int nPixelsPerRow, unsigned char *pBitmap);
+
+/* HalfSpace_SelectMaskers(ulFeatures),
+ * Selects the functions testing the pixels of blocks on edges from
+ * the CPUF_XXX flags in ulFeatures. This is done automatically with
+ * CpuFeatures_Get() on the first fill, call it with 0 to force the
+ * plain C version. Both give identical results.
+ */
+void HalfSpace_SelectMaskers(unsigned long ulFeatures);
+
+/* HalfSpace_InitMaskers(),
+ * Selects the maskers with CpuFeatures_Get() unless they have been
+ * selected already. Call it before filling from several threads at
+ * once so they don't all try to.
+ */
+void HalfSpace_InitMaskers(void);
+
+#endif
@@ -42,6 +42,12 @@ struct Lightmap1
 	unsigned long	ulRGB;			/* 0xRRGGBB unsigned long color.
 											 * Specifies the RGB value */
 	unsigned char	nIndex;			/* Colormap index. */
+	unsigned char	*arBlend;		/* 256 colormap indices, entry n is
+											 * the color half way between the
+											 * color of this Lightmap1 and that
+											 * of index n. NULL unless the
+											 * ColorManager built a blend
+											 * table. */
 };
 
 /* Lightmap1_ConstructM(pThis),
@@ -53,7 +59,8 @@ struct Lightmap1
 	(pThis)->pNext = NULL,\
 	(pThis)->pLNext = NULL,\
 	(pThis)->ulRGB = 0xFFFFFF,\
-	(pThis)->nIndex = 255\
+	(pThis)->nIndex = 255,\
+	(pThis)->arBlend = NULL\
 )
 
 /* Lightmap1_AttachM(pThis),
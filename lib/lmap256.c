@@ -69,6 +69,7 @@ int Lightmap256_RequestColors(struct Lightmap256 *pThis,
 		if (!Octree_AddColor(pOctree, ulRGB))
 			return 0;	/* Mem failure. */
 	}
+	return 1;
 }
 
 /********************************************************************
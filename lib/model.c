@@ -199,6 +199,44 @@ int Model_LinkToColorManager(struct Model *pThis,
 	return 1;
 }
 
+/********************************************************************
+* Function : Model_SetChromeMap()
+* Purpose : Makes all polygons of a Model chrome mapped.
+* Pre : pThis points to an initialized Model structure, pTexMap
+*       points to an initialized TextureMap structure.
+* Post : All polygons of the Model are chrome mapped with pTexMap.
+********************************************************************/
+void Model_SetChromeMap(struct Model *pThis, struct TextureMap *pTexMap)
+{
+	int n;
+	for (n = 0; n < pThis->Polygons.nCount; n++)
+	{
+		pThis->Polygons.arPolygons[n].nFlags = PF_CHROME;
+		pThis->Polygons.arPolygons[n].pLightmap = (void *)pTexMap;
+	}
+}
+
+/********************************************************************
+* Function : Model_SetTextureMap()
+* Purpose : Makes polygons of a Model texture mapped.
+* Pre : pThis points to an initialized Model structure, pTexMap
+*       points to an initialized TextureMap structure.
+* Post : All polygons of the Model that were PF_TEXTURE, or all
+*        polygons if bAll is not 0, are texture mapped with pTexMap.
+********************************************************************/
+void Model_SetTextureMap(struct Model *pThis, struct TextureMap *pTexMap,
+								 int bAll)
+{
+	int n;
+	for (n = 0; n < pThis->Polygons.nCount; n++)
+	{
+		if (bAll || (pThis->Polygons.arPolygons[n].nFlags == PF_TEXTURE))
+		{	pThis->Polygons.arPolygons[n].nFlags = PF_TEXTURE;
+			pThis->Polygons.arPolygons[n].pLightmap = (void *)pTexMap;
+		}
+	}
+}
+
 /********************************************************************
 * Function : Model_RequestColors()
 * Purpose : Requests the colors a model needs for drawing.
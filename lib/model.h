@@ -32,6 +32,7 @@
 #include "vertxset.h"
 #include "polyset.h"
 #include "octree.h"
+#include "texmap.h"
 
 struct Model
 {
@@ -105,6 +106,27 @@ void Model_CalcBoundingSphere(struct Model *pThis);
 int Model_LinkToColorManager(struct Model *pThis,
 									  struct ColorManager *pColorManager);
 
+/* Model_SetChromeMap(pThis, pTexMap)
+ * Makes all polygons of a Model chrome mapped (PF_CHROME) with the
+ * TextureMap pTexMap. Call this before Model_LinkToColorManager(),
+ * the TextureMap must be attached to the same ColorManager and
+ * prepared before the Model is drawn.
+ */
+void Model_SetChromeMap(struct Model *pThis, struct TextureMap *pTexMap);
+
+/* Model_SetTextureMap(pThis, pTexMap, bAll)
+ * Texture maps the polygons of a Model (PF_TEXTURE) with the TextureMap
+ * pTexMap, using their TexCoords (polygons without any map the whole
+ * polygon to the texel at 0,0). If bAll is 0, only the polygons that
+ * are already PF_TEXTURE (e.g. those with a texture in their NFF file)
+ * are affected, otherwise all polygons are.
+ * Call this before Model_LinkToColorManager(), the TextureMap must be
+ * attached to the same ColorManager and prepared before the Model is
+ * drawn.
+ */
+void Model_SetTextureMap(struct Model *pThis, struct TextureMap *pTexMap,
+								 int bAll);
+
 /* Model_RequestColors(pThis, pOctree),
  * Requests all colors for all polygons in a Model.
  * This doesn't initialize the color indices, use
@@ -33,6 +33,7 @@
 #include "vertxset.h"
 #include "polygon.h"
 #include "polyset.h"
+#include "floatset.h"
 
 /********************************************************************
 * Function : Model_LoadNFF()
@@ -82,6 +83,11 @@ struct Model *Model_LoadNFFBuffer(struct ParseBuf *pBuf, int bQuick)
 	struct VertexSet vset;
 	struct Polygon pol;
 	struct PolySet pset;
+	struct FloatSet uvset;	/* Texture coordinates (U, V) of every
+									 * vertex in vset. */
+	int bUV;				/* The vertices of the object have texture
+							 * coordinates. */
+	float fU, fV;
 	int nVertOffset;
 	int nVertCount;
 	int nPolCount;
@@ -93,7 +99,6 @@ struct Model *Model_LoadNFFBuffer(struct ParseBuf *pBuf, int bQuick)
 	int bDone;
 	struct Model *pModel;
 	unsigned long ulRGB;
-	float fDummy;
 	int nColorRun;
 
 	/* Match "NFF" token. */
@@ -151,6 +156,7 @@ struct Model *Model_LoadNFFBuffer(struct ParseBuf *pBuf, int bQuick)
 	VertexSet_ConstructM(&vset);
 	Polygon_ConstructM(&pol);
 	PolySet_ConstructM(&pset);
+	FloatSet_ConstructM(&uvset);
 
 	while (!ParseBuf_EndOfBuffer(pBuf))
 	{
@@ -164,12 +170,14 @@ struct Model *Model_LoadNFFBuffer(struct ParseBuf *pBuf, int bQuick)
 
 		/* Set vertex offset for this object. */
 		nVertOffset = vset.nCount;
+		bUV = 0;
 
 		/* Retrieve all vertices. */
 		n = nVertCount;
 		while (n > 0)
 		{
 			Vertex_ConstructM(&vert);
+			fU = fV = 0.f;
 
 			ParseBuf_SkipNFFWhitespaces(pBuf);
 
@@ -209,9 +217,10 @@ struct Model *Model_LoadNFFBuffer(struct ParseBuf *pBuf, int bQuick)
 			if (ParseBuf_MatchString(pBuf, "uv"))
 			{
 				ParseBuf_SkipNFFWhitespaces(pBuf);
-				ParseBuf_GetFloat(pBuf, &fDummy);
+				ParseBuf_GetFloat(pBuf, &fU);
 				ParseBuf_SkipNFFWhitespaces(pBuf);
-				ParseBuf_GetFloat(pBuf, &fDummy);
+				ParseBuf_GetFloat(pBuf, &fV);
+				bUV = 1;
 			}
 			ParseBuf_SkipNFFWhitespaces(pBuf);
 
@@ -219,10 +228,14 @@ struct Model *Model_LoadNFFBuffer(struct ParseBuf *pBuf, int bQuick)
 			if (ParseBuf_MatchString(pBuf, "N"))
 				ParseBuf_SkipNFFWhitespaces(pBuf);
 
-			/* Add the vertex to the vertex set. */
-			if (!VertexSet_AddM(&vset, &vert))
+			/* Add the vertex to the vertex set, it's texture
+			 * coordinates are kept until the polygons get them. */
+			if ((!VertexSet_AddM(&vset, &vert)) ||
+				 (!FloatSet_AddM(&uvset, fU)) ||
+				 (!FloatSet_AddM(&uvset, fV)))
 			{
 				VertexSet_DestructM(&vset);
+				FloatSet_DestructM(&uvset);
 				Polygon_DestructM(&pol);
 				PolySet_DestructM(&pset);
 				return NULL;
@@ -237,6 +250,8 @@ struct Model *Model_LoadNFFBuffer(struct ParseBuf *pBuf, int bQuick)
 		while (n > 0)
 		{
 			pol.Vertices.nCount = 0;
+			pol.TexCoords.nCount = 0;
+			pol.nFlags = PF_STATICCOLOR;
 
 			/* Retrieve number of vertices on polygon. */
 			ParseBuf_GetInt(pBuf, &nPVertCount);
@@ -249,10 +264,16 @@ struct Model *Model_LoadNFFBuffer(struct ParseBuf *pBuf, int bQuick)
 				ParseBuf_GetInt(pBuf, &nVIndex);
 				ParseBuf_SkipNFFWhitespaces(pBuf);
 
-				/* Add the index to the polygon. */
-				if (!IndexSet_AddM(&(pol.Vertices), nVIndex + nVertOffset))
+				/* Add the index to the polygon, with the texture
+				 * coordinates of the vertex if the object has any. */
+				k = nVIndex + nVertOffset;
+				if ((!IndexSet_AddM(&(pol.Vertices), k)) ||
+					 (bUV &&
+					  ((!FloatSet_AddM(&(pol.TexCoords), FloatSet_GetFloatM(&uvset, 2 * k))) ||
+						(!FloatSet_AddM(&(pol.TexCoords), FloatSet_GetFloatM(&uvset, 2 * k + 1))))))
 				{	/* Mem Failure. */
 					VertexSet_DestructM(&vset);
+					FloatSet_DestructM(&uvset);
 					Polygon_DestructM(&pol);
 					PolySet_DestructM(&pset);
 					return NULL;
@@ -282,7 +303,10 @@ struct Model *Model_LoadNFFBuffer(struct ParseBuf *pBuf, int bQuick)
 			if (ParseBuf_MatchString(pBuf, "_v_") ||
 				 ParseBuf_MatchString(pBuf, "_V_"))
 			{
-				/* Skip the texture & go to next token. */
+				/* The polygon is texture mapped, the TextureMap itself
+				 * is assigned by Model_SetTextureMap().
+				 * Skip the texture & go to next token. */
+				pol.nFlags = PF_TEXTURE;
 				ParseBuf_SkipUntilNFFWhitespace(pBuf);
 				ParseBuf_SkipNFFWhitespaces(pBuf);
 			}
@@ -291,7 +315,10 @@ struct Model *Model_LoadNFFBuffer(struct ParseBuf *pBuf, int bQuick)
 			if (ParseBuf_MatchString(pBuf, "_s_") ||
 				 ParseBuf_MatchString(pBuf, "_S_"))
 			{
-				/* Skip the texture & go to next token. */
+				/* Texture mapped as well, shading of textures isn't
+				 * supported.
+				 * Skip the texture & go to next token. */
+				pol.nFlags = PF_TEXTURE;
 				ParseBuf_SkipUntilNFFWhitespace(pBuf);
 				ParseBuf_SkipNFFWhitespaces(pBuf);
 			}
@@ -300,7 +327,10 @@ struct Model *Model_LoadNFFBuffer(struct ParseBuf *pBuf, int bQuick)
 			if (ParseBuf_MatchString(pBuf, "_t_") ||
 				 ParseBuf_MatchString(pBuf, "_T_"))
 			{
-				/* Skip the texture & go to next token. */
+				/* The texture isn't loaded, but the polygon's color
+				 * is drawn translucent.
+				 * Skip the texture & go to next token. */
+				pol.nFlags = PF_TRANSLUCENT;
 				ParseBuf_SkipUntilNFFWhitespace(pBuf);
 				ParseBuf_SkipNFFWhitespaces(pBuf);
 			}
@@ -309,7 +339,10 @@ struct Model *Model_LoadNFFBuffer(struct ParseBuf *pBuf, int bQuick)
 			if (ParseBuf_MatchString(pBuf, "_u_") ||
 				 ParseBuf_MatchString(pBuf, "_U_"))
 			{
-				/* Skip the texture & go to next token. */
+				/* Translucent as well, shading of textures isn't
+				 * supported.
+				 * Skip the texture & go to next token. */
+				pol.nFlags = PF_TRANSLUCENT;
 				ParseBuf_SkipUntilNFFWhitespace(pBuf);
 				ParseBuf_SkipNFFWhitespaces(pBuf);
 			}
@@ -369,6 +402,7 @@ struct Model *Model_LoadNFFBuffer(struct ParseBuf *pBuf, int bQuick)
 			{
 				/* Mem failure. */
 				VertexSet_DestructM(&vset);
+				FloatSet_DestructM(&uvset);
 				Polygon_DestructM(&pol);
 				PolySet_DestructM(&pset);
 				return NULL;
@@ -389,12 +423,26 @@ struct Model *Model_LoadNFFBuffer(struct ParseBuf *pBuf, int bQuick)
 					IndexSet_GetIndexM(&(pol.Vertices), m) = IndexSet_GetIndexM(&(pol.Vertices), (nPVertCount - 1) - m);
 					IndexSet_GetIndexM(&(pol.Vertices), (nPVertCount - 1) - m) = k;
 				}
+				if (bUV)
+				{	/* And their texture coordinates. */
+					for (m = 0; m < (nPVertCount / 2); m++)
+					{
+						k = (nPVertCount - 1) - m;
+						fU = FloatSet_GetFloatM(&(pol.TexCoords), 2 * m);
+						fV = FloatSet_GetFloatM(&(pol.TexCoords), 2 * m + 1);
+						FloatSet_GetFloatM(&(pol.TexCoords), 2 * m) = FloatSet_GetFloatM(&(pol.TexCoords), 2 * k);
+						FloatSet_GetFloatM(&(pol.TexCoords), 2 * m + 1) = FloatSet_GetFloatM(&(pol.TexCoords), 2 * k + 1);
+						FloatSet_GetFloatM(&(pol.TexCoords), 2 * k) = fU;
+						FloatSet_GetFloatM(&(pol.TexCoords), 2 * k + 1) = fV;
+					}
+				}
 
 				/* Add reversed polygon to set. */
 				if (!PolySet_AddM(&pset, &pol))
 				{
 					/* Mem failure. */
 					VertexSet_DestructM(&vset);
+					FloatSet_DestructM(&uvset);
 					Polygon_DestructM(&pol);
 					PolySet_DestructM(&pset);
 					return NULL;
@@ -409,6 +457,7 @@ struct Model *Model_LoadNFFBuffer(struct ParseBuf *pBuf, int bQuick)
 	if (pModel == NULL)
 	{	/* Mem failure. */
 		VertexSet_DestructM(&vset);
+		FloatSet_DestructM(&uvset);
 		Polygon_DestructM(&pol);
 		PolySet_DestructM(&pset);
 		return NULL;
@@ -427,6 +476,7 @@ struct Model *Model_LoadNFFBuffer(struct ParseBuf *pBuf, int bQuick)
 		
 	if (pModel->pRoot == NULL)
 	{	/* Failed to build the BSP tree. */
+		FloatSet_DestructM(&uvset);
 		Polygon_DestructM(&pol);
 		PolySet_DestructM(&pset);
 		Model_DestructM(pModel);		/* This also destroys vset. */
@@ -441,6 +491,7 @@ struct Model *Model_LoadNFFBuffer(struct ParseBuf *pBuf, int bQuick)
 	HPlane_CalculateLeafCount(pModel->pRoot);
 
 	/* Clean up and return. */
+	FloatSet_DestructM(&uvset);
 	Polygon_DestructM(&pol);
 	PolySet_DestructM(&pset);
 	return pModel;
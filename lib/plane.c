@@ -86,6 +86,8 @@ float Plane_DistanceOfVector(struct Plane *pThis,
 *        clipped polygon. Newly created vertices have negative
 *        indices that point into pTrgVertices.
 *        pTrgVertices now also contains all newly created vertices.
+*        If pSrcPolygon has TexCoords, pTrgPolygon has those of it's
+*        vertices, interpolated for the new ones.
 ********************************************************************/
 int Plane_ClipPolygon(struct Plane *pThis,
 							 struct Polygon *pSrcPolygon,
@@ -105,14 +107,21 @@ int Plane_ClipPolygon(struct Plane *pThis,
 	struct Vertex *pV1;		/* Current vertex ptr. */
 	struct Vertex TV;			/* Temporary result vertex. */
 	float fInterpol;			/* Interpolation value. */
+	int bTexCoords;			/* Polygon has texture coordinates. */
+	float fLastU, fLastV;	/* Texture coordinates of last vertex. */
+	float fU, fV;				/* Texture coordinates of current vertex. */
 	
 	/* Iterate through all edges of the polygon and intersect
 	 * with the plane if needed. */
 
 	/* Set shading information in target polygon. */
 	pTrgPolygon->ulRGB = pSrcPolygon->ulRGB;
+	pTrgPolygon->usRGB565 = pSrcPolygon->usRGB565;
 	pTrgPolygon->pLightmap = pSrcPolygon->pLightmap;
 	pTrgPolygon->nFlags = pSrcPolygon->nFlags;
+	pTrgPolygon->TexCoords.nCount = 0;
+	bTexCoords = (FloatSet_GetCountM(&(pSrcPolygon->TexCoords)) != 0);
+	fLastU = fLastV = fU = fV = 0.f;
 	
 	/* Initialize variables for loop. */
 	/* Find last vertex index. */
@@ -124,6 +133,10 @@ int Plane_ClipPolygon(struct Plane *pThis,
 		return 1;
 	n = n - 1;
 	LastVIndex = IndexSet_GetIndexM(&(pSrcPolygon->Vertices), n);
+	if (bTexCoords)
+	{	fLastU = FloatSet_GetFloatM(&(pSrcPolygon->TexCoords), 2 * n);
+		fLastV = FloatSet_GetFloatM(&(pSrcPolygon->TexCoords), 2 * n + 1);
+	}
 
 	/* Find last vertex's distance from plane. */
 	if (LastVIndex < 0)
@@ -136,6 +149,10 @@ int Plane_ClipPolygon(struct Plane *pThis,
 	{
 		/* Find vertex index. */
 		VIndex = IndexSet_GetIndexM(&(pSrcPolygon->Vertices), n);
+		if (bTexCoords)
+		{	fU = FloatSet_GetFloatM(&(pSrcPolygon->TexCoords), 2 * n);
+			fV = FloatSet_GetFloatM(&(pSrcPolygon->TexCoords), 2 * n + 1);
+		}
 
 		/* Find vertex's distance from plane. */
 		if (VIndex < 0)
@@ -199,6 +216,14 @@ int Plane_ClipPolygon(struct Plane *pThis,
 			{
 				return 0;	/* Mem failure */
 			}
+
+			/* And it's texture coordinates. */
+			if (bTexCoords &&
+				 (!FloatSet_AddM(&(pTrgPolygon->TexCoords), fLastU + (fU - fLastU) * fInterpol) ||
+				  !FloatSet_AddM(&(pTrgPolygon->TexCoords), fLastV + (fV - fLastV) * fInterpol)))
+			{
+				return 0;	/* Mem failure */
+			}
 		}
 	
 		/* If the current vertex is on the right side, add it to the
@@ -209,11 +234,19 @@ int Plane_ClipPolygon(struct Plane *pThis,
 			{
 				return 0;	/* Mem failure */
 			}
+			if (bTexCoords &&
+				 (!FloatSet_AddM(&(pTrgPolygon->TexCoords), fU) ||
+				  !FloatSet_AddM(&(pTrgPolygon->TexCoords), fV)))
+			{
+				return 0;	/* Mem failure */
+			}
 		}
 		
 		/* Switch around, current becomes last. */
 		LastVIndex = VIndex;
 		fLastDistance = fDistance;
+		fLastU = fU;
+		fLastV = fV;
 	}
 	
 	/* Done. */
@@ -88,7 +88,7 @@ float Plane_DistanceOfVector(struct Plane *pThis,
  * use negative indices in the polygons. Negative indices are also
  * looked up in pTrgVertices, negatively indexed distances are
  * looked up in pNIDistances. The resulting polygon is stored in
- * pTrgPolygon.
+ * pTrgPolygon, with it's texture coordinates if pSrcPolygon has any.
  */
 int Plane_ClipPolygon(struct Plane *pThis,
 							 struct Polygon *pSrcPolygon,
@@ -0,0 +1,120 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : polycmd.c
+********************************************************************/
+
+#define POLYCMD_C
+
+#include <stdlib.h>
+
+#include "polycmd.h"
+
+/* Number of commands and vertices the arrays grow by at least. */
+#define POLYCOMMANDBUFFER_EXPAND_SIZE	256
+
+/********************************************************************
+* Function : PolyCommandBuffer_Construct()
+* Purpose : Initializes a PolyCommandBuffer structure.
+* Pre : pThis points to a PolyCommandBuffer structure.
+* Post : pThis points to an initialized, empty, PolyCommandBuffer
+*        structure.
+********************************************************************/
+void PolyCommandBuffer_Construct(struct PolyCommandBuffer *pThis)
+{
+	/* Call macro version. */
+	PolyCommandBuffer_ConstructM(pThis);
+}
+
+/********************************************************************
+* Function : PolyCommandBuffer_Destruct()
+* Purpose : Frees all memory associated with a PolyCommandBuffer
+*           structure.
+* Pre : pThis points to an initialized PolyCommandBuffer structure.
+* Post : pThis points to an invalid PolyCommandBuffer structure that
+*        uses no more memory.
+********************************************************************/
+void PolyCommandBuffer_Destruct(struct PolyCommandBuffer *pThis)
+{
+	if (pThis->arCommands != NULL)
+		free((void *)pThis->arCommands);
+	if (pThis->arVertices != NULL)
+		free((void *)pThis->arVertices);
+}
+
+/********************************************************************
+* Function : PolyCommandBuffer_AddPolygon()
+* Purpose : Starts a new polygon in a PolyCommandBuffer.
+* Pre : pThis points to an initialized PolyCommandBuffer structure,
+*       pPoly to the Polygon holding the rendering information.
+* Post : If the returnvalue is 1, a PolyCommand with the rendering
+*        information of pPoly and no vertices has been added after
+*        the commands added before.
+*        If the returnvalue is 0, a memory failure occured and
+*        nothing was added.
+********************************************************************/
+int PolyCommandBuffer_AddPolygon(struct PolyCommandBuffer *pThis,
+											struct Polygon *pPoly)
+{
+	struct PolyCommand *pCommands;
+	struct PolyCommand *pCommand;
+	int nAlloc;
+
+	if (pThis->nCommands == pThis->nAllocCommands)
+	{	nAlloc = pThis->nAllocCommands * 2 + POLYCOMMANDBUFFER_EXPAND_SIZE;
+		pCommands = (struct PolyCommand *)realloc((void *)pThis->arCommands,
+																sizeof(struct PolyCommand) * nAlloc);
+		if (pCommands == NULL)
+			return 0;	/* Memory failure. */
+		pThis->arCommands = pCommands;
+		pThis->nAllocCommands = nAlloc;
+	}
+
+	pCommand = &(pThis->arCommands[pThis->nCommands++]);
+	PolyCommand_SetPolygonM(pCommand, pPoly);
+	pCommand->nFirstVertex = pThis->nVertices;
+	pCommand->nVertices = 0;
+	return 1;
+}
+
+/********************************************************************
+* Function : PolyCommandBuffer_ExpandVertices()
+* Purpose : Grows the vertex array of a PolyCommandBuffer.
+* Pre : pThis points to an initialized PolyCommandBuffer structure.
+* Post : If the returnvalue is 1, there's room for at least one more
+*        ScreenVertex in pThis.
+*        If the returnvalue is 0, a memory failure occured and pThis
+*        is unchanged.
+* Note : The array doubles in size, as the buffer is refilled every
+*        frame it quickly stops growing at all.
+********************************************************************/
+int PolyCommandBuffer_ExpandVertices(struct PolyCommandBuffer *pThis)
+{
+	struct ScreenVertex *pVertices;
+	int nAlloc;
+
+	nAlloc = pThis->nAllocVertices * 2 + POLYCOMMANDBUFFER_EXPAND_SIZE;
+	pVertices = (struct ScreenVertex *)realloc((void *)pThis->arVertices,
+															 sizeof(struct ScreenVertex) * nAlloc);
+	if (pVertices == NULL)
+		return 0;	/* Memory failure. */
+	pThis->arVertices = pVertices;
+	pThis->nAllocVertices = nAlloc;
+	return 1;
+}
@@ -0,0 +1,160 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : polycmd.h
+* Purpose : Header file for the PolyCommandBuffer structure.
+* Description : The PolyCommandBuffer is a flat list of screen
+*               polygons ready for rasterization. Every PolyCommand
+*               holds the rendering information of a polygon and the
+*               range of it's ScreenVertex structures, which are
+*               copied into the buffer, so it no longer depends on the
+*               Actors or HPlane trees it was recorded from.
+********************************************************************/
+
+#ifndef POLYCMD_H
+#define POLYCMD_H
+
+#include "polygon.h"
+#include "scrvertx.h"
+
+/* A single screen polygon. */
+struct PolyCommand
+{
+	unsigned long	nFlags;		/* POLFLAGS of the polygon. */
+	void	*pLightmap;				/* Lightmap or TextureMap of the polygon. */
+	unsigned long	ulRGB;		/* Color of the polygon, as 0xRRGGBB... */
+	unsigned short	usRGB565;	/* ...and as RGB565 pixel value. */
+	int	nFirstVertex;			/* Index of the first ScreenVertex of the
+										 * polygon in the Vertices of the buffer. */
+	int	nVertices;				/* Number of ScreenVertex structures, in
+										 * order, that make up the polygon. */
+};
+
+/* PolyCommand_SetPolygonM(pThis, pPoly),
+ * Copies the rendering information of Polygon pPoly into PolyCommand
+ * pThis, the vertices are left alone.
+ */
+#define PolyCommand_SetPolygonM(pThis, pPoly)\
+(	(pThis)->nFlags = (pPoly)->nFlags,\
+	(pThis)->pLightmap = (pPoly)->pLightmap,\
+	(pThis)->ulRGB = (pPoly)->ulRGB,\
+	(pThis)->usRGB565 = (pPoly)->usRGB565\
+)
+
+/* PolyCommand_CanMergeM(pThis, pOther),
+ * Non zero if PolyCommands pThis and pOther are both of a static
+ * color and look the same, so their spans may be filled at once.
+ */
+#define PolyCommand_CanMergeM(pThis, pOther)\
+(	((pThis)->nFlags == PF_STATICCOLOR) &&\
+	((pOther)->nFlags == PF_STATICCOLOR) &&\
+	((pThis)->ulRGB == (pOther)->ulRGB) &&\
+	((pThis)->pLightmap == (pOther)->pLightmap)\
+)
+
+struct PolyCommandBuffer
+{
+	/* Array containing the polygons, in drawing order. */
+	int	nCommands;
+	int	nAllocCommands;
+	struct PolyCommand	*arCommands;
+
+	/* Array containing the ScreenVertex structures of all
+	 * polygons. */
+	int	nVertices;
+	int	nAllocVertices;
+	struct ScreenVertex	*arVertices;
+};
+
+/* PolyCommandBuffer_Construct(pThis),
+ * PolyCommandBuffer_ConstructM(pThis),
+ * Initializes a PolyCommandBuffer structure, it holds no polygons.
+ */
+void PolyCommandBuffer_Construct(struct PolyCommandBuffer *pThis);
+#define PolyCommandBuffer_ConstructM(pThis)\
+(	(pThis)->nCommands = 0,\
+	(pThis)->nAllocCommands = 0,\
+	(pThis)->arCommands = NULL,\
+	(pThis)->nVertices = 0,\
+	(pThis)->nAllocVertices = 0,\
+	(pThis)->arVertices = NULL\
+)
+
+/* PolyCommandBuffer_Destruct(pThis),
+ * Frees all memory associated with a PolyCommandBuffer structure.
+ */
+void PolyCommandBuffer_Destruct(struct PolyCommandBuffer *pThis);
+
+/* PolyCommandBuffer_ClearM(pThis),
+ * Removes all polygons from the buffer, keeping the memory.
+ */
+#define PolyCommandBuffer_ClearM(pThis)\
+(	(pThis)->nCommands = 0,\
+	(pThis)->nVertices = 0\
+)
+
+/* PolyCommandBuffer_AddPolygon(pThis, pPoly),
+ * Adds a new PolyCommand with the rendering information of pPoly and
+ * no vertices yet, add them with PolyCommandBuffer_AddVertexM().
+ * Returns 1 if succesful, 0 otherwise (memory allocation failure).
+ */
+int PolyCommandBuffer_AddPolygon(struct PolyCommandBuffer *pThis,
+											struct Polygon *pPoly);
+
+/* PolyCommandBuffer_ExpandVertices(pThis),
+ * Makes room for more ScreenVertex structures in pThis.
+ * Returns 1 if succesful, 0 otherwise (memory allocation failure).
+ */
+int PolyCommandBuffer_ExpandVertices(struct PolyCommandBuffer *pThis);
+
+/* PolyCommandBuffer_AddVertexM(pThis, pScrVertex),
+ * Adds a copy of ScreenVertex pScrVertex to the last PolyCommand.
+ * Returns 1 if succesful, 0 otherwise (memory allocation failure).
+ */
+#define PolyCommandBuffer_AddVertexM(pThis, pScrVertex)\
+(	((pThis)->nVertices < (pThis)->nAllocVertices) ||\
+	PolyCommandBuffer_ExpandVertices(pThis) ?\
+	(	(pThis)->arVertices[((pThis)->nVertices)++] = *(pScrVertex),\
+		((pThis)->arCommands[(pThis)->nCommands - 1].nVertices)++,\
+		1\
+	):(\
+		0	/* Mem failure */ \
+	)\
+)
+
+/* PolyCommandBuffer_GetCountM(pThis),
+ * Retrieves the number of polygons in the buffer.
+ */
+#define PolyCommandBuffer_GetCountM(pThis)\
+	((pThis)->nCommands)
+
+/* PolyCommandBuffer_GetCommandM(pThis, nIndex),
+ * Retrieves the PolyCommand at index nIndex.
+ */
+#define PolyCommandBuffer_GetCommandM(pThis, nIndex)\
+	(&((pThis)->arCommands[(nIndex)]))
+
+/* PolyCommandBuffer_GetVerticesM(pThis, pCommand),
+ * Retrieves a pointer to the first of the pCommand->nVertices
+ * ScreenVertex structures of PolyCommand pCommand.
+ */
+#define PolyCommandBuffer_GetVerticesM(pThis, pCommand)\
+	(&((pThis)->arVertices[(pCommand)->nFirstVertex]))
+
+#endif
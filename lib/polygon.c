@@ -183,6 +183,9 @@ void Polygon_ExtractPlane(struct Polygon *pThis,
 *       structure.
 * Post : If the returnvalue is 0, a memory failure occured, otherwise
 *        the specified Polygon is now linked to the ColorManager.
+*        The 16 bit pixel value of the Polygon's color is computed
+*        as well, as the truecolor rendermodes don't need a
+*        ColorManager but do need that.
 ********************************************************************/
 int Polygon_LinkToColorManager(struct Polygon *pThis,
 				 struct ColorManager *pColorManager)
@@ -190,6 +193,8 @@ int Polygon_LinkToColorManager(struct Polygon *pThis,
 	struct Lightmap1 *pLmap1;
 	struct Lightmap256 *pLmap256;
 
+	pThis->usRGB565 = ColorManager_RGBTo565M(pThis->ulRGB);
+
 	/* The type of colors required is dependant on the type
 	 * of shading that is to be applied to the polygon. */
 	switch (pThis->nFlags)
@@ -211,6 +216,33 @@ int Polygon_LinkToColorManager(struct Polygon *pThis,
 				return 0;		/* Memory failure. */
 			pThis->pLightmap = (void *)pLmap256;
 		}break;
+
+		case PF_TRANSLUCENT :
+		{	/* Static color that's blended with what's behind it, it
+			 * needs a blend table besides it's color. */
+			pLmap1 = ColorManager_GetLightmap1(pColorManager, pThis->ulRGB);
+			if (pLmap1 == NULL)
+				return 0;		/* Memory failure. */
+			pThis->pLightmap = (void *)pLmap1;
+			ColorManager_RequestBlendTableM(pColorManager);
+		}break;
+
+		case PF_CHROME :
+		{	/* Chrome mapped, the colors are those of the TextureMap
+			 * which requests them itself. */
+		}break;
+
+		case PF_TEXTURE :
+		{	/* Texture mapped, as chrome mapped. If no TextureMap
+			 * was ever assigned, fall back to the static color. */
+			if (pThis->pLightmap == NULL)
+			{	pLmap1 = ColorManager_GetLightmap1(pColorManager, pThis->ulRGB);
+				if (pLmap1 == NULL)
+					return 0;		/* Memory failure. */
+				pThis->nFlags = PF_STATICCOLOR;
+				pThis->pLightmap = (void *)pLmap1;
+			}
+		}break;
 	}
 	return 1;
 }
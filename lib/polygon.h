@@ -31,6 +31,7 @@
 #include "vector.h"
 #include "plane.h"
 #include "indexset.h"
+#include "floatset.h"
 #include "vertxset.h"
 #include "colormgr.h"
 
@@ -42,6 +43,24 @@ enum POLFLAGS {
 										 * affected by lighting conditions,
 										 * pLightmap points to a Lightmap256
 										 * structure. */
+	PF_CHROME = 3,					/* Polygon is chrome (environment)
+										 * mapped, pLightmap points to a
+										 * TextureMap structure that is
+										 * attached and prepared by the
+										 * owner of the texture. */
+	PF_TEXTURE = 4,				/* Polygon is texture mapped using the
+										 * TexCoords of the polygon, pLightmap
+										 * points to a TextureMap
+										 * structure that is attached and
+										 * prepared by the owner of the
+										 * texture. */
+	PF_TRANSLUCENT = 5,			/* Polygon has a single color that is
+										 * blended half and half with what's
+										 * behind it, pLightmap points to a
+										 * Lightmap1 structure. Span buffer
+										 * and scanline drawing draw it
+										 * opaque, see
+										 * Viewpoint_SetDrawmode(). */
 	PF_DUMMY							/* Dummy to end of enumeration. */
 };
 
@@ -56,10 +75,20 @@ struct Polygon
 										 * This point to any type of structure,
 										 * depending on the contents of nFlags. */
 	unsigned long ulRGB;			/* RGB color (0xRRGGBB) of the polygon. */
+	unsigned short usRGB565;	/* ulRGB as a 16 bit RGB565 pixel, computed
+										 * by Polygon_LinkToColorManager(). */
 	struct IndexSet Vertices;	/* Indices to all vertices in the polygon.
 										 * The VertexSet that the indices point in
 										 * are not specified at a polygon level but
 										 * are specified per polyhedron. */
+	struct FloatSet TexCoords;	/* Texture map coordinates (U, V) at every
+										 * vertex, in the order of Vertices, or
+										 * none at all. 0..1 spans the texture
+										 * once, used by PF_TEXTURE polygons.
+										 * They are kept with the polygon
+										 * instead of the vertex, so polygons
+										 * sharing a vertex can map it to
+										 * different texels. */
 };
 
 /* Polygon_Construct(pThis),
@@ -72,7 +101,9 @@ void Polygon_Construct(struct Polygon *pThis);
 (	(pThis)->nFlags = PF_STATICCOLOR,\
 	(pThis)->pLightmap = NULL,\
 	IndexSet_ConstructM(&((pThis)->Vertices)),\
-	(pThis)->ulRGB = 0xFFFFFF\
+	FloatSet_ConstructM(&((pThis)->TexCoords)),\
+	(pThis)->ulRGB = 0xFFFFFF,\
+	(pThis)->usRGB565 = 0xFFFF\
 )
 
 /* Polygon_Destruct(pThis),
@@ -82,7 +113,9 @@ void Polygon_Construct(struct Polygon *pThis);
  */
 void Polygon_Destruct(struct Polygon *pThis);
 #define Polygon_DestructM(pThis)\
-	IndexSet_Destruct(&((pThis)->Vertices))
+(	IndexSet_Destruct(&((pThis)->Vertices)),\
+	FloatSet_Destruct(&((pThis)->TexCoords))\
+)
 
 /* Polygon_CloneM(pThis, pSrc),
  * Clones pSrc into pThis. Both pThis and pSrc MUST be initialized
@@ -91,13 +124,15 @@ void Polygon_Destruct(struct Polygon *pThis);
  * of such Lightmap is NOT incremented. pThis should therefore only be
  * used as a temporary polygon or you should increment the count
  * yourself.
- * Returnvalue is that of IndexSet_Clone(). (0 = failure, 1 = success).
+ * Returnvalue is 0 on a memory failure, 1 on success.
  */
 #define Polygon_CloneM(pThis, pSrc)\
 (	(pThis)->nFlags = (pSrc)->nFlags,\
 	(pThis)->pLightmap = (pSrc)->pLightmap,\
 	(pThis)->ulRGB = (pSrc)->ulRGB,\
-	IndexSet_Clone(&((pSrc)->Vertices), &((pThis)->Vertices))\
+	(pThis)->usRGB565 = (pSrc)->usRGB565,\
+	IndexSet_Clone(&((pSrc)->Vertices), &((pThis)->Vertices)) &&\
+	FloatSet_Clone(&((pSrc)->TexCoords), &((pThis)->TexCoords))\
 )
 
 /* Polygon_GetCountM(pThis),
@@ -183,6 +183,7 @@ struct Polygon *PolySet_GetNew(struct PolySet *pThis)
 	{
 		/* Reset the polygon at index nCount. */
 		pThis->arPolygons[pThis->nCount].Vertices.nCount = 0;
+		pThis->arPolygons[pThis->nCount].TexCoords.nCount = 0;
 		pThis->arPolygons[pThis->nCount].pLightmap = NULL;
 		/* Increment nCount. */
 		pThis->nCount ++;
@@ -194,6 +195,7 @@ struct Polygon *PolySet_GetNew(struct PolySet *pThis)
 		{
 			/* Reset the polygon at index nCount. */
 			pThis->arPolygons[pThis->nCount].Vertices.nCount = 0;
+			pThis->arPolygons[pThis->nCount].TexCoords.nCount = 0;
 			pThis->arPolygons[pThis->nCount].pLightmap = NULL;
 			/* Increment nCount. */
 			pThis->nCount ++;
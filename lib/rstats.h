@@ -0,0 +1,71 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : rstats.h
+* Purpose : Header file for the RenderStats structure.
+* Description : The RenderStats structure counts what happened to the
+*               polygons that were drawn in a frame. It only holds
+*               counters, so there is no destructor and no source
+*               file.
+********************************************************************/
+
+#ifndef RSTATS_H
+#define RSTATS_H
+
+struct RenderStats
+{
+	long	lPolygons;	/* Polygons scan converted by the fills. */
+	long	lTiny;		/* Polygons covering at most a few pixels,
+							 * plotted in a single color. */
+	long	lHalfSpace;	/* Small convex polygons filled by a
+							 * HalfSpace rather than an EdgeTable. */
+	long	lRejected;	/* Polygons on a single scanline, which
+							 * cover no pixels and were not drawn. */
+	long	lMerged;		/* Polygons whose spans were coalesced with
+							 * those of the polygon before it, and
+							 * filled along with it. */
+};
+
+/* RenderStats_ConstructM(pThis),
+ * Initializes a RenderStats structure, all counters are 0.
+ */
+#define RenderStats_ConstructM(pThis)\
+	((pThis)->lPolygons = 0,\
+	 (pThis)->lTiny = 0,\
+	 (pThis)->lHalfSpace = 0,\
+	 (pThis)->lRejected = 0,\
+	 (pThis)->lMerged = 0)
+
+/* RenderStats_ClearM(pThis),
+ * Sets all counters back to 0.
+ */
+#define RenderStats_ClearM(pThis)\
+	RenderStats_ConstructM(pThis)
+
+/* RenderStats_AddM(pThis, pSrc),
+ * Adds the counters of RenderStats pSrc to those of pThis.
+ */
+#define RenderStats_AddM(pThis, pSrc)\
+	((pThis)->lPolygons += (pSrc)->lPolygons,\
+	 (pThis)->lTiny += (pSrc)->lTiny,\
+	 (pThis)->lHalfSpace += (pSrc)->lHalfSpace,\
+	 (pThis)->lRejected += (pSrc)->lRejected,\
+	 (pThis)->lMerged += (pSrc)->lMerged)
+
+#endif
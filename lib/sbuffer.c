@@ -0,0 +1,203 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : sbuffer.c
+********************************************************************/
+
+#define SBUFFER_C
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "sbuffer.h"
+
+/********************************************************************
+* Function : SBuffer_Construct()
+* Purpose : Initializes an SBuffer structure.
+* Pre : pThis points to an SBuffer structure.
+* Post : pThis points to an initialized SBuffer structure.
+********************************************************************/
+void SBuffer_Construct(struct SBuffer *pThis)
+{
+	/* Call macro version. */
+	SBuffer_ConstructM(pThis);
+}
+
+/********************************************************************
+* Function : SBuffer_Destruct()
+* Purpose : Frees all memory associated with an SBuffer structure.
+* Pre : pThis points to an initialized SBuffer structure.
+* Post : pThis points to an invalid SBuffer structure that uses
+*        no more memory.
+********************************************************************/
+void SBuffer_Destruct(struct SBuffer *pThis)
+{
+	/* Call macro version. */
+	SBuffer_DestructM(pThis);
+}
+
+/********************************************************************
+* Function : SBuffer_SetSize()
+* Purpose : Sets the size of the area tracked by an SBuffer.
+* Pre : pThis points to an initialized SBuffer structure. nWidth and
+*       nHeight are the size of the area, in pixels.
+* Post : If the returnvalue is 1, pThis tracks nWidth by nHeight
+*        pixels, all of which are uncovered.
+*        If the returnvalue is 0, a memory failure occured and pThis
+*        is unchanged.
+* Note : All memory is allocated here, up front, so inserting spans
+*        never fails. As touching covered spans are merged, a
+*        scanline never holds more than (nWidth + 1) / 2 of them.
+********************************************************************/
+int SBuffer_SetSize(struct SBuffer *pThis, int nWidth, int nHeight)
+{
+	short	*pCounts, *pSpans, *pPieces;
+	int	nMaxSpans;
+
+	if (nWidth < 0)
+		nWidth = 0;
+	if (nHeight < 0)
+		nHeight = 0;
+	nMaxSpans = (nWidth + 1) / 2;
+
+	if ((nHeight > pThis->nHeight) || (nMaxSpans > pThis->nMaxSpans) ||
+		 (pThis->arSpanCounts == NULL))
+	{	/* Allocate new arrays. */
+		pCounts = (short *)malloc(sizeof(short) * (nHeight + 1));
+		pSpans = (short *)malloc(sizeof(short) * 2 * (nMaxSpans * nHeight + 1));
+		pPieces = (short *)malloc(sizeof(short) * 2 * (nMaxSpans + 1));
+		if ((pCounts == NULL) || (pSpans == NULL) || (pPieces == NULL))
+		{	/* Memory failure. */
+			free((void *)pCounts);
+			free((void *)pSpans);
+			free((void *)pPieces);
+			return 0;
+		}
+
+		/* Got the memory, free the old arrays, set the new. */
+		SBuffer_DestructM(pThis);
+		pThis->arSpanCounts = pCounts;
+		pThis->arSpans = pSpans;
+		pThis->arPieces = pPieces;
+	}
+
+	pThis->nWidth = nWidth;
+	pThis->nHeight = nHeight;
+	pThis->nMaxSpans = nMaxSpans;
+	SBuffer_Clear(pThis);
+	return 1;
+}
+
+/********************************************************************
+* Function : SBuffer_Clear()
+* Purpose : Marks all pixels of an SBuffer as uncovered.
+* Pre : pThis points to an initialized SBuffer structure.
+* Post : pThis contains no covered spans.
+********************************************************************/
+void SBuffer_Clear(struct SBuffer *pThis)
+{
+	if (pThis->arSpanCounts != NULL)
+		memset((void *)pThis->arSpanCounts, 0, sizeof(short) * pThis->nHeight);
+	pThis->nFullLines = 0;
+}
+
+/********************************************************************
+* Function : SBuffer_InsertSpan()
+* Purpose : Marks a span as covered and returns the parts of it that
+*           weren't covered yet.
+* Pre : pThis points to an initialized SBuffer structure. nStart up
+*       to (not including) nEnd on scanline nY is the span.
+* Post : The span, clipped to the area of pThis, is now covered. The
+*        returnvalue is the number of pieces of it that were not
+*        covered before, their start and (exclusive) end X are stored
+*        in pThis->arPieces.
+********************************************************************/
+int SBuffer_InsertSpan(struct SBuffer *pThis, int nY, int nStart, int nEnd)
+{
+	short	*pSpans;		/* Covered spans of the scanline. */
+	short	*pPiece;
+	int	nCount;		/* Number of covered spans. */
+	int	i, j, k;
+	int	x;
+
+	/* Clip the span to the area. */
+	if ((nY < 0) || (nY >= pThis->nHeight))
+		return 0;
+	if (nStart < 0)
+		nStart = 0;
+	if (nEnd > pThis->nWidth)
+		nEnd = pThis->nWidth;
+	if (nStart >= nEnd)
+		return 0;
+
+	pSpans = pThis->arSpans + 2 * pThis->nMaxSpans * nY;
+	nCount = pThis->arSpanCounts[nY];
+
+	/* Find the first covered span i that ends at or after nStart,
+	 * and the first covered span j that starts after nEnd. Covered
+	 * spans i up to (not including) j overlap or touch the new
+	 * span. */
+	i = 0;
+	while ((i < nCount) && (pSpans[2 * i + 1] < nStart))
+		i++;
+	j = i;
+	while ((j < nCount) && (pSpans[2 * j] <= nEnd))
+		j++;
+
+	/* Collect the gaps between them. */
+	pPiece = pThis->arPieces;
+	x = nStart;
+	for (k = i; k < j; k++)
+	{	if (pSpans[2 * k] > x)
+		{	*(pPiece++) = (short)x;
+			*(pPiece++) = pSpans[2 * k];
+		}
+		x = pSpans[2 * k + 1];
+	}
+	if (x < nEnd)
+	{	*(pPiece++) = (short)x;
+		*(pPiece++) = (short)nEnd;
+	}
+
+	/* Fully covered already, nothing changes. */
+	if (pPiece == pThis->arPieces)
+		return 0;
+
+	/* Replace covered spans i..j-1 by a single span that also covers
+	 * the new span. */
+	if (i < j)
+	{	if (pSpans[2 * i] < nStart)
+			nStart = pSpans[2 * i];
+		if (pSpans[2 * (j - 1) + 1] > nEnd)
+			nEnd = pSpans[2 * (j - 1) + 1];
+	}
+	if (j - i != 1)
+		memmove((void *)(pSpans + 2 * (i + 1)), (void *)(pSpans + 2 * j),
+				  sizeof(short) * 2 * (nCount - j));
+	pSpans[2 * i] = (short)nStart;
+	pSpans[2 * i + 1] = (short)nEnd;
+	nCount += 1 - (j - i);
+	pThis->arSpanCounts[nY] = (short)nCount;
+
+	/* Keep track of full scanlines. */
+	if ((nCount == 1) && (nStart == 0) && (nEnd == pThis->nWidth))
+		pThis->nFullLines++;
+
+	return (int)(pPiece - pThis->arPieces) / 2;
+}
@@ -0,0 +1,134 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : sbuffer.h
+* Purpose : Header file for the SBuffer structure.
+* Description : The SBuffer (span buffer) keeps track of the parts of
+*               the bitmap that have already been drawn. For each
+*               scanline it maintains a sorted list of covered spans.
+*               When polygons are drawn front to back, only the parts
+*               of a span that are not yet covered need to be
+*               written, which removes all overdraw.
+********************************************************************/
+
+#ifndef SBUFFER_H
+#define SBUFFER_H
+
+struct SBuffer
+{
+	/* Size of the area that is tracked. Spans are clipped to the
+	 * columns 0 up to (not including) nWidth and scanlines outside
+	 * 0..nHeight-1 are ignored. */
+	int	nWidth;
+	int	nHeight;
+
+	/* Maximum number of covered spans on a single scanline. Covered
+	 * spans that touch are merged, so there's at least one uncovered
+	 * pixel between any two of them. */
+	int	nMaxSpans;
+
+	/* Array containing nHeight shorts which describe the number of
+	 * covered spans on each scanline. */
+	short	*arSpanCounts;
+
+	/* Array containing nHeight * nMaxSpans pairs of shorts, the
+	 * start and (exclusive) end X of the covered spans of each
+	 * scanline, sorted from left to right. */
+	short	*arSpans;
+
+	/* Array containing nMaxSpans + 1 pairs of shorts, the uncovered
+	 * pieces of the last span inserted. */
+	short	*arPieces;
+
+	/* Number of scanlines that are fully covered. */
+	int	nFullLines;
+};
+
+/* SBuffer_Construct(pThis),
+ * SBuffer_ConstructM(pThis),
+ * Initializes an SBuffer, it tracks no area at all.
+ */
+void SBuffer_Construct(struct SBuffer *pThis);
+#define SBuffer_ConstructM(pThis)\
+(	(pThis)->nWidth = 0,\
+	(pThis)->nHeight = 0,\
+	(pThis)->nMaxSpans = 0,\
+	(pThis)->arSpanCounts = NULL,\
+	(pThis)->arSpans = NULL,\
+	(pThis)->arPieces = NULL,\
+	(pThis)->nFullLines = 0\
+)
+
+/* SBuffer_Destruct(pThis),
+ * SBuffer_DestructM(pThis), (NEEDS stdlib.h INCLUDED)
+ * Frees all memory associated with an SBuffer structure.
+ */
+void SBuffer_Destruct(struct SBuffer *pThis);
+#define SBuffer_DestructM(pThis)\
+(	(NULL != (pThis)->arSpanCounts) ?\
+	(	free((void *)(pThis)->arSpanCounts)\
+	):(0),\
+	(NULL != (pThis)->arSpans) ?\
+	(	free((void *)(pThis)->arSpans)\
+	):(0),\
+	(NULL != (pThis)->arPieces) ?\
+	(	free((void *)(pThis)->arPieces)\
+	):(0)\
+)
+
+/* SBuffer_SetSize(pThis, nWidth, nHeight),
+ * Sets the size of the area tracked by the SBuffer and clears it.
+ * Memory is only reallocated when the area grows.
+ * Returns 1 if succesful, 0 otherwise (memory allocation failure).
+ */
+int SBuffer_SetSize(struct SBuffer *pThis, int nWidth, int nHeight);
+
+/* SBuffer_Clear(pThis),
+ * Marks the whole area of an SBuffer as uncovered.
+ */
+void SBuffer_Clear(struct SBuffer *pThis);
+
+/* SBuffer_InsertSpan(pThis, nY, nStart, nEnd),
+ * Marks the span nStart up to (not including) nEnd on scanline nY as
+ * covered. Returns the number of pieces of the span that were not
+ * covered before, these are stored as start and end pairs in
+ * pThis->arPieces, from left to right.
+ */
+int SBuffer_InsertSpan(struct SBuffer *pThis, int nY, int nStart, int nEnd);
+
+/* SBuffer_GetSpanCountM(pThis, nY),
+ * Retrieves the number of covered spans on scanline nY.
+ */
+#define SBuffer_GetSpanCountM(pThis, nY)\
+	((pThis)->arSpanCounts[(nY)])
+
+/* SBuffer_GetSpansM(pThis, nY),
+ * Retrieves a pointer to the start and end pairs of the covered
+ * spans on scanline nY, sorted from left to right.
+ */
+#define SBuffer_GetSpansM(pThis, nY)\
+	((pThis)->arSpans + 2 * (pThis)->nMaxSpans * (nY))
+
+/* SBuffer_IsFullM(pThis),
+ * Returns non zero if the whole area of the SBuffer is covered.
+ */
+#define SBuffer_IsFullM(pThis)\
+	((pThis)->nFullLines >= (pThis)->nHeight)
+
+#endif
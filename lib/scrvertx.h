@@ -22,12 +22,13 @@
 * Description : The ScreenVertex structure describes a vertex in 2D
 *               coordinates where they would appear on screen.
 *               It also stores things like intensity of light at the
-*               vertex (for gouraud shading) and X and Y chrome
-*               map coordinates.
-*               Note that texture mapping coordinates can NOT be
-*               stored in the ScreenVertex structure because multiple
-*               polygons can have different textures while using the
-*               same vertices.
+*               vertex (for gouraud shading), X and Y chrome map
+*               coordinates and the texture map coordinates divided
+*               by depth.
+*               Texture map coordinates belong to the polygon, not
+*               the vertex, so they are only filled in for a copy of
+*               the ScreenVertex made for the textured polygon being
+*               drawn, see Actor_GetScreenVertex().
 ********************************************************************/
 
 #ifndef SCRVERTX_H
@@ -43,6 +44,13 @@ struct ScreenVertex
 	
 	short				nCX, nCY;	/* X and Y coordinates for chrome
 										 * mapping. */
+
+	float				fIZ;			/* 1 / Z of the vertex in view space. */
+	float				fUZ, fVZ;	/* Texture map coordinates (in texels)
+										 * multiplied by fIZ. These are linear in
+										 * screen space, unlike the coordinates
+										 * themselves. Only set for the vertices
+										 * of a textured polygon being drawn. */
 };
 
 /* ScreenVertex_ConstructM(pThis),
@@ -56,7 +64,10 @@ struct ScreenVertex
 	(pThis)->nY = 0,\
 	(pThis)->nIntensity = 255,\
 	(pThis)->nCX = 0,\
-	(pThis)->nCY = 0\
+	(pThis)->nCY = 0,\
+	(pThis)->fIZ = 0.f,\
+	(pThis)->fUZ = 0.f,\
+	(pThis)->fVZ = 0.f\
 )
 
 #endif
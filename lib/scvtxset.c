@@ -96,6 +96,32 @@ int ScreenVertexSet_Expand(struct ScreenVertexSet *pThis)
 	}
 }
 
+/********************************************************************
+* Function : ScreenVertexSet_AtLeast()
+* Purpose : Guarantees that there's space for a number of screen
+*           vertices in a ScreenVertexSet structure.
+* Pre : pThis points to an initialized ScreenVertexSet structure.
+* Post : If the returnvalue is 1, pThis has at least nCount screen
+*        vertices allocated, the ones in use are unchanged.
+*        If the returnvalue is 0, a memory allocation failure
+*        occured.
+********************************************************************/
+int ScreenVertexSet_AtLeast(struct ScreenVertexSet *pThis, int nCount)
+{
+	struct ScreenVertex *p;
+
+	if (pThis->nAlloc >= nCount)
+		return 1;	/* Already enough. */
+
+	p = (struct ScreenVertex *)realloc((void *)pThis->arScrVertices,
+												  sizeof(struct ScreenVertex) * nCount);
+	if (p == NULL)
+		return 0;	/* Memory allocation failure. */
+	pThis->arScrVertices = p;
+	pThis->nAlloc = nCount;
+	return 1;
+}
+
 /********************************************************************
 * Function : ScreenVertexSet_Add()
 * Purpose : Adds a new ScreenVertex to a ScreenVertexSet structure.
@@ -70,6 +70,13 @@ void ScreenVertexSet_Destruct(struct ScreenVertexSet *pThis);
  */
 int ScreenVertexSet_Expand(struct ScreenVertexSet *pThis);
 
+/* ScreenVertexSet_AtLeast(pThis, nCount),
+ * Guarantees that there are at least nCount screen vertices allocated,
+ * those in use are kept.
+ * Returns 1 if succesful, 0 otherwise (memory allocation failure).
+ */
+int ScreenVertexSet_AtLeast(struct ScreenVertexSet *pThis, int nCount);
+
 /* ScreenVertexSet_Add(pThis, pScrVertex),
  * ScreenVertexSet_AddM(pThis, pScrVertex),
  * Adds a new ScreenVertex structure to the ScreenVertexSet structure.
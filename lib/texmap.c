@@ -118,6 +118,7 @@ int TextureMap_Prepare(struct TextureMap *pThis)
 int TextureMap_ReadTex(struct TextureMap *pThis, FILE *fp)
 {
 	char HeadMarker[5];
+	unsigned char ColorCount[4];
 	unsigned long ulColors;
 	unsigned long n;
 	unsigned char red, green, blue;
@@ -130,9 +131,15 @@ int TextureMap_ReadTex(struct TextureMap *pThis, FILE *fp)
 		if (0 == strncmp(HeadMarker, "TEX0", 4))
 		{
 			/* Header matches, read the number of colors in the color
-			 * table. */
-			if (1 == fread((void *)&ulColors, sizeof(unsigned long), 1, fp))
+			 * table. This is a 32 bit little endian value, whatever
+			 * the size of a long. */
+			if (4 == fread((void *)ColorCount, 1, 4, fp))
 			{
+				ulColors = (unsigned long)ColorCount[0] |
+							  ((unsigned long)ColorCount[1] << 8) |
+							  ((unsigned long)ColorCount[2] << 16) |
+							  ((unsigned long)ColorCount[3] << 24);
+
 				/* Make sure the number of colors is reasonable. */
 				if (ulColors <= 256)
 				{
@@ -144,6 +151,7 @@ int TextureMap_ReadTex(struct TextureMap *pThis, FILE *fp)
 							(1 == fread((void *)&blue, sizeof(unsigned char), 1, fp)))
 						{
 							pThis->aulPalette[n] = red * 256 * 256 + green * 256 + blue;
+							pThis->ausPalette565[n] = ColorManager_RGBTo565M(pThis->aulPalette[n]);
 						} else
 						{
 							/* Read failure, stop here.
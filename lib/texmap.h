@@ -40,6 +40,9 @@ struct TextureMap
 									/* Original Bitmap data,
 									 * from Left to Right, Top to Bottom.
 									 * Values index colors in aulPalette. */
+	unsigned short	ausPalette565[256];
+									/* aulPalette as 16 bit RGB565 pixel values,
+									 * filled in by TextureMap_ReadTex(). */
 	struct Lightmap1	*arpLMaps[256];
 									/* Assigned Lightmap1 colors. */
 
@@ -59,6 +62,7 @@ struct TextureMap
 	/* Clear palette & lightmaps */\
 	for (n = 0; n < 256; n++)\
 	{	(pThis)->aulPalette[n] = 0;\
+		(pThis)->ausPalette565[n] = 0;\
 		(pThis)->arpLMaps[n] = NULL;\
 	}\
 	/* No colors as default. */\
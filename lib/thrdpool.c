@@ -0,0 +1,372 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : thrdpool.c
+********************************************************************/
+
+#define THRDPOOL_C
+
+#include <stdlib.h>
+
+#include "thrdpool.h"
+
+#if defined(CHROME_POSIX_THREADS)
+#include <pthread.h>
+#include <unistd.h>
+#elif defined(CHROME_WIN32_THREADS)
+#include <windows.h>
+#endif
+
+#if defined(CHROME_POSIX_THREADS) || defined(CHROME_WIN32_THREADS)
+
+/* Thin wrappers so the pool itself is written only once. */
+#ifdef CHROME_POSIX_THREADS
+typedef pthread_mutex_t	ThreadPool_Mutex;
+typedef pthread_cond_t	ThreadPool_Cond;
+typedef pthread_t			ThreadPool_Thread;
+#define ThreadPool_LockM(p)			pthread_mutex_lock(p)
+#define ThreadPool_UnlockM(p)			pthread_mutex_unlock(p)
+#define ThreadPool_WaitM(c, m)		pthread_cond_wait(c, m)
+#define ThreadPool_SignalAllM(c)		pthread_cond_broadcast(c)
+#else
+typedef CRITICAL_SECTION	ThreadPool_Mutex;
+typedef CONDITION_VARIABLE	ThreadPool_Cond;
+typedef HANDLE				ThreadPool_Thread;
+#define ThreadPool_LockM(p)			EnterCriticalSection(p)
+#define ThreadPool_UnlockM(p)			LeaveCriticalSection(p)
+#define ThreadPool_WaitM(c, m)		SleepConditionVariableCS(c, m, INFINITE)
+#define ThreadPool_SignalAllM(c)		WakeAllConditionVariable(c)
+#endif
+
+struct ThreadPoolSys
+{
+	ThreadPool_Mutex	Mutex;		/* Protects everything below. */
+	ThreadPool_Cond	WorkCond;	/* Signalled when a job is started or
+											 * the workers should quit. */
+	ThreadPool_Cond	DoneCond;	/* Signalled when the last busy worker
+											 * finishes. */
+
+	ThreadPool_JobFunc	pJob;		/* Current job. */
+	void	*pData;
+	int	nItems;						/* Number of items in the job. */
+	int	nNext;						/* Next item to process. */
+	int	nBusy;						/* Number of workers processing items. */
+	unsigned long	ulGeneration;	/* Incremented for every job. */
+	int	bQuit;						/* Set when the workers should quit. */
+
+	int	nWorkers;					/* Number of workers started. */
+	ThreadPool_Thread	arThreads[THREADPOOL_MAXTHREADS];
+};
+
+/* Start data for a worker thread, the pool and the thread's
+ * number. */
+struct ThreadPoolStart
+{
+	struct ThreadPoolSys	*pSys;
+	int	nThread;
+};
+
+/********************************************************************
+* Function : ThreadPool_Work()
+* Purpose : Processes items of the current job of a ThreadPool until
+*           there are none left.
+* Pre : The mutex of pSys is locked, nThread is the number of the
+*       calling thread.
+* Post : All items of the current job have been taken, the mutex is
+*        still locked.
+********************************************************************/
+static void ThreadPool_Work(struct ThreadPoolSys *pSys, int nThread)
+{
+	int n;
+	while (pSys->nNext < pSys->nItems)
+	{	n = pSys->nNext++;
+		ThreadPool_UnlockM(&(pSys->Mutex));
+		pSys->pJob(pSys->pData, n, nThread);
+		ThreadPool_LockM(&(pSys->Mutex));
+	}
+}
+
+/********************************************************************
+* Function : ThreadPool_WorkerMain()
+* Purpose : Main loop of a worker thread, waits for jobs and helps
+*           processing them until the pool quits.
+* Pre : pStart points to the ThreadPoolStart of the worker.
+* Post : The pool has quit.
+********************************************************************/
+static void ThreadPool_WorkerMain(struct ThreadPoolStart *pStart)
+{
+	struct ThreadPoolSys *pSys;
+	unsigned long ulGeneration;
+	int nThread;
+
+	pSys = pStart->pSys;
+	nThread = pStart->nThread;
+	free((void *)pStart);
+
+	ThreadPool_LockM(&(pSys->Mutex));
+	ulGeneration = pSys->ulGeneration;
+	for (;;)
+	{	/* Wait for a new job. */
+		while (!pSys->bQuit && (ulGeneration == pSys->ulGeneration))
+			ThreadPool_WaitM(&(pSys->WorkCond), &(pSys->Mutex));
+		if (pSys->bQuit)
+			break;
+		ulGeneration = pSys->ulGeneration;
+
+		pSys->nBusy++;
+		ThreadPool_Work(pSys, nThread);
+		if (--(pSys->nBusy) == 0)
+			ThreadPool_SignalAllM(&(pSys->DoneCond));
+	}
+	ThreadPool_UnlockM(&(pSys->Mutex));
+}
+
+#ifdef CHROME_POSIX_THREADS
+static void *ThreadPool_PosixMain(void *pStart)
+{
+	ThreadPool_WorkerMain((struct ThreadPoolStart *)pStart);
+	return NULL;
+}
+#else
+static DWORD WINAPI ThreadPool_Win32Main(LPVOID pStart)
+{
+	ThreadPool_WorkerMain((struct ThreadPoolStart *)pStart);
+	return 0;
+}
+#endif
+
+/********************************************************************
+* Function : ThreadPool_Stop()
+* Purpose : Stops the workers of a ThreadPool and frees their
+*           resources.
+* Pre : pThis points to an initialized ThreadPool structure.
+* Post : pThis has no workers.
+********************************************************************/
+static void ThreadPool_Stop(struct ThreadPool *pThis)
+{
+	struct ThreadPoolSys *pSys;
+	int n;
+
+	pSys = pThis->pSys;
+	if (pSys != NULL)
+	{	ThreadPool_LockM(&(pSys->Mutex));
+		pSys->bQuit = 1;
+		ThreadPool_SignalAllM(&(pSys->WorkCond));
+		ThreadPool_UnlockM(&(pSys->Mutex));
+		for (n = 0; n < pSys->nWorkers; n++)
+		{
+#ifdef CHROME_POSIX_THREADS
+			pthread_join(pSys->arThreads[n], NULL);
+#else
+			WaitForSingleObject(pSys->arThreads[n], INFINITE);
+			CloseHandle(pSys->arThreads[n]);
+#endif
+		}
+#ifdef CHROME_POSIX_THREADS
+		pthread_cond_destroy(&(pSys->DoneCond));
+		pthread_cond_destroy(&(pSys->WorkCond));
+		pthread_mutex_destroy(&(pSys->Mutex));
+#else
+		DeleteCriticalSection(&(pSys->Mutex));
+#endif
+		free((void *)pSys);
+	}
+	pThis->pSys = NULL;
+	pThis->nThreads = 1;
+}
+
+#endif /* Thread support. */
+
+/********************************************************************
+* Function : ThreadPool_Construct()
+* Purpose : Initializes a ThreadPool structure.
+* Pre : pThis points to a ThreadPool structure.
+* Post : pThis points to an initialized ThreadPool without workers.
+********************************************************************/
+void ThreadPool_Construct(struct ThreadPool *pThis)
+{
+	/* Call macro version. */
+	ThreadPool_ConstructM(pThis);
+}
+
+/********************************************************************
+* Function : ThreadPool_Destruct()
+* Purpose : Stops all workers and frees all memory associated with a
+*           ThreadPool structure.
+* Pre : pThis points to an initialized ThreadPool structure that
+*       isn't running a job.
+* Post : pThis points to an invalid ThreadPool structure that uses no
+*        more memory or threads.
+********************************************************************/
+void ThreadPool_Destruct(struct ThreadPool *pThis)
+{
+#if defined(CHROME_POSIX_THREADS) || defined(CHROME_WIN32_THREADS)
+	ThreadPool_Stop(pThis);
+#endif
+	pThis->pSys = NULL;
+}
+
+/********************************************************************
+* Function : ThreadPool_GetProcessorCount()
+* Purpose : Determines the number of processors.
+* Pre : -
+* Post : Returns the number of processors that are online, or 1 if
+*        it can't be determined.
+********************************************************************/
+int ThreadPool_GetProcessorCount(void)
+{
+	long n;
+#if defined(CHROME_POSIX_THREADS) && defined(_SC_NPROCESSORS_ONLN)
+	n = sysconf(_SC_NPROCESSORS_ONLN);
+#elif defined(CHROME_WIN32_THREADS)
+	SYSTEM_INFO Info;
+	GetSystemInfo(&Info);
+	n = (long)Info.dwNumberOfProcessors;
+#else
+	n = 1;
+#endif
+	return (n < 1) ? 1 : (int)n;
+}
+
+/********************************************************************
+* Function : ThreadPool_Start()
+* Purpose : Starts the worker threads of a ThreadPool.
+* Pre : pThis points to an initialized ThreadPool structure that
+*       isn't running a job. nThreads is the number of threads that
+*       should process jobs, 0 for one per processor.
+* Post : If the returnvalue is 1, pThis uses nThreads threads (at
+*        most THREADPOOL_MAXTHREADS), or just the calling thread if
+*        there is no thread support.
+*        If the returnvalue is 0, memory or threads could not be
+*        allocated and pThis has no workers.
+********************************************************************/
+int ThreadPool_Start(struct ThreadPool *pThis, int nThreads)
+{
+#if defined(CHROME_POSIX_THREADS) || defined(CHROME_WIN32_THREADS)
+	struct ThreadPoolSys *pSys;
+	struct ThreadPoolStart *pStart;
+	int n;
+	int bFailed;
+
+	ThreadPool_Stop(pThis);
+
+	if (nThreads <= 0)
+		nThreads = ThreadPool_GetProcessorCount();
+	if (nThreads > THREADPOOL_MAXTHREADS)
+		nThreads = THREADPOOL_MAXTHREADS;
+	if (nThreads == 1)
+		return 1;	/* No workers needed. */
+
+	pSys = (struct ThreadPoolSys *)malloc(sizeof(struct ThreadPoolSys));
+	if (pSys == NULL)
+		return 0;	/* Memory failure. */
+#ifdef CHROME_POSIX_THREADS
+	pthread_mutex_init(&(pSys->Mutex), NULL);
+	pthread_cond_init(&(pSys->WorkCond), NULL);
+	pthread_cond_init(&(pSys->DoneCond), NULL);
+#else
+	InitializeCriticalSection(&(pSys->Mutex));
+	InitializeConditionVariable(&(pSys->WorkCond));
+	InitializeConditionVariable(&(pSys->DoneCond));
+#endif
+	pSys->pJob = NULL;
+	pSys->pData = NULL;
+	pSys->nItems = 0;
+	pSys->nNext = 0;
+	pSys->nBusy = 0;
+	pSys->ulGeneration = 0;
+	pSys->bQuit = 0;
+	pSys->nWorkers = 0;
+	pThis->pSys = pSys;
+
+	/* Start the workers, the calling thread is thread 0. */
+	bFailed = 0;
+	for (n = 1; !bFailed && (n < nThreads); n++)
+	{	pStart = (struct ThreadPoolStart *)malloc(sizeof(struct ThreadPoolStart));
+		if (pStart == NULL)
+		{	bFailed = 1;
+			break;
+		}
+		pStart->pSys = pSys;
+		pStart->nThread = n;
+#ifdef CHROME_POSIX_THREADS
+		bFailed = (0 != pthread_create(&(pSys->arThreads[pSys->nWorkers]), NULL,
+												 ThreadPool_PosixMain, (void *)pStart));
+#else
+		pSys->arThreads[pSys->nWorkers] = CreateThread(NULL, 0, ThreadPool_Win32Main,
+																	  (LPVOID)pStart, 0, NULL);
+		bFailed = (pSys->arThreads[pSys->nWorkers] == NULL);
+#endif
+		if (bFailed)
+			free((void *)pStart);
+		else
+			pSys->nWorkers++;
+	}
+
+	if (bFailed)
+	{	/* Clean up whatever was started. */
+		ThreadPool_Stop(pThis);
+		return 0;
+	}
+	pThis->nThreads = nThreads;
+#endif
+	return 1;
+}
+
+/********************************************************************
+* Function : ThreadPool_Run()
+* Purpose : Processes all items of a job on the threads of a
+*           ThreadPool.
+* Pre : pThis points to an initialized ThreadPool structure, pJob is
+*       the function processing an item of the job and pData is
+*       passed to it. nItems is the number of items.
+* Post : pJob has been called for all items 0..nItems-1 and has
+*        returned for all of them.
+********************************************************************/
+void ThreadPool_Run(struct ThreadPool *pThis, ThreadPool_JobFunc pJob,
+						  void *pData, int nItems)
+{
+#if defined(CHROME_POSIX_THREADS) || defined(CHROME_WIN32_THREADS)
+	struct ThreadPoolSys *pSys;
+
+	pSys = pThis->pSys;
+	if ((pSys != NULL) && (nItems > 1))
+	{	/* Hand the job to the workers and help out. */
+		ThreadPool_LockM(&(pSys->Mutex));
+		pSys->pJob = pJob;
+		pSys->pData = pData;
+		pSys->nItems = nItems;
+		pSys->nNext = 0;
+		pSys->ulGeneration++;
+		ThreadPool_SignalAllM(&(pSys->WorkCond));
+		ThreadPool_Work(pSys, 0);
+
+		/* Wait for the workers still processing an item. */
+		while (pSys->nBusy > 0)
+			ThreadPool_WaitM(&(pSys->DoneCond), &(pSys->Mutex));
+		ThreadPool_UnlockM(&(pSys->Mutex));
+		return;
+	}
+#endif
+	{	/* No workers, do it all ourselves. */
+		int n;
+		for (n = 0; n < nItems; n++)
+			pJob(pData, n, 0);
+	}
+}
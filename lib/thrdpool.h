@@ -0,0 +1,102 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : thrdpool.h
+* Purpose : Header file for the ThreadPool structure.
+* Description : The ThreadPool keeps a number of worker threads
+*               around that can process the items of a job in
+*               parallel. The calling thread works on the job as
+*               well and only returns when all items are done.
+********************************************************************/
+
+#ifndef THRDPOOL_H
+#define THRDPOOL_H
+
+/* Worker threads use POSIX threads or Win32 threads, whichever the
+ * platform has. Define CHROME_NO_THREADS to process all jobs in the
+ * calling thread only. */
+#if !defined(CHROME_NO_THREADS)
+#if defined(_WIN32)
+#define CHROME_WIN32_THREADS
+#elif defined(unix) || defined(__unix__) || defined(__unix) || defined(__APPLE__)
+#define CHROME_POSIX_THREADS
+#endif
+#endif
+
+/* Maximum number of threads in a ThreadPool, including the calling
+ * thread. */
+#define THREADPOOL_MAXTHREADS	64
+
+/* ThreadPool_JobFunc,
+ * Function processing item nItem of a job, pData is the data passed
+ * to ThreadPool_Run(). nThread identifies the thread calling it,
+ * 0 for the calling thread up to (not including) the number of
+ * threads in the pool, so per thread scratch data can be used.
+ */
+typedef void (*ThreadPool_JobFunc)(void *pData, int nItem, int nThread);
+
+struct ThreadPool
+{
+	int	nThreads;						/* Number of threads, including the
+												 * calling thread. */
+	struct ThreadPoolSys *pSys;		/* Synchronisation and worker
+												 * threads, NULL when there are no
+												 * workers. */
+};
+
+/* ThreadPool_Construct(pThis),
+ * ThreadPool_ConstructM(pThis),
+ * Initializes a ThreadPool, it has no workers so all jobs are
+ * processed by the calling thread.
+ */
+void ThreadPool_Construct(struct ThreadPool *pThis);
+#define ThreadPool_ConstructM(pThis)\
+(	(pThis)->nThreads = 1,\
+	(pThis)->pSys = NULL\
+)
+
+/* ThreadPool_Destruct(pThis),
+ * Stops the worker threads and frees all memory associated with a
+ * ThreadPool.
+ */
+void ThreadPool_Destruct(struct ThreadPool *pThis);
+
+/* ThreadPool_Start(pThis, nThreads),
+ * Stops any workers and starts nThreads - 1 new ones, so jobs are
+ * processed by nThreads threads. If nThreads is 0, one thread per
+ * processor is used. Returns 1 if succesful, 0 otherwise (failed to
+ * allocate memory or start the workers, pThis then has no workers).
+ * Without thread support, this succeeds but no workers are started.
+ */
+int ThreadPool_Start(struct ThreadPool *pThis, int nThreads);
+
+/* ThreadPool_Run(pThis, pJob, pData, nItems),
+ * Calls pJob for items 0 up to (not including) nItems, spread over
+ * the threads of the pool in no particular order. Returns when all
+ * items are done. Don't call this from inside a job.
+ */
+void ThreadPool_Run(struct ThreadPool *pThis, ThreadPool_JobFunc pJob,
+						  void *pData, int nItems);
+
+/* ThreadPool_GetProcessorCount(),
+ * Returns the number of processors available, 1 if unknown.
+ */
+int ThreadPool_GetProcessorCount(void);
+
+#endif
@@ -0,0 +1,190 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : tilebin.c
+********************************************************************/
+
+#define TILEBIN_C
+
+#include <stdlib.h>
+
+#include "tilebin.h"
+
+/* Number of commands the command array grows by at least. */
+#define TILEBINS_EXPAND_SIZE	256
+
+/********************************************************************
+* Function : TileBins_Construct()
+* Purpose : Initializes a TileBins structure.
+* Pre : pThis points to a TileBins structure.
+* Post : pThis points to an initialized TileBins structure.
+********************************************************************/
+void TileBins_Construct(struct TileBins *pThis)
+{
+	/* Call macro version. */
+	TileBins_ConstructM(pThis);
+}
+
+/********************************************************************
+* Function : TileBins_Destruct()
+* Purpose : Frees all memory associated with a TileBins structure.
+* Pre : pThis points to an initialized TileBins structure.
+* Post : pThis points to an invalid TileBins structure that uses
+*        no more memory.
+********************************************************************/
+void TileBins_Destruct(struct TileBins *pThis)
+{
+	int n;
+
+	for (n = 0; n < pThis->nAllocBins; n++)
+	{	IndexSet_DestructM(&(pThis->arBins[n]));
+	}
+	if (pThis->arBins != NULL)
+		free((void *)pThis->arBins);
+	if (pThis->arCommands != NULL)
+		free((void *)pThis->arCommands);
+}
+
+/********************************************************************
+* Function : TileBins_SetSize()
+* Purpose : Divides a bitmap into tiles.
+* Pre : pThis points to an initialized TileBins structure. nWidth
+*       and nHeight are the size of the bitmap, nTileSize the size of
+*       a tile, all in pixels.
+* Post : If the returnvalue is 1, pThis has enough empty tiles to
+*        cover the bitmap.
+*        If the returnvalue is 0, a memory failure occured and pThis
+*        has no tiles.
+* Note : The bins are kept when the number of tiles shrinks, so they
+*        don't have to grow again every frame.
+********************************************************************/
+int TileBins_SetSize(struct TileBins *pThis, int nWidth, int nHeight,
+							int nTileSize)
+{
+	struct IndexSet *pBins;
+	int nBins;
+	int n;
+
+	if (nTileSize < 1)
+		nTileSize = 1;
+	if (nWidth < 0)
+		nWidth = 0;
+	if (nHeight < 0)
+		nHeight = 0;
+	pThis->nColumns = 0;
+	pThis->nRows = 0;
+
+	nBins = ((nWidth + nTileSize - 1) / nTileSize) *
+			  ((nHeight + nTileSize - 1) / nTileSize);
+	if (nBins > pThis->nAllocBins)
+	{	pBins = (struct IndexSet *)realloc((void *)pThis->arBins,
+													  sizeof(struct IndexSet) * nBins);
+		if (pBins == NULL)
+			return 0;	/* Memory failure. */
+		for (n = pThis->nAllocBins; n < nBins; n++)
+		{	IndexSet_ConstructM(&(pBins[n]));
+		}
+		pThis->arBins = pBins;
+		pThis->nAllocBins = nBins;
+	}
+
+	pThis->nTileSize = nTileSize;
+	pThis->nWidth = nWidth;
+	pThis->nHeight = nHeight;
+	pThis->nColumns = (nWidth + nTileSize - 1) / nTileSize;
+	pThis->nRows = (nHeight + nTileSize - 1) / nTileSize;
+	TileBins_Clear(pThis);
+	return 1;
+}
+
+/********************************************************************
+* Function : TileBins_Clear()
+* Purpose : Empties all tiles of a TileBins structure.
+* Pre : pThis points to an initialized TileBins structure.
+* Post : pThis holds no polygons.
+********************************************************************/
+void TileBins_Clear(struct TileBins *pThis)
+{
+	int n;
+
+	for (n = 0; n < pThis->nAllocBins; n++)
+		pThis->arBins[n].nCount = 0;
+	pThis->nCommands = 0;
+}
+
+/********************************************************************
+* Function : TileBins_Add()
+* Purpose : Adds a polygon to the tiles it overlaps.
+* Pre : pThis points to an initialized TileBins structure. pPoly is
+*       a polygon of pActor, ready for drawing, and nLeft, nTop up to
+*       (not including) nRight, nBottom is a rectangle containing all
+*       pixels it may draw.
+* Post : If the returnvalue is 1, the polygon has been added after
+*        all polygons added before to every tile that overlaps the
+*        rectangle.
+*        If the returnvalue is 0, a memory failure occured and the
+*        polygon may be missing from some of the tiles.
+********************************************************************/
+int TileBins_Add(struct TileBins *pThis, struct Actor *pActor,
+					  struct Polygon *pPoly,
+					  int nLeft, int nTop, int nRight, int nBottom)
+{
+	struct TileCommand *pCommands;
+	int nAlloc;
+	int nX, nY;
+
+	/* Clip the rectangle to the bitmap. */
+	if (nLeft < 0)
+		nLeft = 0;
+	if (nTop < 0)
+		nTop = 0;
+	if (nRight > pThis->nWidth)
+		nRight = pThis->nWidth;
+	if (nBottom > pThis->nHeight)
+		nBottom = pThis->nHeight;
+	if ((nRight <= nLeft) || (nBottom <= nTop))
+		return 1;	/* Nothing to draw. */
+
+	/* Store the command. */
+	if (pThis->nCommands == pThis->nAllocCommands)
+	{	nAlloc = pThis->nAllocCommands * 2 + TILEBINS_EXPAND_SIZE;
+		pCommands = (struct TileCommand *)realloc((void *)pThis->arCommands,
+																sizeof(struct TileCommand) * nAlloc);
+		if (pCommands == NULL)
+			return 0;	/* Memory failure. */
+		pThis->arCommands = pCommands;
+		pThis->nAllocCommands = nAlloc;
+	}
+	pThis->arCommands[pThis->nCommands].pActor = pActor;
+	pThis->arCommands[pThis->nCommands].pPoly = pPoly;
+
+	/* Add it to the tiles. */
+	nLeft /= pThis->nTileSize;
+	nTop /= pThis->nTileSize;
+	nRight = (nRight - 1) / pThis->nTileSize;
+	nBottom = (nBottom - 1) / pThis->nTileSize;
+	for (nY = nTop; nY <= nBottom; nY++)
+		for (nX = nLeft; nX <= nRight; nX++)
+			if (!IndexSet_AddM(&(pThis->arBins[nY * pThis->nColumns + nX]),
+									 pThis->nCommands))
+				return 0;	/* Memory failure. */
+
+	pThis->nCommands++;
+	return 1;
+}
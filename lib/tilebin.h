@@ -0,0 +1,129 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : tilebin.h
+* Purpose : Header file for the TileBins structure.
+* Description : The TileBins divide the bitmap into square tiles and
+*               record, for every tile, which of the polygons drawn
+*               overlap it. The polygons are kept in the order in
+*               which they were added, so each tile can be drawn on
+*               it's own, independently of the other tiles.
+********************************************************************/
+
+#ifndef TILEBIN_H
+#define TILEBIN_H
+
+#include "actor.h"
+#include "indexset.h"
+
+/* A single polygon to draw, with the Actor that holds it's
+ * ScreenVertex structures. */
+struct TileCommand
+{
+	struct Actor	*pActor;
+	struct Polygon	*pPoly;
+};
+
+struct TileBins
+{
+	/* Width and height of the tiles in pixels, and the number of
+	 * tiles horizontally and vertically. Tiles on the right and
+	 * bottom may be cut off by the edge of the bitmap. */
+	int	nTileSize;
+	int	nColumns;
+	int	nRows;
+	int	nWidth;
+	int	nHeight;
+
+	/* Array containing nAllocBins IndexSet structures, one per tile
+	 * (left to right, top to bottom) holding indices into
+	 * arCommands. */
+	int	nAllocBins;
+	struct IndexSet	*arBins;
+
+	/* Array containing all polygons added, in order. */
+	int	nCommands;
+	int	nAllocCommands;
+	struct TileCommand	*arCommands;
+};
+
+/* TileBins_Construct(pThis),
+ * TileBins_ConstructM(pThis),
+ * Initializes a TileBins structure, it has no tiles at all.
+ */
+void TileBins_Construct(struct TileBins *pThis);
+#define TileBins_ConstructM(pThis)\
+(	(pThis)->nTileSize = 0,\
+	(pThis)->nColumns = 0,\
+	(pThis)->nRows = 0,\
+	(pThis)->nWidth = 0,\
+	(pThis)->nHeight = 0,\
+	(pThis)->nAllocBins = 0,\
+	(pThis)->arBins = NULL,\
+	(pThis)->nCommands = 0,\
+	(pThis)->nAllocCommands = 0,\
+	(pThis)->arCommands = NULL\
+)
+
+/* TileBins_Destruct(pThis),
+ * Frees all memory associated with a TileBins structure.
+ */
+void TileBins_Destruct(struct TileBins *pThis);
+
+/* TileBins_SetSize(pThis, nWidth, nHeight, nTileSize),
+ * Divides a bitmap of nWidth by nHeight pixels into tiles of
+ * nTileSize by nTileSize pixels and empties all of them.
+ * Returns 1 if succesful, 0 otherwise (memory allocation failure).
+ */
+int TileBins_SetSize(struct TileBins *pThis, int nWidth, int nHeight,
+							int nTileSize);
+
+/* TileBins_Clear(pThis),
+ * Removes all polygons from the tiles.
+ */
+void TileBins_Clear(struct TileBins *pThis);
+
+/* TileBins_Add(pThis, pActor, pPoly, nLeft, nTop, nRight, nBottom),
+ * Adds polygon pPoly of Actor pActor to all tiles overlapping the
+ * rectangle nLeft, nTop up to (not including) nRight, nBottom.
+ * Returns 1 if succesful, 0 otherwise (memory allocation failure).
+ */
+int TileBins_Add(struct TileBins *pThis, struct Actor *pActor,
+					  struct Polygon *pPoly,
+					  int nLeft, int nTop, int nRight, int nBottom);
+
+/* TileBins_GetCountM(pThis),
+ * Retrieves the number of tiles.
+ */
+#define TileBins_GetCountM(pThis)\
+	((pThis)->nColumns * (pThis)->nRows)
+
+/* TileBins_GetBinM(pThis, nTile),
+ * Retrieves the IndexSet with the commands of tile nTile.
+ */
+#define TileBins_GetBinM(pThis, nTile)\
+	(&((pThis)->arBins[(nTile)]))
+
+/* TileBins_GetCommandM(pThis, nIndex),
+ * Retrieves the TileCommand at index nIndex.
+ */
+#define TileBins_GetCommandM(pThis, nIndex)\
+	(&((pThis)->arCommands[(nIndex)]))
+
+#endif
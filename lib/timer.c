@@ -0,0 +1,68 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : timer.c
+********************************************************************/
+
+#define TIMER_C
+
+#include <time.h>
+
+#include "timer.h"
+
+/* Windows has the performance counter. Elsewhere, the monotonic
+ * clock is part of the POSIX realtime extension, unistd.h tells if
+ * it's there. */
+#if defined(_WIN32)
+#define CHROME_WIN32_TIMER
+#include <windows.h>
+#elif defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#if defined(_POSIX_TIMERS) && (_POSIX_TIMERS > 0) && defined(CLOCK_MONOTONIC)
+#define CHROME_POSIX_TIMER
+#endif
+#endif
+
+/********************************************************************
+* Function : Timer_GetSeconds()
+* Purpose : Reads the high resolution clock.
+* Pre : -
+* Post : Returns the time in seconds since some fixed point in the
+*        past.
+* Note : Falls back on the processor time used by the program if
+*        there is no monotonic clock, this is only right as long as
+*        the program doesn't wait for anything.
+********************************************************************/
+double Timer_GetSeconds(void)
+{
+#if defined(CHROME_WIN32_TIMER)
+	LARGE_INTEGER Count;
+	LARGE_INTEGER Frequency;
+
+	if (QueryPerformanceFrequency(&Frequency) &&
+		 QueryPerformanceCounter(&Count))
+		return (double)Count.QuadPart / (double)Frequency.QuadPart;
+#elif defined(CHROME_POSIX_TIMER)
+	struct timespec Now;
+
+	if (0 == clock_gettime(CLOCK_MONOTONIC, &Now))
+		return (double)Now.tv_sec + (double)Now.tv_nsec * 1e-9;
+#endif
+	return (double)clock() / (double)CLOCKS_PER_SEC;
+}
@@ -0,0 +1,37 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : timer.h
+* Purpose : Header file for the high resolution timer.
+* Description : Reads a clock that only ever moves forward, at the
+*               best resolution the platform offers. It's meant for
+*               measuring how long parts of a frame take, not for
+*               telling the time of day.
+********************************************************************/
+
+#ifndef TIMER_H
+#define TIMER_H
+
+/* Timer_GetSeconds(),
+ * Returns the number of seconds passed since some fixed point in the
+ * past. Only the difference between two calls means anything.
+ */
+double Timer_GetSeconds(void);
+
+#endif
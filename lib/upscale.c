@@ -0,0 +1,333 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : upscale.c
+********************************************************************/
+
+#define UPSCALE_C
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "upscale.h"
+#include "edgetbl.h"		/* unsigned_int_32 */
+#include "cpufeat.h"
+
+#ifdef CHROME_X86_SIMD
+#include <emmintrin.h>
+#endif
+
+/* Positions in the source bitmap are 16.16 fixed point. */
+
+/* Upscale_LerpM(ulA, ulB, nW),
+ * Blends the 4 bytes of ulA and ulB, nW (0 to 256) is the weight of
+ * ulB out of 256. Two bytes are done at once, 16 bits apart. */
+#define Upscale_LerpM(ulA, ulB, nW)\
+(	(unsigned_int_32)\
+	(((((ulA) & 0x00FF00FFUL) * (256 - (nW)) +\
+		 ((ulB) & 0x00FF00FFUL) * (nW)) >> 8) & 0x00FF00FFUL) |\
+	(unsigned_int_32)\
+	((((((ulA) >> 8) & 0x00FF00FFUL) * (256 - (nW)) +\
+		 (((ulB) >> 8) & 0x00FF00FFUL) * (nW))) & 0xFF00FF00UL)\
+)
+
+/* Upscale_ColumnM(lX, nSrcWidth, nX0, nFX),
+ * Splits source position lX in the left column nX0 of the two
+ * columns to blend and the weight nFX of the right one. Positions
+ * left of the first column or right of the last one take that
+ * column whole. nSrcWidth must be at least 2. */
+#define Upscale_ColumnM(lX, nSrcWidth, nX0, nFX)\
+(	(nX0) = ((lX) > 0) ? (int)((lX) >> 16) : 0,\
+	(nFX) = ((lX) > 0) ? (int)(((lX) >> 8) & 0xFF) : 0,\
+	((nX0) >= (nSrcWidth) - 1) ? ((nX0) = (nSrcWidth) - 2, (nFX) = 256) : 0\
+)
+
+/* Function blending one row of target pixels from two source rows,
+ * see Upscale_BilinearRowC(). */
+typedef void (*Upscale_BilinearRowFunc)(unsigned_int_32 *pDst, int nCount,
+													 unsigned_int_32 *pRow0,
+													 unsigned_int_32 *pRow1, int nFY,
+													 long lX, long lXStep, int nSrcWidth);
+
+static void Upscale_NearestRow(unsigned char *pDst, int nCount,
+										 unsigned char *pRow, long lXStep,
+										 int nPixelSize);
+static void Upscale_BilinearRowC(unsigned_int_32 *pDst, int nCount,
+											unsigned_int_32 *pRow0,
+											unsigned_int_32 *pRow1, int nFY,
+											long lX, long lXStep, int nSrcWidth);
+#ifdef CHROME_X86_SIMD
+static void Upscale_BilinearRowSSE2(unsigned_int_32 *pDst, int nCount,
+												unsigned_int_32 *pRow0,
+												unsigned_int_32 *pRow1, int nFY,
+												long lX, long lXStep, int nSrcWidth);
+#endif
+
+static Upscale_BilinearRowFunc Upscale_pBilinearRow = NULL;
+
+/********************************************************************
+* Function : Upscale_Nearest()
+* Purpose : Stretches a bitmap by repeating it's pixels.
+* Pre : pSrc points to nSrcWidth by nSrcHeight pixels of nPixelSize
+*       bytes, nSrcPixelRow pixels apart. pDst points to nDstWidth by
+*       nDstHeight pixels of the same size, nDstPixelRow pixels
+*       apart, that don't overlap those of pSrc.
+* Post : Every pixel of pDst has the value of the pixel of pSrc that
+*        it's center maps to.
+* Note : A source row usually lands on several target rows in a row,
+*        the ones after the first are copied from the one before.
+********************************************************************/
+void Upscale_Nearest(unsigned char *pSrc, int nSrcWidth, int nSrcHeight,
+							int nSrcPixelRow,
+							unsigned char *pDst, int nDstWidth, int nDstHeight,
+							int nDstPixelRow, int nPixelSize)
+{
+	unsigned char *pPrev;
+	long lXStep;
+	long lYStep;
+	long lY;
+	int nSrcY;
+	int nLastY;
+	int nY;
+
+	if ((nSrcWidth <= 0) || (nSrcHeight <= 0) ||
+		 (nDstWidth <= 0) || (nDstHeight <= 0))
+		return;
+
+	lXStep = ((long)nSrcWidth << 16) / nDstWidth;
+	lYStep = ((long)nSrcHeight << 16) / nDstHeight;
+
+	pPrev = NULL;
+	nLastY = -1;
+	lY = lYStep / 2;
+	for (nY = 0; nY < nDstHeight; nY++)
+	{	nSrcY = (int)(lY >> 16);
+		if (nSrcY == nLastY)
+			memcpy(pDst, pPrev, (size_t)nDstWidth * nPixelSize);
+		else
+			Upscale_NearestRow(pDst, nDstWidth,
+									 pSrc + (size_t)nSrcY * nSrcPixelRow * nPixelSize,
+									 lXStep, nPixelSize);
+		nLastY = nSrcY;
+		pPrev = pDst;
+		pDst += (size_t)nDstPixelRow * nPixelSize;
+		lY += lYStep;
+	}
+}
+
+/********************************************************************
+* Function : Upscale_NearestRow()
+* Purpose : Helper to Upscale_Nearest(), stretches a single row.
+* Pre : pDst points to nCount pixels of nPixelSize bytes, pRow to the
+*       source row, lXStep is the distance between the centers of
+*       two target pixels in source pixels.
+* Post : The nCount pixels at pDst have been set.
+********************************************************************/
+static void Upscale_NearestRow(unsigned char *pDst, int nCount,
+										 unsigned char *pRow, long lXStep,
+										 int nPixelSize)
+{
+	unsigned char *pS;
+	long lX;
+
+	lX = lXStep / 2;
+	switch (nPixelSize)
+	{	case 1 :
+		{	while (nCount-- > 0)
+			{	*(pDst++) = pRow[lX >> 16];
+				lX += lXStep;
+			}
+		}break;
+
+		case 2 :
+		{	unsigned_int_16 *pD16 = (unsigned_int_16 *)pDst;
+			unsigned_int_16 *pS16 = (unsigned_int_16 *)pRow;
+			while (nCount-- > 0)
+			{	*(pD16++) = pS16[lX >> 16];
+				lX += lXStep;
+			}
+		}break;
+
+		case 3 :
+		{	while (nCount-- > 0)
+			{	pS = pRow + 3 * (lX >> 16);
+				pDst[0] = pS[0];
+				pDst[1] = pS[1];
+				pDst[2] = pS[2];
+				pDst += 3;
+				lX += lXStep;
+			}
+		}break;
+
+		case 4 :
+		{	unsigned_int_32 *pD32 = (unsigned_int_32 *)pDst;
+			unsigned_int_32 *pS32 = (unsigned_int_32 *)pRow;
+			while (nCount-- > 0)
+			{	*(pD32++) = pS32[lX >> 16];
+				lX += lXStep;
+			}
+		}break;
+	}
+}
+
+/********************************************************************
+* Function : Upscale_Bilinear32()
+* Purpose : Stretches a bitmap of 4 byte pixels, blending the source
+*           pixels.
+* Pre : As Upscale_Nearest(), for 4 byte pixels.
+* Post : Every pixel of pDst is a blend of the 4 pixels of pSrc
+*        around the point it's center maps to. Along the edges of
+*        pSrc, the pixels are blended with themselves.
+* Note : A source bitmap only 1 pixel wide is stretched by
+*        Upscale_Nearest() instead.
+********************************************************************/
+void Upscale_Bilinear32(unsigned char *pSrc, int nSrcWidth, int nSrcHeight,
+								int nSrcPixelRow,
+								unsigned char *pDst, int nDstWidth, int nDstHeight,
+								int nDstPixelRow)
+{
+	unsigned_int_32 *pRow0;
+	unsigned_int_32 *pRow1;
+	long lXStep;
+	long lYStep;
+	long lY;
+	int nSrcY;
+	int nFY;
+	int nY;
+
+	if (nSrcWidth < 2)
+	{	Upscale_Nearest(pSrc, nSrcWidth, nSrcHeight, nSrcPixelRow,
+							 pDst, nDstWidth, nDstHeight, nDstPixelRow, 4);
+		return;
+	}
+	if ((nSrcHeight <= 0) || (nDstWidth <= 0) || (nDstHeight <= 0))
+		return;
+
+	/* Select the row blender on first use. */
+	if (Upscale_pBilinearRow == NULL)
+	{	Upscale_pBilinearRow = Upscale_BilinearRowC;
+#ifdef CHROME_X86_SIMD
+		if (CpuFeatures_Get() & CPUF_SSE2)
+			Upscale_pBilinearRow = Upscale_BilinearRowSSE2;
+#endif
+	}
+
+	/* The center of target pixel n maps to (n + 0.5) * step source
+	 * pixels, the center of source pixel m is at m + 0.5. */
+	lXStep = ((long)nSrcWidth << 16) / nDstWidth;
+	lYStep = ((long)nSrcHeight << 16) / nDstHeight;
+
+	lY = lYStep / 2 - 0x8000L;
+	for (nY = 0; nY < nDstHeight; nY++)
+	{	nSrcY = (lY > 0) ? (int)(lY >> 16) : 0;
+		nFY = (lY > 0) ? (int)((lY >> 8) & 0xFF) : 0;
+		pRow0 = (unsigned_int_32 *)(pSrc + (size_t)nSrcY * nSrcPixelRow * 4);
+		pRow1 = (nSrcY + 1 < nSrcHeight) ? pRow0 + nSrcPixelRow : pRow0;
+
+		Upscale_pBilinearRow((unsigned_int_32 *)pDst, nDstWidth, pRow0, pRow1, nFY,
+									lXStep / 2 - 0x8000L, lXStep, nSrcWidth);
+
+		pDst += (size_t)nDstPixelRow * 4;
+		lY += lYStep;
+	}
+}
+
+/********************************************************************
+* Function : Upscale_BilinearRowC()
+* Purpose : Plain C version of the row blender of
+*           Upscale_Bilinear32().
+* Pre : pDst points to nCount pixels, pRow0 and pRow1 to the source
+*       rows above and below them, nFY (0 to 255) is the weight of
+*       pRow1 out of 256. lX is the source position of the first
+*       pixel, lXStep the distance to the next. Both rows have
+*       nSrcWidth (at least 2) pixels.
+* Post : The nCount pixels at pDst have been set.
+* Note : The rows are blended first, then the columns, so the result
+*        is exactly that of Upscale_BilinearRowSSE2().
+********************************************************************/
+static void Upscale_BilinearRowC(unsigned_int_32 *pDst, int nCount,
+											unsigned_int_32 *pRow0,
+											unsigned_int_32 *pRow1, int nFY,
+											long lX, long lXStep, int nSrcWidth)
+{
+	unsigned_int_32 ulLeft;
+	unsigned_int_32 ulRight;
+	int nX0;
+	int nFX;
+
+	while (nCount-- > 0)
+	{	Upscale_ColumnM(lX, nSrcWidth, nX0, nFX);
+		ulLeft = Upscale_LerpM(pRow0[nX0], pRow1[nX0], nFY);
+		ulRight = Upscale_LerpM(pRow0[nX0 + 1], pRow1[nX0 + 1], nFY);
+		*(pDst++) = Upscale_LerpM(ulLeft, ulRight, nFX);
+		lX += lXStep;
+	}
+}
+
+#ifdef CHROME_X86_SIMD
+/********************************************************************
+* Function : Upscale_BilinearRowSSE2()
+* Purpose : SSE2 version of the row blender of Upscale_Bilinear32().
+* Pre : As Upscale_BilinearRowC().
+* Post : As Upscale_BilinearRowC().
+* Note : The left and right pixels are loaded together and spread
+*        over 16 bit lanes, so both rows are blended in one go. The
+*        products reach 255 * 256 at most, which still fits in an
+*        unsigned 16 bit lane.
+********************************************************************/
+CPUFEAT_TARGET_SSE2
+static void Upscale_BilinearRowSSE2(unsigned_int_32 *pDst, int nCount,
+												unsigned_int_32 *pRow0,
+												unsigned_int_32 *pRow1, int nFY,
+												long lX, long lXStep, int nSrcWidth)
+{
+	__m128i Zero;
+	__m128i WY0;
+	__m128i WY1;
+	__m128i WX;
+	__m128i Top;
+	__m128i Bottom;
+	__m128i Mix;
+	int nX0;
+	int nFX;
+
+	Zero = _mm_setzero_si128();
+	WY0 = _mm_set1_epi16((short)(256 - nFY));
+	WY1 = _mm_set1_epi16((short)nFY);
+	while (nCount-- > 0)
+	{	Upscale_ColumnM(lX, nSrcWidth, nX0, nFX);
+
+		/* Left pixel in the low 4 lanes, right pixel in the high. */
+		Top = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *)(pRow0 + nX0)), Zero);
+		Bottom = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i *)(pRow1 + nX0)), Zero);
+		Mix = _mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(Top, WY0),
+													  _mm_mullo_epi16(Bottom, WY1)), 8);
+
+		/* Blend the left pixel with the right one. */
+		WX = _mm_set_epi16((short)nFX, (short)nFX, (short)nFX, (short)nFX,
+								 (short)(256 - nFX), (short)(256 - nFX),
+								 (short)(256 - nFX), (short)(256 - nFX));
+		Mix = _mm_mullo_epi16(Mix, WX);
+		Mix = _mm_srli_epi16(_mm_add_epi16(Mix, _mm_srli_si128(Mix, 8)), 8);
+
+		*(pDst++) = (unsigned_int_32)_mm_cvtsi128_si32(_mm_packus_epi16(Mix, Mix));
+		lX += lXStep;
+	}
+}
+#endif
@@ -0,0 +1,58 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : upscale.h
+* Purpose : Header file for the bitmap upscalers.
+* Description : Stretches a bitmap onto a larger one, either by
+*               repeating pixels (nearest neighbour) or by blending
+*               the four source pixels around every target pixel
+*               (bilinear). The Viewpoint uses these to show a frame
+*               that was drawn at a lower resolution.
+********************************************************************/
+
+#ifndef UPSCALE_H
+#define UPSCALE_H
+
+/* Upscale_Nearest(pSrc, nSrcWidth, nSrcHeight, nSrcPixelRow,
+ *                 pDst, nDstWidth, nDstHeight, nDstPixelRow,
+ *                 nPixelSize),
+ * Stretches the nSrcWidth by nSrcHeight pixels at pSrc over the
+ * nDstWidth by nDstHeight pixels at pDst, every target pixel gets
+ * the value of the source pixel it's center falls in. Pixels are
+ * nPixelSize (1 to 4) bytes, both pixelrows count pixels. The
+ * bitmaps may not overlap.
+ */
+void Upscale_Nearest(unsigned char *pSrc, int nSrcWidth, int nSrcHeight,
+							int nSrcPixelRow,
+							unsigned char *pDst, int nDstWidth, int nDstHeight,
+							int nDstPixelRow, int nPixelSize);
+
+/* Upscale_Bilinear32(pSrc, nSrcWidth, nSrcHeight, nSrcPixelRow,
+ *                    pDst, nDstWidth, nDstHeight, nDstPixelRow),
+ * As Upscale_Nearest() for 4 byte pixels, but blends the 4 source
+ * pixels nearest to the center of every target pixel by their
+ * distance to it. All 4 bytes of a pixel are blended separately, so
+ * any byte order will do. Uses SSE2 where available.
+ */
+void Upscale_Bilinear32(unsigned char *pSrc, int nSrcWidth, int nSrcHeight,
+								int nSrcPixelRow,
+								unsigned char *pDst, int nDstWidth, int nDstHeight,
+								int nDstPixelRow);
+
+#endif
@@ -57,6 +57,8 @@ void Vertex_Construct(struct Vertex *pThis);
  * and stores the result in pTarget.
  * fInterpol determines the weight of the interpolation,
  * 0 is entirely pThis, 1 if entirely pThat.
+ * Both the position and the normal are interpolated, the normal
+ * isn't renormalized (it's only used for shading).
  */
 void Vertex_Interpolate(struct Vertex *pThis, struct Vertex *pThat,
 								float fInterpol, struct Vertex *pTarget);
@@ -69,7 +71,16 @@ void Vertex_Interpolate(struct Vertex *pThis, struct Vertex *pThat,
                              (pThis)->Position.V[1]) * (fInterpol), \
 	(pTarget)->Position.V[2] = (pThis)->Position.V[2] + \
                             ((pThat)->Position.V[2] - \
-                             (pThis)->Position.V[2]) * (fInterpol) \
+                             (pThis)->Position.V[2]) * (fInterpol), \
+	(pTarget)->Normal.V[0] = (pThis)->Normal.V[0] + \
+                          ((pThat)->Normal.V[0] - \
+                           (pThis)->Normal.V[0]) * (fInterpol), \
+	(pTarget)->Normal.V[1] = (pThis)->Normal.V[1] + \
+                          ((pThat)->Normal.V[1] - \
+                           (pThis)->Normal.V[1]) * (fInterpol), \
+	(pTarget)->Normal.V[2] = (pThis)->Normal.V[2] + \
+                          ((pThat)->Normal.V[2] - \
+                           (pThis)->Normal.V[2]) * (fInterpol) \
 )
 
 #endif
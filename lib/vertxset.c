@@ -95,6 +95,31 @@ int VertexSet_Expand(struct VertexSet *pThis)
 	}
 }
 
+/********************************************************************
+* Function : VertexSet_AtLeast()
+* Purpose : Guarantees that there's space for a number of vertices in
+*           a VertexSet.
+* Pre : pThis points to an initialized VertexSet structure.
+* Post : If the returnvalue is 1, pThis has at least nCount vertices
+*        allocated, the ones in use are unchanged.
+*        If the returnvalue is 0, a memory failure occured.
+********************************************************************/
+int VertexSet_AtLeast(struct VertexSet *pThis, int nCount)
+{
+	struct Vertex *p;
+
+	if (pThis->nAlloc >= nCount)
+		return 1;	/* Already enough. */
+
+	p = (struct Vertex *)realloc((void *)pThis->arVertices,
+										  sizeof(struct Vertex) * nCount);
+	if (p == NULL)
+		return 0;	/* Memory failure. */
+	pThis->arVertices = p;
+	pThis->nAlloc = nCount;
+	return 1;
+}
+
 /********************************************************************
 * Function : VertexSet_Add()
 * Purpose : Adds a new vertex to a VertexSet.
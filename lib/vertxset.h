@@ -71,6 +71,13 @@ void VertexSet_Destruct(struct VertexSet *pThis);
  */
 int VertexSet_Expand(struct VertexSet *pThis);
 
+/* VertexSet_AtLeast(pThis, nCount),
+ * Guarantees that there are at least nCount vertices allocated, those
+ * in use are kept.
+ * Returns 1 if succesful, 0 otherwise (memory allocation failure).
+ */
+int VertexSet_AtLeast(struct VertexSet *pThis, int nCount);
+
 /* VertexSet_Add(pThis, pVertex),
  * VertexSet_AddM(pThis, pVertex),
  * Adds a new vertex to the VertexSet structure.
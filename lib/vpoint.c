@@ -23,6 +23,7 @@
 #define VPOINT_C
 
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>			/* sin, cos etc. */
 
 #include "vpoint.h"
@@ -30,8 +31,164 @@
 #include "trans.h"
 #include "lmap1.h"
 #include "lmap256.h"
+#include "texmap.h"
+#include "cpufeat.h"
+#include "timer.h"
+#include "upscale.h"
+#include "hspace.h"
+#include "vtxblock.h"
 
-static void Viewpoint_DrawPolygon(struct Viewpoint *pThis, struct Polygon *pPoly);
+#ifdef CHROME_X86_SIMD
+#include <emmintrin.h>
+#endif
+
+/* Bitmaps are cleared by repeating a pattern of
+ * VIEWPOINT_PATTERNSIZE bytes, a whole number of pixels of any size
+ * and of 16 byte vectors. The pattern array holds a little more so it
+ * can be read from any pixel byte on. Runs of at least
+ * VIEWPOINT_STREAMBYTES bytes are written with non-temporal stores. */
+#define VIEWPOINT_PATTERNSIZE		48
+#define VIEWPOINT_PATTERNALLOC	64
+#define VIEWPOINT_STREAMBYTES		4096
+
+/* The render scale is only adjusted when the frame time is more than
+ * VIEWPOINT_BUDGETSLACK off the budget (as a fraction of it). */
+#define VIEWPOINT_BUDGETSLACK		0.1f
+
+/* Polygons with no more than VIEWPOINT_TINYVERTICES vertices whose
+ * screen bounds are at most VIEWPOINT_TINYSIZE pixels wide and high
+ * cover 1 to 4 pixels, they are plotted in a single color rather
+ * than filled. */
+#define VIEWPOINT_TINYVERTICES	8
+#define VIEWPOINT_TINYSIZE			2
+
+/* What Viewpoint_ClassifySmallPolygon() found a polygon to be. */
+#define VIEWPOINT_SMALL_FILL		0	/* Fill it as usual. */
+#define VIEWPOINT_SMALL_REJECT	1	/* On a single scanline. */
+#define VIEWPOINT_SMALL_TINY		2	/* Plot it in a single color. */
+#define VIEWPOINT_SMALL_BLOCKS	3	/* Static color, small enough to
+												 * fill it by a HalfSpace. */
+
+/* Data of the ThreadPool job preparing the Actors, see
+ * Viewpoint_PrepScene(). */
+struct ViewpointPrepJob
+{
+	struct Viewpoint	*pThis;
+	struct Transformation	TransToViewpoint;	/* Root to Viewpoint. */
+};
+
+/* Function adding an edge to an EdgeTable, one of the
+ * EdgeTable_AddXXXEdge() functions. */
+typedef void (*Viewpoint_AddEdgeFunc)(struct EdgeTable *pThis,
+												  struct ScreenVertex *pSrcVtx,
+												  struct ScreenVertex *pTrgVtx);
+
+static int Viewpoint_AddSidePlanes(struct PlaneSet *pPlanes, float fXFOV, float fYFOV);
+static int Viewpoint_ProjectVertices(struct Viewpoint *pThis,
+												 struct PrepScratch *pScratch,
+												 struct VertexSet *pVertices,
+												 struct ScreenVertexSet *pScreenVertices,
+												 struct Transformation *pFinalTrans,
+												 struct Transformation *pViewTrans,
+												 int nXOfs, int nYOfs);
+static unsigned char Viewpoint_CalcIntensity(struct Viewpoint *pThis,
+															struct PrepScratch *pScratch,
+															struct Vector *pNormal);
+static unsigned char Viewpoint_CueIntensity(struct Viewpoint *pThis,
+														  unsigned char nIntensity, float fDepth);
+static void Viewpoint_CalcChromeCoords(struct Transformation *pViewTrans,
+												  struct Vector *pNormal,
+												  struct ScreenVertex *pSV);
+static void Viewpoint_ScanPolygon(struct Viewpoint *pThis,
+											 struct EdgeTable *pEdgeTable,
+											 struct Actor *pActor,
+											 struct Polygon *pPoly,
+											 struct PolyCommand *pPending);
+static Viewpoint_AddEdgeFunc Viewpoint_SelectAddEdge(unsigned long nFlags);
+static void Viewpoint_ScanCommand(struct Viewpoint *pThis,
+											 struct EdgeTable *pEdgeTable,
+											 struct PolyCommand *pCommand,
+											 struct ScreenVertex *arVertices,
+											 struct PolyCommand *pPending);
+static void Viewpoint_FillPolygon(struct Viewpoint *pThis,
+											 struct EdgeTable *pEdgeTable,
+											 struct PolyCommand *pCommand,
+											 struct PolyCommand *pPending);
+static void Viewpoint_FlushSpans(struct Viewpoint *pThis,
+											struct EdgeTable *pEdgeTable,
+											struct PolyCommand *pPending);
+static int Viewpoint_CheckSmallPolygon(struct Viewpoint *pThis,
+													struct EdgeTable *pEdgeTable,
+													struct PolyCommand *pCommand,
+													struct ScreenVertex **arpVertices,
+													int nVertices);
+static int Viewpoint_ClassifySmallPolygon(struct PolyCommand *pCommand,
+														 struct ScreenVertex **arpVertices,
+														 int nVertices);
+static unsigned long Viewpoint_TinyPixel(struct Viewpoint *pThis,
+													  struct PolyCommand *pCommand,
+													  struct ScreenVertex **arpVertices,
+													  int nVertices);
+static void Viewpoint_SolidFill(struct Viewpoint *pThis,
+										  struct EdgeTable *pEdgeTable,
+										  unsigned long ulPixel);
+static unsigned long Viewpoint_ShadeRGB(unsigned long ulRGB, int nIntensity);
+static void Viewpoint_DrawPolygon(struct Viewpoint *pThis,
+											 struct EdgeTable *pEdgeTable,
+											 struct PolyCommand *pCommand);
+static void Viewpoint_FillSpans(struct Viewpoint *pThis,
+										  struct EdgeTable *pEdgeTable,
+										  struct PolyCommand *pCommand);
+static int Viewpoint_CollectActorTree(struct Viewpoint *pThis,
+												  struct Actor *pActor,
+												  struct HPlane *pPlane,
+												  int nLevel,
+												  int (*pCollect)(struct Viewpoint *pThis,
+																		struct Actor *pActor,
+																		struct Polygon *pPoly));
+static int Viewpoint_RecordPolygon(struct Viewpoint *pThis,
+											  struct Actor *pActor,
+											  struct Polygon *pPoly);
+static int Viewpoint_BinPolygon(struct Viewpoint *pThis,
+										  struct Actor *pActor,
+										  struct Polygon *pPoly);
+static void Viewpoint_DrawTile(void *pData, int nTile, int nThread);
+static int Viewpoint_DrawTiled(struct Viewpoint *pThis);
+static int Viewpoint_AddScanlinePolygon(struct Viewpoint *pThis,
+													 struct Actor *pActor,
+													 struct Polygon *pPoly);
+static void Viewpoint_DrawSegment(void *pData, struct EdgeTable *pEdgeTable,
+											 struct AETPolygon *pPolygon);
+static void Viewpoint_BuildPattern(struct Viewpoint *pThis, unsigned long ulPixel,
+											  unsigned char *pPattern);
+static void Viewpoint_ClearBytesC(unsigned char *p, int nBytes,
+											 unsigned char *pPattern);
+#ifdef CHROME_X86_SIMD
+static void Viewpoint_ClearBytesSSE2(unsigned char *p, int nBytes,
+												 unsigned char *pPattern);
+#endif
+static int Viewpoint_PrepScene(struct Viewpoint *pThis, struct Actor *pActors);
+static void Viewpoint_PrepActor(void *pData, int nItem, int nThread);
+static int Viewpoint_TransformActor(struct PrepScratch *pScratch, struct Actor *pActor,
+												struct Transformation *pFinalTrans,
+												int nXOfs, int nYOfs);
+static int Viewpoint_ClipActor(struct PrepScratch *pScratch, struct Actor *pActor);
+static int Viewpoint_ClipPolygon(struct PrepScratch *pScratch, struct Actor *pActor,
+											struct Polygon *pPoly, unsigned long ulOr);
+static void Viewpoint_LightVertices(struct Viewpoint *pThis,
+												struct PrepScratch *pScratch,
+												struct Actor *pActor,
+												struct Transformation *pViewTrans);
+static int Viewpoint_DrawField(struct Viewpoint *pThis);
+static int Viewpoint_DrawScene(struct Viewpoint *pThis);
+static void Viewpoint_CoverSkippedRows(struct Viewpoint *pThis);
+static int Viewpoint_RestoreSkippedRows(struct Viewpoint *pThis);
+static void Viewpoint_AdjustRenderScale(struct Viewpoint *pThis);
+static int Viewpoint_CoverCommands(struct Viewpoint *pThis);
+static void Viewpoint_FillBackground(struct Viewpoint *pThis);
+
+static void (*Viewpoint_pClearBytes)(unsigned char *p, int nBytes,
+												 unsigned char *pPattern) = NULL;
 
 /********************************************************************
 * Function : Viewpoint_Construct()
@@ -45,6 +202,72 @@ void Viewpoint_Construct(struct Viewpoint *pThis)
 	Viewpoint_ConstructM(pThis);
 }
 
+/********************************************************************
+* Function : Viewpoint_Destruct()
+* Purpose : Frees all memory associated with a Viewpoint.
+* Pre : pThis points to an initialized Viewpoint structure.
+* Post : pThis points to an invalid Viewpoint structure that uses no
+*        more memory or threads.
+********************************************************************/
+void Viewpoint_Destruct(struct Viewpoint *pThis)
+{	/* Call the macro version. */
+	Viewpoint_DestructM(pThis);
+}
+
+/********************************************************************
+* Function : Viewpoint_DestructTileEdgeTables()
+* Purpose : Frees the EdgeTables used for tiled drawing.
+* Pre : pThis points to an initialized Viewpoint structure.
+* Post : pThis has no EdgeTables for tiled drawing.
+********************************************************************/
+void Viewpoint_DestructTileEdgeTables(struct Viewpoint *pThis)
+{
+	int n;
+
+	for (n = 0; n < pThis->nTileEdgeTables; n++)
+		EdgeTable_Destruct(&(pThis->arTileEdgeTables[n]));
+	if (pThis->arTileEdgeTables != NULL)
+		free((void *)pThis->arTileEdgeTables);
+	if (pThis->arTileDamage != NULL)
+		free((void *)pThis->arTileDamage);
+	if (pThis->arTileStats != NULL)
+		free((void *)pThis->arTileStats);
+	pThis->arTileEdgeTables = NULL;
+	pThis->arTileDamage = NULL;
+	pThis->arTileStats = NULL;
+	pThis->nTileEdgeTables = 0;
+}
+
+/********************************************************************
+* Function : Viewpoint_DestructPrep()
+* Purpose : Frees the Actor list and scratch sets used for preparing
+*           Actors.
+* Pre : pThis points to an initialized Viewpoint structure.
+* Post : pThis has no scratch sets for preparing Actors.
+********************************************************************/
+void Viewpoint_DestructPrep(struct Viewpoint *pThis)
+{
+	int n;
+
+	for (n = 0; n < pThis->nPrepScratch; n++)
+	{	FloatSet_Destruct(&(pThis->arPrepScratch[n].TempFloatSet));
+		FloatSet_Destruct(&(pThis->arPrepScratch[n].TempFloatSet2));
+		PlaneSet_Destruct(&(pThis->arPrepScratch[n].ClipPlanes));
+		if (pThis->arPrepScratch[n].arOutcodes != NULL)
+			free((void *)pThis->arPrepScratch[n].arOutcodes);
+		VertexSet_DestructM(&(pThis->arPrepScratch[n].ViewVertices));
+		VertexSet_DestructM(&(pThis->arPrepScratch[n].ClipVertices));
+		Polygon_DestructM(&(pThis->arPrepScratch[n].arClipPolygons[0]));
+		Polygon_DestructM(&(pThis->arPrepScratch[n].arClipPolygons[1]));
+	}
+	if (pThis->arPrepScratch != NULL)
+		free((void *)pThis->arPrepScratch);
+	pThis->arPrepScratch = NULL;
+	pThis->nPrepScratch = 0;
+	ActorPtrSet_Destruct(&(pThis->PrepActors));
+	ActorPtrSet_ConstructM(&(pThis->PrepActors));
+}
+
 /********************************************************************
 * Function : Viewpoint_PrecalcFrustrum()
 * Arguments : Besides the Viewpoint, size and position of window whithin bitmap.
@@ -53,27 +276,102 @@ void Viewpoint_Construct(struct Viewpoint *pThis)
 *           fYFOV).
 * Pre : pThis points to an initialized Viewpoint structure.
 * Post : If the returnvalue is 1, pThis points to an initialized
-*        Viewpoint structure with 4 view frustrum planes installed.
+*        Viewpoint structure with 4 view frustrum planes installed,
+*        followed by the near and far planes if they're set.
 *        If the returnvalue is 0, a memory allocation failure
 *        occured.
 * Note : Any previously set frustrum planes will be lost even if
 *        this routine did not set them.
 * Note-2 : It's VERY IMPORTANT to call this function when the field
-*          of view is changed. The frustrum planes concept is the
-*          ONLY clipping mechanism. Without correct frustrum planes,
-*          the drawing WILL go outside the bitmap!
+*          of view is changed. Without correct frustrum (or guard
+*          band) planes, screen coordinates may overflow the
+*          EdgeTable's spans.
 ********************************************************************/
 int Viewpoint_PrecalcFrustrum(struct Viewpoint *pThis)
 {
 	struct Plane FrustrumPlane;
 	float fXFOV;
 	float fYFOV;
+	float fBand, fMaxBand;
+	int nSize;
+	int n;
 
 	Plane_ConstructM(&FrustrumPlane);
 
-	/* Insert the 4 frustrum planes. */
-	fXFOV = pThis->fXFOV;
-	fYFOV = pThis->fYFOV;
+	/* Start with empty sets. */
+	pThis->FrustrumPlanes.nCount = 0;
+	pThis->GuardPlanes.nCount = 0;
+
+	/* Insert the 4 frustrum planes first, and then the 4 guard band
+	 * planes if there is a guard band. */
+	for (n = 0; n < 2; n++)
+	{
+		fXFOV = pThis->fXFOV;
+		fYFOV = pThis->fYFOV;
+		if (n == 1)
+		{	if (pThis->fGuardBand <= 1.f)
+				break;	/* No guard band. */
+
+			/* Limit the guard band so the projected coordinates,
+			 * including the offset to the center of the screen, stay
+			 * within +/- 16000. The guard band that was set is kept,
+			 * for when the bitmap gets smaller again. */
+			nSize = (pThis->nWidth > pThis->nHeight) ? pThis->nWidth : pThis->nHeight;
+			fMaxBand = (nSize > 0) ? (32000.f / nSize) - 1.f : 1.f;
+			fBand = pThis->fGuardBand;
+			if (fBand > fMaxBand)
+				fBand = fMaxBand;
+			if (fBand <= 1.f)
+				break;	/* Bitmap too large for a guard band. */
+
+			/* Widen the field of view by the guard band. */
+			fXFOV = (float) atan(fBand * tan(fXFOV));
+			fYFOV = (float) atan(fBand * tan(fYFOV));
+		}
+		if (!Viewpoint_AddSidePlanes(n == 0 ? &(pThis->FrustrumPlanes) : &(pThis->GuardPlanes),
+											  fXFOV, fYFOV))
+			return 0;
+	}
+
+	/* The near and far planes come after the side planes, those have
+	 * the same index as their guard band planes. */
+	if (pThis->fNearDistance > 0.f)
+	{	FrustrumPlane.Normal.V[0] = 0.f;
+		FrustrumPlane.Normal.V[1] = 0.f;
+		FrustrumPlane.Normal.V[2] = 1.f;
+		FrustrumPlane.Distance = pThis->fNearDistance;
+		if (!PlaneSet_AddM(&(pThis->FrustrumPlanes), &FrustrumPlane))
+			return 0;
+	}
+	if (pThis->fFarDistance > 0.f)
+	{	FrustrumPlane.Normal.V[0] = 0.f;
+		FrustrumPlane.Normal.V[1] = 0.f;
+		FrustrumPlane.Normal.V[2] = -1.f;
+		FrustrumPlane.Distance = -pThis->fFarDistance;
+		if (!PlaneSet_AddM(&(pThis->FrustrumPlanes), &FrustrumPlane))
+			return 0;
+	}
+
+	/* Success. */
+	return 1;
+}
+
+/********************************************************************
+* Function : Viewpoint_AddSidePlanes()
+* Purpose : Helper to Viewpoint_PrecalcFrustrum(), adds the left,
+*           right, top and bottom planes for a given field of view.
+* Pre : pPlanes points to an initialized PlaneSet, fXFOV and fYFOV
+*       hold half the horizontal and vertical field of view.
+* Post : If the returnvalue is 1, the 4 planes were added to pPlanes
+*        in left, right, top, bottom order.
+*        If the returnvalue is 0, a memory allocation failure
+*        occured.
+********************************************************************/
+static int Viewpoint_AddSidePlanes(struct PlaneSet *pPlanes, float fXFOV, float fYFOV)
+{
+	struct Plane FrustrumPlane;
+
+	Plane_ConstructM(&FrustrumPlane);
 
 	/* These will be slightly away from the view position (0,0,0)
 	 * to prevent a division by zero (clipping will then not allow
@@ -86,7 +384,7 @@ int Viewpoint_PrecalcFrustrum(struct Viewpoint *pThis)
 	FrustrumPlane.Normal.V[1] = 0.f;
 	FrustrumPlane.Normal.V[2] = (float) sin(fXFOV);
 	FrustrumPlane.Distance = 0.00001f;
-	if (!PlaneSet_AddM(&(pThis->FrustrumPlanes), &FrustrumPlane))
+	if (!PlaneSet_AddM(pPlanes, &FrustrumPlane))
 		return 0;
 
 	/* Right plane. */
@@ -94,7 +392,7 @@ int Viewpoint_PrecalcFrustrum(struct Viewpoint *pThis)
 	FrustrumPlane.Normal.V[1] = 0.f;
 	FrustrumPlane.Normal.V[2] = (float) sin(fXFOV);
 	FrustrumPlane.Distance = 0.00001f;
-	if (!PlaneSet_AddM(&(pThis->FrustrumPlanes), &FrustrumPlane))
+	if (!PlaneSet_AddM(pPlanes, &FrustrumPlane))
 		return 0;
 
 	/* Top plane. */
@@ -102,7 +400,7 @@ int Viewpoint_PrecalcFrustrum(struct Viewpoint *pThis)
 	FrustrumPlane.Normal.V[1] = (float) cos(fYFOV);
 	FrustrumPlane.Normal.V[2] = (float) sin(fYFOV);
 	FrustrumPlane.Distance = 0.00001f;
-	if (!PlaneSet_AddM(&(pThis->FrustrumPlanes), &FrustrumPlane))
+	if (!PlaneSet_AddM(pPlanes, &FrustrumPlane))
 		return 0;
 
 	/* Bottom plane. */
@@ -110,7 +408,7 @@ int Viewpoint_PrecalcFrustrum(struct Viewpoint *pThis)
 	FrustrumPlane.Normal.V[1] = -(float) cos(fYFOV);
 	FrustrumPlane.Normal.V[2] = (float) sin(fYFOV);
 	FrustrumPlane.Distance = 0.00001f;
-	if (!PlaneSet_AddM(&(pThis->FrustrumPlanes), &FrustrumPlane))
+	if (!PlaneSet_AddM(pPlanes, &FrustrumPlane))
 		return 0;
 
 	/* Success. */
@@ -125,456 +423,1836 @@ int Viewpoint_PrecalcFrustrum(struct Viewpoint *pThis)
 *       points to an initialized Actor structure with optionally
 *       more Actors in it's tail (thus forming a linked list).
 * Post : If the returnvalue is 1, the Actors in pActor have been
-*        succesfully initialized for display.
+*        succesfully initialized for display at the render scale.
 *        If the returnvalue is 0, a memory failure occured.
 * Note : Between Viewpoint_PrepActorsForDraw() and Viewpoint_Draw()
 *        no other Viewpoint_PrepActorsForDraw() calls may be made for
 *        other viewpoints in the same world.
-* Bugs : All vertices every encountered will be recalculated every
-*        time for all planes. This is quite inefficient because we
-*        only need to calculate the distances for those vertices that
-*        are still used by the polygons. 
+* Note-2 : Below a render scale of 1, the multipliers are those of
+*          the scaled bitmap while preparing. The frustrum only
+*          depends on the field of view and the depth range, and
+*          stays as it is; a guard band limited for the full bitmap
+*          is fine for a smaller one.
 ********************************************************************/
 int Viewpoint_PrepActorsForDraw(struct Viewpoint *pThis, struct Actor *pActors)
 {
+	float fXMultiplier;
+	float fYMultiplier;
+	int nWidth;
+	int nHeight;
+	int nResult;
+
+	pThis->dFrameStart = Timer_GetSeconds();
+
+	/* Determine the size of the bitmap actually drawn, Viewpoint_Draw()
+	 * uses the same. */
+	pThis->nScaledWidth = pThis->nWidth;
+	pThis->nScaledHeight = pThis->nHeight;
+	if (pThis->fRenderScale < 1.f)
+	{	pThis->nScaledWidth = (int)(pThis->nWidth * pThis->fRenderScale + 0.5f);
+		pThis->nScaledHeight = (int)(pThis->nHeight * pThis->fRenderScale + 0.5f);
+		if (pThis->nScaledWidth < 1)
+			pThis->nScaledWidth = 1;
+		if (pThis->nScaledHeight < 1)
+			pThis->nScaledHeight = 1;
+	}
+	if ((pThis->nScaledWidth == pThis->nWidth) &&
+		 (pThis->nScaledHeight == pThis->nHeight))
+		return Viewpoint_PrepScene(pThis, pActors);
+
+	/* Prepare for the scaled bitmap. */
+	nWidth = pThis->nWidth;
+	nHeight = pThis->nHeight;
+	fXMultiplier = pThis->fXMultiplier;
+	fYMultiplier = pThis->fYMultiplier;
+	pThis->nWidth = pThis->nScaledWidth;
+	pThis->nHeight = pThis->nScaledHeight;
+	Viewpoint_PrecalcM(pThis);
+
+	nResult = Viewpoint_PrepScene(pThis, pActors);
+
+	pThis->nWidth = nWidth;
+	pThis->nHeight = nHeight;
+	pThis->fXMultiplier = fXMultiplier;
+	pThis->fYMultiplier = fYMultiplier;
+	return nResult;
+}
+
+/********************************************************************
+* Function : Viewpoint_PrepScene()
+* Purpose : Helper to Viewpoint_PrepActorsForDraw(), prepares the
+*           list of Actors pActors for drawing in the pThis viewpoint
+*           at the size of it's bitmap.
+* Pre : pThis points to an initialized Viewpoint structure. pActors
+*       points to an initialized Actor structure with optionally
+*       more Actors in it's tail (thus forming a linked list).
+* Post : If the returnvalue is 1, the Actors in pActor have been
+*        succesfully initialized for display.
+*        If the returnvalue is 0, a memory failure occured.
+* Note : Between Viewpoint_PrepActorsForDraw() and Viewpoint_Draw()
+*        no other Viewpoint_PrepActorsForDraw() calls may be made for
+*        other viewpoints in the same world.
+*        Clipping and projecting an Actor only touches the Actor
+*        itself and a PrepScratch, see Viewpoint_PrepActor(), so
+*        with nParallelPrep set the Actors are spread over the
+*        threads of TilePool. Inserting them into the display BSP
+*        tree changes the Actors already in it and is done
+*        afterwards, in the order of the list, so the tree doesn't
+*        depend on the threads.
+********************************************************************/
+static int Viewpoint_PrepScene(struct Viewpoint *pThis, struct Actor *pActors)
+{
+	struct ViewpointPrepJob Job;
+	struct PrepScratch *pScratch;
+	struct Actor *pActor;
+	int nThreads;
+	int nActors;
+	int n, m;
+	
+	/* Build transformation from Root to Viewpoint frame. */
+	Job.pThis = pThis;
+	Frame_GetTransformationFromRoot(&(pThis->VpointFrame), &(Job.TransToViewpoint));
+
+	/* Make sure that the old tree is not reused.
+	 * Start over again. */
+	pThis->pRootActor = NULL;
+
+	/* List all actors, so they can be prepared in any order. */
+	pThis->PrepActors.nCount = 0;
+	for (pActor = pActors; pActor != NULL; pActor = pActor->pNext)
+		if (!ActorPtrSet_AddM(&(pThis->PrepActors), pActor))
+			return 0;	/* Memory failure. */
+	nActors = ActorPtrSet_GetCountM(&(pThis->PrepActors));
+
+	/* Every thread needs it's own scratch sets. */
+	nThreads = pThis->nParallelPrep ? pThis->TilePool.nThreads : 1;
+	if (nThreads > pThis->nPrepScratch)
+	{	pScratch = (struct PrepScratch *)realloc((void *)pThis->arPrepScratch,
+															  sizeof(struct PrepScratch) * nThreads);
+		if (pScratch == NULL)
+			return 0;	/* Memory failure. */
+		pThis->arPrepScratch = pScratch;
+		for (n = pThis->nPrepScratch; n < nThreads; n++)
+		{	FloatSet_Construct(&(pScratch[n].TempFloatSet));
+			FloatSet_Construct(&(pScratch[n].TempFloatSet2));
+			PlaneSet_ConstructM(&(pScratch[n].ClipPlanes));
+			pScratch[n].nOutcodeAlloc = 0;
+			pScratch[n].arOutcodes = NULL;
+			VertexSet_ConstructM(&(pScratch[n].ViewVertices));
+			VertexSet_ConstructM(&(pScratch[n].ClipVertices));
+			Polygon_ConstructM(&(pScratch[n].arClipPolygons[0]));
+			Polygon_ConstructM(&(pScratch[n].arClipPolygons[1]));
+		}
+		pThis->nPrepScratch = nThreads;
+	}
+	for (n = 0; n < nThreads; n++)
+		pThis->arPrepScratch[n].bFailed = 0;
+
+	/* Clip and project the actors. The projectors are selected up
+	 * front so the threads don't all try to. */
+	VertexBlock_InitProjectors();
+	if (nThreads > 1)
+		ThreadPool_Run(&(pThis->TilePool), Viewpoint_PrepActor, (void *)&Job, nActors);
+	else
+	{	for (n = 0; n < nActors; n++)
+			Viewpoint_PrepActor((void *)&Job, n, 0);
+	}
+	for (n = 0; n < nThreads; n++)
+		if (pThis->arPrepScratch[n].bFailed)
+			return 0;	/* Memory failure. */
+
+	/* Add the actors that weren't dropped to the viewpoint's display
+	 * BSP tree. */
+	for (n = 0; n < nActors; n++)
+	{	pActor = ActorPtrSet_GetActorPtrM(&(pThis->PrepActors), n);
+		if (pActor == NULL)
+			continue;	/* Dropped. */
+
+		/* But first clean it's SubActorSet.
+		 * Because the count value in the SubActorSet is not used,
+		 * we need to clear all allocated pointers. */
+		for (m = 0; m < pActor->SubActorSet.nAlloc; m++)
+			ActorPtrSet_GetActorPtrM(&(pActor->SubActorSet), m) = NULL;
+
+		if (pThis->pRootActor == NULL)
+		{	pThis->pRootActor = pActor;	/* This is the first actor. */
+		} else
+		{	/* This is not the first actor, so insert this actor into
+			 * the existing tree of actors. */
+			if (!Actor_InsertActor(pThis->pRootActor, pActor))
+			{	/* A memory failure occured during the insertion. */
+				return 0;
+			}
+		}
+	}
+	/* Success! */
+	return 1;
+}
+
+/********************************************************************
+* Function : Viewpoint_PrepActor()
+* Purpose : Helper to Viewpoint_PrepScene(), clips an Actor to the
+*           view frustrum and projects it's vertices. This is a
+*           ThreadPool job, pData points to a ViewpointPrepJob.
+* Pre : Actor nItem of PrepActors is to be prepared by thread
+*       nThread, which uses PrepScratch nThread.
+* Post : If the Actor is not visible, it's entry in PrepActors is
+*        set to NULL, otherwise it's clipped polygons and screen
+*        vertices are ready for drawing.
+*        On a memory failure, bFailed of the PrepScratch is set.
+* Note : Models may be shared by Actors prepared at the same time,
+*        they're only read.
+********************************************************************/
+static void Viewpoint_PrepActor(void *pData, int nItem, int nThread)
+{
+	struct Viewpoint *pThis;
+	struct PrepScratch *pScratch;
+	struct Actor *pActor;
+	struct Transformation *pTransToViewpoint;
 	struct Transformation TransFromActor;
-	struct Transformation TransToViewpoint;
 	struct Transformation FinalTrans;
+	struct Transformation TransFromLight;
+	struct Transformation ViewTrans;	/* Actor to Viewpoint, unscaled. */
+	struct DirLight *pLight;
 	struct Vector Temporarypoint;
 	struct Vector Centerpoint;
 	struct Vector VPos;
 	struct Plane *pFrustrumPlane;
-	struct Plane TFPlane;			/* Frustrum Plane in Actor Frame. */
-	struct Polygon *pSrcPoly;
-	struct Polygon *pTrgPoly;
-	struct Vertex *pTempVert;
-	struct ScreenVertex *pSV;
-	float fTempDistance;
-	int n, m;
+	struct Plane *pClipPlane;		/* Plane actually clipped to. */
+	struct Plane TFPlane;			/* Clip plane in rescaled view space. */
+	struct Transformation ClipTrans;	/* For the clipped vertices. */
+	int n;
 	int nXOfs, nYOfs;
 	int bDropActor;
 	float fCPDistance;
-	
-	/* Build transformation from Root to Viewpoint frame. */
-	Frame_GetTransformationFromRoot(&(pThis->VpointFrame), &TransToViewpoint);
 
-	/* Make sure that the old tree is not reused.
-	 * Start over again. */
-	pThis->pRootActor = NULL;
+	pThis = ((struct ViewpointPrepJob *)pData)->pThis;
+	pTransToViewpoint = &(((struct ViewpointPrepJob *)pData)->TransToViewpoint);
+	pScratch = &(pThis->arPrepScratch[nThread]);
+	pActor = ActorPtrSet_GetActorPtrM(&(pThis->PrepActors), nItem);
 
-	/* Iterate all actors. */
-	while (pActors != NULL)
-	{
-		/* Convert sphere bounding volume to viewspace. */
+	/* Convert sphere bounding volume to viewspace. */
 
-		/* Build transformation from Actor frame to Root frame. */
-		Frame_GetTransformationToRoot(&(pActors->ActorFrame), &TransFromActor);
+	/* Build transformation from Actor frame to Root frame. */
+	Frame_GetTransformationToRoot(&(pActor->ActorFrame), &TransFromActor);
 
 #ifndef NO_INLINE
-		/* Transform centerpoint to root frame. */
-		Transformation_TransformM(&TransFromActor, &(pActors->pModel->Centerpoint), &Temporarypoint);
-		/* Transform centerpoint to Viewpoint frame. */
-		Transformation_TransformM(&TransToViewpoint, &Temporarypoint, &Centerpoint);
+	/* Transform centerpoint to root frame. */
+	Transformation_TransformM(&TransFromActor, &(pActor->pModel->Centerpoint), &Temporarypoint);
+	/* Transform centerpoint to Viewpoint frame. */
+	Transformation_TransformM(pTransToViewpoint, &Temporarypoint, &Centerpoint);
 #else
-		/* Transform centerpoint to root frame. */
-		Transformation_Transform(&TransFromActor, &(pActors->pModel->Centerpoint), &Centerpoint);
-		/* Transform centerpoint to Viewpoint frame. */
-		Transformation_Transform(&TransToViewpoint, &Centerpoint, &Centerpoint);
+	/* Transform centerpoint to root frame. */
+	Transformation_Transform(&TransFromActor, &(pActor->pModel->Centerpoint), &Centerpoint);
+	/* Transform centerpoint to Viewpoint frame. */
+	Transformation_Transform(pTransToViewpoint, &Centerpoint, &Centerpoint);
 #endif
-		
-		/* Centerpoint now is in the Viewpoint frame. */
-		/* Initialize the buffer swapping pointers in the current Actor. */
-		pActors->pSrcPolySet = &(pActors->pModel->Polygons);
-		pActors->pTrgPolySet = &(pActors->ClippedPolySetA);
-		pActors->ClippedPolySetA.nCount = 0;
-		pActors->ClippedPolySetB.nCount = 0;
-		pActors->ClippedVertexSet.nCount = 0;
-
-		/* Iterate all frustrum planes. */
-		bDropActor = 0;
-		for (n = 0; !bDropActor && (n < PlaneSet_GetCountM(&(pThis->FrustrumPlanes))); n++)
-		{
-			/* Get the frustrum plane at index n. */
-			pFrustrumPlane = PlaneSet_GetPlaneM(&(pThis->FrustrumPlanes), n);
-			
-			/* Check bounding sphere against plane.
-			 * This consists of checking the distance of the Centerpoint from
-			 * the plane and then checking if that is within the radius or
-			 * completely inside etc. */
-			fCPDistance = Plane_DistanceOfVectorM(pFrustrumPlane, &Centerpoint);
-			
-			/* Check what the distance means... 3 possibilities :
-			 * fCPDistance < -Radius ?
-			 *    1. Actor is fully outside (i.e. not visible), proceed with
-			 *       next Actor. (bDropActor = TRUE).
-			 * ELSE
-			 *    fCPDistance < Radius ?
-			 *       2. Actor is intersecting the plane, clip to plane,
-			 *          proceed with next plane.
-			 *    ELSE
-			 *       3. Actor is fully inside, proceed with next plane.
-			 */
-			if (fCPDistance < -(pActors->pModel->fRadius))
-			{	/* Actor is fully outside this plane and therefore not
-				 * visible, proceed with next Actor. */
-				bDropActor = 1;
-			} else
-			{	if (fCPDistance < pActors->pModel->fRadius)
-				{	/* Actor is intersecting the plane, clip polygons to plane. */
-					Transformation_InvTransformPlane(&TransToViewpoint, pFrustrumPlane, &TFPlane);
-					Transformation_InvTransformPlane(&TransFromActor, &TFPlane, &TFPlane);
-					
-					/* Produce a set of distances from the plane for all vertices. */
-					pThis->TempFloatSet.nCount = 0;	/* Reset floatset for distances. */
-					pThis->TempFloatSet2.nCount = 0;	/* Reset floatset for secondary distances. */
-					
-					/* Iterate all normal vertices. */
-					for (m = 0; m < VertexSet_GetCountM(&(pActors->pModel->Vertices)); m++)
-					{
-						/* Calculate distance & add it to the DistSet. */
-						pTempVert = VertexSet_GetVertexM(&(pActors->pModel->Vertices), m);
-						fTempDistance = Plane_DistanceOfVectorM(&TFPlane, &(pTempVert->Position));
-						FloatSet_AddM(&(pThis->TempFloatSet), fTempDistance);
-					}
-					/* Iterate all negatively indexed vertices. */
-					for (m = 0; m < VertexSet_GetCountM(&(pActors->ClippedVertexSet)); m++)
-					{
-						/* Calculate distance & add it to the DistSet. */
-						pTempVert = VertexSet_GetVertexM(&(pActors->ClippedVertexSet), m);
-						fTempDistance = Plane_DistanceOfVectorM(&TFPlane, &(pTempVert->Position));
-						FloatSet_AddM(&(pThis->TempFloatSet2), fTempDistance);
-					}
-					
-
-					/* Iterate all polygons from pSrcPolySet. */
-					for (m = 0; m < PolySet_GetCountM(pActors->pSrcPolySet); m++)
-					{
-						/* Get the source polygon. */
-						pSrcPoly = PolySet_GetPolygonM(pActors->pSrcPolySet, m);
-
-						
-						/* Get a ptr to a new target polygon. */
-						pTrgPoly = PolySet_GetNewM(pActors->pTrgPolySet);
-						
-						/* Check for memory failure */
-						if (pTrgPoly == NULL)
-						{
-							return 0;
-						}
-						/* Clip Polygon pSrcPoly using pThis->TempFloatSet and store
-						 * result in pTrgPoly. */
-						if (!Plane_ClipPolygon(&TFPlane, pSrcPoly, &(pThis->TempFloatSet),
-													  &(pActors->pModel->Vertices),
-													  &(pThis->TempFloatSet2), pTrgPoly, 
-													  &(pActors->ClippedVertexSet)))
-						{
-							return 0;	/* Memory failure. */
-						}
-					}
-					
-					/* Swap buffer pointers around. */
-					if (pActors->pTrgPolySet == &(pActors->ClippedPolySetA))
-					{	pActors->pTrgPolySet = &(pActors->ClippedPolySetB);
-						pActors->pSrcPolySet = &(pActors->ClippedPolySetA);
-					} else
-					{	pActors->pTrgPolySet = &(pActors->ClippedPolySetA);	
-						pActors->pSrcPolySet = &(pActors->ClippedPolySetB);
-					}
-					pActors->pTrgPolySet->nCount = 0;	/* Reset target buffer. */
-
-				}
-			}
-		}	/* For loop for all planes. */
+	
+	/* Centerpoint now is in the Viewpoint frame. */
+	/* No planes to clip to yet. */
+	pScratch->ClipPlanes.nCount = 0;
 
+	/* Iterate all frustrum planes. */
+	bDropActor = 0;
+	for (n = 0; !bDropActor && (n < PlaneSet_GetCountM(&(pThis->FrustrumPlanes))); n++)
+	{
+		/* Get the frustrum plane at index n. */
+		pFrustrumPlane = PlaneSet_GetPlaneM(&(pThis->FrustrumPlanes), n);
 		
-		/* If the actor should not be dropped, (!bDropActor)
-		 * add the actor to the display BSP tree. */
-		if (!bDropActor)
-		{	/* Add the actor the the viewpoint's display BSP tree. */
-			/* But first clean it's SubActorSet.
-			 * Because the count value in the SubActorSet is not used,
-			 * we need to clear all allocated pointers. */
-			for (n = 0; n < pActors->SubActorSet.nAlloc; n++)
-				ActorPtrSet_GetActorPtrM(&(pActors->SubActorSet), n) = NULL;
-
-			if (pThis->pRootActor == NULL)
-			{	pThis->pRootActor = pActors;	/* This is the first actor. */
-			} else
-			{	/* This is not the first actor, so insert this actor into
-				 * the existing tree of actors. */
-				if (!Actor_InsertActor(pThis->pRootActor, pActors))
-				{	/* A memory failure occured during the insertion. */
-					return 0;
-				}
+		/* Check bounding sphere against plane.
+		 * This consists of checking the distance of the Centerpoint from
+		 * the plane and then checking if that is within the radius or
+		 * completely inside etc. */
+		fCPDistance = Plane_DistanceOfVectorM(pFrustrumPlane, &Centerpoint);
+		
+		/* Check what the distance means... 3 possibilities :
+		 * fCPDistance < -Radius ?
+		 *    1. Actor is fully outside (i.e. not visible), proceed with
+		 *       next Actor. (bDropActor = TRUE).
+		 * ELSE
+		 *    fCPDistance < Radius ?
+		 *       2. Actor is intersecting the plane, clip to plane,
+		 *          proceed with next plane.
+		 *    ELSE
+		 *       3. Actor is fully inside, proceed with next plane.
+		 */
+		if (fCPDistance < -(pActor->pModel->fRadius))
+		{	/* Actor is fully outside this plane and therefore not
+			 * visible, proceed with next Actor. */
+			bDropActor = 1;
+		} else
+		{	pClipPlane = pFrustrumPlane;
+			if ((fCPDistance < pActor->pModel->fRadius) &&
+				 (n < PlaneSet_GetCountM(&(pThis->GuardPlanes))))
+			{	/* Actor is intersecting a side plane, the rasterizer
+				 * takes care of it as long as the actor is fully
+				 * inside the guard band, otherwise clip to the guard
+				 * band instead. */
+				pClipPlane = PlaneSet_GetPlaneM(&(pThis->GuardPlanes), n);
+				fCPDistance = Plane_DistanceOfVectorM(pClipPlane, &Centerpoint);
 			}
-			
-			/* Transform all vertices from there 3D position to 2D screen
-			 * coordinates. */
-			/* Concatenate the transformation from the Actor to the Root
-			 * with the transformation from the Root to the Viewpoint. */
-			Transformation_Concatenate(&TransToViewpoint, &TransFromActor, &FinalTrans);
-			
-			/* Transform point (0,0,0) from the Viewpoint Frame to the Actor
-			 * Frame. This is the Viewpoint's origin and is used in the Draw
-			 * stage to traverse the Actor's BSP tree. */
-			Vector_ConstructM(&VPos);
-			Transformation_InvTransform(&FinalTrans, &VPos, &(pActors->ViewpointOrigin));
-			
-			/* Scale the transformation X and Y rows with the Multipliers. */
-			Transformation_ScaleXYRowM(&FinalTrans, pThis->fXMultiplier, pThis->fYMultiplier);
-			
-			/* FinalTrans now contains the transformation we need to go from
-			 * the Actor frame to the Viewpoint Frame whereby the X and Y axes
-			 * have been scaled as such that after division by Z each vertex
-			 * will represent the screen coordinate whereby the center of the
-			 * screen is at (0,0). */
-			/* Initializes viewpoint's Screen Vertex Sets. */
-			pActors->NormalScreenVertices.nCount = 0;
-			pActors->ClippedScreenVertices.nCount = 0;
-			
-			/* Produce a center of the screen offset from top left. */
-			nXOfs = pThis->nWidth / 2;
-			nYOfs = pThis->nHeight / 2;
-			
-			/* Transform Normal Vertices. */
-			for (n = 0; n < VertexSet_GetCountM(&(pActors->pModel->Vertices)); n++)
-			{
-				/* Get a new ScreenVertex. */
-				pSV = ScreenVertexSet_GetNewM(&(pActors->NormalScreenVertices));
-				
-				if (pSV == NULL)
-					return 0;	/* Memory allocation failure. */
-
-				/* Transform vertex position. */
-				Transformation_TransformM(&FinalTrans, &(VertexSet_GetVertexM(&(pActors->pModel->Vertices), n)->Position), &VPos);
-
-				/* VPos now contains the 3D position of the n'th vertex in 
-				 * rescaled viewpoint space. */
-
-				/* Make VPos 2D by division & adding half the width to the
-				 * center of the screen. 
-				 * THIS IS THE ACTUAL PERSPECTIVE TRANSFORMATION ! */
-				if (VPos.V[2] != 0.f)
-				{	/* This test should not be needed.... */
-					pSV->nX = nXOfs + (short)(VPos.V[0] / VPos.V[2]);
-					pSV->nY = nYOfs + (short)(VPos.V[1] / VPos.V[2]);
+			if (fCPDistance < pActor->pModel->fRadius)
+			{	/* Actor is intersecting the plane, clip polygons to plane.
+				 * Collect the plane, all are clipped to at once in view
+				 * space, with the X and Y axes scaled like the vertices
+				 * projected. There a pixel on the screen is Z wide, the
+				 * plane is moved out by one so vertices clipped to it
+				 * aren't truncated to just inside the screen. The
+				 * scissor rectangle takes care of the rest. */
+				TFPlane.Normal.V[0] = pClipPlane->Normal.V[0] / pThis->fXMultiplier;
+				TFPlane.Normal.V[1] = pClipPlane->Normal.V[1] / pThis->fYMultiplier;
+				TFPlane.Normal.V[2] = pClipPlane->Normal.V[2] +
+											 (float)fabs(TFPlane.Normal.V[0]) +
+											 (float)fabs(TFPlane.Normal.V[1]);
+				TFPlane.Distance = pClipPlane->Distance;
+				if (!PlaneSet_AddM(&(pScratch->ClipPlanes), &TFPlane))
+				{	pScratch->bFailed = 1;
+					return;	/* Memory failure. */
 				}
 			}
-			
-			/* Transform Clipped Vertices. */
-			for (n = 0; n < VertexSet_GetCountM(&(pActors->ClippedVertexSet)); n++)
-			{
-				/* Get a new ScreenVertex. */
-				pSV = ScreenVertexSet_GetNewM(&(pActors->ClippedScreenVertices));
-				
-				if (pSV == NULL)
-					return 0;	/* Memory allocation failure. */
-
-				/* Transform vertex position. */
-				Transformation_TransformM(&FinalTrans, &(VertexSet_GetVertexM(&(pActors->ClippedVertexSet), n)->Position), &VPos);
-
-				/* VPos now contains the 3D position of the n'th clipped vertex in
-				 * rescaled viewpoint space. */
-				/* Make VPos 2D by division & adding half the width to the
-				 * center of the screen. 
-				 * THIS IS THE ACTUAL PERSPECTIVE TRANSFORMATION ! */
-				if (VPos.V[2] != 0.f)
-				{	/* This test should not be needed.... */
-					pSV->nX = nXOfs + (short)(VPos.V[0] / VPos.V[2]);
-					pSV->nY = nYOfs + (short)(VPos.V[1] / VPos.V[2]);
-				}
+		}
+	}	/* For loop for all planes. */
+
+	
+	/* If the actor should not be dropped, (!bDropActor)
+	 * clip and project it. Otherwise remove it from the list. */
+	if (bDropActor)
+		ActorPtrSet_GetActorPtrM(&(pThis->PrepActors), nItem) = NULL;
+	else
+	{
+		/* Concatenate the transformation from the Actor to the Root
+		 * with the transformation from the Root to the Viewpoint. */
+		Transformation_Concatenate(pTransToViewpoint, &TransFromActor, &FinalTrans);
+		
+		/* Transform point (0,0,0) from the Viewpoint Frame to the Actor
+		 * Frame. This is the Viewpoint's origin and is used in the Draw
+		 * stage to traverse the Actor's BSP tree. */
+		Vector_ConstructM(&VPos);
+		Transformation_InvTransform(&FinalTrans, &VPos, &(pActor->ViewpointOrigin));
+		
+		/* Keep the unscaled transformation for rotating normals. */
+		ViewTrans = FinalTrans;
+
+		/* Scale the transformation X and Y rows with the Multipliers. */
+		Transformation_ScaleXYRowM(&FinalTrans, pThis->fXMultiplier, pThis->fYMultiplier);
+		
+		/* FinalTrans now contains the transformation we need to go from
+		 * the Actor frame to the Viewpoint Frame whereby the X and Y axes
+		 * have been scaled as such that after division by Z each vertex
+		 * will represent the screen coordinate whereby the center of the
+		 * screen is at (0,0). */
+
+		/* Produce a center of the screen offset from top left. */
+		nXOfs = pThis->nWidth / 2;
+		nYOfs = pThis->nHeight / 2;
+
+		/* Transform all vertices to view space once, clip the polygons
+		 * to the planes collected there. */
+		if (!Viewpoint_TransformActor(pScratch, pActor, &FinalTrans, nXOfs, nYOfs) ||
+			 !Viewpoint_ClipActor(pScratch, pActor))
+		{	pScratch->bFailed = 1;
+			return;	/* Memory failure. */
+		}
+
+		/* Rotate the direction of all lights into the Actor frame,
+		 * TempFloatSet holds them as X, Y, Z triples. */
+		pScratch->TempFloatSet.nCount = 0;
+		for (pLight = pThis->pDirLights; pLight != NULL; pLight = pLight->pNext)
+		{	Frame_GetTransformationToRoot(&(pLight->DirLightFrame), &TransFromLight);
+			Transformation_Rotate(&TransFromLight, &(pLight->Direction), &Temporarypoint);
+			Transformation_InvRotate(&TransFromActor, &Temporarypoint, &Temporarypoint);
+			if (!FloatSet_AddM(&(pScratch->TempFloatSet), Temporarypoint.V[0]) ||
+				 !FloatSet_AddM(&(pScratch->TempFloatSet), Temporarypoint.V[1]) ||
+				 !FloatSet_AddM(&(pScratch->TempFloatSet), Temporarypoint.V[2]))
+			{	pScratch->bFailed = 1;
+				return;	/* Memory allocation failure. */
 			}
 		}
 		
-		/* Proceed with next actor in the list. */
-		pActors = pActors->pNext;
+		/* Light the vertices left, the clipped ones are in view space
+		 * already and only need projecting. */
+		Viewpoint_LightVertices(pThis, pScratch, pActor, &ViewTrans);
+		Transformation_Construct(&ClipTrans);
+		pActor->ClippedScreenVertices.nCount = 0;
+		if (!Viewpoint_ProjectVertices(pThis, pScratch, &(pScratch->ClipVertices),
+										 &(pActor->ClippedScreenVertices),
+										 &ClipTrans, &ViewTrans, nXOfs, nYOfs))
+			pScratch->bFailed = 1;	/* Memory allocation failure. */
 	}
-	/* Success! */
-	return 1;
 }
 
 /********************************************************************
-* Function : Viewpoint_DrawActorTree() (Used by Viewpoint_DrawActor)
-* Purpose : Recursive function that traverses an entire HPlane
-*           tree and renders polygons in the required order.
-* Pre : pThis points to an initialized Viewpoint structure with
-*       a bitmap associated to it. pActor points to an initialized
-*       Actor structure. pPlane points to a HPlane structure from the
-*       tree of with pActor's model. nLevel indicates the number
-*       of subspaces left in the tree of pPlane.
-*       Viewpoint_PrepActorsForDraw() must have been called on the
-*       Viewpoint structure (pThis) and the Actor (pActor).
-* Post : The bitmap in the Viewpoint (pThis->pBitmap) now contains
-*        the whole subtree of pPlane (including all actors in the
-*        subspaces) drawn.
+* Function : Viewpoint_TransformActor()
+* Purpose : Helper to Viewpoint_PrepActor(), transforms the vertices
+*           of the Model of an Actor to view space and projects them.
+* Pre : pScratch points to the PrepScratch of the thread, it's
+*       ClipPlanes holding the planes to clip to. pActor points to the
+*       Actor being prepared, pFinalTrans to the transformation from
+*       it's frame to rescaled view space. nXOfs, nYOfs is the center
+*       of the screen.
+* Post : If the returnvalue is 1, the NormalScreenVertices of pActor
+*        hold the screen positions of the vertices of it's Model,
+*        except for those at Z = 0 in view space. If there are planes,
+*        the positions in view space are in the ViewVertices of
+*        pScratch and their outcodes in arOutcodes.
+*        If the returnvalue is 0, a memory allocation failure
+*        occured.
+* Note : The vertices are projected and classified by VertexBlock, a
+*        block of vertices at a time. The lighting is left until it's
+*        known which vertices are visible.
 ********************************************************************/
-void Viewpoint_DrawActorTree(struct Viewpoint *pThis,
-								  struct Actor *pActor,
-								  struct HPlane *pPlane,
-								  int nLevel)
+static int Viewpoint_TransformActor(struct PrepScratch *pScratch, struct Actor *pActor,
+												struct Transformation *pFinalTrans,
+												int nXOfs, int nYOfs)
 {
-	int k, n, m;
-	struct Polygon *pPoly;
-	struct ScreenVertex *pSV, *pLastSV;
+	struct VertexBlock Block;
+	struct Vertex *pViewVertex;
+	struct ScreenVertex *pSV;
+	unsigned long *arOutcodes;
+	int nPlanes, nVertices;
+	int n, m;
 
-	/* Check if we reached one of our tree's leafs. */
-	if (pPlane == NULL)
-	{	/* We've reached a leaf, setup a new tree
-		 * for traversal. */
+	nVertices = VertexSet_GetCountM(&(pActor->pModel->Vertices));
+	if (!ScreenVertexSet_AtLeast(&(pActor->NormalScreenVertices), nVertices))
+		return 0;	/* Memory allocation failure. */
+	pActor->NormalScreenVertices.nCount = nVertices;
 
-		/* Check if there is an Actor in this leaf. */
-		pActor = ActorPtrSet_GetActorPtrM(&(pActor->SubActorSet), nLevel);
-		if (pActor != NULL)
-		{	/* Call ourselves recursively, but now using
-			 * the embedded Actor from the current subspace. */
-			Viewpoint_DrawActorTree(pThis,pActor, pActor->pModel->pRoot, 0);
+	nPlanes = PlaneSet_GetCountM(&(pScratch->ClipPlanes));
+	if (nPlanes != 0)
+	{	if (!VertexSet_AtLeast(&(pScratch->ViewVertices), nVertices))
+			return 0;	/* Memory allocation failure. */
+		pScratch->ViewVertices.nCount = nVertices;
+		if (nVertices > pScratch->nOutcodeAlloc)
+		{	arOutcodes = (unsigned long *)realloc((void *)pScratch->arOutcodes,
+																sizeof(unsigned long) * nVertices);
+			if (arOutcodes == NULL)
+				return 0;	/* Memory allocation failure. */
+			pScratch->arOutcodes = arOutcodes;
+			pScratch->nOutcodeAlloc = nVertices;
 		}
-	} else
-	{	/* Check on what side the viewpoint's origin is on this
-		 * given hyperplane. */
-		if (0.f < Plane_DistanceOfVectorM(&(pPlane->BinPlane), &(pActor->ViewpointOrigin)))
-		{
-			/* The viewpoint is on the outside of the plane.
-			 * first draw the inside, then draw the polygons that
-			 * are coplanar with the current plane and visible from
-			 * the outside of the plane,
-			 * then draw the outside. This is Back to Front
-			 * drawing. */
-			Viewpoint_DrawActorTree(pThis, pActor, pPlane->pInSubtree, nLevel);
-			
-			/* Iterate all polygons visible from the outside of the plane. */
-			for (n = 0; n < IndexSet_GetCountM(&(pPlane->OutsideIndices)); n++)
-			{	/* Get index of polygon. */
-				m = IndexSet_GetIndexM(&(pPlane->OutsideIndices), n);
-				/* Get polygon from index. */
-				pPoly = PolySet_GetPolygonM(pActor->pSrcPolySet, m);
-
-				/* Get last vertex of polygon. */
-				m = IndexSet_GetCountM(&(pPoly->Vertices)) - 1;
-				/* Only display polygons with more than 2 vertices. */
-				if (m > 1)
-				{
-					m = IndexSet_GetIndexM(&(pPoly->Vertices), m);
-	
-					/* Get ScreenVertex for vertex j. */
-					if (m < 0)
-						pLastSV = ScreenVertexSet_GetScreenVertexM(&(pActor->ClippedScreenVertices), ~m);
-					else
-						pLastSV = ScreenVertexSet_GetScreenVertexM(&(pActor->NormalScreenVertices), m);
-					
-					/* Iterate all vertices of poly, building spans from them in the
-					 * edge table. */
-					EdgeTable_WhipeM(&(pThis->PolyEdgeTable));
-					for (m = 0; m < IndexSet_GetCountM(&(pPoly->Vertices)); m++)
-					{	/* Get ScreenVertex. */
-						k = IndexSet_GetIndexM(&(pPoly->Vertices), m);
-						if (k < 0)
-							pSV = ScreenVertexSet_GetScreenVertexM(&(pActor->ClippedScreenVertices), ~k);
-						else
-							pSV = ScreenVertexSet_GetScreenVertexM(&(pActor->NormalScreenVertices), k);
-						EdgeTable_AddEdge(&(pThis->PolyEdgeTable), pLastSV, pSV);
-						pLastSV = pSV;
-					}
-					
-					/* Draw the polygon. */
-					Viewpoint_DrawPolygon (pThis, pPoly);
-				}
+	}
+
+	for (n = 0; n < nVertices; n += VERTEXBLOCK_SIZE)
+	{	/* Project the positions of the next block. */
+		VertexBlock_Load(&Block, VertexSet_GetVertexM(&(pActor->pModel->Vertices), n),
+							  nVertices - n < VERTEXBLOCK_SIZE ? nVertices - n : VERTEXBLOCK_SIZE);
+		VertexBlock_Project(&Block, pFinalTrans);
+
+		/* Keep the positions in view space to clip to. */
+		if (nPlanes != 0)
+		{	VertexBlock_Classify(&Block, pScratch->ClipPlanes.arPlanes, nPlanes);
+			for (m = 0; m < Block.nCount; m++)
+			{	pViewVertex = VertexSet_GetVertexM(&(pScratch->ViewVertices), n + m);
+				pViewVertex->Position.V[0] = Block.arViewX[m];
+				pViewVertex->Position.V[1] = Block.arViewY[m];
+				pViewVertex->Position.V[2] = Block.arDepth[m];
+				pScratch->arOutcodes[n + m] = Block.arOutcodes[m];
 			}
-			
-			/* Draw the outside. */
-			Viewpoint_DrawActorTree(pThis, pActor, pPlane->pOutSubtree,
-											nLevel + pPlane->nInsideLeafCount);
-		} else
-		{
-			/* The viewpoint is on the inside of the plane.
-			 * first draw the outside, then draw the polygons that
-			 * are coplanar with the current plane and visible from
-			 * the inside of the plane,
-			 * then draw the inside. This is Back to Front
-			 * drawing. */
-			Viewpoint_DrawActorTree(pThis, pActor, pPlane->pOutSubtree,
-											nLevel + pPlane->nInsideLeafCount);
-			
-			/* Iterate all polygons visible from the inside of the plane. */
-			for (n = 0; n < IndexSet_GetCountM(&(pPlane->InsideIndices)); n++)
-			{	/* Get index of polygon. */
-				m = IndexSet_GetIndexM(&(pPlane->InsideIndices), n);
-				/* Get polygon from index. */
-				pPoly = PolySet_GetPolygonM(pActor->pSrcPolySet, m);
-
-				/* Get last vertex of polygon. */
-				m = IndexSet_GetCountM(&(pPoly->Vertices)) - 1;
-				/* Only display polygons with more than 2 vertices. */
-				if (m > 1)
-				{
-					m = IndexSet_GetIndexM(&(pPoly->Vertices), m);
-	
-					/* Get ScreenVertex for vertex m. */
-					if (m < 0)
-						pLastSV = ScreenVertexSet_GetScreenVertexM(&(pActor->ClippedScreenVertices), ~m);
-					else
-						pLastSV = ScreenVertexSet_GetScreenVertexM(&(pActor->NormalScreenVertices), m);
-					
-					/* Iterate all vertices of poly, building spans from them in the
-					 * edge table. */
-					EdgeTable_WhipeM(&(pThis->PolyEdgeTable));
-					for (m = 0; m < IndexSet_GetCountM(&(pPoly->Vertices)); m++)
-					{	/* Get ScreenVertex. */
-						k = IndexSet_GetIndexM(&(pPoly->Vertices), m);
-						if (k < 0)
-							pSV = ScreenVertexSet_GetScreenVertexM(&(pActor->ClippedScreenVertices), ~k);
-						else
-							pSV = ScreenVertexSet_GetScreenVertexM(&(pActor->NormalScreenVertices), k);
-						EdgeTable_AddEdge(&(pThis->PolyEdgeTable), pLastSV, pSV);
-						pLastSV = pSV;
-					}
-
-					/* Draw the polygon. */
-					Viewpoint_DrawPolygon (pThis, pPoly);
-				}
+		}
+
+		/* Scatter them to the ScreenVertices. */
+		for (m = 0; m < Block.nCount; m++)
+		{	pSV = ScreenVertexSet_GetScreenVertexM(&(pActor->NormalScreenVertices), n + m);
+
+			/* Add half the width to the center of the screen.
+			 * The perspective division itself was done by the block. */
+			if (Block.arDepth[m] != 0.f)
+			{	/* This test should not be needed.... */
+				pSV->nX = nXOfs + (short)Block.arSX[m];
+				pSV->nY = nYOfs + (short)Block.arSY[m];
+
+				/* 1 / Z, for perspective correct texture mapping. */
+				pSV->fIZ = Block.arIZ[m];
 			}
-			/* Draw the inside. */
-			Viewpoint_DrawActorTree(pThis, pActor, pPlane->pInSubtree, nLevel);
 		}
-	}				
-}
-	
-/********************************************************************
-* Function : Viewpoint_Draw()
-* Purpose : Draws all Actors that were prepared for drawing by a call
-*           to Viewpoint_PrepActorsForDraw().
-* Pre : pThis points to an initialized Viewpoint structure with
-*       a bitmap associated with it. pThis has just been used in a
-*       Viewpoint_PrepActorsForDraw() call.
-* Post : All Actors were rendered in correct order in the pBitmap
-*        bitmap in the Viewpoint structure.
-********************************************************************/
-int Viewpoint_Draw(struct Viewpoint *pThis)
-{
-	/* Call the Viewpoint_DrawActorTree() helper function. */
-	/* Only draw something when there is an Actor inside
-	 * the View Frustrum. */
-	if (pThis->pRootActor != NULL)
-		Viewpoint_DrawActorTree(pThis, pThis->pRootActor,
-					pThis->pRootActor->pModel->pRoot,
-					0);
+	}
 	return 1;
 }
 
 /********************************************************************
-* Function : Viewpoint_SetRendermode()
-* Purpose : Select the kind of rendering we want in this Viewpoint.
-*         See header about accepted modes.
-* Post : Returns 1 if this Viewpoint successfully accepted this mode.
-*       All rendering using this Viewpoint will use this mode,
-*       other possible Viewpoints will not be affected.
+* Function : Viewpoint_ClipActor()
+* Purpose : Helper to Viewpoint_PrepActor(), clips the polygons of an
+*           Actor to the planes it intersects.
+* Pre : pScratch points to the PrepScratch of the thread, it's
+*       ClipPlanes holding the planes to clip to, the vertices of the
+*       Model of pActor transformed to the same space by
+*       Viewpoint_TransformActor().
+* Post : If the returnvalue is 1, the arpPolygons of pActor point to
+*        the polygons to display, clipped to all planes. New vertices
+*        are in view space in the ClipVertices of pScratch.
+*        If the returnvalue is 0, a memory failure occured.
+* Note : A polygon with all vertices inside every plane is displayed
+*        as it is, without copying it. One with all vertices outside
+*        the same plane becomes an empty polygon. Only the rest is
+*        clipped, and only to the planes it crosses.
 ********************************************************************/
-int Viewpoint_SetRendermode(struct Viewpoint *pThis, unsigned char mode)
+static int Viewpoint_ClipActor(struct PrepScratch *pScratch, struct Actor *pActor)
 {
-	switch( mode )
-	{
+	struct Polygon *pPoly;
+	struct Polygon *pTrgPoly;
+	struct Polygon **arpPolygons;
+	unsigned long ulAnd, ulOr;
+	int nPolygons;
+	int n, m;
+
+	/* Make room for a pointer to every polygon. */
+	nPolygons = PolySet_GetCountM(&(pActor->pModel->Polygons));
+	if (nPolygons > pActor->nPolygonAlloc)
+	{	arpPolygons = (struct Polygon **)realloc((void *)pActor->arpPolygons,
+															  sizeof(struct Polygon *) * nPolygons);
+		if (arpPolygons == NULL)
+			return 0;	/* Memory failure. */
+		pActor->arpPolygons = arpPolygons;
+		pActor->nPolygonAlloc = nPolygons;
+	}
+	pActor->ClippedPolySet.nCount = 0;
+	pScratch->ClipVertices.nCount = 0;
+
+	/* Without planes all polygons are displayed as they are. */
+	if (PlaneSet_GetCountM(&(pScratch->ClipPlanes)) == 0)
+	{	for (n = 0; n < nPolygons; n++)
+			pActor->arpPolygons[n] = PolySet_GetPolygonM(&(pActor->pModel->Polygons), n);
+		return 1;
+	}
+
+	/* Classify the polygons by the outcodes of their vertices. */
+	for (n = 0; n < nPolygons; n++)
+	{	pPoly = PolySet_GetPolygonM(&(pActor->pModel->Polygons), n);
+		ulAnd = ~0UL;
+		ulOr = 0;
+		for (m = 0; m < IndexSet_GetCountM(&(pPoly->Vertices)); m++)
+		{	ulAnd &= pScratch->arOutcodes[IndexSet_GetIndexM(&(pPoly->Vertices), m)];
+			ulOr |= pScratch->arOutcodes[IndexSet_GetIndexM(&(pPoly->Vertices), m)];
+		}
+		if (ulOr == 0)
+		{	/* Fully inside, display it as it is. */
+			pActor->arpPolygons[n] = pPoly;
+			continue;
+		}
+
+		/* The polygon goes to ClippedPolySet, which may still move,
+		 * so it's pointed to afterwards. */
+		pActor->arpPolygons[n] = NULL;
+		if (ulAnd & ~VertexBlock_OutcodeBitM(VERTEXBLOCK_OUTCODEBITS - 1))
+		{	/* Fully outside one of the planes, nothing is left. The
+			 * shared last bit doesn't tell which plane it was. */
+			pTrgPoly = PolySet_GetNewM(&(pActor->ClippedPolySet));
+			if (pTrgPoly == NULL)
+				return 0;	/* Memory failure. */
+			pTrgPoly->ulRGB = pPoly->ulRGB;
+			pTrgPoly->usRGB565 = pPoly->usRGB565;
+			pTrgPoly->pLightmap = pPoly->pLightmap;
+			pTrgPoly->nFlags = pPoly->nFlags;
+		} else if (!Viewpoint_ClipPolygon(pScratch, pActor, pPoly, ulOr))
+			return 0;	/* Memory failure. */
+	}
+
+	/* Point to the clipped polygons, in the order they were added. */
+	for (n = 0, m = 0; n < nPolygons; n++)
+		if (pActor->arpPolygons[n] == NULL)
+			pActor->arpPolygons[n] = PolySet_GetPolygonM(&(pActor->ClippedPolySet), m++);
+	return 1;
+}
+
+/********************************************************************
+* Function : Viewpoint_ClipPolygon()
+* Purpose : Helper to Viewpoint_ClipActor(), clips a polygon of the
+*           Model of an Actor to the planes it crosses.
+* Pre : pScratch and pActor are as Viewpoint_ClipActor(). pPoly
+*       points to a polygon of the Model, ulOr holds the bits of the
+*       planes any of it's vertices is outside of.
+* Post : If the returnvalue is 1, the clipped polygon has been added
+*        to the ClippedPolySet of pActor, new vertices to the
+*        ClipVertices of pScratch.
+*        If the returnvalue is 0, a memory failure occured.
+* Note : The planes are clipped to in order, with the planes sharing
+*        the last outcode bit all clipped to when it is set.
+*        The distances are only calculated for the vertices of the
+*        polygon, and for each plane of the clipped polygon so far,
+*        those of the new vertices included.
+********************************************************************/
+static int Viewpoint_ClipPolygon(struct PrepScratch *pScratch, struct Actor *pActor,
+											struct Polygon *pPoly, unsigned long ulOr)
+{
+	struct Plane *pPlane;
+	struct Polygon *pSrcPoly;
+	struct Polygon *pTrgPoly;
+	struct Vertex *pVertex;
+	struct Vertex *pViewVertex;
+	int nPlanes, nLast;
+	int nClip;
+	int n, m, k;
+
+	/* Find the last plane to clip to, it's result goes straight to
+	 * the ClippedPolySet. */
+	nPlanes = PlaneSet_GetCountM(&(pScratch->ClipPlanes));
+	for (nLast = nPlanes - 1; !(ulOr & VertexBlock_OutcodeBitM(nLast)); nLast--)
+		;
+
+	if (!FloatSet_AtLeast(&(pScratch->TempFloatSet),
+								 VertexSet_GetCountM(&(pScratch->ViewVertices))))
+		return 0;	/* Memory failure. */
+
+	/* Complete the vertices of the polygon in view space, the
+	 * normals are interpolated as well. */
+	for (m = 0; m < IndexSet_GetCountM(&(pPoly->Vertices)); m++)
+	{	k = IndexSet_GetIndexM(&(pPoly->Vertices), m);
+		pVertex = VertexSet_GetVertexM(&(pActor->pModel->Vertices), k);
+		pViewVertex = VertexSet_GetVertexM(&(pScratch->ViewVertices), k);
+		pViewVertex->Normal = pVertex->Normal;
+	}
+
+	pSrcPoly = pPoly;
+	nClip = 0;
+	for (n = 0; n <= nLast; n++)
+	{	if (!(ulOr & VertexBlock_OutcodeBitM(n)))
+			continue;	/* Fully inside this plane. */
+		pPlane = PlaneSet_GetPlaneM(&(pScratch->ClipPlanes), n);
+
+		/* Produce the distances of the vertices of the polygon. */
+		if (!FloatSet_AtLeast(&(pScratch->TempFloatSet2),
+									 VertexSet_GetCountM(&(pScratch->ClipVertices))))
+			return 0;	/* Memory failure. */
+		for (m = 0; m < IndexSet_GetCountM(&(pSrcPoly->Vertices)); m++)
+		{	k = IndexSet_GetIndexM(&(pSrcPoly->Vertices), m);
+			if (k < 0)
+			{	/* Negatively indexed, a clipped vertex. */
+				pVertex = VertexSet_GetVertexM(&(pScratch->ClipVertices), ~k);
+				pScratch->TempFloatSet2.arFloats[~k] =
+					Plane_DistanceOfVectorM(pPlane, &(pVertex->Position));
+			} else
+			{	pVertex = VertexSet_GetVertexM(&(pScratch->ViewVertices), k);
+				pScratch->TempFloatSet.arFloats[k] =
+					Plane_DistanceOfVectorM(pPlane, &(pVertex->Position));
+			}
+		}
+
+		/* Clip it, into one of the scratch polygons unless this is the
+		 * last plane. */
+		if (n == nLast)
+		{	pTrgPoly = PolySet_GetNewM(&(pActor->ClippedPolySet));
+			if (pTrgPoly == NULL)
+				return 0;	/* Memory failure. */
+		} else
+		{	pTrgPoly = &(pScratch->arClipPolygons[nClip]);
+			pTrgPoly->Vertices.nCount = 0;
+			nClip ^= 1;
+		}
+		if (!Plane_ClipPolygon(pPlane, pSrcPoly, &(pScratch->TempFloatSet),
+									  &(pScratch->ViewVertices),
+									  &(pScratch->TempFloatSet2), pTrgPoly,
+									  &(pScratch->ClipVertices)))
+			return 0;	/* Memory failure. */
+		pSrcPoly = pTrgPoly;
+	}
+	return 1;
+}
+
+/********************************************************************
+* Function : Viewpoint_LightVertices()
+* Purpose : Helper to Viewpoint_PrepActor(), calculates the intensity
+*           and chrome coordinates of the visible vertices of the
+*           Model of an Actor.
+* Pre : pThis points to an initialized Viewpoint structure, pScratch
+*       to the PrepScratch of the thread, it's TempFloatSet holding
+*       the light directions (see Viewpoint_CalcIntensity()). pActor
+*       points to the Actor being prepared, it's polygons clipped by
+*       Viewpoint_ClipActor(). pViewTrans is the unscaled
+*       transformation from the frame of pActor to view space.
+* Post : The NormalScreenVertices of pActor used by it's polygons are
+*        lit, and faded with their depth if depth cueing is on.
+* Note : A vertex is left in a clipped polygon only if it's inside
+*        all planes, those outside aren't lit.
+********************************************************************/
+static void Viewpoint_LightVertices(struct Viewpoint *pThis,
+												struct PrepScratch *pScratch,
+												struct Actor *pActor,
+												struct Transformation *pViewTrans)
+{
+	struct Vertex *pVertex;
+	struct ScreenVertex *pSV;
+	int bClipped;
+	int bCue;
+	int n;
+
+	bClipped = (PlaneSet_GetCountM(&(pScratch->ClipPlanes)) != 0);
+	bCue = Viewpoint_DepthCueM(pThis);
+	for (n = 0; n < VertexSet_GetCountM(&(pActor->pModel->Vertices)); n++)
+	{	if (bClipped && (pScratch->arOutcodes[n] != 0))
+			continue;	/* Clipped away. */
+		pVertex = VertexSet_GetVertexM(&(pActor->pModel->Vertices), n);
+		pSV = ScreenVertexSet_GetScreenVertexM(&(pActor->NormalScreenVertices), n);
+		pSV->nIntensity = Viewpoint_CalcIntensity(pThis, pScratch, &(pVertex->Normal));
+		if (bCue && (pSV->fIZ > 0.f))
+			pSV->nIntensity = Viewpoint_CueIntensity(pThis, pSV->nIntensity, 1.f / pSV->fIZ);
+		Viewpoint_CalcChromeCoords(pViewTrans, &(pVertex->Normal), pSV);
+	}
+}
+
+/********************************************************************
+* Function : Viewpoint_ProjectVertices()
+* Purpose : Helper to Viewpoint_PrepActor(), transforms vertices to
+*           the screen and lights them.
+* Pre : pThis points to an initialized Viewpoint structure, pScratch
+*       to the PrepScratch of the thread, it's TempFloatSet holding
+*       the light directions (see Viewpoint_CalcIntensity()). pVertices
+*       to the vertices to transform, pScreenVertices to the (empty)
+*       ScreenVertexSet receiving them. pFinalTrans transforms to
+*       rescaled view space (no operation for the vertices created by
+*       clipping, they're there already), pViewTrans the normals to
+*       unscaled view space.
+*       nXOfs, nYOfs is the center of the screen.
+* Post : If the returnvalue is 1, pScreenVertices holds a ScreenVertex
+*        for every vertex in pVertices, faded with their depth if
+*        depth cueing is on. Those at Z = 0 in view space only have
+*        their intensity and chrome coordinates set.
+*        If the returnvalue is 0, a memory allocation failure
+*        occured.
+* Note : The positions are projected by VertexBlock, a block of
+*        vertices at a time.
+********************************************************************/
+static int Viewpoint_ProjectVertices(struct Viewpoint *pThis,
+												 struct PrepScratch *pScratch,
+												 struct VertexSet *pVertices,
+												 struct ScreenVertexSet *pScreenVertices,
+												 struct Transformation *pFinalTrans,
+												 struct Transformation *pViewTrans,
+												 int nXOfs, int nYOfs)
+{
+	struct VertexBlock Block;
+	struct Vertex *pVertex;
+	struct ScreenVertex *pSV;
+	int bCue;
+	int nCount;
+	int n, m;
+
+	bCue = Viewpoint_DepthCueM(pThis);
+	nCount = VertexSet_GetCountM(pVertices);
+	if (!ScreenVertexSet_AtLeast(pScreenVertices, nCount))
+		return 0;	/* Memory allocation failure. */
+	pScreenVertices->nCount = nCount;
+
+	for (n = 0; n < nCount; n += VERTEXBLOCK_SIZE)
+	{	/* Project the positions of the next block. */
+		VertexBlock_Load(&Block, VertexSet_GetVertexM(pVertices, n),
+							  nCount - n < VERTEXBLOCK_SIZE ? nCount - n : VERTEXBLOCK_SIZE);
+		VertexBlock_Project(&Block, pFinalTrans);
+
+		/* Scatter them to the ScreenVertices, the lighting is done
+		 * per vertex. */
+		for (m = 0; m < Block.nCount; m++)
+		{	pVertex = VertexSet_GetVertexM(pVertices, n + m);
+			pSV = ScreenVertexSet_GetScreenVertexM(pScreenVertices, n + m);
+			pSV->nIntensity = Viewpoint_CalcIntensity(pThis, pScratch, &(pVertex->Normal));
+			if (bCue && (Block.arDepth[m] > 0.f))
+				pSV->nIntensity = Viewpoint_CueIntensity(pThis, pSV->nIntensity,
+																	  Block.arDepth[m]);
+			Viewpoint_CalcChromeCoords(pViewTrans, &(pVertex->Normal), pSV);
+
+			/* Add half the width to the center of the screen.
+			 * The perspective division itself was done by the block. */
+			if (Block.arDepth[m] != 0.f)
+			{	/* This test should not be needed.... */
+				pSV->nX = nXOfs + (short)Block.arSX[m];
+				pSV->nY = nYOfs + (short)Block.arSY[m];
+
+				/* 1 / Z, for perspective correct texture mapping. */
+				pSV->fIZ = Block.arIZ[m];
+			}
+		}
+	}
+	return 1;
+}
+
+/********************************************************************
+* Function : Viewpoint_CalcIntensity()
+* Purpose : Helper to Viewpoint_PrepActorsForDraw, calculates the
+*           intensity of a vertex from it's normal.
+* Pre : pThis points to a Viewpoint, the TempFloatSet of pScratch
+*       holds the directions of all it's lights in the frame of
+*       pNormal.
+* Post : Returns the intensity, 0 for unlit to 255 for fully lit.
+*        Without any lights, the vertex is fully lit.
+********************************************************************/
+static unsigned char Viewpoint_CalcIntensity(struct Viewpoint *pThis,
+															struct PrepScratch *pScratch,
+															struct Vector *pNormal)
+{
+	float	fIntensity;
+	float	fLight;
+	float	*pDir;
+	int	n;
+
+	if (pThis->pDirLights == NULL)
+		return 255;
+
+	/* Sum the ambient light and all lights facing the normal. */
+	fIntensity = pThis->fAmbient;
+	pDir = pScratch->TempFloatSet.arFloats;
+	for (n = 0; n < pScratch->TempFloatSet.nCount; n += 3, pDir += 3)
+	{	fLight = pDir[0] * pNormal->V[0] + pDir[1] * pNormal->V[1] + pDir[2] * pNormal->V[2];
+		if (fLight > 0.f)
+			fIntensity += fLight;
+	}
+
+	/* Clamp overlight. */
+	if (fIntensity >= 1.f)
+		return 255;
+	if (fIntensity <= 0.f)
+		return 0;
+	return (unsigned char)(fIntensity * 255.f);
+}
+
+/********************************************************************
+* Function : Viewpoint_CueIntensity()
+* Purpose : Helper to Viewpoint_PrepActorsForDraw, fades the
+*           intensity of a vertex with it's depth.
+* Pre : pThis points to a Viewpoint with depth cueing on (see
+*       Viewpoint_DepthCueM()), fDepth is the Z of the vertex in
+*       view space.
+* Post : Returns nIntensity up to the fFadeDistance of pThis, from
+*        there on less, down to 0 at the far plane.
+********************************************************************/
+static unsigned char Viewpoint_CueIntensity(struct Viewpoint *pThis,
+														  unsigned char nIntensity, float fDepth)
+{
+	if (fDepth <= pThis->fFadeDistance)
+		return nIntensity;
+	if (fDepth >= pThis->fFarDistance)
+		return 0;
+	return (unsigned char)(nIntensity * (pThis->fFarDistance - fDepth) /
+								  (pThis->fFarDistance - pThis->fFadeDistance));
+}
+
+/********************************************************************
+* Function : Viewpoint_CalcChromeCoords()
+* Purpose : Helper to Viewpoint_PrepActorsForDraw, calculates the
+*           chrome map coordinates of a vertex from it's normal.
+* Pre : pViewTrans points to the (unscaled) transformation from the
+*       frame of pNormal to the Viewpoint frame, pSV points to the
+*       ScreenVertex of the vertex.
+* Post : pSV->nCX and pSV->nCY contain the texel (0..255) at which the
+*        chrome map reflects in the vertex.
+* Note : The X and Y of the normal in view space directly select the
+*        texel, like looking at a chrome ball with the chrome map
+*        painted on it. A normal facing the viewer maps to the center
+*        of the texture.
+********************************************************************/
+static void Viewpoint_CalcChromeCoords(struct Transformation *pViewTrans,
+												  struct Vector *pNormal,
+												  struct ScreenVertex *pSV)
+{
+	struct Vector ViewNormal;
+	float fX, fY;
+
+	Transformation_Rotate(pViewTrans, pNormal, &ViewNormal);
+	fX = 127.5f + ViewNormal.V[0] * 127.5f;
+	fY = 127.5f + ViewNormal.V[1] * 127.5f;
+
+	/* Clamp unnormalized normals to the texture. */
+	pSV->nCX = (short)((fX < 0.f) ? 0.f : ((fX > 255.f) ? 255.f : fX));
+	pSV->nCY = (short)((fY < 0.f) ? 0.f : ((fY > 255.f) ? 255.f : fY));
+}
+
+/********************************************************************
+* Function : Viewpoint_ScanPolygon()
+* Purpose : Helper to Viewpoint_DrawActorTree, builds the edges of a
+*           polygon in an EdgeTable and draws it.
+* Pre : pThis points to an initialized Viewpoint, pEdgeTable to the
+*       EdgeTable to use (the PolyEdgeTable of pThis, or that of a
+*       tile), pActor to an Actor prepared for drawing and pPoly to
+*       one of it's polygons. pPending is NULL, or holds the color of
+*       the pending spans of pEdgeTable.
+* Post : pPoly has been drawn, clipped to the scissor rectangle of
+*        pEdgeTable, if it has more than 2 vertices. If pPending is
+*        not NULL, it may have been coalesced with the pending spans
+*        instead, see Viewpoint_FillPolygon().
+********************************************************************/
+static void Viewpoint_ScanPolygon(struct Viewpoint *pThis,
+											 struct EdgeTable *pEdgeTable,
+											 struct Actor *pActor,
+											 struct Polygon *pPoly,
+											 struct PolyCommand *pPending)
+{
+	int m, nCount;
+	struct ScreenVertex *pSV, *pLastSV;
+	struct ScreenVertex *arpSV[VIEWPOINT_TINYVERTICES];
+	struct ScreenVertex arTexSV[VIEWPOINT_TINYVERTICES];
+	struct ScreenVertex arEdgeSV[2];
+	Viewpoint_AddEdgeFunc pAddEdge;
+	struct PolyCommand Command;
+
+	/* Only display polygons with more than 2 vertices. */
+	nCount = IndexSet_GetCountM(&(pPoly->Vertices));
+	if (nCount <= 2)
+		return;
+
+	/* Polygons of another color must not be drawn before the pending
+	 * ones. */
+	PolyCommand_SetPolygonM(&Command, pPoly);
+	if ((pPending != NULL) && EdgeTable_HasPendingM(pEdgeTable) &&
+		 !PolyCommand_CanMergeM(pPending, &Command))
+		Viewpoint_FlushSpans(pThis, pEdgeTable, pPending);
+
+	if (nCount <= VIEWPOINT_TINYVERTICES)
+	{	/* Small enough to look at the screen bounds first. */
+		for (m = 0; m < nCount; m++)
+			arpSV[m] = Actor_GetScreenVertex(pActor, pPoly, m, &(arTexSV[m]));
+		if (Viewpoint_CheckSmallPolygon(pThis, pEdgeTable, &Command, arpSV, nCount))
+			return;	/* Rejected or plotted. */
+	}
+
+	/* Get ScreenVertex for the last vertex. Textured vertices are
+	 * copied, alternately into the two of arEdgeSV. */
+	pLastSV = Actor_GetScreenVertex(pActor, pPoly, nCount - 1, &(arEdgeSV[0]));
+
+	/* Select the edges that carry the vertex attributes the fill
+	 * needs. */
+	pAddEdge = Viewpoint_SelectAddEdge(pPoly->nFlags);
+
+	/* Iterate all vertices of poly, building spans from them in the
+	 * edge table. */
+	EdgeTable_WhipeM(pEdgeTable);
+	for (m = 0; m < nCount; m++)
+	{	pSV = Actor_GetScreenVertex(pActor, pPoly, m, &(arEdgeSV[(m & 1) ^ 1]));
+		pAddEdge(pEdgeTable, pLastSV, pSV);
+		pLastSV = pSV;
+	}
+
+	/* Draw the polygon. */
+	Viewpoint_FillPolygon(pThis, pEdgeTable, &Command, pPending);
+}
+
+/********************************************************************
+* Function : Viewpoint_SelectAddEdge()
+* Purpose : Helper to Viewpoint_ScanPolygon and
+*           Viewpoint_ScanCommand, selects the EdgeTable function
+*           adding the edges of a polygon.
+* Pre : nFlags are the POLFLAGS of the polygon.
+* Post : Returns the function adding edges that carry the vertex
+*        attributes the fill of the polygon needs.
+********************************************************************/
+static Viewpoint_AddEdgeFunc Viewpoint_SelectAddEdge(unsigned long nFlags)
+{
+	switch (nFlags)
+	{	case PF_DYNACOLOR :
+			return EdgeTable_AddGouraudEdge;
+		case PF_CHROME :
+			return EdgeTable_AddChromeEdge;
+		case PF_TEXTURE :
+			return EdgeTable_AddTextureEdge;
+	}
+	return EdgeTable_AddEdge;
+}
+
+/********************************************************************
+* Function : Viewpoint_ScanCommand()
+* Purpose : Helper to Viewpoint_DrawCommands, builds the edges of a
+*           screen polygon in an EdgeTable and draws it.
+* Pre : pThis points to an initialized Viewpoint, pEdgeTable to the
+*       EdgeTable to use, pCommand to the screen polygon and
+*       arVertices to it's pCommand->nVertices ScreenVertex
+*       structures. pPending is as for Viewpoint_ScanPolygon().
+* Post : The polygon has been drawn, clipped to the scissor rectangle
+*        of pEdgeTable, if it has more than 2 vertices, or coalesced
+*        with the pending spans.
+********************************************************************/
+static void Viewpoint_ScanCommand(struct Viewpoint *pThis,
+											 struct EdgeTable *pEdgeTable,
+											 struct PolyCommand *pCommand,
+											 struct ScreenVertex *arVertices,
+											 struct PolyCommand *pPending)
+{
+	int m;
+	struct ScreenVertex *pLastSV;
+	struct ScreenVertex *arpSV[VIEWPOINT_TINYVERTICES];
+	Viewpoint_AddEdgeFunc pAddEdge;
+
+	/* Only display polygons with more than 2 vertices. */
+	if (pCommand->nVertices <= 2)
+		return;
+
+	/* Polygons of another color must not be drawn before the pending
+	 * ones. */
+	if ((pPending != NULL) && EdgeTable_HasPendingM(pEdgeTable) &&
+		 !PolyCommand_CanMergeM(pPending, pCommand))
+		Viewpoint_FlushSpans(pThis, pEdgeTable, pPending);
+
+	if (pCommand->nVertices <= VIEWPOINT_TINYVERTICES)
+	{	/* Small enough to look at the screen bounds first. */
+		for (m = 0; m < pCommand->nVertices; m++)
+			arpSV[m] = &(arVertices[m]);
+		if (Viewpoint_CheckSmallPolygon(pThis, pEdgeTable, pCommand, arpSV,
+												 pCommand->nVertices))
+			return;	/* Rejected or plotted. */
+	}
+
+	/* Build the edges, starting with the one closing the polygon. */
+	pAddEdge = Viewpoint_SelectAddEdge(pCommand->nFlags);
+	EdgeTable_WhipeM(pEdgeTable);
+	pLastSV = &(arVertices[pCommand->nVertices - 1]);
+	for (m = 0; m < pCommand->nVertices; m++)
+	{	pAddEdge(pEdgeTable, pLastSV, &(arVertices[m]));
+		pLastSV = &(arVertices[m]);
+	}
+
+	/* Draw the polygon. */
+	Viewpoint_FillPolygon(pThis, pEdgeTable, pCommand, pPending);
+}
+
+/********************************************************************
+* Function : Viewpoint_FillPolygon()
+* Purpose : Helper to Viewpoint_ScanPolygon and
+*           Viewpoint_ScanCommand, draws a polygon or coalesces it's
+*           spans with those of the polygons before it.
+* Pre : pThis points to an initialized Viewpoint, pEdgeTable to the
+*       EdgeTable holding the edges of the polygon of which pCommand
+*       holds the rendering information. pPending is NULL, or holds
+*       the color of the pending spans of pEdgeTable, which can be
+*       merged with pCommand.
+* Post : Polygons of a static color have been merged with the
+*        pending spans if pPending is not NULL, the pending spans
+*        were drawn first if they couldn't be. Others have been
+*        drawn.
+* Note : Split walls are many polygons of a single color next to each
+*        other, coalesced their spans are filled once. Drawing a
+*        color over pixels of that same color changes nothing, so
+*        this doesn't change what's drawn.
+********************************************************************/
+static void Viewpoint_FillPolygon(struct Viewpoint *pThis,
+											 struct EdgeTable *pEdgeTable,
+											 struct PolyCommand *pCommand,
+											 struct PolyCommand *pPending)
+{
+	if ((pPending == NULL) || (pCommand->nFlags != PF_STATICCOLOR))
+	{	Viewpoint_DrawPolygon(pThis, pEdgeTable, pCommand);
+		return;
+	}
+
+	if (EdgeTable_HasPendingM(pEdgeTable) && EdgeTable_MergeSpans(pEdgeTable))
+	{	/* Filled along with the pending spans. */
+		if (pEdgeTable->pStats != NULL)
+			pEdgeTable->pStats->lMerged++;
+		return;
+	}
+
+	/* Start new pending spans. */
+	Viewpoint_FlushSpans(pThis, pEdgeTable, pPending);
+	EdgeTable_MergeSpans(pEdgeTable);
+	*pPending = *pCommand;
+}
+
+/********************************************************************
+* Function : Viewpoint_FlushSpans()
+* Purpose : Draws the pending spans of an EdgeTable.
+* Pre : pThis points to an initialized Viewpoint, pEdgeTable to the
+*       EdgeTable used for drawing and pPending to the rendering
+*       information of it's pending spans, if it has any.
+* Post : The pending spans have been drawn, pEdgeTable has none.
+********************************************************************/
+static void Viewpoint_FlushSpans(struct Viewpoint *pThis,
+											struct EdgeTable *pEdgeTable,
+											struct PolyCommand *pPending)
+{
+	if (!EdgeTable_HasPendingM(pEdgeTable))
+		return;	/* Nothing pending. */
+
+	EdgeTable_SwapPending(pEdgeTable);
+	Viewpoint_DrawPolygon(pThis, pEdgeTable, pPending);
+	EdgeTable_SwapPending(pEdgeTable);
+	EdgeTable_ClearPendingM(pEdgeTable);
+}
+
+/********************************************************************
+* Function : Viewpoint_CheckSmallPolygon()
+* Purpose : Helper to Viewpoint_ScanPolygon and
+*           Viewpoint_ScanCommand, takes care of polygons that are
+*           too small to be worth an EdgeTable.
+* Pre : pThis points to an initialized Viewpoint, pEdgeTable to the
+*       EdgeTable to use, pCommand to the rendering information of
+*       the polygon and arpVertices to it's nVertices (at most
+*       VIEWPOINT_TINYVERTICES) ScreenVertex structures.
+* Post : If the returnvalue is 1, the polygon has been taken care of:
+*        it lies on a single scanline and was rejected, it covers
+*        at most 2 by 2 pixels and was plotted in a single color, or
+*        it's a small convex polygon of a static color that was
+*        filled by a HalfSpace. Each is counted in
+*        pEdgeTable->pStats, if that's not NULL. Translucent polygons
+*        are only rejected.
+*        If the returnvalue is 0, the polygon should be filled as
+*        usual.
+* Note : Tiny polygons cover exactly the pixels the fills would, only
+*        their color is that of a single vertex (or the average
+*        intensity, for gouraud shading). A HalfSpace can't be used
+*        with a span buffer.
+********************************************************************/
+static int Viewpoint_CheckSmallPolygon(struct Viewpoint *pThis,
+													struct EdgeTable *pEdgeTable,
+													struct PolyCommand *pCommand,
+													struct ScreenVertex **arpVertices,
+													int nVertices)
+{
+	struct ScreenVertex *pLastSV;
+	struct HalfSpace Blocks;
+	int nSmall;
+	unsigned long ulPixel;
+	int m;
+
+	nSmall = Viewpoint_ClassifySmallPolygon(pCommand, arpVertices, nVertices);
+	if (nSmall == VIEWPOINT_SMALL_REJECT)
+	{	if (pEdgeTable->pStats != NULL)
+			pEdgeTable->pStats->lRejected++;
+		return 1;
+	}
+	if (nSmall == VIEWPOINT_SMALL_FILL)
+		return 0;	/* Fill it. */
+	ulPixel = Viewpoint_TinyPixel(pThis, pCommand, arpVertices, nVertices);
+
+	/* Fill it in blocks if it's convex. */
+	if ((pEdgeTable->pSBuffer == NULL) &&
+		 HalfSpace_Setup(&Blocks, arpVertices, nVertices))
+	{	HalfSpace_SolidFill(&Blocks, pEdgeTable, (unsigned_int_32)ulPixel,
+								  Viewpoint_GetPixelSizeM(pThis), pThis->nPixelRow,
+								  pThis->pBitmap);
+		if (pEdgeTable->pStats != NULL)
+		{	if (nSmall == VIEWPOINT_SMALL_TINY)
+				pEdgeTable->pStats->lTiny++;
+			else
+				pEdgeTable->pStats->lHalfSpace++;
+		}
+		return 1;
+	}
+	if (nSmall != VIEWPOINT_SMALL_TINY)
+		return 0;	/* Fill it. */
+
+	/* Find the pixels it covers, the edges don't need anything but
+	 * their X positions. */
+	EdgeTable_WhipeM(pEdgeTable);
+	pLastSV = arpVertices[nVertices - 1];
+	for (m = 0; m < nVertices; m++)
+	{	EdgeTable_AddEdge(pEdgeTable, pLastSV, arpVertices[m]);
+		pLastSV = arpVertices[m];
+	}
+	EdgeTable_AddDamage(pEdgeTable);
+
+	/* Plot them. */
+	Viewpoint_SolidFill(pThis, pEdgeTable, ulPixel);
+	if (pEdgeTable->pStats != NULL)
+		pEdgeTable->pStats->lTiny++;
+	return 1;
+}
+
+/********************************************************************
+* Function : Viewpoint_ClassifySmallPolygon()
+* Purpose : Helper to Viewpoint_CheckSmallPolygon and
+*           Viewpoint_AddScanlinePolygon, decides what to do with a
+*           polygon from it's screen bounds.
+* Pre : pCommand points to the rendering information of the polygon
+*       and arpVertices to it's nVertices ScreenVertex structures.
+* Post : Returns VIEWPOINT_SMALL_REJECT if it lies on a single
+*        scanline, VIEWPOINT_SMALL_TINY if it covers at most 2 by 2
+*        pixels, VIEWPOINT_SMALL_BLOCKS if it's of a static color and
+*        a HalfSpace may fill it, VIEWPOINT_SMALL_FILL otherwise.
+*        Translucent polygons are only rejected.
+********************************************************************/
+static int Viewpoint_ClassifySmallPolygon(struct PolyCommand *pCommand,
+														 struct ScreenVertex **arpVertices,
+														 int nVertices)
+{
+	struct ScreenVertex *pSV;
+	int nMinX, nMinY, nMaxX, nMaxY;
+	int m;
+
+	/* Find the screen bounds. */
+	pSV = arpVertices[nVertices - 1];
+	nMinX = nMaxX = pSV->nX;
+	nMinY = nMaxY = pSV->nY;
+	for (m = 0; m < nVertices; m++)
+	{	pSV = arpVertices[m];
+		if (pSV->nX < nMinX)
+			nMinX = pSV->nX;
+		if (pSV->nX > nMaxX)
+			nMaxX = pSV->nX;
+		if (pSV->nY < nMinY)
+			nMinY = pSV->nY;
+		if (pSV->nY > nMaxY)
+			nMaxY = pSV->nY;
+	}
+
+	/* Polygons on a single scanline have only horizontal edges,
+	 * which give no spans. Any other polygon may cover pixels, even
+	 * one without area: a self intersecting polygon, or one that
+	 * collapsed when it was rounded to the screen. */
+	if (nMinY == nMaxY)
+		return VIEWPOINT_SMALL_REJECT;
+
+	/* Translucent polygons must blend every pixel. */
+	if (pCommand->nFlags == PF_TRANSLUCENT)
+		return VIEWPOINT_SMALL_FILL;
+
+	if (((nMaxX - nMinX) <= VIEWPOINT_TINYSIZE) &&
+		 ((nMaxY - nMinY) <= VIEWPOINT_TINYSIZE))
+		return VIEWPOINT_SMALL_TINY;
+	if ((pCommand->nFlags != PF_STATICCOLOR) ||
+		 ((nMaxX - nMinX) > HALFSPACE_MAXSIZE) ||
+		 ((nMaxY - nMinY) > HALFSPACE_MAXSIZE))
+		return VIEWPOINT_SMALL_FILL;
+	return VIEWPOINT_SMALL_BLOCKS;
+}
+
+/********************************************************************
+* Function : Viewpoint_SolidFill()
+* Purpose : Fills the spans of an EdgeTable in a single pixel value.
+* Pre : pThis points to an initialized Viewpoint, pEdgeTable to the
+*       EdgeTable holding the spans and ulPixel is in the format of
+*       the rendermode of pThis.
+* Post : The spans have been filled with ulPixel.
+********************************************************************/
+static void Viewpoint_SolidFill(struct Viewpoint *pThis,
+										  struct EdgeTable *pEdgeTable,
+										  unsigned long ulPixel)
+{
+	if (CHROME_VIEWPOINT_RENDERMODE_INDEXED_8 == pThis->nRendermode)
+		EdgeTable_SolidFill(pEdgeTable, (unsigned char)ulPixel,
+								  (short)pThis->nPixelRow, pThis->pBitmap);
+	else if (CHROME_VIEWPOINT_RENDERMODE_RGB565_16 == pThis->nRendermode)
+		EdgeTable_SolidFill16(pEdgeTable, (unsigned_int_16)ulPixel,
+									 (short)pThis->nPixelRow, (unsigned_int_16 *)pThis->pBitmap);
+	else if (CHROME_VIEWPOINT_RENDERMODE_PACKED_24 == pThis->nRendermode)
+		EdgeTable_SolidFill24(pEdgeTable, (unsigned_int_32)ulPixel,
+									 (short)pThis->nPixelRow, pThis->pBitmap);
+	else
+		EdgeTable_SolidFill32(pEdgeTable, (unsigned_int_32)ulPixel,
+									 (short)pThis->nPixelRow, (unsigned_int_32 *)pThis->pBitmap);
+}
+
+/********************************************************************
+* Function : Viewpoint_TinyPixel()
+* Purpose : Helper to Viewpoint_CheckSmallPolygon, picks the single
+*           pixel value a small polygon is plotted with.
+* Pre : As Viewpoint_CheckSmallPolygon().
+* Post : Returns the pixel value, in the format of the rendermode of
+*        pThis. Static colors are exact, gouraud shading uses the
+*        average intensity of the vertices and chrome and texture
+*        mapping the texel at the first vertex. Without a lightmap or
+*        TextureMap this falls back just like Viewpoint_DrawPolygon.
+********************************************************************/
+static unsigned long Viewpoint_TinyPixel(struct Viewpoint *pThis,
+													  struct PolyCommand *pCommand,
+													  struct ScreenVertex **arpVertices,
+													  int nVertices)
+{
+	struct TextureMap *pTexMap;
+	struct ScreenVertex *pSV;
+	unsigned long ulRGB;
+	float z;
+	int nTexel;
+	int nIntensity;
+	int m;
+
+	pSV = arpVertices[0];
+	switch (pCommand->nFlags)
+	{	case PF_DYNACOLOR :
+		{	nIntensity = 0;
+			for (m = 0; m < nVertices; m++)
+				nIntensity += arpVertices[m]->nIntensity;
+			nIntensity /= nVertices;
+			if (CHROME_VIEWPOINT_RENDERMODE_INDEXED_8 == pThis->nRendermode)
+			{	if (pCommand->pLightmap == NULL)
+					return 0;
+				return ((struct Lightmap256 *)pCommand->pLightmap)->arIndices[nIntensity];
+			}
+			ulRGB = Viewpoint_ShadeRGB(pCommand->ulRGB, nIntensity);
+			if (CHROME_VIEWPOINT_RENDERMODE_RGB565_16 == pThis->nRendermode)
+				return ColorManager_RGBTo565M(ulRGB);
+			return ulRGB;
+		}
+		case PF_CHROME :
+		case PF_TEXTURE :
+		{	pTexMap = (struct TextureMap *)pCommand->pLightmap;
+			if (pTexMap == NULL)
+				break;	/* Falls back to the static color. */
+			if (pCommand->nFlags == PF_CHROME)
+				nTexel = ((pSV->nCY & 0xFF) << 8) | (pSV->nCX & 0xFF);
+			else if (pSV->fIZ > 0.f)
+			{	z = 1.f / pSV->fIZ;
+				nTexel = ((((int)(pSV->fVZ * z)) & 0xFF) << 8) |
+							(((int)(pSV->fUZ * z)) & 0xFF);
+			} else
+				nTexel = 0;
+			if (CHROME_VIEWPOINT_RENDERMODE_INDEXED_8 == pThis->nRendermode)
+				return pTexMap->CMBmp[nTexel];
+			if (CHROME_VIEWPOINT_RENDERMODE_RGB565_16 == pThis->nRendermode)
+				return pTexMap->ausPalette565[pTexMap->Bitmap[nTexel]];
+			return pTexMap->aulPalette[pTexMap->Bitmap[nTexel]];
+		}
+	}
+
+	/* Static color. */
+	if (CHROME_VIEWPOINT_RENDERMODE_INDEXED_8 == pThis->nRendermode)
+	{	if ((pCommand->pLightmap == NULL) || (pCommand->nFlags != PF_STATICCOLOR))
+			return 0;
+		return ((struct Lightmap1 *)pCommand->pLightmap)->nIndex;
+	}
+	if (CHROME_VIEWPOINT_RENDERMODE_RGB565_16 == pThis->nRendermode)
+		return pCommand->usRGB565;
+	return pCommand->ulRGB;
+}
+
+/********************************************************************
+* Function : Viewpoint_ShadeRGB()
+* Purpose : Helper to Viewpoint_TinyPixel, shades a color the way the
+*           truecolor gouraud fills do.
+* Pre : ulRGB is a 0xRRGGBB color, nIntensity an intensity 0..255.
+* Post : Returns ulRGB at intensity nIntensity, as 0xRRGGBB.
+********************************************************************/
+static unsigned long Viewpoint_ShadeRGB(unsigned long ulRGB, int nIntensity)
+{
+	unsigned long i;
+
+	/* The fills interpolate in 8.16 fixed point from the middle of
+	 * the intensity, then scale it to full intensity at 255. */
+	i = ((unsigned long)nIntensity << 16) + 32768;
+	i = (i >> 8) + (i >> 16);
+	return (((((ulRGB >> 16) & 0xFF) * i) >> 16) << 16) |
+			 (((((ulRGB >> 8) & 0xFF) * i) >> 16) << 8) |
+			 (((ulRGB & 0xFF) * i) >> 16);
+}
+
+/********************************************************************
+* Function : Viewpoint_DrawActorTree() (Used by Viewpoint_DrawActor)
+* Purpose : Recursive function that traverses an entire HPlane
+*           tree and renders polygons in the required order.
+* Pre : pThis points to an initialized Viewpoint structure with
+*       a bitmap associated to it. pActor points to an initialized
+*       Actor structure. pPlane points to a HPlane structure from the
+*       tree of with pActor's model. nLevel indicates the number
+*       of subspaces left in the tree of pPlane.
+*       Viewpoint_PrepActorsForDraw() must have been called on the
+*       Viewpoint structure (pThis) and the Actor (pActor).
+* Post : The bitmap in the Viewpoint (pThis->pBitmap) now contains
+*        the whole subtree of pPlane (including all actors in the
+*        subspaces) drawn.
+********************************************************************/
+void Viewpoint_DrawActorTree(struct Viewpoint *pThis,
+								  struct Actor *pActor,
+								  struct HPlane *pPlane,
+								  int nLevel)
+{
+	int n, m;
+	int nPass;
+	struct Polygon *pPoly;
+	struct PolyCommand Pending;
+
+	/* Check if we reached one of our tree's leafs. */
+	if (pPlane == NULL)
+	{	/* We've reached a leaf, setup a new tree
+		 * for traversal. */
+
+		/* Check if there is an Actor in this leaf. */
+		pActor = ActorPtrSet_GetActorPtrM(&(pActor->SubActorSet), nLevel);
+		if (pActor != NULL)
+		{	/* Call ourselves recursively, but now using
+			 * the embedded Actor from the current subspace. */
+			Viewpoint_DrawActorTree(pThis,pActor, pActor->pModel->pRoot, 0);
+		}
+	} else
+	{	/* Check on what side the viewpoint's origin is on this
+		 * given hyperplane. */
+		if (0.f < Plane_DistanceOfVectorM(&(pPlane->BinPlane), &(pActor->ViewpointOrigin)))
+		{
+			/* The viewpoint is on the outside of the plane.
+			 * first draw the inside, then draw the polygons that
+			 * are coplanar with the current plane and visible from
+			 * the outside of the plane,
+			 * then draw the outside. This is Back to Front
+			 * drawing. */
+			Viewpoint_DrawActorTree(pThis, pActor, pPlane->pInSubtree, nLevel);
+			
+			/* Iterate all polygons visible from the outside of the plane. */
+			for (nPass = 0; nPass < 2; nPass++)
+				for (n = 0; n < IndexSet_GetCountM(&(pPlane->OutsideIndices)); n++)
+				{	/* Get index of polygon. */
+					m = IndexSet_GetIndexM(&(pPlane->OutsideIndices), n);
+					/* Get polygon from index. */
+					pPoly = Actor_GetPolygonM(pActor, m);
+					/* Opaque polygons in the first pass, translucent
+					 * ones in the second. */
+					if ((pPoly->nFlags == PF_TRANSLUCENT) != nPass)
+						continue;
+
+					/* Scan convert and draw it. */
+					Viewpoint_ScanPolygon(pThis, &(pThis->PolyEdgeTable), pActor, pPoly,
+												 &Pending);
+				}
+			Viewpoint_FlushSpans(pThis, &(pThis->PolyEdgeTable), &Pending);
+			
+			/* Draw the outside. */
+			Viewpoint_DrawActorTree(pThis, pActor, pPlane->pOutSubtree,
+											nLevel + pPlane->nInsideLeafCount);
+		} else
+		{
+			/* The viewpoint is on the inside of the plane.
+			 * first draw the outside, then draw the polygons that
+			 * are coplanar with the current plane and visible from
+			 * the inside of the plane,
+			 * then draw the inside. This is Back to Front
+			 * drawing. */
+			Viewpoint_DrawActorTree(pThis, pActor, pPlane->pOutSubtree,
+											nLevel + pPlane->nInsideLeafCount);
+			
+			/* Iterate all polygons visible from the inside of the plane. */
+			for (nPass = 0; nPass < 2; nPass++)
+				for (n = 0; n < IndexSet_GetCountM(&(pPlane->InsideIndices)); n++)
+				{	/* Get index of polygon. */
+					m = IndexSet_GetIndexM(&(pPlane->InsideIndices), n);
+					/* Get polygon from index. */
+					pPoly = Actor_GetPolygonM(pActor, m);
+					/* Opaque polygons in the first pass, translucent
+					 * ones in the second. */
+					if ((pPoly->nFlags == PF_TRANSLUCENT) != nPass)
+						continue;
+
+					/* Scan convert and draw it. */
+					Viewpoint_ScanPolygon(pThis, &(pThis->PolyEdgeTable), pActor, pPoly,
+												 &Pending);
+				}
+			Viewpoint_FlushSpans(pThis, &(pThis->PolyEdgeTable), &Pending);
+			/* Draw the inside. */
+			Viewpoint_DrawActorTree(pThis, pActor, pPlane->pInSubtree, nLevel);
+		}
+	}				
+}
+	
+/********************************************************************
+* Function : Viewpoint_DrawActorTreeFrontToBack()
+*            (Used by Viewpoint_Draw)
+* Purpose : Recursive function that traverses an entire HPlane
+*           tree and renders polygons front to back.
+* Pre : As Viewpoint_DrawActorTree(), the EdgeTable of pThis uses
+*       the SpanBuffer of pThis.
+* Post : The bitmap in the Viewpoint (pThis->pBitmap) now contains
+*        the whole subtree of pPlane (including all actors in the
+*        subspaces), except where it was already covered.
+* Note : This is Viewpoint_DrawActorTree() with the order of the
+*        subtrees reversed. Polygons nearer to the viewpoint are
+*        drawn first, the span buffer keeps those further away from
+*        overwriting them. Once the span buffer is full, nothing
+*        behind it can show and the traversal stops.
+********************************************************************/
+void Viewpoint_DrawActorTreeFrontToBack(struct Viewpoint *pThis,
+													 struct Actor *pActor,
+													 struct HPlane *pPlane,
+													 int nLevel)
+{
+	int n, m;
+	struct Polygon *pPoly;
+	struct IndexSet *pIndices;
+	struct PolyCommand Pending;
+
+	/* Nothing left to draw on? */
+	if (SBuffer_IsFullM(&(pThis->SpanBuffer)))
+		return;
+
+	/* Check if we reached one of our tree's leafs. */
+	if (pPlane == NULL)
+	{	/* We've reached a leaf, setup a new tree
+		 * for traversal. */
+
+		/* Check if there is an Actor in this leaf. */
+		pActor = ActorPtrSet_GetActorPtrM(&(pActor->SubActorSet), nLevel);
+		if (pActor != NULL)
+		{	/* Call ourselves recursively, but now using
+			 * the embedded Actor from the current subspace. */
+			Viewpoint_DrawActorTreeFrontToBack(pThis, pActor, pActor->pModel->pRoot, 0);
+		}
+	} else
+	{	/* Check on what side the viewpoint's origin is on this
+		 * given hyperplane. */
+		if (0.f < Plane_DistanceOfVectorM(&(pPlane->BinPlane), &(pActor->ViewpointOrigin)))
+		{
+			/* The viewpoint is on the outside of the plane.
+			 * first draw the outside, then draw the polygons that
+			 * are coplanar with the current plane and visible from
+			 * the outside of the plane,
+			 * then draw the inside. This is Front to Back
+			 * drawing. */
+			Viewpoint_DrawActorTreeFrontToBack(pThis, pActor, pPlane->pOutSubtree,
+														  nLevel + pPlane->nInsideLeafCount);
+			pIndices = &(pPlane->OutsideIndices);
+		} else
+		{
+			/* The viewpoint is on the inside of the plane, draw the
+			 * inside first. */
+			Viewpoint_DrawActorTreeFrontToBack(pThis, pActor, pPlane->pInSubtree, nLevel);
+			pIndices = &(pPlane->InsideIndices);
+		}
+
+		/* Iterate all polygons visible from the viewpoint's side of
+		 * the plane. These are coplanar and may overlap (like a
+		 * decal), back to front drawing lets the last one win, so
+		 * iterate them in reverse. */
+		for (n = IndexSet_GetCountM(pIndices) - 1; n >= 0; n--)
+		{	/* Nothing left to draw on? */
+			if (SBuffer_IsFullM(&(pThis->SpanBuffer)))
+				break;
+
+			/* Get index of polygon. */
+			m = IndexSet_GetIndexM(pIndices, n);
+			/* Get polygon from index. */
+			pPoly = Actor_GetPolygonM(pActor, m);
+
+			/* Scan convert and draw it. */
+			Viewpoint_ScanPolygon(pThis, &(pThis->PolyEdgeTable), pActor, pPoly,
+										 &Pending);
+		}
+		Viewpoint_FlushSpans(pThis, &(pThis->PolyEdgeTable), &Pending);
+
+		/* Draw the far side. */
+		if (pIndices == &(pPlane->OutsideIndices))
+			Viewpoint_DrawActorTreeFrontToBack(pThis, pActor, pPlane->pInSubtree, nLevel);
+		else
+			Viewpoint_DrawActorTreeFrontToBack(pThis, pActor, pPlane->pOutSubtree,
+														  nLevel + pPlane->nInsideLeafCount);
+	}
+}
+
+/********************************************************************
+* Function : Viewpoint_Draw()
+* Purpose : Draws all Actors that were prepared for drawing by a call
+*           to Viewpoint_PrepActorsForDraw().
+* Pre : pThis points to an initialized Viewpoint structure with
+*       a bitmap associated with it. pThis has just been used in a
+*       Viewpoint_PrepActorsForDraw() call.
+* Post : If the returnvalue is 1, all Actors were rendered in correct
+*        order in the pBitmap bitmap in the Viewpoint structure.
+*        If the returnvalue is 0, a memory failure occured.
+* Note : When prepared at a render scale below 1, the Actors are
+*        drawn in pScaleBitmap first, which is cleared to the
+*        background whether that is enabled or not, and then
+*        stretched over pBitmap.
+********************************************************************/
+int Viewpoint_Draw(struct Viewpoint *pThis)
+{
+	unsigned char *pBitmap;
+	unsigned char *pScaleBitmap;
+	int nWidth;
+	int nHeight;
+	int nPixelRow;
+	int nBackground;
+	int nPixelSize;
+	int nBytes;
+	int nResult;
+
+	if ((pThis->nScaledWidth <= 0) || (pThis->nScaledHeight <= 0) ||
+		 ((pThis->nScaledWidth == pThis->nWidth) &&
+		  (pThis->nScaledHeight == pThis->nHeight)))
+	{	/* Draw directly in the bitmap. */
+		nResult = Viewpoint_DrawField(pThis);
+		Viewpoint_AdjustRenderScale(pThis);
+		return nResult;
+	}
+
+	/* Make sure the scaled bitmap is large enough. */
+	nPixelSize = Viewpoint_GetPixelSizeM(pThis);
+	nBytes = pThis->nScaledWidth * pThis->nScaledHeight * nPixelSize;
+	if (nBytes > pThis->nScaleAlloc)
+	{	pScaleBitmap = (unsigned char *)realloc((void *)pThis->pScaleBitmap, nBytes);
+		if (pScaleBitmap == NULL)
+			return 0;	/* Memory failure. */
+		pThis->pScaleBitmap = pScaleBitmap;
+		pThis->nScaleAlloc = nBytes;
+	}
+
+	/* Draw in the scaled bitmap, nothing of the last frame may show
+	 * through. */
+	pBitmap = pThis->pBitmap;
+	nWidth = pThis->nWidth;
+	nHeight = pThis->nHeight;
+	nPixelRow = pThis->nPixelRow;
+	nBackground = pThis->nBackground;
+	pThis->pBitmap = pThis->pScaleBitmap;
+	pThis->nWidth = pThis->nScaledWidth;
+	pThis->nHeight = pThis->nScaledHeight;
+	pThis->nPixelRow = pThis->nScaledWidth;
+	pThis->nBackground = 1;
+
+	nResult = Viewpoint_DrawField(pThis);
+
+	pThis->pBitmap = pBitmap;
+	pThis->nWidth = nWidth;
+	pThis->nHeight = nHeight;
+	pThis->nPixelRow = nPixelRow;
+	pThis->nBackground = nBackground;
+	if (!nResult)
+		return 0;	/* Memory failure. */
+
+	/* Stretch it over the bitmap, which is then changed all over. */
+	if ((pThis->nScaleFilter == CHROME_VIEWPOINT_SCALEFILTER_BILINEAR) &&
+		 (pThis->nRendermode == CHROME_VIEWPOINT_RENDERMODE_TRUECOLOR_32))
+		Upscale_Bilinear32(pThis->pScaleBitmap, pThis->nScaledWidth,
+								 pThis->nScaledHeight, pThis->nScaledWidth,
+								 pThis->pBitmap, pThis->nWidth, pThis->nHeight,
+								 pThis->nPixelRow);
+	else
+		Upscale_Nearest(pThis->pScaleBitmap, pThis->nScaledWidth,
+							 pThis->nScaledHeight, pThis->nScaledWidth,
+							 pThis->pBitmap, pThis->nWidth, pThis->nHeight,
+							 pThis->nPixelRow, nPixelSize);
+	DamageList_ClearM(&(pThis->Damage));
+	DamageList_Add(&(pThis->Damage), 0, 0, pThis->nWidth, pThis->nHeight);
+
+	Viewpoint_AdjustRenderScale(pThis);
+	return 1;
+}
+
+/********************************************************************
+* Function : Viewpoint_DrawField()
+* Purpose : Helper to Viewpoint_Draw(), draws all Actors that were
+*           prepared for drawing in the bitmap, on the scanlines of
+*           the current field when interlacing.
+* Pre : As Viewpoint_DrawScene().
+* Post : If the returnvalue is 1, all Actors were rendered and, when
+*        interlacing, the next frame draws the other field.
+*        If the returnvalue is 0, a memory failure occured.
+********************************************************************/
+static int Viewpoint_DrawField(struct Viewpoint *pThis)
+{
+	int nResult;
+
+	EdgeTable_SetInterlace(&(pThis->PolyEdgeTable), pThis->nInterlace, pThis->nField);
+	nResult = Viewpoint_DrawScene(pThis);
+	EdgeTable_SetInterlace(&(pThis->PolyEdgeTable), 0, 0);
+	if (!nResult)
+		return 0;	/* Memory failure. */
+
+	if (pThis->nInterlace == CHROME_VIEWPOINT_INTERLACE_RECONSTRUCT)
+	{	if (!Viewpoint_RestoreSkippedRows(pThis))
+			return 0;	/* Memory failure. */
+	}
+	if (pThis->nInterlace)
+		pThis->nField ^= 1;
+	return 1;
+}
+
+/********************************************************************
+* Function : Viewpoint_DrawScene()
+* Purpose : Helper to Viewpoint_Draw(), draws all Actors that were
+*           prepared for drawing in the bitmap.
+* Pre : pThis points to an initialized Viewpoint structure with
+*       a bitmap associated with it of the size the Actors were
+*       prepared for.
+* Post : If the returnvalue is 1, all Actors were rendered in correct
+*        order in the pBitmap bitmap in the Viewpoint structure.
+*        If the returnvalue is 0, a memory failure occured.
+********************************************************************/
+static int Viewpoint_DrawScene(struct Viewpoint *pThis)
+{
+	int nRecorded;
+
+	/* Keep the rasterizer inside the bitmap, needed when polygons
+	 * were only clipped to the guard band. */
+	EdgeTable_SetClipRect(&(pThis->PolyEdgeTable), 0, 0,
+								 pThis->nWidth, pThis->nHeight);
+
+	/* Start collecting the damage of a new frame. */
+	pThis->LastDamage = pThis->Damage;
+	DamageList_ClearM(&(pThis->Damage));
+	pThis->PolyEdgeTable.pDamage = &(pThis->Damage);
+	RenderStats_ClearM(&(pThis->Stats));
+	pThis->PolyEdgeTable.pStats = &(pThis->Stats);
+
+	/* Only draw something when there is an Actor inside
+	 * the View Frustrum. */
+	if (pThis->pRootActor == NULL)
+	{	/* Nothing covers the background. */
+		if (pThis->nBackground)
+			Viewpoint_Clear(pThis, pThis->ulBackground);
+		return 1;
+	}
+
+	/* Clear the part of the background that won't be covered, span
+	 * buffer drawing knows it after drawing. */
+	nRecorded = 0;
+	if (pThis->nBackground &&
+		 (pThis->nDrawmode != CHROME_VIEWPOINT_DRAWMODE_SBUFFER))
+	{	if (!Viewpoint_RecordCommands(pThis) ||
+			 !Viewpoint_CoverCommands(pThis))
+			return 0;	/* Memory failure. */
+		Viewpoint_FillBackground(pThis);
+		nRecorded = 1;
+	}
+
+	if (pThis->nDrawmode == CHROME_VIEWPOINT_DRAWMODE_TILED)
+	{	/* Bin the polygons and draw the tiles. */
+		return Viewpoint_DrawTiled(pThis);
+	} else
+	if (pThis->nDrawmode == CHROME_VIEWPOINT_DRAWMODE_SCANLINE)
+	{	/* Collect all polygons, then draw the scanlines. */
+		if (!ActiveEdgeTable_SetSize(&(pThis->ScanlineTable), pThis->nWidth, pThis->nHeight))
+			return 0;	/* Memory failure. */
+		if (!Viewpoint_CollectActorTree(pThis, pThis->pRootActor,
+												  pThis->pRootActor->pModel->pRoot, 0,
+												  Viewpoint_AddScanlinePolygon))
+			return 0;	/* Memory failure. */
+		ActiveEdgeTable_Walk(&(pThis->ScanlineTable), &(pThis->PolyEdgeTable),
+									Viewpoint_DrawSegment, (void *)pThis);
+		EdgeTable_SetClipRect(&(pThis->PolyEdgeTable), 0, 0,
+									 pThis->nWidth, pThis->nHeight);
+	} else
+	if (pThis->nDrawmode == CHROME_VIEWPOINT_DRAWMODE_SBUFFER)
+	{	/* Start with an empty span buffer covering the bitmap. */
+		if (!SBuffer_SetSize(&(pThis->SpanBuffer), pThis->nWidth, pThis->nHeight))
+			return 0;	/* Memory failure. */
+		Viewpoint_CoverSkippedRows(pThis);
+
+		/* Call the Viewpoint_DrawActorTreeFrontToBack() helper
+		 * function. */
+		pThis->PolyEdgeTable.pSBuffer = &(pThis->SpanBuffer);
+		Viewpoint_DrawActorTreeFrontToBack(pThis, pThis->pRootActor,
+					pThis->pRootActor->pModel->pRoot,
+					0);
+		pThis->PolyEdgeTable.pSBuffer = NULL;
+		if (pThis->nBackground)
+			Viewpoint_FillBackground(pThis);
+	} else
+	{	/* Record the polygons back to front, then rasterize them. */
+		if (!nRecorded && !Viewpoint_RecordCommands(pThis))
+			return 0;	/* Memory failure. */
+		Viewpoint_DrawCommands(pThis, &(pThis->Commands));
+	}
+	return 1;
+}
+
+/********************************************************************
+* Function : Viewpoint_AdjustRenderScale()
+* Purpose : Helper to Viewpoint_Draw(), adjusts the render scale to
+*           the time the frame took.
+* Pre : pThis points to an initialized Viewpoint structure that has
+*       just been used in a Viewpoint_PrepActorsForDraw() and a
+*       Viewpoint_Draw() call.
+* Post : If there is a frame budget, fRenderScale has been moved
+*        toward the scale that would have drawn the frame in budget.
+* Note : Drawing time is taken to go with the number of pixels, the
+*        square of the scale. As part of the time doesn't depend on
+*        the scale at all and a single frame may be slow for other
+*        reasons, the scale only goes halfway there every frame.
+********************************************************************/
+static void Viewpoint_AdjustRenderScale(struct Viewpoint *pThis)
+{
+	float fRatio;
+	float fScale;
+	double dTime;
+
+	if (pThis->fFrameBudget <= 0.f)
+		return;	/* No budget. */
+
+	dTime = Timer_GetSeconds() - pThis->dFrameStart;
+	if (dTime <= 0.)
+		return;	/* Too fast to measure. */
+	fRatio = (float)(pThis->fFrameBudget / dTime);
+	if ((fRatio > 1.f - VIEWPOINT_BUDGETSLACK) &&
+		 (fRatio < 1.f + VIEWPOINT_BUDGETSLACK))
+		return;	/* Close enough. */
+
+	fScale = pThis->fRenderScale * (float)sqrt(fRatio);
+	fScale = (pThis->fRenderScale + fScale) / 2.f;
+	if (fScale < pThis->fMinRenderScale)
+		fScale = pThis->fMinRenderScale;
+	if (fScale > 1.f)
+		fScale = 1.f;
+	pThis->fRenderScale = fScale;
+}
+
+/********************************************************************
+* Function : Viewpoint_GetChanges()
+* Purpose : Determines which parts of the bitmap may have changed
+*           since the frame before the last one.
+* Pre : pThis points to an initialized Viewpoint structure,
+*       pChanges to a DamageList structure.
+* Post : pChanges covers everything drawn by the last two
+*        Viewpoint_Draw() calls.
+* Note : A pixel that wasn't drawn in either frame is background in
+*        both, pixels drawn in only one of them were background in
+*        the other.
+********************************************************************/
+void Viewpoint_GetChanges(struct Viewpoint *pThis,
+								  struct DamageList *pChanges)
+{
+	*pChanges = pThis->Damage;
+	DamageList_AddList(pChanges, &(pThis->LastDamage));
+}
+
+/********************************************************************
+* Function : Viewpoint_RecordCommands()
+* Purpose : Records all Actors that were prepared for drawing as a
+*           flat list of screen polygons.
+* Pre : pThis points to an initialized Viewpoint structure that has
+*       just been used in a Viewpoint_PrepActorsForDraw() call.
+* Post : If the returnvalue is 1, pThis->Commands holds the polygons
+*        of all Actors in the order Viewpoint_DrawActorTree() would
+*        draw them, with copies of their ScreenVertex structures.
+*        If the returnvalue is 0, a memory failure occured and
+*        pThis->Commands holds only part of the polygons.
+********************************************************************/
+int Viewpoint_RecordCommands(struct Viewpoint *pThis)
+{
+	PolyCommandBuffer_ClearM(&(pThis->Commands));
+	if (pThis->pRootActor == NULL)
+		return 1;	/* Nothing to record. */
+	return Viewpoint_CollectActorTree(pThis, pThis->pRootActor,
+												 pThis->pRootActor->pModel->pRoot, 0,
+												 Viewpoint_RecordPolygon);
+}
+
+/********************************************************************
+* Function : Viewpoint_DrawCommands()
+* Purpose : Rasterizes a list of screen polygons.
+* Pre : pThis points to an initialized Viewpoint structure with a
+*       bitmap associated with it, pCommands to a PolyCommandBuffer
+*       recorded by Viewpoint_RecordCommands() for a bitmap of the
+*       same size.
+* Post : The polygons in pCommands have been drawn, in order, in the
+*        bitmap of pThis. Runs of polygons of the same static color
+*        are filled at once.
+* Note : Only the bitmap and the PolyEdgeTable of pThis are used, so
+*        pThis may record the next frame in a different buffer at
+*        the same time, as long as it doesn't draw.
+********************************************************************/
+void Viewpoint_DrawCommands(struct Viewpoint *pThis,
+									 struct PolyCommandBuffer *pCommands)
+{
+	struct PolyCommand *pCommand;
+	struct PolyCommand Pending;
+	int n;
+
+	EdgeTable_SetClipRect(&(pThis->PolyEdgeTable), 0, 0,
+								 pThis->nWidth, pThis->nHeight);
+	for (n = 0; n < PolyCommandBuffer_GetCountM(pCommands); n++)
+	{	pCommand = PolyCommandBuffer_GetCommandM(pCommands, n);
+		Viewpoint_ScanCommand(pThis, &(pThis->PolyEdgeTable), pCommand,
+									 PolyCommandBuffer_GetVerticesM(pCommands, pCommand),
+									 &Pending);
+	}
+	Viewpoint_FlushSpans(pThis, &(pThis->PolyEdgeTable), &Pending);
+}
+
+/********************************************************************
+* Function : Viewpoint_SetRendermode()
+* Purpose : Select the kind of rendering we want in this Viewpoint.
+*         See header about accepted modes.
+* Post : Returns 1 if this Viewpoint successfully accepted this mode.
+*       All rendering using this Viewpoint will use this mode,
+*       other possible Viewpoints will not be affected.
+********************************************************************/
+int Viewpoint_SetRendermode(struct Viewpoint *pThis, unsigned char mode)
+{
+	switch( mode )
+	{
 		case CHROME_VIEWPOINT_RENDERMODE_TRUECOLOR_32:
 		case CHROME_VIEWPOINT_RENDERMODE_INDEXED_8:
+		case CHROME_VIEWPOINT_RENDERMODE_RGB565_16:
+		case CHROME_VIEWPOINT_RENDERMODE_PACKED_24:
 			pThis->nRendermode = mode;
 			break;
 		default:
@@ -583,56 +2261,1130 @@ int Viewpoint_SetRendermode(struct Viewpoint *pThis, unsigned char mode)
 	return 1;
 }
 
+/********************************************************************
+* Function : Viewpoint_Clear()
+* Purpose : Sets all pixels of the bitmap to a single value.
+* Pre : pThis points to an initialized Viewpoint structure with a
+*       bitmap associated with it. ulPixel is a pixel value of the
+*       rendermode of pThis.
+* Post : All nWidth by nHeight pixels of the bitmap are ulPixel.
+* Note : When the rows follow each other without a gap, the bitmap
+*        is cleared in one go.
+********************************************************************/
+void Viewpoint_Clear(struct Viewpoint *pThis, unsigned long ulPixel)
+{
+	unsigned char arPattern[VIEWPOINT_PATTERNALLOC];
+	unsigned char *pRow;
+	int nPixelSize;
+	int nY;
+
+	if ((pThis->nWidth <= 0) || (pThis->nHeight <= 0))
+		return;
+	Viewpoint_BuildPattern(pThis, ulPixel, arPattern);
+	nPixelSize = Viewpoint_GetPixelSizeM(pThis);
+
+	if (pThis->nPixelRow == pThis->nWidth)
+	{	Viewpoint_pClearBytes(pThis->pBitmap,
+									 pThis->nWidth * pThis->nHeight * nPixelSize, arPattern);
+		return;
+	}
+	pRow = pThis->pBitmap;
+	for (nY = 0; nY < pThis->nHeight; nY++)
+	{	Viewpoint_pClearBytes(pRow, pThis->nWidth * nPixelSize, arPattern);
+		pRow += pThis->nPixelRow * nPixelSize;
+	}
+}
+
+/********************************************************************
+* Function : Viewpoint_SetRenderScale()
+* Purpose : Sets the fraction of the bitmap's width and height the
+*           Actors are drawn at.
+* Pre : pThis points to an initialized Viewpoint structure.
+* Post : If the returnvalue is 1, the next frame is drawn at fScale
+*        times the bitmap's size and stretched over it.
+*        If the returnvalue is 0, fScale is not above 0 and up to 1
+*        and nothing has changed.
+********************************************************************/
+int Viewpoint_SetRenderScale(struct Viewpoint *pThis, float fScale)
+{
+	if ((fScale <= 0.f) || (fScale > 1.f))
+		return 0;
+	pThis->fRenderScale = fScale;
+	return 1;
+}
+
+/********************************************************************
+* Function : Viewpoint_SetFrameBudget()
+* Purpose : Lets Viewpoint_Draw() adjust the render scale to keep the
+*           time per frame at fSeconds.
+* Pre : pThis points to an initialized Viewpoint structure.
+* Post : If fSeconds is above 0, the render scale follows the time
+*        taken per frame, between fMinScale (limited to 0.1 to 1)
+*        and 1. Otherwise it is left alone.
+********************************************************************/
+void Viewpoint_SetFrameBudget(struct Viewpoint *pThis, float fSeconds,
+										float fMinScale)
+{
+	if (fMinScale < 0.1f)
+		fMinScale = 0.1f;
+	if (fMinScale > 1.f)
+		fMinScale = 1.f;
+	pThis->fFrameBudget = (fSeconds > 0.f) ? fSeconds : 0.f;
+	pThis->fMinRenderScale = fMinScale;
+	if (pThis->fRenderScale < fMinScale)
+		pThis->fRenderScale = fMinScale;
+}
+
+/********************************************************************
+* Function : Viewpoint_SetScaleFilter()
+* Purpose : Select how frames drawn below a render scale of 1 are
+*           stretched over the bitmap. See header about accepted
+*           modes.
+* Post : Returns 1 if this Viewpoint successfully accepted this mode.
+********************************************************************/
+int Viewpoint_SetScaleFilter(struct Viewpoint *pThis, unsigned char mode)
+{
+	switch (mode)
+	{
+		case CHROME_VIEWPOINT_SCALEFILTER_NEAREST:
+		case CHROME_VIEWPOINT_SCALEFILTER_BILINEAR:
+			pThis->nScaleFilter = mode;
+			break;
+		default:
+			return 0;
+	}
+	return 1;
+}
+
+/********************************************************************
+* Function : Viewpoint_SetInterlace()
+* Purpose : Select whether Viewpoint_Draw() draws all scanlines or
+*           alternates between the even and odd ones. See header
+*           about accepted modes.
+* Post : Returns 1 if this Viewpoint successfully accepted this mode.
+*        The next frame draws the even scanlines, and has no frame
+*        before to reconstruct the odd ones from.
+********************************************************************/
+int Viewpoint_SetInterlace(struct Viewpoint *pThis, unsigned char mode)
+{
+	switch (mode)
+	{
+		case CHROME_VIEWPOINT_INTERLACE_OFF:
+		case CHROME_VIEWPOINT_INTERLACE_FIELDS:
+		case CHROME_VIEWPOINT_INTERLACE_RECONSTRUCT:
+			pThis->nInterlace = mode;
+			break;
+		default:
+			return 0;
+	}
+	pThis->nField = 0;
+	pThis->nLastFrameRow = 0;
+	return 1;
+}
+
+/********************************************************************
+* Function : Viewpoint_SetBackground()
+* Purpose : Lets Viewpoint_Draw() clear the background of the bitmap.
+* Pre : pThis points to an initialized Viewpoint structure. nEnable
+*       is non zero to clear the background, ulPixel is a pixel value
+*       of the rendermode of pThis.
+* Post : If nEnable is non zero, Viewpoint_Draw() sets every pixel
+*        it doesn't draw to ulPixel, otherwise it leaves them alone.
+********************************************************************/
+void Viewpoint_SetBackground(struct Viewpoint *pThis, int nEnable,
+									  unsigned long ulPixel)
+{
+	pThis->nBackground = (nEnable != 0);
+	pThis->ulBackground = ulPixel;
+}
+
+/********************************************************************
+* Function : Viewpoint_SetDepthRange()
+* Purpose : Sets the distances of the near and far planes.
+* Pre : pThis points to an initialized Viewpoint structure.
+* Post : If the returnvalue is 1, the next Viewpoint_PrecalcFrustrum()
+*        adds a near plane at fNear and a far plane at fFar along the
+*        view direction to the frustrum, each only if it's above 0.
+*        If the returnvalue is 0, a distance is below 0 or fFar is
+*        not beyond fNear, and nothing has changed.
+********************************************************************/
+int Viewpoint_SetDepthRange(struct Viewpoint *pThis, float fNear, float fFar)
+{
+	if ((fNear < 0.f) || (fFar < 0.f) || ((fFar > 0.f) && (fFar <= fNear)))
+		return 0;
+	pThis->fNearDistance = fNear;
+	pThis->fFarDistance = fFar;
+	return 1;
+}
+
+/********************************************************************
+* Function : Viewpoint_SetDepthCue()
+* Purpose : Sets the distance from which vertices fade out toward the
+*           far plane.
+* Pre : pThis points to an initialized Viewpoint structure.
+* Post : The next Viewpoint_PrepActorsForDraw() fades the intensity
+*        of the vertices beyond fFadeDistance, if that's above 0 and
+*        in front of the far plane.
+********************************************************************/
+void Viewpoint_SetDepthCue(struct Viewpoint *pThis, float fFadeDistance)
+{
+	pThis->fFadeDistance = fFadeDistance;
+}
+
+/********************************************************************
+* Function : Viewpoint_BuildPattern()
+* Purpose : Helper to Viewpoint_Clear and Viewpoint_FillBackground,
+*           builds the pattern of bytes a pixel value repeats as.
+* Pre : pThis points to an initialized Viewpoint structure, ulPixel
+*       is a pixel value of it's rendermode, pPattern points to
+*       VIEWPOINT_PATTERNALLOC bytes.
+* Post : pPattern holds the bytes of ulPixel, lowest first, repeated.
+*        Viewpoint_pClearBytes is set.
+********************************************************************/
+static void Viewpoint_BuildPattern(struct Viewpoint *pThis, unsigned long ulPixel,
+											  unsigned char *pPattern)
+{
+	int nPixelSize;
+	int n;
+
+	/* Select the clear function on first use. */
+	if (Viewpoint_pClearBytes == NULL)
+	{	Viewpoint_pClearBytes = Viewpoint_ClearBytesC;
+#ifdef CHROME_X86_SIMD
+		if (CpuFeatures_Get() & CPUF_SSE2)
+			Viewpoint_pClearBytes = Viewpoint_ClearBytesSSE2;
+#endif
+	}
+
+	nPixelSize = Viewpoint_GetPixelSizeM(pThis);
+	for (n = 0; n < VIEWPOINT_PATTERNALLOC; n++)
+		pPattern[n] = (unsigned char)(ulPixel >> (8 * (n % nPixelSize)));
+}
+
+/********************************************************************
+* Function : Viewpoint_ClearBytesC()
+* Purpose : Plain C version of the clear function, repeats a pattern
+*           over a run of bytes.
+* Pre : p points to nBytes bytes to clear, starting at a pixel,
+*       pPattern to the pattern built by Viewpoint_BuildPattern().
+* Post : The pixels in the nBytes bytes are set to those of pPattern.
+********************************************************************/
+static void Viewpoint_ClearBytesC(unsigned char *p, int nBytes,
+											 unsigned char *pPattern)
+{
+	/* Single byte patterns, like black, are just a memset(). */
+	if ((pPattern[0] == pPattern[1]) && (pPattern[1] == pPattern[2]) &&
+		 (pPattern[2] == pPattern[3]))
+	{	memset((void *)p, pPattern[0], nBytes);
+		return;
+	}
+
+	while (nBytes >= VIEWPOINT_PATTERNSIZE)
+	{	memcpy((void *)p, (void *)pPattern, VIEWPOINT_PATTERNSIZE);
+		p += VIEWPOINT_PATTERNSIZE;
+		nBytes -= VIEWPOINT_PATTERNSIZE;
+	}
+	memcpy((void *)p, (void *)pPattern, nBytes);
+}
+
+#ifdef CHROME_X86_SIMD
+/********************************************************************
+* Function : Viewpoint_ClearBytesSSE2()
+* Purpose : SSE2 version of the clear function, repeats a pattern
+*           over a run of bytes using non-temporal stores.
+* Pre : As Viewpoint_ClearBytesC(), the processor supports SSE2.
+* Post : As Viewpoint_ClearBytesC().
+* Note : Non-temporal stores go around the cache, which only pays
+*        off for long runs, shorter ones are left to the C version.
+********************************************************************/
+CPUFEAT_TARGET_SSE2
+static void Viewpoint_ClearBytesSSE2(unsigned char *p, int nBytes,
+												 unsigned char *pPattern)
+{
+	__m128i V0, V1, V2;
+	int nOffset;
+
+	if (nBytes < VIEWPOINT_STREAMBYTES)
+	{	Viewpoint_ClearBytesC(p, nBytes, pPattern);
+		return;
+	}
+
+	/* Leading bytes up to a 16 byte allignment, the pattern then
+	 * continues at nOffset. */
+	nOffset = (int)((16 - ((size_t)p & 15)) & 15);
+	memcpy((void *)p, (void *)pPattern, nOffset);
+	p += nOffset;
+	nBytes -= nOffset;
+
+	V0 = _mm_loadu_si128((__m128i *)(pPattern + nOffset));
+	V1 = _mm_loadu_si128((__m128i *)(pPattern + nOffset + 16));
+	V2 = _mm_loadu_si128((__m128i *)(pPattern + nOffset + 32));
+	while (nBytes >= VIEWPOINT_PATTERNSIZE)
+	{	_mm_stream_si128((__m128i *)p, V0);
+		_mm_stream_si128((__m128i *)(p + 16), V1);
+		_mm_stream_si128((__m128i *)(p + 32), V2);
+		p += VIEWPOINT_PATTERNSIZE;
+		nBytes -= VIEWPOINT_PATTERNSIZE;
+	}
+	if (nBytes >= 16)
+	{	_mm_stream_si128((__m128i *)p, V0);
+		p += 16;
+		nBytes -= 16;
+		nOffset += 16;
+		if (nBytes >= 16)
+		{	_mm_stream_si128((__m128i *)p, V1);
+			p += 16;
+			nBytes -= 16;
+			nOffset += 16;
+		}
+	}
+	_mm_sfence();
+
+	/* Trailing bytes. */
+	memcpy((void *)p, (void *)(pPattern + nOffset), nBytes);
+}
+#endif
+
+/********************************************************************
+* Function : Viewpoint_CoverCommands()
+* Purpose : Helper to Viewpoint_Draw, finds the pixels the recorded
+*           polygons cover.
+* Pre : pThis points to an initialized Viewpoint structure, it's
+*       Commands were just recorded.
+* Post : If the returnvalue is 1, the SpanBuffer of pThis covers the
+*        pixels the Commands draw, or the whole bitmap.
+*        If the returnvalue is 0, a memory failure occured.
+* Note : The polygons are added front to back, so this stops as soon
+*        as the bitmap is covered. The plain edges give the same
+*        spans as the ones the fills use. Translucent polygons don't
+*        cover anything.
+********************************************************************/
+static int Viewpoint_CoverCommands(struct Viewpoint *pThis)
+{
+	struct EdgeTable *pEdgeTable;
+	struct PolyCommand *pCommand;
+	struct ScreenVertex *arVertices;
+	int n, m;
+	int nY;
+
+	if (!SBuffer_SetSize(&(pThis->SpanBuffer), pThis->nWidth, pThis->nHeight))
+		return 0;	/* Memory failure. */
+	Viewpoint_CoverSkippedRows(pThis);
+
+	pEdgeTable = &(pThis->PolyEdgeTable);
+	for (n = PolyCommandBuffer_GetCountM(&(pThis->Commands)) - 1;
+		  (n >= 0) && !SBuffer_IsFullM(&(pThis->SpanBuffer)); n--)
+	{	pCommand = PolyCommandBuffer_GetCommandM(&(pThis->Commands), n);
+		if ((pCommand->nVertices <= 2) || (pCommand->nFlags == PF_TRANSLUCENT))
+			continue;	/* Nothing drawn, or the background shows through. */
+		arVertices = PolyCommandBuffer_GetVerticesM(&(pThis->Commands), pCommand);
+
+		EdgeTable_WhipeM(pEdgeTable);
+		EdgeTable_AddEdge(pEdgeTable, &(arVertices[pCommand->nVertices - 1]),
+								&(arVertices[0]));
+		for (m = 1; m < pCommand->nVertices; m++)
+			EdgeTable_AddEdge(pEdgeTable, &(arVertices[m - 1]), &(arVertices[m]));
+
+		for (nY = pEdgeTable->nMinScan; nY < pEdgeTable->nMaxScan; nY++)
+			SBuffer_InsertSpan(&(pThis->SpanBuffer), nY,
+									 pEdgeTable->arSpanStartValues[nY],
+									 pEdgeTable->arSpanEndValues[nY]);
+	}
+	return 1;
+}
+
+/********************************************************************
+* Function : Viewpoint_FillBackground()
+* Purpose : Helper to Viewpoint_Draw, clears the pixels that aren't
+*           covered by polygons.
+* Pre : pThis points to an initialized Viewpoint structure with a
+*       bitmap associated with it, it's SpanBuffer covers the pixels
+*       drawn.
+* Post : All pixels of the bitmap that the SpanBuffer doesn't cover
+*        are ulBackground. If it covers everything, nothing's been
+*        written.
+********************************************************************/
+static void Viewpoint_FillBackground(struct Viewpoint *pThis)
+{
+	unsigned char arPattern[VIEWPOINT_PATTERNALLOC];
+	unsigned char *pRow;
+	short *pSpans;
+	int nPixelSize;
+	int nCount;
+	int nX, nY;
+
+	if (SBuffer_IsFullM(&(pThis->SpanBuffer)))
+		return;	/* Nothing to clear. */
+
+	Viewpoint_BuildPattern(pThis, pThis->ulBackground, arPattern);
+	nPixelSize = Viewpoint_GetPixelSizeM(pThis);
+	pRow = pThis->pBitmap;
+	for (nY = 0; nY < pThis->nHeight; nY++)
+	{	/* Clear in between the covered spans. */
+		nX = 0;
+		pSpans = SBuffer_GetSpansM(&(pThis->SpanBuffer), nY);
+		for (nCount = SBuffer_GetSpanCountM(&(pThis->SpanBuffer), nY); nCount > 0; nCount--)
+		{	if (pSpans[0] > nX)
+				Viewpoint_pClearBytes(pRow + nX * nPixelSize,
+											 (pSpans[0] - nX) * nPixelSize, arPattern);
+			nX = pSpans[1];
+			pSpans += 2;
+		}
+		if (nX < pThis->nWidth)
+			Viewpoint_pClearBytes(pRow + nX * nPixelSize,
+										 (pThis->nWidth - nX) * nPixelSize, arPattern);
+		pRow += pThis->nPixelRow * nPixelSize;
+	}
+}
+
+/********************************************************************
+* Function : Viewpoint_CoverSkippedRows()
+* Purpose : Helper to Viewpoint_Draw(), marks the scanlines that
+*           interlacing skips as covered in the span buffer.
+* Pre : pThis points to an initialized Viewpoint structure, it's
+*       SpanBuffer has just been sized to the bitmap.
+* Post : If interlacing, the scanlines of the other field are fully
+*        covered, so nothing is drawn there, the background isn't
+*        cleared there and the span buffer is full as soon as the
+*        current field is.
+********************************************************************/
+static void Viewpoint_CoverSkippedRows(struct Viewpoint *pThis)
+{
+	int nY;
+
+	if (!pThis->nInterlace)
+		return;
+	for (nY = pThis->nField ^ 1; nY < pThis->nHeight; nY += 2)
+		SBuffer_InsertSpan(&(pThis->SpanBuffer), nY, 0, pThis->nWidth);
+}
+
+/********************************************************************
+* Function : Viewpoint_RestoreSkippedRows()
+* Purpose : Helper to Viewpoint_Draw(), fills the scanlines that
+*           interlacing skipped from the frame before.
+* Pre : pThis points to an initialized Viewpoint structure that has
+*       just drawn the scanlines of field nField.
+* Post : If the returnvalue is 1, the drawn scanlines were saved in
+*        pLastFrame and the others were copied from there, or
+*        repeated from a neighbour if it didn't hold a frame of the
+*        same size. Damage also covers the restored scanlines,
+*        LastDrawnDamage is the damage of the drawn ones.
+*        If the returnvalue is 0, a memory failure occured and the
+*        skipped scanlines are left as they were.
+********************************************************************/
+static int Viewpoint_RestoreSkippedRows(struct Viewpoint *pThis)
+{
+	struct DamageList Drawn;
+	struct DamageRect *pRect;
+	unsigned char *pLastFrame;
+	unsigned char *pRow;
+	unsigned char *pSaved;
+	int nRowBytes;
+	int nBytesPerRow;
+	int nBytes;
+	int nValid;
+	int nY;
+	int n;
+
+	nRowBytes = pThis->nWidth * Viewpoint_GetPixelSizeM(pThis);
+	nBytesPerRow = pThis->nPixelRow * Viewpoint_GetPixelSizeM(pThis);
+	nBytes = nRowBytes * pThis->nHeight;
+	if (nBytes <= 0)
+		return 1;	/* Nothing to restore. */
+	if (nBytes > pThis->nLastFrameAlloc)
+	{	pLastFrame = (unsigned char *)realloc((void *)pThis->pLastFrame, nBytes);
+		if (pLastFrame == NULL)
+			return 0;	/* Memory failure. */
+		pThis->pLastFrame = pLastFrame;
+		pThis->nLastFrameAlloc = nBytes;
+		pThis->nLastFrameRow = 0;
+	}
+	nValid = (pThis->nLastFrameRow == nRowBytes) &&
+				(pThis->nLastFrameHeight == pThis->nHeight);
+
+	/* Save the drawn scanlines, restore the others. */
+	pRow = pThis->pBitmap;
+	pSaved = pThis->pLastFrame;
+	for (nY = 0; nY < pThis->nHeight; nY++)
+	{	if (!((nY ^ pThis->nField) & 1))
+			memcpy(pSaved, pRow, nRowBytes);
+		else
+		if (nValid)
+			memcpy(pRow, pSaved, nRowBytes);
+		pRow += nBytesPerRow;
+		pSaved += nRowBytes;
+	}
+	if (!nValid)
+	{	/* Repeat the drawn scanline above, or below for the top. */
+		pRow = pThis->pBitmap + (pThis->nField ^ 1) * nBytesPerRow;
+		for (nY = pThis->nField ^ 1; nY < pThis->nHeight; nY += 2)
+		{	if (nY > 0)
+				memcpy(pRow, pRow - nBytesPerRow, nRowBytes);
+			else
+			if (pThis->nHeight > 1)
+				memcpy(pRow, pRow + nBytesPerRow, nRowBytes);
+			pRow += 2 * nBytesPerRow;
+		}
+	}
+	pThis->nLastFrameRow = nRowBytes;
+	pThis->nLastFrameHeight = pThis->nHeight;
+
+	/* The restored scanlines were drawn the frame before, only the
+	 * damage of the ones drawn then counts. Repeated scanlines are
+	 * next to the drawn ones. */
+	Drawn = pThis->Damage;
+	if (nValid)
+		DamageList_AddList(&(pThis->Damage), &(pThis->LastDrawnDamage));
+	else
+	{	for (n = 0; n < DamageList_GetCountM(&Drawn); n++)
+		{	pRect = DamageList_GetRectM(&Drawn, n);
+			DamageList_Add(&(pThis->Damage), pRect->nLeft,
+								(pRect->nTop > 0) ? pRect->nTop - 1 : 0,
+								pRect->nRight,
+								(pRect->nBottom < pThis->nHeight) ? pRect->nBottom + 1 : pRect->nBottom);
+		}
+	}
+	pThis->LastDrawnDamage = Drawn;
+	return 1;
+}
+
+/********************************************************************
+* Function : Viewpoint_SetDrawmode()
+* Purpose : Select the order in which this Viewpoint draws polygons.
+*         See header about accepted modes.
+* Post : Returns 1 if this Viewpoint successfully accepted this mode.
+*       All drawing using this Viewpoint will use this mode,
+*       other possible Viewpoints will not be affected.
+********************************************************************/
+int Viewpoint_SetDrawmode(struct Viewpoint *pThis, unsigned char mode)
+{
+	switch( mode )
+	{
+		case CHROME_VIEWPOINT_DRAWMODE_BACKTOFRONT:
+		case CHROME_VIEWPOINT_DRAWMODE_SBUFFER:
+		case CHROME_VIEWPOINT_DRAWMODE_TILED:
+		case CHROME_VIEWPOINT_DRAWMODE_SCANLINE:
+			pThis->nDrawmode = mode;
+			break;
+		default:
+			return 0;
+	}
+	return 1;
+}
+
+/********************************************************************
+* Function : Viewpoint_SetThreads()
+* Purpose : Select the number of threads that draw in tiled drawing
+*         mode and prepare Actors in parallel.
+* Pre : pThis points to an initialized Viewpoint structure that
+*       isn't drawing. nThreads is the number of threads, including
+*       the calling thread, 0 for one per processor.
+* Post : Returns 1 if the threads were started, 0 if not, in which
+*       case only the calling thread draws the tiles.
+********************************************************************/
+int Viewpoint_SetThreads(struct Viewpoint *pThis, int nThreads)
+{
+	return ThreadPool_Start(&(pThis->TilePool), nThreads);
+}
+
+/********************************************************************
+* Function : Viewpoint_SetParallelPrep()
+* Purpose : Select whether Actors are prepared for drawing on the
+*         threads set by Viewpoint_SetThreads().
+* Pre : pThis points to an initialized Viewpoint structure that
+*       isn't preparing Actors.
+* Post : With nEnable set, Viewpoint_PrepActorsForDraw() clips and
+*       projects the Actors in parallel, otherwise only on the
+*       calling thread.
+********************************************************************/
+void Viewpoint_SetParallelPrep(struct Viewpoint *pThis, int nEnable)
+{
+	pThis->nParallelPrep = nEnable ? 1 : 0;
+}
+
+/********************************************************************
+* Function : Viewpoint_CollectActorTree()
+*            (Used by Viewpoint_DrawTiled and Viewpoint_Draw)
+* Purpose : Recursive function that traverses an entire HPlane
+*           tree and passes the polygons, back to front, to a
+*           function collecting them for drawing later on.
+* Pre : As Viewpoint_DrawActorTree(). pCollect is the function
+*       collecting the polygons, it returns 0 on a memory failure.
+* Post : If the returnvalue is 1, pCollect has been called for the
+*        whole subtree of pPlane (including all actors in the
+*        subspaces), in the order Viewpoint_DrawActorTree() would
+*        draw it.
+*        If the returnvalue is 0, a memory failure occured.
+********************************************************************/
+static int Viewpoint_CollectActorTree(struct Viewpoint *pThis,
+												  struct Actor *pActor,
+												  struct HPlane *pPlane,
+												  int nLevel,
+												  int (*pCollect)(struct Viewpoint *pThis,
+																		struct Actor *pActor,
+																		struct Polygon *pPoly))
+{
+	int n;
+	int nPass;
+	struct IndexSet *pIndices;
+	struct Polygon *pPoly;
+	struct HPlane *pNear, *pFar;
+	int nNearLevel, nFarLevel;
+
+	/* Check if we reached one of our tree's leafs. */
+	if (pPlane == NULL)
+	{	/* Check if there is an Actor in this leaf. */
+		pActor = ActorPtrSet_GetActorPtrM(&(pActor->SubActorSet), nLevel);
+		if (pActor != NULL)
+			return Viewpoint_CollectActorTree(pThis, pActor, pActor->pModel->pRoot, 0,
+														 pCollect);
+		return 1;
+	}
+
+	/* Pick the sides of the plane as Viewpoint_DrawActorTree() does,
+	 * the far side is collected first. */
+	if (0.f < Plane_DistanceOfVectorM(&(pPlane->BinPlane), &(pActor->ViewpointOrigin)))
+	{	pFar = pPlane->pInSubtree;
+		nFarLevel = nLevel;
+		pNear = pPlane->pOutSubtree;
+		nNearLevel = nLevel + pPlane->nInsideLeafCount;
+		pIndices = &(pPlane->OutsideIndices);
+	} else
+	{	pFar = pPlane->pOutSubtree;
+		nFarLevel = nLevel + pPlane->nInsideLeafCount;
+		pNear = pPlane->pInSubtree;
+		nNearLevel = nLevel;
+		pIndices = &(pPlane->InsideIndices);
+	}
+
+	if (!Viewpoint_CollectActorTree(pThis, pActor, pFar, nFarLevel, pCollect))
+		return 0;	/* Memory failure. */
+	/* The opaque polygons of the plane first, then the translucent
+	 * ones that blend with them. */
+	for (nPass = 0; nPass < 2; nPass++)
+		for (n = 0; n < IndexSet_GetCountM(pIndices); n++)
+		{	pPoly = Actor_GetPolygonM(pActor, IndexSet_GetIndexM(pIndices, n));
+			if ((pPoly->nFlags == PF_TRANSLUCENT) != nPass)
+				continue;	/* Other pass. */
+			if (!pCollect(pThis, pActor, pPoly))
+				return 0;	/* Memory failure. */
+		}
+	return Viewpoint_CollectActorTree(pThis, pActor, pNear, nNearLevel, pCollect);
+}
+
+/********************************************************************
+* Function : Viewpoint_RecordPolygon()
+* Purpose : Helper to Viewpoint_RecordCommands, adds a polygon to the
+*           Commands of the Viewpoint.
+* Pre : pThis points to an initialized Viewpoint, pActor to an Actor
+*       prepared for drawing and pPoly to one of it's polygons.
+* Post : If the returnvalue is 1, pPoly and it's ScreenVertex
+*        structures have been added after the polygons added before,
+*        unless it has 2 vertices or less.
+*        If the returnvalue is 0, a memory failure occured.
+********************************************************************/
+static int Viewpoint_RecordPolygon(struct Viewpoint *pThis,
+											  struct Actor *pActor,
+											  struct Polygon *pPoly)
+{
+	struct ScreenVertex *pSV;
+	struct ScreenVertex TexSV;
+	int m;
+
+	/* Only display polygons with more than 2 vertices. */
+	if (IndexSet_GetCountM(&(pPoly->Vertices)) <= 2)
+		return 1;
+
+	if (!PolyCommandBuffer_AddPolygon(&(pThis->Commands), pPoly))
+		return 0;	/* Memory failure. */
+	for (m = 0; m < IndexSet_GetCountM(&(pPoly->Vertices)); m++)
+	{	pSV = Actor_GetScreenVertex(pActor, pPoly, m, &TexSV);
+		if (!PolyCommandBuffer_AddVertexM(&(pThis->Commands), pSV))
+			return 0;	/* Memory failure. */
+	}
+	return 1;
+}
+
+/********************************************************************
+* Function : Viewpoint_BinPolygon()
+* Purpose : Helper to Viewpoint_DrawTiled, adds a polygon to the
+*           tiles that it's screen vertices overlap.
+* Pre : pThis points to an initialized Viewpoint, pActor to an Actor
+*       prepared for drawing and pPoly to one of it's polygons.
+* Post : If the returnvalue is 1, pPoly has been added to the tiles
+*        if it has more than 2 vertices.
+*        If the returnvalue is 0, a memory failure occured.
+********************************************************************/
+static int Viewpoint_BinPolygon(struct Viewpoint *pThis,
+										  struct Actor *pActor,
+										  struct Polygon *pPoly)
+{
+	int k, m;
+	int nLeft, nTop, nRight, nBottom;
+	struct ScreenVertex *pSV;
+
+	/* Only display polygons with more than 2 vertices. */
+	if (IndexSet_GetCountM(&(pPoly->Vertices)) <= 2)
+		return 1;
+
+	/* Get the bounding rectangle of the ScreenVertices. Spans end
+	 * before the rightmost X and the last scanline isn't filled, so
+	 * the polygon never draws outside of it. */
+	nLeft = nTop = 32767;
+	nRight = nBottom = -32768;
+	for (m = 0; m < IndexSet_GetCountM(&(pPoly->Vertices)); m++)
+	{	k = IndexSet_GetIndexM(&(pPoly->Vertices), m);
+		if (k < 0)
+			pSV = ScreenVertexSet_GetScreenVertexM(&(pActor->ClippedScreenVertices), ~k);
+		else
+			pSV = ScreenVertexSet_GetScreenVertexM(&(pActor->NormalScreenVertices), k);
+		if (pSV->nX < nLeft)
+			nLeft = pSV->nX;
+		if (pSV->nX > nRight)
+			nRight = pSV->nX;
+		if (pSV->nY < nTop)
+			nTop = pSV->nY;
+		if (pSV->nY > nBottom)
+			nBottom = pSV->nY;
+	}
+
+	return TileBins_Add(&(pThis->Tiles), pActor, pPoly,
+							  nLeft, nTop, nRight, nBottom);
+}
+
+/********************************************************************
+* Function : Viewpoint_DrawTile()
+* Purpose : Job of the TilePool in tiled drawing, draws the polygons
+*           of a single tile.
+* Pre : pData points to the Viewpoint structure being drawn by
+*       Viewpoint_DrawTiled(), nTile is the tile to draw and nThread
+*       the number of the thread drawing it.
+* Post : The polygons of the tile have been drawn in order, clipped
+*        to the part of the tile inside the bitmap.
+* Note : Every thread has it's own EdgeTable and no two threads ever
+*        write the same pixels, the Viewpoint is only read.
+********************************************************************/
+static void Viewpoint_DrawTile(void *pData, int nTile, int nThread)
+{
+	struct Viewpoint *pThis;
+	struct EdgeTable *pEdgeTable;
+	struct IndexSet *pBin;
+	struct TileCommand *pCommand;
+	struct PolyCommand Pending;
+	int nX, nY;
+	int nRight, nBottom;
+	int n;
+
+	pThis = (struct Viewpoint *)pData;
+	pEdgeTable = &(pThis->arTileEdgeTables[nThread]);
+	pBin = TileBins_GetBinM(&(pThis->Tiles), nTile);
+
+	/* Clip to the tile. The last tiles of a row or column may reach
+	 * past the bitmap, and clipped polygons may as well, so the
+	 * tile is clipped to the bitmap too. */
+	nX = (nTile % pThis->Tiles.nColumns) * pThis->Tiles.nTileSize;
+	nY = (nTile / pThis->Tiles.nColumns) * pThis->Tiles.nTileSize;
+	nRight = nX + pThis->Tiles.nTileSize;
+	if (nRight > pThis->nWidth)
+		nRight = pThis->nWidth;
+	nBottom = nY + pThis->Tiles.nTileSize;
+	if (nBottom > pThis->nHeight)
+		nBottom = pThis->nHeight;
+	EdgeTable_SetClipRect(pEdgeTable, nX, nY, nRight, nBottom);
+
+	for (n = 0; n < IndexSet_GetCountM(pBin); n++)
+	{	pCommand = TileBins_GetCommandM(&(pThis->Tiles), IndexSet_GetIndexM(pBin, n));
+		Viewpoint_ScanPolygon(pThis, pEdgeTable, pCommand->pActor, pCommand->pPoly,
+									 &Pending);
+	}
+	Viewpoint_FlushSpans(pThis, pEdgeTable, &Pending);
+}
+
+/********************************************************************
+* Function : Viewpoint_DrawTiled() (Used by Viewpoint_Draw)
+* Purpose : Draws all Actors that were prepared for drawing tile by
+*           tile, on the threads of the TilePool.
+* Pre : As Viewpoint_Draw(), pThis->pRootActor is not NULL.
+* Post : If the returnvalue is 1, all Actors have been rendered in
+*        the bitmap exactly as Viewpoint_DrawActorTree() would.
+*        If the returnvalue is 0, a memory failure occured and
+*        nothing has been drawn.
+* Note : The edges of a polygon are stepped from their top vertex in
+*        every tile, whatever part is clipped, so the pixels of a
+*        polygon don't depend on the tiles it's cut into.
+********************************************************************/
+static int Viewpoint_DrawTiled(struct Viewpoint *pThis)
+{
+	struct EdgeTable *pEdgeTables;
+	struct DamageList *pDamage;
+	struct RenderStats *pStats;
+	int nThreads;
+	int n;
+
+	/* Every thread needs an EdgeTable covering the bitmap, a
+	 * DamageList and RenderStats. */
+	nThreads = pThis->TilePool.nThreads;
+	if (nThreads > pThis->nTileEdgeTables)
+	{	pDamage = (struct DamageList *)realloc((void *)pThis->arTileDamage,
+															sizeof(struct DamageList) * nThreads);
+		if (pDamage == NULL)
+			return 0;	/* Memory failure. */
+		pThis->arTileDamage = pDamage;
+		pStats = (struct RenderStats *)realloc((void *)pThis->arTileStats,
+															sizeof(struct RenderStats) * nThreads);
+		if (pStats == NULL)
+			return 0;	/* Memory failure. */
+		pThis->arTileStats = pStats;
+		pEdgeTables = (struct EdgeTable *)realloc((void *)pThis->arTileEdgeTables,
+																sizeof(struct EdgeTable) * nThreads);
+		if (pEdgeTables == NULL)
+			return 0;	/* Memory failure. */
+		pThis->arTileEdgeTables = pEdgeTables;
+		for (n = pThis->nTileEdgeTables; n < nThreads; n++)
+			EdgeTable_ConstructM(&(pEdgeTables[n]));
+		pThis->nTileEdgeTables = nThreads;
+	}
+	for (n = 0; n < nThreads; n++)
+	{	if (!EdgeTable_AtLeast(&(pThis->arTileEdgeTables[n]), pThis->nHeight))
+			return 0;	/* Memory failure. */
+		DamageList_ConstructM(&(pThis->arTileDamage[n]));
+		pThis->arTileEdgeTables[n].pDamage = &(pThis->arTileDamage[n]);
+		RenderStats_ClearM(&(pThis->arTileStats[n]));
+		pThis->arTileEdgeTables[n].pStats = &(pThis->arTileStats[n]);
+		EdgeTable_SetInterlace(&(pThis->arTileEdgeTables[n]), pThis->nInterlace,
+									  pThis->nField);
+	}
+
+	/* Collect the polygons in the tiles. */
+	if (!TileBins_SetSize(&(pThis->Tiles), pThis->nWidth, pThis->nHeight,
+								 pThis->nTileSize))
+		return 0;	/* Memory failure. */
+	if (!Viewpoint_CollectActorTree(pThis, pThis->pRootActor,
+											  pThis->pRootActor->pModel->pRoot, 0,
+											  Viewpoint_BinPolygon))
+		return 0;	/* Memory failure. */
+
+	/* Draw the tiles. Select the span fillers first, so the threads
+	 * don't race to do so. */
+	EdgeTable_InitFillers();
+	HalfSpace_InitMaskers();
+	ThreadPool_Run(&(pThis->TilePool), Viewpoint_DrawTile, (void *)pThis,
+						TileBins_GetCountM(&(pThis->Tiles)));
+
+	/* Collect the damage and statistics of all threads. */
+	for (n = 0; n < nThreads; n++)
+	{	DamageList_AddList(&(pThis->Damage), &(pThis->arTileDamage[n]));
+		RenderStats_AddM(&(pThis->Stats), &(pThis->arTileStats[n]));
+	}
+	return 1;
+}
+
+/********************************************************************
+* Function : Viewpoint_AddScanlinePolygon()
+* Purpose : Helper to Viewpoint_Draw, adds a polygon to the
+*           ScanlineTable.
+* Pre : pThis points to an initialized Viewpoint, pActor to an Actor
+*       prepared for drawing and pPoly to one of it's polygons.
+* Post : If the returnvalue is 1, pPoly has been added in front of
+*        the polygons added before, or rejected for lying on a single
+*        scanline. It has been counted in the Stats of pThis.
+*        If the returnvalue is 0, a memory failure occured.
+* Note : Small polygons are looked at like Viewpoint_CheckSmallPolygon()
+*        does, tiny ones are added to be plotted in a single color.
+*        There's no HalfSpace here, the other small polygons are
+*        filled like any other.
+********************************************************************/
+static int Viewpoint_AddScanlinePolygon(struct Viewpoint *pThis,
+													 struct Actor *pActor,
+													 struct Polygon *pPoly)
+{
+	struct ScreenVertex *arpSV[VIEWPOINT_TINYVERTICES];
+	struct ScreenVertex arTexSV[VIEWPOINT_TINYVERTICES];
+	struct PolyCommand Command;
+	struct RenderStats *pStats;
+	unsigned long ulPixel;
+	int m, nCount;
+
+	/* Only display polygons with more than 2 vertices. */
+	nCount = IndexSet_GetCountM(&(pPoly->Vertices));
+	if (nCount <= 2)
+		return 1;
+
+	pStats = pThis->PolyEdgeTable.pStats;
+	if (nCount <= VIEWPOINT_TINYVERTICES)
+	{	/* Small enough to look at the screen bounds first. */
+		PolyCommand_SetPolygonM(&Command, pPoly);
+		for (m = 0; m < nCount; m++)
+			arpSV[m] = Actor_GetScreenVertex(pActor, pPoly, m, &(arTexSV[m]));
+		switch (Viewpoint_ClassifySmallPolygon(&Command, arpSV, nCount))
+		{	case VIEWPOINT_SMALL_REJECT :
+				if (pStats != NULL)
+					pStats->lRejected++;
+				return 1;
+			case VIEWPOINT_SMALL_TINY :
+				if (pStats != NULL)
+					pStats->lTiny++;
+				ulPixel = Viewpoint_TinyPixel(pThis, &Command, arpSV, nCount);
+				return ActiveEdgeTable_AddPolygon(&(pThis->ScanlineTable), pActor, pPoly,
+															 0, ulPixel);
+		}
+	}
+
+	if (pStats != NULL)
+		pStats->lPolygons++;
+	return ActiveEdgeTable_AddPolygon(&(pThis->ScanlineTable), pActor, pPoly,
+												 pPoly->nFlags, 0);
+}
+
+/********************************************************************
+* Function : Viewpoint_DrawSegment()
+* Purpose : Helper to Viewpoint_Draw, draws the part of a polygon's
+*           span that the ScanlineTable found to be in front.
+* Pre : pData points to the Viewpoint being drawn, pEdgeTable to it's
+*       PolyEdgeTable, set up by the ScanlineTable with the span of
+*       pPolygon on a single scanline, clipped to the part to draw.
+* Post : The part of the span has been drawn.
+* Note : The span and it's attributes are those the EdgeTable would
+*        have for the whole polygon, so the part is drawn exactly as
+*        if the whole polygon was.
+********************************************************************/
+static void Viewpoint_DrawSegment(void *pData, struct EdgeTable *pEdgeTable,
+											 struct AETPolygon *pPolygon)
+{
+	struct Viewpoint *pThis;
+	struct PolyCommand Command;
+
+	pThis = (struct Viewpoint *)pData;
+	if (pPolygon->nFlags == 0)
+	{	/* Tiny, plotted in a single color. */
+		Viewpoint_SolidFill(pThis, pEdgeTable, pPolygon->ulPixel);
+		return;
+	}
+	PolyCommand_SetPolygonM(&Command, pPolygon->pPoly);
+	Viewpoint_FillSpans(pThis, pEdgeTable, &Command);
+}
+
 /********************************************************************
 * Function : Viewpoint_DrawPolygon()
 * Purpose : Helper to Viewpoint_DrawActorTree, is not supposed
 *         to be used from anywhere else!
 * Pre : pThis points to an initialized Viewpoint
-*     pPoly points to a Polygon that have been prepared for drawing.
+*     pEdgeTable points to the EdgeTable holding the edges of
+*     the polygon of which pCommand holds the rendering
+*     information.
+********************************************************************/
+static void Viewpoint_DrawPolygon(struct Viewpoint *pThis,
+											 struct EdgeTable *pEdgeTable,
+											 struct PolyCommand *pCommand)
+{
+	/* Keep track of what's drawn. */
+	EdgeTable_AddDamage(pEdgeTable);
+	if (pEdgeTable->pStats != NULL)
+		pEdgeTable->pStats->lPolygons++;
+
+	Viewpoint_FillSpans(pThis, pEdgeTable, pCommand);
+}
+
+/********************************************************************
+* Function : Viewpoint_FillSpans()
+* Purpose : Helper to Viewpoint_DrawPolygon and Viewpoint_DrawSegment,
+*           fills the spans of a polygon.
+* Pre : pThis points to an initialized Viewpoint, pEdgeTable to the
+*       EdgeTable holding the spans of the polygon of which pCommand
+*       holds the rendering information.
+* Post : The spans have been filled, they're neither counted nor
+*        added to the damage.
 ********************************************************************/
-static void Viewpoint_DrawPolygon(struct Viewpoint *pThis, struct Polygon *pPoly)
+static void Viewpoint_FillSpans(struct Viewpoint *pThis,
+										  struct EdgeTable *pEdgeTable,
+										  struct PolyCommand *pCommand)
 {
 	struct Lightmap256 *pLmap256;
 	struct Lightmap1 *pLmap1;
+	struct TextureMap *pTexMap;
+	unsigned long nFlags;
+
+	/* Drawing front to back there's nothing behind a polygon to blend
+	 * with yet, translucent polygons are drawn opaque then. */
+	nFlags = pCommand->nFlags;
+	if ((nFlags == PF_TRANSLUCENT) &&
+		 ((pEdgeTable->pSBuffer != NULL) ||
+		  (pThis->nDrawmode == CHROME_VIEWPOINT_DRAWMODE_SCANLINE)))
+		nFlags = PF_STATICCOLOR;
 
 	if (CHROME_VIEWPOINT_RENDERMODE_INDEXED_8 == pThis->nRendermode)
 	{
-		switch (pPoly->nFlags)
+		switch (nFlags)
 		{	case PF_STATICCOLOR :
-			{	pLmap1 = (struct Lightmap1 *)pPoly->pLightmap;
+			{	pLmap1 = (struct Lightmap1 *)pCommand->pLightmap;
 				if (pLmap1 == NULL)
 				{	// A problem, there's no lightmap.
 					// Use color 0 for this.
-					EdgeTable_SolidFill(&(pThis->PolyEdgeTable), 0,
+					EdgeTable_SolidFill(pEdgeTable, 0,
+								  (short)pThis->nPixelRow, pThis->pBitmap);
+				} else
+					EdgeTable_SolidFill(pEdgeTable, (unsigned char)pLmap1->nIndex,
+								  (short)pThis->nPixelRow, pThis->pBitmap);
+			}break;
+			case PF_TRANSLUCENT :
+			{	pLmap1 = (struct Lightmap1 *)pCommand->pLightmap;
+				if (pLmap1 == NULL)
+				{	// There's no lightmap (this should not happen)
+					// Use color 0.
+					EdgeTable_SolidFill(pEdgeTable, 0,
+								  (short)pThis->nPixelRow, pThis->pBitmap);
+				} else if (pLmap1->arBlend == NULL)
+				{	// No blend table was built, draw it opaque.
+					EdgeTable_SolidFill(pEdgeTable, (unsigned char)pLmap1->nIndex,
 								  (short)pThis->nPixelRow, pThis->pBitmap);
 				} else
-					EdgeTable_SolidFill(&(pThis->PolyEdgeTable), (unsigned char)pLmap1->nIndex,
+					EdgeTable_BlendFill(pEdgeTable, pLmap1->arBlend,
 								  (short)pThis->nPixelRow, pThis->pBitmap);
 			}break;
 			case PF_DYNACOLOR :
-			{	pLmap256 = (struct Lightmap256 *)pPoly->pLightmap;
+			{	pLmap256 = (struct Lightmap256 *)pCommand->pLightmap;
 				if (pLmap256 == NULL)
 				{	// There's no lightmap (this should not happen)
 					// Use color 0.
-					EdgeTable_SolidFill(&(pThis->PolyEdgeTable), 0,
+					EdgeTable_SolidFill(pEdgeTable, 0,
+								  (short)pThis->nPixelRow, pThis->pBitmap);
+				} else
+					EdgeTable_GouraudFill(pEdgeTable, pLmap256->arIndices,
+								  (short)pThis->nPixelRow, pThis->pBitmap);
+			}break;
+			case PF_CHROME :
+			{	pTexMap = (struct TextureMap *)pCommand->pLightmap;
+				if (pTexMap == NULL)
+				{	// There's no texture (this should not happen)
+					// Use color 0.
+					EdgeTable_SolidFill(pEdgeTable, 0,
+								  (short)pThis->nPixelRow, pThis->pBitmap);
+				} else
+					EdgeTable_ChromeFill(pEdgeTable, pTexMap->CMBmp,
+								  (short)pThis->nPixelRow, pThis->pBitmap);
+			}break;
+			case PF_TEXTURE :
+			{	pTexMap = (struct TextureMap *)pCommand->pLightmap;
+				if (pTexMap == NULL)
+				{	// There's no texture (this should not happen)
+					// Use color 0.
+					EdgeTable_SolidFill(pEdgeTable, 0,
 								  (short)pThis->nPixelRow, pThis->pBitmap);
 				} else
-					EdgeTable_SolidFill(&(pThis->PolyEdgeTable), (unsigned char)pLmap256->arIndices[255],
+					EdgeTable_TextureFill(pEdgeTable, pTexMap->CMBmp,
 								  (short)pThis->nPixelRow, pThis->pBitmap);
 			}break;
 		}
 	}		
+	else if (CHROME_VIEWPOINT_RENDERMODE_RGB565_16 == pThis->nRendermode)
+	{
+		switch (nFlags)
+		{	case PF_STATICCOLOR :
+			{	EdgeTable_SolidFill16(pEdgeTable, pCommand->usRGB565,
+							  (short)pThis->nPixelRow, (unsigned_int_16 *) pThis->pBitmap);
+			}break;
+			case PF_TRANSLUCENT :
+			{	EdgeTable_BlendFill16(pEdgeTable, pCommand->usRGB565,
+							  (short)pThis->nPixelRow, (unsigned_int_16 *) pThis->pBitmap);
+			}break;
+			case PF_DYNACOLOR :
+			{	EdgeTable_GouraudFill16(pEdgeTable, pCommand->ulRGB,
+							  (short)pThis->nPixelRow, (unsigned_int_16 *) pThis->pBitmap);
+			}break;
+			case PF_CHROME :
+			{	pTexMap = (struct TextureMap *)pCommand->pLightmap;
+				if (pTexMap == NULL)
+					EdgeTable_SolidFill16(pEdgeTable, pCommand->usRGB565,
+								  (short)pThis->nPixelRow, (unsigned_int_16 *) pThis->pBitmap);
+				else
+					EdgeTable_ChromeFill16(pEdgeTable, pTexMap->Bitmap,
+								  pTexMap->ausPalette565,
+								  (short)pThis->nPixelRow, (unsigned_int_16 *) pThis->pBitmap);
+			}break;
+			case PF_TEXTURE :
+			{	pTexMap = (struct TextureMap *)pCommand->pLightmap;
+				if (pTexMap == NULL)
+					EdgeTable_SolidFill16(pEdgeTable, pCommand->usRGB565,
+								  (short)pThis->nPixelRow, (unsigned_int_16 *) pThis->pBitmap);
+				else
+					EdgeTable_TextureFill16(pEdgeTable, pTexMap->Bitmap,
+								  pTexMap->ausPalette565,
+								  (short)pThis->nPixelRow, (unsigned_int_16 *) pThis->pBitmap);
+			}break;
+		}
+	}
+	else if (CHROME_VIEWPOINT_RENDERMODE_PACKED_24 == pThis->nRendermode)
+	{
+		switch (nFlags)
+		{	case PF_STATICCOLOR :
+			{	EdgeTable_SolidFill24(pEdgeTable, pCommand->ulRGB,
+							  (short)pThis->nPixelRow, pThis->pBitmap);
+			}break;
+			case PF_TRANSLUCENT :
+			{	EdgeTable_BlendFill24(pEdgeTable, pCommand->ulRGB,
+							  (short)pThis->nPixelRow, pThis->pBitmap);
+			}break;
+			case PF_DYNACOLOR :
+			{	EdgeTable_GouraudFill24(pEdgeTable, pCommand->ulRGB,
+							  (short)pThis->nPixelRow, pThis->pBitmap);
+			}break;
+			case PF_CHROME :
+			{	pTexMap = (struct TextureMap *)pCommand->pLightmap;
+				if (pTexMap == NULL)
+					EdgeTable_SolidFill24(pEdgeTable, pCommand->ulRGB,
+								  (short)pThis->nPixelRow, pThis->pBitmap);
+				else
+					EdgeTable_ChromeFill24(pEdgeTable, pTexMap->Bitmap,
+								  pTexMap->aulPalette,
+								  (short)pThis->nPixelRow, pThis->pBitmap);
+			}break;
+			case PF_TEXTURE :
+			{	pTexMap = (struct TextureMap *)pCommand->pLightmap;
+				if (pTexMap == NULL)
+					EdgeTable_SolidFill24(pEdgeTable, pCommand->ulRGB,
+								  (short)pThis->nPixelRow, pThis->pBitmap);
+				else
+					EdgeTable_TextureFill24(pEdgeTable, pTexMap->Bitmap,
+								  pTexMap->aulPalette,
+								  (short)pThis->nPixelRow, pThis->pBitmap);
+			}break;
+		}
+	}
 	else /* Using truecolor */
 	{
-		switch (pPoly->nFlags)
+		switch (nFlags)
 		{	case PF_STATICCOLOR :
-			{	EdgeTable_SolidFill32(&(pThis->PolyEdgeTable), pPoly->ulRGB,
+			{	EdgeTable_SolidFill32(pEdgeTable, pCommand->ulRGB,
+							  (short)pThis->nPixelRow, (unsigned_int_32 *) pThis->pBitmap);
+			}break;
+			case PF_TRANSLUCENT :
+			{	EdgeTable_BlendFill32(pEdgeTable, pCommand->ulRGB,
 							  (short)pThis->nPixelRow, (unsigned_int_32 *) pThis->pBitmap);
 			}break;
 			case PF_DYNACOLOR :
-			{	EdgeTable_SolidFill32(&(pThis->PolyEdgeTable), pPoly->ulRGB,
+			{	EdgeTable_GouraudFill32(pEdgeTable, pCommand->ulRGB,
 							  (short)pThis->nPixelRow, (unsigned_int_32 *) pThis->pBitmap);
 			}break;
+			case PF_CHROME :
+			{	pTexMap = (struct TextureMap *)pCommand->pLightmap;
+				if (pTexMap == NULL)
+					EdgeTable_SolidFill32(pEdgeTable, pCommand->ulRGB,
+								  (short)pThis->nPixelRow, (unsigned_int_32 *) pThis->pBitmap);
+				else
+					EdgeTable_ChromeFill32(pEdgeTable, pTexMap->Bitmap,
+								  pTexMap->aulPalette,
+								  (short)pThis->nPixelRow, (unsigned_int_32 *) pThis->pBitmap);
+			}break;
+			case PF_TEXTURE :
+			{	pTexMap = (struct TextureMap *)pCommand->pLightmap;
+				if (pTexMap == NULL)
+					EdgeTable_SolidFill32(pEdgeTable, pCommand->ulRGB,
+								  (short)pThis->nPixelRow, (unsigned_int_32 *) pThis->pBitmap);
+				else
+					EdgeTable_TextureFill32(pEdgeTable, pTexMap->Bitmap,
+								  pTexMap->aulPalette,
+								  (short)pThis->nPixelRow, (unsigned_int_32 *) pThis->pBitmap);
+			}break;
 		}
 	}
 }
@@ -32,6 +32,44 @@
 #include "actor.h"
 #include "scvtxset.h"
 #include "edgetbl.h"
+#include "dirlight.h"
+#include "tilebin.h"
+#include "thrdpool.h"
+#include "aedgetbl.h"
+#include "polycmd.h"
+
+/* Scratch sets for preparing a single Actor for drawing, every thread
+ * preparing Actors has it's own. */
+struct PrepScratch
+{
+	/* FloatSets available for multiple purposes. Putting them here
+	 * prevents reallocating and freeing on a per frame basis. Now
+	 * they just expand on an as needed basis. */
+	struct FloatSet	TempFloatSet;
+	struct FloatSet	TempFloatSet2;
+
+	/* Planes the Actor being prepared is clipped to, in view space
+	 * with X and Y scaled as for the projection, and the outcodes
+	 * against them of the vertices of it's Model (nOutcodeAlloc
+	 * allocated), see Viewpoint_ClipActor(). */
+	struct PlaneSet	ClipPlanes;
+	int	nOutcodeAlloc;
+	unsigned long	*arOutcodes;
+
+	/* The vertices of the Model in that same space, and the vertices
+	 * created by clipping it's polygons to the planes. Of the former
+	 * only the positions are set for every vertex, the normals only for
+	 * the vertices of clipped polygons. */
+	struct VertexSet	ViewVertices;
+	struct VertexSet	ClipVertices;
+
+	/* Polygons holding the intermediate results of clipping a polygon
+	 * to more than one plane. */
+	struct Polygon	arClipPolygons[2];
+
+	/* Set when preparing an Actor failed to allocate memory. */
+	int	bFailed;
+};
 
 struct Viewpoint
 {
@@ -42,15 +80,35 @@ struct Viewpoint
 	struct Frame	VpointFrame;
 
 	/* View frustrum planes. The view frustrum consists of at least
-	 * 4 planes (excluding front- and backplanes which are optional).
+	 * 4 planes (excluding near and far planes which are optional).
 	 * Only Actors that are (fully or partially) inside the view
 	 * frustrum are visible. Actors partially inside the view
-	 * frustrum will be clipped to the view frustrum.
-	 * This is the only clipping mechanism that prevents writing
-	 * outside the bitmap's width and height. Rasterisation doesn't
-	 * perform clipping. */
+	 * frustrum will be clipped to the view frustrum, unless a guard
+	 * band is used (see below). */
 	struct PlaneSet	FrustrumPlanes;
 
+	/* Guard band. If fGuardBand is larger than 1, the rasterizer
+	 * clips spans to the bitmap's width and height and actors that
+	 * cross one of the 4 side planes of the frustrum are only
+	 * clipped in 3D when they also cross the matching plane in
+	 * GuardPlanes. These are the side planes widened to fGuardBand
+	 * times the width and height of the bitmap (around it's center).
+	 * Screen coordinates must fit in the EdgeTable, so
+	 * Viewpoint_PrecalcFrustrum() limits the band to about 16000
+	 * pixels from the center. A value of 0 (the default) disables
+	 * the guard band. */
+	float	fGuardBand;
+	struct PlaneSet	GuardPlanes;
+
+	/* Near and far planes, at fNearDistance and fFarDistance along
+	 * the Z axis, see Viewpoint_SetDepthRange(). Actors beyond the
+	 * far plane are dropped as a whole. Vertices fade out between
+	 * fFadeDistance and the far plane, see Viewpoint_SetDepthCue().
+	 * A value of 0 (the default) disables each of them. */
+	float	fNearDistance;
+	float	fFarDistance;
+	float	fFadeDistance;
+
 	/* Pointer to the Root actor. All other actors will be inserted
 	 * into the BSP tree of this actor to form a full BSP tree of the
 	 * whole 3D world. This tree is filled by the
@@ -63,7 +121,70 @@ struct Viewpoint
 	/* Some flags for multiple purposes.
 	 * Currently only used to determine if we should
 	 * render in truecolor of indexed mode. */
-	unsigned int nRendermode : 1;
+	unsigned int nRendermode : 2;
+
+	/* Order in which Viewpoint_Draw() draws the polygons, see
+	 * Viewpoint_SetDrawmode(). In span buffer mode SpanBuffer keeps
+	 * track of the pixels drawn so far. */
+	unsigned int nDrawmode : 2;
+	struct SBuffer	SpanBuffer;
+
+	/* Background. If nBackground is set, Viewpoint_Draw() sets all
+	 * pixels that no polygon covers to ulBackground itself, see
+	 * Viewpoint_SetBackground(). */
+	unsigned int nBackground : 1;
+	unsigned long	ulBackground;
+
+	/* Interlacing. With nInterlace set, Viewpoint_Draw() only draws
+	 * the even or odd scanlines (nField), the other field every
+	 * frame, see Viewpoint_SetInterlace(). To restore the scanlines
+	 * that are skipped, pLastFrame (nLastFrameAlloc bytes) keeps the
+	 * ones drawn the frame before, for a bitmap of nLastFrameRow
+	 * bytes per scanline by nLastFrameHeight scanlines. */
+	unsigned int nInterlace : 2;
+	unsigned int nField : 1;
+	int	nLastFrameRow;
+	int	nLastFrameHeight;
+	int	nLastFrameAlloc;
+	unsigned char	*pLastFrame;
+
+	/* Tiled drawing. The bitmap is divided into tiles of nTileSize
+	 * by nTileSize pixels, Tiles holds the polygons that overlap
+	 * each of them. The tiles are drawn by the threads of
+	 * TilePool, each thread using it's own EdgeTable from
+	 * arTileEdgeTables (nTileEdgeTables of them). */
+	int	nTileSize;
+	struct TileBins	Tiles;
+	struct ThreadPool	TilePool;
+	int	nTileEdgeTables;
+	struct EdgeTable	*arTileEdgeTables;
+
+	/* Scanline drawing. ScanlineTable holds all polygons to draw and
+	 * works out which parts of them are in front. */
+	struct ActiveEdgeTable	ScanlineTable;
+
+	/* Back to front drawing. Viewpoint_RecordCommands() traverses
+	 * the BSP trees into Commands, Viewpoint_DrawCommands() then
+	 * rasterizes them. */
+	struct PolyCommandBuffer	Commands;
+
+	/* Damage. Viewpoint_Draw() collects the rectangles covering
+	 * every polygon it fills in Damage, after moving the damage of
+	 * the frame before to LastDamage. In tiled drawing every thread
+	 * collects it's own in arTileDamage (nTileEdgeTables of them).
+	 * Reconstructing interlaced frames, LastDrawnDamage covers only
+	 * the scanlines drawn the frame before, which are restored. */
+	struct DamageList	Damage;
+	struct DamageList	LastDamage;
+	struct DamageList	LastDrawnDamage;
+	struct DamageList	*arTileDamage;
+
+	/* Statistics. Viewpoint_Draw() counts the polygons it draws,
+	 * plots as tiny ones and rejects in Stats. In tiled drawing every
+	 * thread counts in it's own arTileStats (nTileEdgeTables of
+	 * them), which are added up afterwards. */
+	struct RenderStats	Stats;
+	struct RenderStats	*arTileStats;
 
 	/* Bitmap information. The bitmap consists of a width, height,
 	 * pixelrow and a pointer to the bitmap.
@@ -80,9 +201,28 @@ struct Viewpoint
 	int	nPixelRow;
 	unsigned char	*pBitmap;
 
+	/* Render scale. With fRenderScale below 1, the actors are
+	 * prepared and drawn for a bitmap of nScaledWidth by
+	 * nScaledHeight pixels, pScaleBitmap (nScaleAlloc bytes), which
+	 * is then stretched over the bitmap above using filter
+	 * nScaleFilter, see Viewpoint_SetRenderScale(). If fFrameBudget
+	 * is set, Viewpoint_Draw() adjusts fRenderScale (down to
+	 * fMinRenderScale) to the time taken since dFrameStart, when
+	 * Viewpoint_PrepActorsForDraw() was called. */
+	float	fRenderScale;
+	float	fMinRenderScale;
+	float	fFrameBudget;
+	double	dFrameStart;
+	unsigned int nScaleFilter : 1;
+	int	nScaledWidth;
+	int	nScaledHeight;
+	int	nScaleAlloc;
+	unsigned char	*pScaleBitmap;
+
 	/* EdgeTable used for rendering polygons in the above bitmap.
-	 * This should be in Viewpoint to preserve cache, and in the
-	 * Window to allow paralellized rendering. */
+	 * This should be in Viewpoint to preserve cache. Tiled drawing
+	 * doesn't use it, every thread has it's own EdgeTable (see
+	 * above). */
 	struct EdgeTable	PolyEdgeTable;
 	
 	/* Field of view (FOV). The field of view is specified in radians.
@@ -103,11 +243,26 @@ struct Viewpoint
 	float	fXMultiplier;
 	float	fYMultiplier;
 
-	/* A FloatSet available for multiple purposes. Putting it here
-	 * prevents reallocating and freeing on a per frame basis. Now
-	 * it just expands on an as needed basis. */
-	struct FloatSet	TempFloatSet;
-	struct FloatSet	TempFloatSet2;
+	/* Lighting. pDirLights is a linked list (by pNext) of the
+	 * directional lightsources that light the Actors, the Direction
+	 * of each points toward the light. fAmbient is the intensity
+	 * of light that reaches every vertex (0 to 1).
+	 * Viewpoint_PrepActorsForDraw() uses these to calculate the
+	 * intensity of every ScreenVertex from it's normal, the
+	 * PF_DYNACOLOR polygons are then gouraud shaded with them.
+	 * Without any lights, all vertices are fully lit. */
+	struct DirLight	*pDirLights;
+	float	fAmbient;
+
+	/* Preparation. Viewpoint_PrepActorsForDraw() lists the Actors
+	 * to prepare in PrepActors, then clips and projects them, with
+	 * nParallelPrep set on the threads of TilePool, see
+	 * Viewpoint_SetParallelPrep(). Each thread uses it's own
+	 * PrepScratch from arPrepScratch (nPrepScratch of them). */
+	unsigned int nParallelPrep : 1;
+	struct ActorPtrSet	PrepActors;
+	int	nPrepScratch;
+	struct PrepScratch	*arPrepScratch;
 };
 
 /* Viewpoint_Construct(pThis),
@@ -120,15 +275,56 @@ void Viewpoint_Construct(struct Viewpoint *pThis);
 	(pThis)->nHeight = 0,\
 	(pThis)->nPixelRow = 0,\
 	(pThis)->pBitmap = NULL,\
+	(pThis)->fRenderScale = 1.f,\
+	(pThis)->fMinRenderScale = 1.f,\
+	(pThis)->fFrameBudget = 0.f,\
+	(pThis)->dFrameStart = 0.,\
+	(pThis)->nScaleFilter = 0,\
+	(pThis)->nScaledWidth = 0,\
+	(pThis)->nScaledHeight = 0,\
+	(pThis)->nScaleAlloc = 0,\
+	(pThis)->pScaleBitmap = NULL,\
 	(pThis)->nRendermode = 1,\
+	(pThis)->nDrawmode = 0,\
+	(pThis)->nBackground = 0,\
+	(pThis)->ulBackground = 0,\
+	(pThis)->nInterlace = 0,\
+	(pThis)->nField = 0,\
+	(pThis)->nLastFrameRow = 0,\
+	(pThis)->nLastFrameHeight = 0,\
+	(pThis)->nLastFrameAlloc = 0,\
+	(pThis)->pLastFrame = NULL,\
+	SBuffer_Construct(&((pThis)->SpanBuffer)),\
+	(pThis)->nTileSize = 64,\
+	TileBins_Construct(&((pThis)->Tiles)),\
+	ThreadPool_Construct(&((pThis)->TilePool)),\
+	(pThis)->nTileEdgeTables = 0,\
+	(pThis)->arTileEdgeTables = NULL,\
+	DamageList_ConstructM(&((pThis)->Damage)),\
+	DamageList_ConstructM(&((pThis)->LastDamage)),\
+	DamageList_ConstructM(&((pThis)->LastDrawnDamage)),\
+	(pThis)->arTileDamage = NULL,\
+	RenderStats_ConstructM(&((pThis)->Stats)),\
+	(pThis)->arTileStats = NULL,\
+	ActiveEdgeTable_Construct(&((pThis)->ScanlineTable)),\
+	PolyCommandBuffer_Construct(&((pThis)->Commands)),\
 	(pThis)->pRootActor = NULL,\
+	(pThis)->pDirLights = NULL,\
+	(pThis)->fAmbient = 0.f,\
 	(pThis)->fXMultiplier = 0.f,\
 	(pThis)->fYMultiplier = 0.f,\
 	(pThis)->fXFOV = 0.5235987757f,\
 	(pThis)->fYFOV = 0.5235987757f,\
+	(pThis)->fGuardBand = 0.f,\
+	(pThis)->fNearDistance = 0.f,\
+	(pThis)->fFarDistance = 0.f,\
+	(pThis)->fFadeDistance = 0.f,\
 	PlaneSet_Construct(&((pThis)->FrustrumPlanes)),\
-	FloatSet_Construct(&((pThis)->TempFloatSet)),\
-	FloatSet_Construct(&((pThis)->TempFloatSet2)),\
+	PlaneSet_Construct(&((pThis)->GuardPlanes)),\
+	(pThis)->nParallelPrep = 0,\
+	ActorPtrSet_ConstructM(&((pThis)->PrepActors)),\
+	(pThis)->nPrepScratch = 0,\
+	(pThis)->arPrepScratch = NULL,\
 	EdgeTable_Construct(&((pThis)->PolyEdgeTable))\
 )
 
@@ -138,19 +334,175 @@ void Viewpoint_Construct(struct Viewpoint *pThis);
  * to the bitmap / surface you want to render into! */
 #define CHROME_VIEWPOINT_RENDERMODE_TRUECOLOR_32 0 /* Common truecolor mode, 4 bytes/pixel [aRGB] */
 #define CHROME_VIEWPOINT_RENDERMODE_INDEXED_8 1 /* Common 256 color mode, 1 byte/pixel */
+#define CHROME_VIEWPOINT_RENDERMODE_RGB565_16 2 /* Hicolor mode, 2 bytes/pixel [RGB565] */
+#define CHROME_VIEWPOINT_RENDERMODE_PACKED_24 3 /* Packed truecolor mode, 3 bytes/pixel [B,G,R] */
+/* Like TRUECOLOR_32, the RGB565_16 and PACKED_24 modes don't use the
+ * palette of the ColorManager, but the pixel values are still computed
+ * by Model_LinkToColorManager(). In all modes nPixelRow counts pixels,
+ * not bytes. */
 int Viewpoint_SetRendermode(struct Viewpoint *pThis, unsigned char mode);
 
+/* Viewpoint_GetPixelSizeM(pThis),
+ * Retrieves the number of bytes per pixel of the rendermode.
+ */
+#define Viewpoint_GetPixelSizeM(pThis)\
+(	((pThis)->nRendermode == CHROME_VIEWPOINT_RENDERMODE_INDEXED_8) ? 1 :\
+	((pThis)->nRendermode == CHROME_VIEWPOINT_RENDERMODE_RGB565_16) ? 2 :\
+	((pThis)->nRendermode == CHROME_VIEWPOINT_RENDERMODE_PACKED_24) ? 3 : 4\
+)
+
+/* Viewpoint_Clear(pThis, ulPixel),
+ * Sets all nWidth by nHeight pixels of the bitmap to ulPixel, a pixel
+ * value of the rendermode (a color index, an RGB565 value or an
+ * 0xRRGGBB color). Where available, the bitmap is written with
+ * non-temporal stores so the clear doesn't push the data used for
+ * drawing out of the cache.
+ */
+void Viewpoint_Clear(struct Viewpoint *pThis, unsigned long ulPixel);
+
+/* Viewpoint_SetBackground(pThis, nEnable, ulPixel),
+ * With nEnable set, Viewpoint_Draw() takes care of clearing the
+ * bitmap to pixel value ulPixel (as Viewpoint_Clear()) and the bitmap
+ * no longer needs to be cleared before drawing. Only the pixels no
+ * polygon covers are cleared, so when the polygons cover the whole
+ * bitmap (for instance when inside a closed room) nothing is cleared
+ * at all. Finding these pixels takes an extra pass over the polygons
+ * from front to back, which stops as soon as the bitmap is covered.
+ * Span buffer drawing gets them for free.
+ */
+void Viewpoint_SetBackground(struct Viewpoint *pThis, int nEnable,
+									  unsigned long ulPixel);
+
+/* Viewpoint_SetInterlace(pThis, mode),
+ * Lets Viewpoint_Draw() draw only every other scanline, the even
+ * ones one frame and the odd ones the next, which takes about half
+ * the filling time at the cost of some combing on moving edges. With
+ * INTERLACE_FIELDS, the skipped scanlines are left alone, they still
+ * hold the frame before if nothing else writes the bitmap. With
+ * INTERLACE_RECONSTRUCT, the skipped scanlines are restored from a
+ * copy of the frame before, so the bitmap may be cleared or swapped
+ * in between; right after switching this on or resizing there is no
+ * such copy and the neighbouring scanline is repeated instead. The
+ * damage of the frame before is added to that of a reconstructed
+ * frame. The background (see Viewpoint_SetBackground()) is only
+ * cleared on the scanlines drawn. */
+#define CHROME_VIEWPOINT_INTERLACE_OFF 0 /* Draw all scanlines */
+#define CHROME_VIEWPOINT_INTERLACE_FIELDS 1 /* Draw every other scanline */
+#define CHROME_VIEWPOINT_INTERLACE_RECONSTRUCT 2 /* Same, restore the others */
+int Viewpoint_SetInterlace(struct Viewpoint *pThis, unsigned char mode);
+
+/* Viewpoint_SetDrawmode(pThis, mode),
+ * Selects the order in which polygons are drawn.
+ * Back to front drawing (the default) overwrites whatever is behind a
+ * polygon. Span buffer drawing traverses the BSP trees front to back
+ * and only writes pixels that haven't been drawn yet, it stops as
+ * soon as the whole bitmap is covered. Tiled drawing first collects
+ * the polygons back to front for every tile of the bitmap, then
+ * draws the tiles in parallel (see Viewpoint_SetThreads()), the
+ * result is exactly that of back to front drawing. Scanline drawing
+ * collects all polygons, then walks the scanlines top to bottom and
+ * only draws the parts of the spans that are in front, so every
+ * pixel is written once, in order; the result is again that of back
+ * to front drawing. Pixels that aren't covered by any polygon are
+ * left alone in all modes. Span buffer and scanline drawing only
+ * draw the frontmost polygon of every pixel, so PF_TRANSLUCENT
+ * polygons are drawn opaque, in their own color, in those modes. */
+#define CHROME_VIEWPOINT_DRAWMODE_BACKTOFRONT 0 /* Painter's algorithm, overdraws */
+#define CHROME_VIEWPOINT_DRAWMODE_SBUFFER 1 /* Front to back, no overdraw */
+#define CHROME_VIEWPOINT_DRAWMODE_TILED 2 /* Back to front per tile, multithreaded */
+#define CHROME_VIEWPOINT_DRAWMODE_SCANLINE 3 /* Scanline order, no overdraw */
+int Viewpoint_SetDrawmode(struct Viewpoint *pThis, unsigned char mode);
+
+/* Viewpoint_SetThreads(pThis, nThreads),
+ * Sets the number of threads that draw the tiles in tiled drawing
+ * mode, and prepare the Actors with Viewpoint_SetParallelPrep(),
+ * including the thread calling Viewpoint_Draw() or
+ * Viewpoint_PrepActorsForDraw(). 0 uses one thread per processor. By
+ * default, only the calling thread is used.
+ * Returns 1 if succesful, 0 otherwise (the threads could not be
+ * started, only the calling thread is used).
+ */
+int Viewpoint_SetThreads(struct Viewpoint *pThis, int nThreads);
+
+/* Viewpoint_SetParallelPrep(pThis, nEnable),
+ * With nEnable set, Viewpoint_PrepActorsForDraw() clips and projects
+ * the Actors on the threads set by Viewpoint_SetThreads(), then
+ * inserts them in the display BSP tree one by one, in the order of
+ * the list. The result is exactly that of preparing them all on the
+ * calling thread (the default). This pays off for scenes with many
+ * Actors that need clipping.
+ */
+void Viewpoint_SetParallelPrep(struct Viewpoint *pThis, int nEnable);
+
+/* Viewpoint_SetRenderScale(pThis, fScale),
+ * Draws the actors at fScale (above 0, up to 1) times the width and
+ * height of the bitmap, and then stretches the result over the
+ * bitmap. Drawing time goes down about as fast as the number of
+ * pixels, the square of fScale. The frame is drawn in a bitmap of
+ * the Viewpoint's own that is always cleared to ulBackground (see
+ * Viewpoint_SetBackground()), and the whole bitmap is damaged. The
+ * scale is picked up by the next Viewpoint_PrepActorsForDraw() call.
+ * Returns 1 if succesful, 0 if fScale is out of range.
+ */
+int Viewpoint_SetRenderScale(struct Viewpoint *pThis, float fScale);
+
+/* Viewpoint_SetFrameBudget(pThis, fSeconds, fMinScale),
+ * Lets Viewpoint_Draw() pick the render scale (see
+ * Viewpoint_SetRenderScale()) so that Viewpoint_PrepActorsForDraw()
+ * and Viewpoint_Draw() together take about fSeconds. The scale is
+ * kept between fMinScale and 1 and follows changes in load over a
+ * few frames. A budget of 0 switches this off again, the render
+ * scale then stays where it is.
+ */
+void Viewpoint_SetFrameBudget(struct Viewpoint *pThis, float fSeconds,
+										float fMinScale);
+
+/* Viewpoint_SetScaleFilter(pThis, mode),
+ * Selects how a frame drawn at a render scale below 1 is stretched
+ * over the bitmap. Nearest neighbour (the default) repeats pixels,
+ * bilinear blends them and looks smoother, but takes more time and
+ * only works in TRUECOLOR_32 mode; other modes use nearest neighbour
+ * either way. */
+#define CHROME_VIEWPOINT_SCALEFILTER_NEAREST 0 /* Repeat pixels */
+#define CHROME_VIEWPOINT_SCALEFILTER_BILINEAR 1 /* Blend pixels, truecolor only */
+int Viewpoint_SetScaleFilter(struct Viewpoint *pThis, unsigned char mode);
+
 /* Viewpoint_Destruct(pThis),
  * Viewpoint_DestructM(pThis), (NEEDS stdlib.h INCLUDED)
- * Frees all memory associated with the viewpoint structure. */
+ * Frees all memory associated with the viewpoint structure and stops
+ * it's threads. */
 void Viewpoint_Destruct(struct Viewpoint *pThis);
 #define Viewpoint_DestructM(pThis)\
 (	PlaneSet_Destruct(&((pThis)->FrustrumPlanes)),\
-	FloatSet_Destruct(&((pThis)->TempFloatSet)),\
-	FloatSet_Destruct(&((pThis)->TempFloatSet2)),\
-	EdgeTable_Destruct(&((pThis)->PolyEdgeTable))\
+	PlaneSet_Destruct(&((pThis)->GuardPlanes)),\
+	Viewpoint_DestructPrep(pThis),\
+	EdgeTable_Destruct(&((pThis)->PolyEdgeTable)),\
+	SBuffer_Destruct(&((pThis)->SpanBuffer)),\
+	ThreadPool_Destruct(&((pThis)->TilePool)),\
+	TileBins_Destruct(&((pThis)->Tiles)),\
+	Viewpoint_DestructTileEdgeTables(pThis),\
+	ActiveEdgeTable_Destruct(&((pThis)->ScanlineTable)),\
+	PolyCommandBuffer_Destruct(&((pThis)->Commands)),\
+	(NULL != (pThis)->pScaleBitmap) ?\
+	(	free((void *)(pThis)->pScaleBitmap)\
+	):((void)0),\
+	(NULL != (pThis)->pLastFrame) ?\
+	(	free((void *)(pThis)->pLastFrame)\
+	):((void)0)\
 )
 
+/* Viewpoint_DestructTileEdgeTables(pThis),
+ * Frees the EdgeTables and DamageLists used by tiled drawing.
+ * This is a helper function for Viewpoint_DestructM().
+ */
+void Viewpoint_DestructTileEdgeTables(struct Viewpoint *pThis);
+
+/* Viewpoint_DestructPrep(pThis),
+ * Frees the Actor list and scratch sets used for preparing Actors.
+ * This is a helper function for Viewpoint_DestructM().
+ */
+void Viewpoint_DestructPrep(struct Viewpoint *pThis);
+
 /* Viewpoint_PrecalcM(pThis), (NEEDS math.h INCLUDED)
  * Initializes the fXMultiplier and fYMultiplier values from nWidth, 
  * nHeight, fXFOV and fYFOV. Call this when any of the variables has
@@ -164,7 +516,9 @@ void Viewpoint_Destruct(struct Viewpoint *pThis);
 )
 
 /* Viewpoint_PrecalcFrustrum(pThis),
- * Builds the standard 4 planes that define the view frustrum.
+ * Builds the standard 4 planes that define the view frustrum, the
+ * near and far planes if set, and the 4 guard band planes if
+ * fGuardBand is set.
  * This function depends on correct values for fXFOV and fYFOV
  * (the field of view).
  * This function **MUST** be called after the field of view has been
@@ -175,6 +529,37 @@ void Viewpoint_Destruct(struct Viewpoint *pThis);
  */
 int Viewpoint_PrecalcFrustrum(struct Viewpoint *pThis );
 
+/* Viewpoint_SetDepthRange(pThis, fNear, fFar),
+ * Sets the distances along the view direction of the near and far
+ * planes, 0 for no plane. Actors entirely beyond the far plane are
+ * dropped by their bounding sphere before any of their vertices are
+ * transformed, in large worlds that's most of them. Those crossing
+ * it are clipped to it. Like the guard band, the planes are built by
+ * the next Viewpoint_PrecalcFrustrum().
+ * Returns 1 if succesful, 0 if a distance is below 0 or the far
+ * plane isn't beyond the near plane, nothing has changed then.
+ */
+int Viewpoint_SetDepthRange(struct Viewpoint *pThis, float fNear, float fFar);
+
+/* Viewpoint_SetDepthCue(pThis, fFadeDistance),
+ * Fades the intensity of vertices from full at fFadeDistance to 0 at
+ * the far plane, so the far plane cutting off the world isn't seen.
+ * The polygons shaded by intensity (PF_DYNACOLOR) fade down their
+ * Lightmap256 to black, best used with a black background. A
+ * distance of 0, or one that isn't in front of the far plane,
+ * disables the fading.
+ */
+void Viewpoint_SetDepthCue(struct Viewpoint *pThis, float fFadeDistance);
+
+/* Viewpoint_DepthCueM(pThis),
+ * Evaluates to non zero if vertices fade out toward the far plane,
+ * see Viewpoint_SetDepthCue().
+ */
+#define Viewpoint_DepthCueM(pThis)\
+(	((pThis)->fFadeDistance > 0.f) &&\
+	((pThis)->fFadeDistance < (pThis)->fFarDistance)\
+)
+
 /* Viewpoint_PrepActorsForDraw(pThis, pActors),
  * Prepares a list of Actors pActors for display from the Viewpoint
  * pThis. What this effectively does is it inserts all Actors in the
@@ -187,7 +572,9 @@ int Viewpoint_PrecalcFrustrum(struct Viewpoint *pThis );
  * The reason for splitting these calls is that the programmer may
  * want to start a blitter during Viewpoint_PrepActorsForDraw()
  * to clear the bitmap before any drawing takes place, thus saving
- * time by running two essential processes concurrently.
+ * time by running two essential processes concurrently. Otherwise,
+ * use Viewpoint_Clear(), or have Viewpoint_Draw() clear only what
+ * it has to with Viewpoint_SetBackground().
  */
 int Viewpoint_PrepActorsForDraw(struct Viewpoint *pThis, struct Actor *pActors);
 
@@ -198,12 +585,68 @@ int Viewpoint_PrepActorsForDraw(struct Viewpoint *pThis, struct Actor *pActors);
  */
 int Viewpoint_Draw(struct Viewpoint *pThis);
 
+/* Viewpoint_GetDamageM(pThis),
+ * Retrieves the DamageList holding the rectangles that cover all
+ * pixels drawn by the last Viewpoint_Draw() call.
+ */
+#define Viewpoint_GetDamageM(pThis)\
+	(&((pThis)->Damage))
+
+/* Viewpoint_GetStatsM(pThis),
+ * Retrieves the RenderStats counting the polygons the last
+ * Viewpoint_Draw() call filled with an EdgeTable, plotted as tiny
+ * polygons (covering at most 2 by 2 pixels), filled in blocks by a
+ * HalfSpace and rejected for lying on a single scanline. Scanline
+ * drawing has no HalfSpace, it counts those polygons as filled.
+ */
+#define Viewpoint_GetStatsM(pThis)\
+	(&((pThis)->Stats))
+
+/* Viewpoint_GetChanges(pThis, pChanges),
+ * Fills DamageList pChanges with rectangles covering all pixels that
+ * may differ between the last two frames drawn by Viewpoint_Draw(),
+ * that is, the pixels drawn in either of them. This assumes the
+ * bitmap is cleared to the same background before every frame, only
+ * the pixels inside the rectangles then need to be copied out.
+ */
+void Viewpoint_GetChanges(struct Viewpoint *pThis,
+								  struct DamageList *pChanges);
+
+/* Viewpoint_RecordCommands(pThis),
+ * Traverses all actors that have been prepared for drawing by
+ * Viewpoint_PrepActorsForDraw() and records their polygons, back to
+ * front, as screen polygons in pThis->Commands, replacing what was
+ * recorded before. Nothing is drawn.
+ * Returns 1 if succesful, 0 otherwise (memory allocation failure).
+ */
+int Viewpoint_RecordCommands(struct Viewpoint *pThis);
+
+/* Viewpoint_DrawCommands(pThis, pCommands),
+ * Rasterizes the screen polygons in pCommands, in order, into the
+ * bitmap associated to pThis Viewpoint structure. pCommands is
+ * usually &pThis->Commands, but may be any PolyCommandBuffer
+ * recorded for a bitmap of the same size.
+ */
+void Viewpoint_DrawCommands(struct Viewpoint *pThis,
+									 struct PolyCommandBuffer *pCommands);
+
 /* Viewpoint_DrawActorTree(pThis, pActor, pPlane, nLevel),
- * Renders all polygons and actors in a given hyperplane tree.
- * This is a helper function for Viewpoint_Draw().
+ * Renders all polygons and actors in a given hyperplane tree,
+ * traversing and rasterizing in one go. Viewpoint_Draw() uses
+ * Viewpoint_RecordCommands() and Viewpoint_DrawCommands() instead.
  */
 void Viewpoint_DrawActorTree(struct Viewpoint *pThis,
 									  struct Actor *pActor,
 									  struct HPlane *pPlane,
 									  int nLevel);
+
+/* Viewpoint_DrawActorTreeFrontToBack(pThis, pActor, pPlane, nLevel),
+ * Renders all polygons and actors in a given hyperplane tree front to
+ * back into the span buffer, until the bitmap is covered.
+ * This is a helper function for Viewpoint_Draw().
+ */
+void Viewpoint_DrawActorTreeFrontToBack(struct Viewpoint *pThis,
+													 struct Actor *pActor,
+													 struct HPlane *pPlane,
+													 int nLevel);
 #endif
@@ -0,0 +1,382 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : vtxblock.c
+********************************************************************/
+
+#include <stdlib.h>
+
+#include "vtxblock.h"
+#include "cpufeat.h"
+
+#ifdef CHROME_X86_SIMD
+#include <emmintrin.h>
+#include <immintrin.h>
+#endif
+
+static void VertexBlock_ProjectC(struct VertexBlock *pThis, struct Transformation *pTrans);
+static void VertexBlock_ClassifyC(struct VertexBlock *pThis, struct Plane *arPlanes,
+											 int nPlanes);
+#ifdef CHROME_X86_SIMD
+static void VertexBlock_ProjectSSE2(struct VertexBlock *pThis, struct Transformation *pTrans);
+static void VertexBlock_ProjectAVX2(struct VertexBlock *pThis, struct Transformation *pTrans);
+static void VertexBlock_ClassifySSE2(struct VertexBlock *pThis, struct Plane *arPlanes,
+												 int nPlanes);
+static void VertexBlock_ClassifyAVX2(struct VertexBlock *pThis, struct Plane *arPlanes,
+												 int nPlanes);
+#endif
+
+static void (*VertexBlock_pProject)(struct VertexBlock *pThis,
+												struct Transformation *pTrans) = NULL;
+static void (*VertexBlock_pClassify)(struct VertexBlock *pThis,
+												 struct Plane *arPlanes, int nPlanes) = NULL;
+
+/********************************************************************
+* Function : VertexBlock_Load()
+* Purpose : Gathers vertices into a VertexBlock.
+* Pre : pThis points to a VertexBlock structure, arVertices to an
+*       array of at least nCount vertices, nCount is at most
+*       VERTEXBLOCK_SIZE.
+* Post : pThis holds the positions of the nCount vertices. The rest of the block is at Z = 1, so it
+*        can be projected along without dividing by 0.
+********************************************************************/
+void VertexBlock_Load(struct VertexBlock *pThis, struct Vertex *arVertices,
+							 int nCount)
+{
+	struct Vertex *pVertex;
+	int n;
+
+	pThis->nCount = nCount;
+	for (n = 0; n < nCount; n++)
+	{	pVertex = &(arVertices[n]);
+		pThis->arX[n] = pVertex->Position.V[0];
+		pThis->arY[n] = pVertex->Position.V[1];
+		pThis->arZ[n] = pVertex->Position.V[2];
+	}
+	for (; n < VERTEXBLOCK_SIZE; n++)
+	{	pThis->arX[n] = pThis->arY[n] = 0.f;
+		pThis->arZ[n] = 1.f;
+	}
+}
+
+/********************************************************************
+* Function : VertexBlock_Project()
+* Purpose : Projects the vertices of a VertexBlock to the screen.
+* Pre : pThis points to a loaded VertexBlock, pTrans to the
+*       transformation to view space, with the X and Y rows scaled
+*       so that dividing by Z gives screen coordinates.
+* Post : The outputs of pThis hold the projected vertices.
+* Note : The actual work is done by the projector selected by
+*        VertexBlock_SelectProjectors().
+********************************************************************/
+void VertexBlock_Project(struct VertexBlock *pThis, struct Transformation *pTrans)
+{
+	/* Select projectors on first use. */
+	if (VertexBlock_pProject == NULL)
+		VertexBlock_SelectProjectors(CpuFeatures_Get());
+	VertexBlock_pProject(pThis, pTrans);
+}
+
+/********************************************************************
+* Function : VertexBlock_Classify()
+* Purpose : Calculates the outcodes of the vertices of a VertexBlock.
+* Pre : pThis points to a projected VertexBlock, arPlanes to an array
+*       of nPlanes planes in view space, scaled as the transformation
+*       it was projected with.
+* Post : The arOutcodes of pThis hold the outcodes of it's vertices.
+* Note : The actual work is done by the classifier selected by
+*        VertexBlock_SelectProjectors().
+********************************************************************/
+void VertexBlock_Classify(struct VertexBlock *pThis, struct Plane *arPlanes,
+								  int nPlanes)
+{
+	/* Select classifiers on first use. */
+	if (VertexBlock_pClassify == NULL)
+		VertexBlock_SelectProjectors(CpuFeatures_Get());
+	VertexBlock_pClassify(pThis, arPlanes, nPlanes);
+}
+
+/********************************************************************
+* Function : VertexBlock_SelectProjectors()
+* Purpose : Selects the functions projecting and classifying blocks.
+* Pre : ulFeatures holds the CPUF_XXX flags of the processor.
+* Post : The fastest functions the flags allow are used from now on.
+********************************************************************/
+void VertexBlock_SelectProjectors(unsigned long ulFeatures)
+{
+	VertexBlock_pProject = VertexBlock_ProjectC;
+	VertexBlock_pClassify = VertexBlock_ClassifyC;
+#ifdef CHROME_X86_SIMD
+	if (ulFeatures & CPUF_SSE2)
+	{	VertexBlock_pProject = VertexBlock_ProjectSSE2;
+		VertexBlock_pClassify = VertexBlock_ClassifySSE2;
+	}
+	if (ulFeatures & CPUF_AVX2)
+	{	VertexBlock_pProject = VertexBlock_ProjectAVX2;
+		VertexBlock_pClassify = VertexBlock_ClassifyAVX2;
+	}
+#endif
+}
+
+/********************************************************************
+* Function : VertexBlock_InitProjectors()
+* Purpose : Selects the projectors if that hasn't been done yet.
+* Pre : -
+* Post : The projectors have been selected, either by an earlier call
+*        to VertexBlock_SelectProjectors() or now, from
+*        CpuFeatures_Get().
+********************************************************************/
+void VertexBlock_InitProjectors(void)
+{
+	if (VertexBlock_pProject == NULL)
+		VertexBlock_SelectProjectors(CpuFeatures_Get());
+}
+
+/********************************************************************
+* Function : VertexBlock_ProjectC()
+* Purpose : Plain C version of VertexBlock_Project().
+* Pre : As VertexBlock_Project().
+* Post : As VertexBlock_Project().
+* Note : The sums are in the order of Transformation_TransformM(),
+*        the SIMD versions keep it, so all give the same result.
+********************************************************************/
+static void VertexBlock_ProjectC(struct VertexBlock *pThis, struct Transformation *pTrans)
+{
+	float x, y, z;
+	int n;
+
+	for (n = 0; n < pThis->nCount; n++)
+	{	x = pTrans->Translation.V[0] +
+			 pTrans->Rotation[0][0] * pThis->arX[n] +
+			 pTrans->Rotation[0][1] * pThis->arY[n] +
+			 pTrans->Rotation[0][2] * pThis->arZ[n];
+		y = pTrans->Translation.V[1] +
+			 pTrans->Rotation[1][0] * pThis->arX[n] +
+			 pTrans->Rotation[1][1] * pThis->arY[n] +
+			 pTrans->Rotation[1][2] * pThis->arZ[n];
+		z = pTrans->Translation.V[2] +
+			 pTrans->Rotation[2][0] * pThis->arX[n] +
+			 pTrans->Rotation[2][1] * pThis->arY[n] +
+			 pTrans->Rotation[2][2] * pThis->arZ[n];
+
+		pThis->arViewX[n] = x;
+		pThis->arViewY[n] = y;
+		pThis->arDepth[n] = z;
+		if (z != 0.f)
+		{	pThis->arSX[n] = (int)(x / z);
+			pThis->arSY[n] = (int)(y / z);
+			pThis->arIZ[n] = 1.f / z;
+		}
+	}
+}
+
+/********************************************************************
+* Function : VertexBlock_ClassifyC()
+* Purpose : Plain C version of VertexBlock_Classify().
+* Pre : As VertexBlock_Classify().
+* Post : As VertexBlock_Classify().
+********************************************************************/
+static void VertexBlock_ClassifyC(struct VertexBlock *pThis, struct Plane *arPlanes,
+											 int nPlanes)
+{
+	struct Vector Position;
+	unsigned long ulOutcode;
+	int n, m;
+
+	for (n = 0; n < pThis->nCount; n++)
+	{	Position.V[0] = pThis->arViewX[n];
+		Position.V[1] = pThis->arViewY[n];
+		Position.V[2] = pThis->arDepth[n];
+		ulOutcode = 0;
+		for (m = 0; m < nPlanes; m++)
+			if (Plane_DistanceOfVectorM(&(arPlanes[m]), &Position) < 0.f)
+				ulOutcode |= VertexBlock_OutcodeBitM(m);
+		pThis->arOutcodes[n] = ulOutcode;
+	}
+}
+
+#ifdef CHROME_X86_SIMD
+/********************************************************************
+* Function : VertexBlock_ProjectSSE2()
+* Purpose : SSE2 version of VertexBlock_Project(), projects 4
+*           vertices at once.
+* Pre : As VertexBlock_Project(), the processor supports SSE2.
+* Post : As VertexBlock_Project().
+* Note : Divisions are exact, like the scalar ones. A reciprocal
+*        estimate would be faster but move vertices by a pixel now
+*        and then, and with that the edges shared with polygons that
+*        weren't projected the same way.
+********************************************************************/
+CPUFEAT_TARGET_SSE2
+static void VertexBlock_ProjectSSE2(struct VertexBlock *pThis, struct Transformation *pTrans)
+{
+	__m128 X, Y, Z;
+	__m128 x, y, z;
+	__m128 One;
+	int n;
+
+	One = _mm_set1_ps(1.f);
+	for (n = 0; n < pThis->nCount; n += 4)
+	{	X = _mm_loadu_ps(pThis->arX + n);
+		Y = _mm_loadu_ps(pThis->arY + n);
+		Z = _mm_loadu_ps(pThis->arZ + n);
+
+		x = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_set1_ps(pTrans->Translation.V[0]),
+							_mm_mul_ps(_mm_set1_ps(pTrans->Rotation[0][0]), X)),
+							_mm_mul_ps(_mm_set1_ps(pTrans->Rotation[0][1]), Y)),
+							_mm_mul_ps(_mm_set1_ps(pTrans->Rotation[0][2]), Z));
+		y = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_set1_ps(pTrans->Translation.V[1]),
+							_mm_mul_ps(_mm_set1_ps(pTrans->Rotation[1][0]), X)),
+							_mm_mul_ps(_mm_set1_ps(pTrans->Rotation[1][1]), Y)),
+							_mm_mul_ps(_mm_set1_ps(pTrans->Rotation[1][2]), Z));
+		z = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_set1_ps(pTrans->Translation.V[2]),
+							_mm_mul_ps(_mm_set1_ps(pTrans->Rotation[2][0]), X)),
+							_mm_mul_ps(_mm_set1_ps(pTrans->Rotation[2][1]), Y)),
+							_mm_mul_ps(_mm_set1_ps(pTrans->Rotation[2][2]), Z));
+
+		/* Vertices at Z = 0 divide by 0 as well, the result of those
+		 * isn't used. */
+		_mm_storeu_ps(pThis->arViewX + n, x);
+		_mm_storeu_ps(pThis->arViewY + n, y);
+		_mm_storeu_ps(pThis->arDepth + n, z);
+		_mm_storeu_si128((__m128i *)(pThis->arSX + n), _mm_cvttps_epi32(_mm_div_ps(x, z)));
+		_mm_storeu_si128((__m128i *)(pThis->arSY + n), _mm_cvttps_epi32(_mm_div_ps(y, z)));
+		_mm_storeu_ps(pThis->arIZ + n, _mm_div_ps(One, z));
+	}
+}
+
+/********************************************************************
+* Function : VertexBlock_ProjectAVX2()
+* Purpose : AVX version of VertexBlock_Project(), projects all 8
+*           vertices at once.
+* Pre : As VertexBlock_Project(), the processor supports AVX2.
+* Post : As VertexBlock_Project().
+* Note : As VertexBlock_ProjectSSE2(). Only AVX instructions are
+*        used, but AVX2 is what the processor is checked for.
+********************************************************************/
+CPUFEAT_TARGET_AVX2
+static void VertexBlock_ProjectAVX2(struct VertexBlock *pThis, struct Transformation *pTrans)
+{
+	__m256 X, Y, Z;
+	__m256 x, y, z;
+
+	X = _mm256_loadu_ps(pThis->arX);
+	Y = _mm256_loadu_ps(pThis->arY);
+	Z = _mm256_loadu_ps(pThis->arZ);
+
+	x = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_set1_ps(pTrans->Translation.V[0]),
+						 _mm256_mul_ps(_mm256_set1_ps(pTrans->Rotation[0][0]), X)),
+						 _mm256_mul_ps(_mm256_set1_ps(pTrans->Rotation[0][1]), Y)),
+						 _mm256_mul_ps(_mm256_set1_ps(pTrans->Rotation[0][2]), Z));
+	y = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_set1_ps(pTrans->Translation.V[1]),
+						 _mm256_mul_ps(_mm256_set1_ps(pTrans->Rotation[1][0]), X)),
+						 _mm256_mul_ps(_mm256_set1_ps(pTrans->Rotation[1][1]), Y)),
+						 _mm256_mul_ps(_mm256_set1_ps(pTrans->Rotation[1][2]), Z));
+	z = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(_mm256_set1_ps(pTrans->Translation.V[2]),
+						 _mm256_mul_ps(_mm256_set1_ps(pTrans->Rotation[2][0]), X)),
+						 _mm256_mul_ps(_mm256_set1_ps(pTrans->Rotation[2][1]), Y)),
+						 _mm256_mul_ps(_mm256_set1_ps(pTrans->Rotation[2][2]), Z));
+
+	_mm256_storeu_ps(pThis->arViewX, x);
+	_mm256_storeu_ps(pThis->arViewY, y);
+	_mm256_storeu_ps(pThis->arDepth, z);
+	_mm256_storeu_si256((__m256i *)pThis->arSX, _mm256_cvttps_epi32(_mm256_div_ps(x, z)));
+	_mm256_storeu_si256((__m256i *)pThis->arSY, _mm256_cvttps_epi32(_mm256_div_ps(y, z)));
+	_mm256_storeu_ps(pThis->arIZ, _mm256_div_ps(_mm256_set1_ps(1.f), z));
+}
+
+/********************************************************************
+* Function : VertexBlock_ClassifySSE2()
+* Purpose : SSE2 version of VertexBlock_Classify(), classifies 4
+*           vertices against a plane at once.
+* Pre : As VertexBlock_Classify(), the processor supports SSE2.
+* Post : As VertexBlock_Classify().
+* Note : The distances are summed in the order of
+*        Plane_DistanceOfVectorM(), so a vertex is outside exactly
+*        when Plane_ClipPolygon() would find it is.
+********************************************************************/
+CPUFEAT_TARGET_SSE2
+static void VertexBlock_ClassifySSE2(struct VertexBlock *pThis, struct Plane *arPlanes,
+												 int nPlanes)
+{
+	__m128 X, Y, Z;
+	__m128 Distance;
+	__m128i Outcodes;
+	unsigned int auOutcodes[4];
+	int n, m;
+
+	for (n = 0; n < pThis->nCount; n += 4)
+	{	X = _mm_loadu_ps(pThis->arViewX + n);
+		Y = _mm_loadu_ps(pThis->arViewY + n);
+		Z = _mm_loadu_ps(pThis->arDepth + n);
+		Outcodes = _mm_setzero_si128();
+		for (m = 0; m < nPlanes; m++)
+		{	Distance = _mm_sub_ps(_mm_add_ps(_mm_add_ps(
+								_mm_mul_ps(_mm_set1_ps(arPlanes[m].Normal.V[0]), X),
+								_mm_mul_ps(_mm_set1_ps(arPlanes[m].Normal.V[1]), Y)),
+								_mm_mul_ps(_mm_set1_ps(arPlanes[m].Normal.V[2]), Z)),
+								_mm_set1_ps(arPlanes[m].Distance));
+			Outcodes = _mm_or_si128(Outcodes,
+						  _mm_and_si128(_mm_castps_si128(_mm_cmplt_ps(Distance, _mm_setzero_ps())),
+											 _mm_set1_epi32((int)VertexBlock_OutcodeBitM(m))));
+		}
+		_mm_storeu_si128((__m128i *)auOutcodes, Outcodes);
+		for (m = 0; m < 4; m++)
+			pThis->arOutcodes[n + m] = auOutcodes[m];
+	}
+}
+
+/********************************************************************
+* Function : VertexBlock_ClassifyAVX2()
+* Purpose : AVX2 version of VertexBlock_Classify(), classifies all 8
+*           vertices against a plane at once.
+* Pre : As VertexBlock_Classify(), the processor supports AVX2.
+* Post : As VertexBlock_Classify().
+* Note : As VertexBlock_ClassifySSE2().
+********************************************************************/
+CPUFEAT_TARGET_AVX2
+static void VertexBlock_ClassifyAVX2(struct VertexBlock *pThis, struct Plane *arPlanes,
+												 int nPlanes)
+{
+	__m256 X, Y, Z;
+	__m256 Distance;
+	__m256i Outcodes;
+	unsigned int auOutcodes[8];
+	int m;
+
+	X = _mm256_loadu_ps(pThis->arViewX);
+	Y = _mm256_loadu_ps(pThis->arViewY);
+	Z = _mm256_loadu_ps(pThis->arDepth);
+	Outcodes = _mm256_setzero_si256();
+	for (m = 0; m < nPlanes; m++)
+	{	Distance = _mm256_sub_ps(_mm256_add_ps(_mm256_add_ps(
+							_mm256_mul_ps(_mm256_set1_ps(arPlanes[m].Normal.V[0]), X),
+							_mm256_mul_ps(_mm256_set1_ps(arPlanes[m].Normal.V[1]), Y)),
+							_mm256_mul_ps(_mm256_set1_ps(arPlanes[m].Normal.V[2]), Z)),
+							_mm256_set1_ps(arPlanes[m].Distance));
+		Outcodes = _mm256_or_si256(Outcodes,
+					  _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(Distance, _mm256_setzero_ps(),
+																						  _CMP_LT_OQ)),
+											 _mm256_set1_epi32((int)VertexBlock_OutcodeBitM(m))));
+	}
+	_mm256_storeu_si256((__m256i *)auOutcodes, Outcodes);
+	for (m = 0; m < pThis->nCount; m++)
+		pThis->arOutcodes[m] = auOutcodes[m];
+}
+#endif
@@ -0,0 +1,119 @@
+/* Chrome - Small 3D library...
+ * Copyright (C) Martijn Boekhorst <m.boekhorst@pi.net>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Library General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.	 See the GNU
+ * Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ * License along with this library; if not, write to the
+ * Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ * Boston, MA 02111-1307, USA.
+ */
+/********************************************************************
+* FILE : vtxblock.h
+* Purpose : Header file for the VertexBlock structure.
+* Description : The VertexBlock structure projects vertices to the
+*               screen a block at a time. The positions are gathered
+*               into separate arrays per coordinate, so every step of
+*               the transformation and the perspective division
+*               works on a whole block with SSE or AVX.
+*               The results are exactly those of projecting the
+*               vertices one by one with Transformation_TransformM()
+*               and plain divisions.
+*               Projected blocks are classified against a set of
+*               planes in view space the same way, giving an outcode
+*               per vertex.
+********************************************************************/
+
+#ifndef VTXBLOCK_H
+#define VTXBLOCK_H
+
+#include "vertex.h"
+#include "trans.h"
+#include "plane.h"
+
+/* Maximum number of vertices in a block. */
+#define VERTEXBLOCK_SIZE	8
+
+/* Number of bits in an outcode. Plane n sets bit n, the last bit is
+ * shared by all planes from VERTEXBLOCK_OUTCODEBITS - 1 on. */
+#define VERTEXBLOCK_OUTCODEBITS	32
+
+/* VertexBlock_OutcodeBitM(n),
+ * Retrieves the outcode bit of plane n.
+ */
+#define VertexBlock_OutcodeBitM(n)\
+(	((n) < VERTEXBLOCK_OUTCODEBITS - 1) ? (1UL << (n)) :\
+	(1UL << (VERTEXBLOCK_OUTCODEBITS - 1))\
+)
+
+struct VertexBlock
+{
+	int	nCount;			/* Number of vertices in the block. */
+
+	/* Input, position of the vertices. */
+	float	arX[VERTEXBLOCK_SIZE];
+	float	arY[VERTEXBLOCK_SIZE];
+	float	arZ[VERTEXBLOCK_SIZE];
+
+	/* Output, the position in view space (X and Y scaled as by the
+	 * transformation) and, for those vertices where Z isn't 0, screen
+	 * coordinates relative to the center of the
+	 * screen (truncated toward 0) and 1 / Z. */
+	float	arViewX[VERTEXBLOCK_SIZE];
+	float	arViewY[VERTEXBLOCK_SIZE];
+	float	arDepth[VERTEXBLOCK_SIZE];
+	int	arSX[VERTEXBLOCK_SIZE];
+	int	arSY[VERTEXBLOCK_SIZE];
+	float	arIZ[VERTEXBLOCK_SIZE];
+
+	/* Output of VertexBlock_Classify(), the bits of the planes each
+	 * vertex is outside of. */
+	unsigned long	arOutcodes[VERTEXBLOCK_SIZE];
+};
+
+/* VertexBlock_Load(pThis, arVertices, nCount),
+ * Gathers the first nCount (at most VERTEXBLOCK_SIZE) of the vertices
+ * in array arVertices into pThis.
+ */
+void VertexBlock_Load(struct VertexBlock *pThis, struct Vertex *arVertices,
+							 int nCount);
+
+/* VertexBlock_Project(pThis, pTrans),
+ * Transforms the vertices of pThis by pTrans and divides them by
+ * their Z to give the outputs. Uses SSE or AVX where available.
+ */
+void VertexBlock_Project(struct VertexBlock *pThis, struct Transformation *pTrans);
+
+/* VertexBlock_Classify(pThis, arPlanes, nPlanes),
+ * Sets the outcode of every projected vertex of pThis to the bits (see
+ * VertexBlock_OutcodeBitM()) of the planes in array arPlanes (nPlanes
+ * of them, in view space) it is outside of, that is, at a distance below 0 as given
+ * by Plane_DistanceOfVectorM(). Uses SSE or AVX where available.
+ */
+void VertexBlock_Classify(struct VertexBlock *pThis, struct Plane *arPlanes,
+								  int nPlanes);
+
+/* VertexBlock_SelectProjectors(ulFeatures),
+ * Selects the functions projecting and classifying blocks from the
+ * CPUF_XXX flags in ulFeatures. This is done automatically with
+ * CpuFeatures_Get() on first use, call it with 0 to force the plain C
+ * versions. All give identical results.
+ */
+void VertexBlock_SelectProjectors(unsigned long ulFeatures);
+
+/* VertexBlock_InitProjectors(),
+ * Selects the projectors with CpuFeatures_Get() unless they have been
+ * selected already. Call it before projecting from several threads at
+ * once so they don't all try to.
+ */
+void VertexBlock_InitProjectors(void);
+
+#endif